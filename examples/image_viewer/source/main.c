@@ -21,9 +21,18 @@ int main()
         return 1;
     }
 
+    // Resampled once to the window size, as floating point RGB ready to be drawn
+    PM_Image display = {0};
+
+    if(!PM_ImageTransformsResize(&display, &image, 512, 512, PICOMEDIA_IMAGE_RESIZE_FILTER_BILINEAR) ||
+       !PM_ImageTransformsChangeDataType(&display, PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT32) ||
+       !PM_ImageTransformsChangeChannelFormat(&display, PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGB)) {
+        printf("Failed to prepare image for display! \n");
+        return 1;
+    }
+
+    const PM_Float32* pixels = (const PM_Float32*)display.data;
 
-    return 0;
- 
     if(!window_manager_init())
     {
         printf("Failed to initialize window manager! \n");
@@ -39,9 +48,8 @@ int main()
         {
             for (int j = 0; j < 512; j++)
             {
-                int j2 = (int)((j / 512.0f) * image.width);
-                int i2 = (int)((i / 512.0f) * image.height);
-                window_manager_set_pixel(j / 512.0f, i / 512.0f, (float)PM_ImageGetPixelValue(&image, j2, i2, 0, NULL), (float)PM_ImageGetPixelValue(&image, j2, i2, 1, NULL), (float)PM_ImageGetPixelValue(&image, j2, i2, 2, NULL), 1.0f);
+                const PM_Float32* pixel = pixels + ((PM_Size)i * 512 + j) * 3;
+                window_manager_set_pixel(j / 512.0f, i / 512.0f, pixel[0], pixel[1], pixel[2], 1.0f);
             }
         }
 
@@ -55,6 +63,7 @@ int main()
         return 1;
     }
 
+    PM_ImageDestroy(&display);
     PM_ImageDestroy(&image);
 
     return 0;
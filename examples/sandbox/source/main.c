@@ -43,6 +43,15 @@ static PM_Bool thread_func(PM_ThreadHandle thread, void* data)
     return PM_TRUE;
 }
 
+static void parallel_for_func(PM_Size begin, PM_Size end, void* data)
+{
+    PM_UInt64* squares = (PM_UInt64*)data;
+    for (PM_Size i = begin; i < end; i++)
+    {
+        squares[i] = (PM_UInt64)i * i;
+    }
+}
+
 int main()
 {
 
@@ -71,7 +80,10 @@ int main()
         PM_ThreadDestroy(threads[i]);
     }
 
-    
+    static PM_UInt64 squares[1 << 16];
+    PM_ParallelFor(NULL, 0, sizeof(squares) / sizeof(squares[0]), 0, parallel_for_func, squares);
+    PM_LogInfo("ParallelFor on %zu workers: squares[255] = %llu", PM_ThreadPoolGetThreadCount(NULL), (unsigned long long)squares[255]);
+
     PM_LogInfo("Shutting down sandbox...");
     return 0;
 }
@@ -0,0 +1,195 @@
+#ifndef PICOMEDIA_COMMON_ATOMIC_H
+#define PICOMEDIA_COMMON_ATOMIC_H
+
+#include "libpicomedia/common/common_base.h"
+
+/**
+ * @file atomic.h
+ * @brief Portable atomic operations on 32-bit, 64-bit and pointer sized values.
+ *
+ * All the operations are sequentially consistent. They are defined inline as they usually compile
+ * down to a single instruction, the values must be naturally aligned.
+ */
+
+#if defined(PM_COMPILER_MSVC)
+    #include <intrin.h>
+#endif
+
+/**
+ * @brief Atomically reads a 32-bit value.
+ *
+ * @param value Pointer to the value.
+ * @return PM_Int32 The value.
+ */
+static inline PM_Int32 PM_AtomicLoadInt32(volatile PM_Int32* value)
+{
+#if defined(PM_COMPILER_MSVC)
+    return (PM_Int32)_InterlockedCompareExchange((volatile long*)value, 0, 0);
+#else
+    return __atomic_load_n(value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/**
+ * @brief Atomically writes a 32-bit value.
+ *
+ * @param value Pointer to the value.
+ * @param newValue The value to write.
+ */
+static inline void PM_AtomicStoreInt32(volatile PM_Int32* value, PM_Int32 newValue)
+{
+#if defined(PM_COMPILER_MSVC)
+    _InterlockedExchange((volatile long*)value, (long)newValue);
+#else
+    __atomic_store_n(value, newValue, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/**
+ * @brief Atomically adds to a 32-bit value.
+ *
+ * @param value Pointer to the value.
+ * @param delta The amount to add, may be negative.
+ * @return PM_Int32 The value after the addition.
+ */
+static inline PM_Int32 PM_AtomicAddInt32(volatile PM_Int32* value, PM_Int32 delta)
+{
+#if defined(PM_COMPILER_MSVC)
+    return (PM_Int32)_InterlockedExchangeAdd((volatile long*)value, (long)delta) + delta;
+#else
+    return __atomic_add_fetch(value, delta, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/**
+ * @brief Atomically replaces a 32-bit value if it is equal to the expected one.
+ *
+ * @param value Pointer to the value.
+ * @param expected The value expected to be found.
+ * @param desired The value to write if the expected one was found.
+ * @return PM_Bool PM_TRUE if the value was replaced, PM_FALSE otherwise.
+ */
+static inline PM_Bool PM_AtomicCompareExchangeInt32(volatile PM_Int32* value, PM_Int32 expected, PM_Int32 desired)
+{
+#if defined(PM_COMPILER_MSVC)
+    return _InterlockedCompareExchange((volatile long*)value, (long)desired, (long)expected) == (long)expected;
+#else
+    return __atomic_compare_exchange_n(value, &expected, desired, PM_FALSE, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/**
+ * @brief Atomically reads a 64-bit value.
+ *
+ * @param value Pointer to the value.
+ * @return PM_Int64 The value.
+ */
+static inline PM_Int64 PM_AtomicLoadInt64(volatile PM_Int64* value)
+{
+#if defined(PM_COMPILER_MSVC)
+    return _InterlockedCompareExchange64((volatile __int64*)value, 0, 0);
+#else
+    return __atomic_load_n(value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/**
+ * @brief Atomically writes a 64-bit value.
+ *
+ * @param value Pointer to the value.
+ * @param newValue The value to write.
+ */
+static inline void PM_AtomicStoreInt64(volatile PM_Int64* value, PM_Int64 newValue)
+{
+#if defined(PM_COMPILER_MSVC)
+    PM_Int64 current = *value;
+    while (_InterlockedCompareExchange64((volatile __int64*)value, newValue, current) != current)
+    {
+        current = *value;
+    }
+#else
+    __atomic_store_n(value, newValue, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/**
+ * @brief Atomically adds to a 64-bit value.
+ *
+ * @param value Pointer to the value.
+ * @param delta The amount to add, may be negative.
+ * @return PM_Int64 The value after the addition.
+ */
+static inline PM_Int64 PM_AtomicAddInt64(volatile PM_Int64* value, PM_Int64 delta)
+{
+#if defined(PM_COMPILER_MSVC)
+    return _InterlockedExchangeAdd64((volatile __int64*)value, delta) + delta;
+#else
+    return __atomic_add_fetch(value, delta, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/**
+ * @brief Atomically replaces a 64-bit value if it is equal to the expected one.
+ *
+ * @param value Pointer to the value.
+ * @param expected The value expected to be found.
+ * @param desired The value to write if the expected one was found.
+ * @return PM_Bool PM_TRUE if the value was replaced, PM_FALSE otherwise.
+ */
+static inline PM_Bool PM_AtomicCompareExchangeInt64(volatile PM_Int64* value, PM_Int64 expected, PM_Int64 desired)
+{
+#if defined(PM_COMPILER_MSVC)
+    return _InterlockedCompareExchange64((volatile __int64*)value, desired, expected) == expected;
+#else
+    return __atomic_compare_exchange_n(value, &expected, desired, PM_FALSE, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/**
+ * @brief Atomically reads a pointer.
+ *
+ * @param value Pointer to the pointer.
+ * @return void* The pointer.
+ */
+static inline void* PM_AtomicLoadPointer(void* volatile* value)
+{
+#if defined(PM_COMPILER_MSVC)
+    return _InterlockedCompareExchangePointer(value, NULL, NULL);
+#else
+    return __atomic_load_n(value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/**
+ * @brief Atomically writes a pointer.
+ *
+ * @param value Pointer to the pointer.
+ * @param newValue The pointer to write.
+ */
+static inline void PM_AtomicStorePointer(void* volatile* value, void* newValue)
+{
+#if defined(PM_COMPILER_MSVC)
+    _InterlockedExchangePointer(value, newValue);
+#else
+    __atomic_store_n(value, newValue, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/**
+ * @brief Atomically replaces a pointer if it is equal to the expected one.
+ *
+ * @param value Pointer to the pointer.
+ * @param expected The pointer expected to be found.
+ * @param desired The pointer to write if the expected one was found.
+ * @return PM_Bool PM_TRUE if the pointer was replaced, PM_FALSE otherwise.
+ */
+static inline PM_Bool PM_AtomicCompareExchangePointer(void* volatile* value, void* expected, void* desired)
+{
+#if defined(PM_COMPILER_MSVC)
+    return _InterlockedCompareExchangePointer(value, desired, expected) == expected;
+#else
+    return __atomic_compare_exchange_n(value, &expected, desired, PM_FALSE, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+}
+
+#endif // PICOMEDIA_COMMON_ATOMIC_H
@@ -3,6 +3,7 @@
 
 #include "libpicomedia/common/common_base.h"
 #include "libpicomedia/common/stream.h"
+#include "libpicomedia/common/thread.h"
 
 // Functions for CRC32 checksums
 // These algorithms are from https://github.com/stbrumme/crc32
@@ -45,7 +46,21 @@ PM_UInt32 PICOMEDIA_API PM_CRC32OneByte(const PM_UInt8* pData, PM_Size size, PM_
 PM_UInt32 PICOMEDIA_API PM_CRC32FourByte(const PM_UInt8* pData, PM_Size size, PM_UInt32 previousCRC32);
 
 /**
- * @brief This is just a wrapper for the PM_CRC32FourByte function.
+ * @brief Calculates the CRC32 checksum of a given data buffer using the sixteen-byte (slicing-by-16) algorithm.
+ * 
+ * This is the portable fallback used by PM_CRC32 when no hardware acceleration is available.
+ * 
+ * @param pData The data buffer.
+ * @param size The size of the data buffer.
+ * @param previousCRC32 The previous CRC32 value. Use 0 for the first call.
+ */
+PM_UInt32 PICOMEDIA_API PM_CRC32SixteenByte(const PM_UInt8* pData, PM_Size size, PM_UInt32 previousCRC32);
+
+/**
+ * @brief Calculates the CRC32 checksum using the fastest implementation supported by the CPU.
+ * 
+ * Uses carry-less multiplication folding (PCLMULQDQ) on x86, the CRC32 instructions on ARMv8
+ * and PM_CRC32SixteenByte otherwise. The result is identical to the other PM_CRC32* functions.
  * 
  * @param pData The data buffer.
  * @param size The size of the data buffer.
@@ -53,7 +68,91 @@ PM_UInt32 PICOMEDIA_API PM_CRC32FourByte(const PM_UInt8* pData, PM_Size size, PM
  */
 PM_UInt32 PICOMEDIA_API PM_CRC32(const PM_UInt8* pData, PM_Size size, PM_UInt32 previousCRC32);
 
+/**
+ * @brief Combines the CRC32 checksums of two consecutive data buffers.
+ * 
+ * Given crcA = PM_CRC32(A, lenA, 0) and crcB = PM_CRC32(B, lenB, 0) this returns the CRC32 of A followed by B,
+ * in O(log(lenB)) time without touching the data.
+ * 
+ * @param crcA The CRC32 checksum of the first buffer.
+ * @param crcB The CRC32 checksum of the second buffer.
+ * @param lenB The size of the second buffer.
+ */
+PM_UInt32 PICOMEDIA_API PM_CRC32Combine(PM_UInt32 crcA, PM_UInt32 crcB, PM_UInt64 lenB);
+
+/**
+ * @brief Calculates the CRC32 checksum of a large data buffer on multiple threads.
+ * 
+ * The buffer is split into one slice per worker of the pool plus one for the calling thread, so the size of the
+ * pool decides how many threads take part. The slices are checksummed with PM_CRC32 and the partial checksums are
+ * merged with PM_CRC32Combine. Small buffers are checksummed on the calling thread.
+ * 
+ * @param pData The data buffer.
+ * @param size The size of the data buffer.
+ * @param previousCRC32 The previous CRC32 value. Use 0 for the first call.
+ * @param pool A pointer to the PM_ThreadPool object to run on, or NULL for the default pool.
+ */
+PM_UInt32 PICOMEDIA_API PM_CRC32Parallel(const PM_UInt8* pData, PM_Size size, PM_UInt32 previousCRC32, PM_ThreadPool* pool);
+
+// Functions for CRC32C (Castagnoli) checksums, as used by iSCSI, ext4 and many storage formats
+
+/**
+ * @brief Calculates the CRC32C checksum of a given data buffer using the four-byte table algorithm.
+ * 
+ * @param pData The data buffer.
+ * @param size The size of the data buffer.
+ * @param previousCRC32C The previous CRC32C value. Use 0 for the first call.
+ */
+PM_UInt32 PICOMEDIA_API PM_CRC32CFourByte(const PM_UInt8* pData, PM_Size size, PM_UInt32 previousCRC32C);
+
+/**
+ * @brief Calculates the CRC32C checksum using the fastest implementation supported by the CPU.
+ * 
+ * Uses the SSE4.2 CRC32 instructions on x86, the CRC32C instructions on ARMv8 and PM_CRC32CFourByte otherwise.
+ * 
+ * @param pData The data buffer.
+ * @param size The size of the data buffer.
+ * @param previousCRC32C The previous CRC32C value. Use 0 for the first call.
+ */
+PM_UInt32 PICOMEDIA_API PM_CRC32C(const PM_UInt8* pData, PM_Size size, PM_UInt32 previousCRC32C);
+
+// Functions for Adler-32 checksums, as used by the zlib format (RFC 1950)
+
+/**
+ * @brief Calculates the Adler-32 checksum of a given data buffer one byte at a time.
+ * 
+ * @param pData The data buffer.
+ * @param size The size of the data buffer.
+ * @param previousAdler32 The previous Adler-32 value. Use 1 for the first call.
+ */
+PM_UInt32 PICOMEDIA_API PM_Adler32Scalar(const PM_UInt8* pData, PM_Size size, PM_UInt32 previousAdler32);
+
+/**
+ * @brief Calculates the Adler-32 checksum using the fastest implementation supported by the CPU.
+ * 
+ * Uses SSSE3 or AVX2 on x86, NEON on ARM64 and PM_Adler32Scalar otherwise.
+ * 
+ * @param pData The data buffer.
+ * @param size The size of the data buffer.
+ * @param previousAdler32 The previous Adler-32 value. Use 1 for the first call.
+ */
+PM_UInt32 PICOMEDIA_API PM_Adler32(const PM_UInt8* pData, PM_Size size, PM_UInt32 previousAdler32);
+
+// Functions for fast non-cryptographic hashes
+
+/**
+ * @brief Calculates the 64-bit XXH64 hash of a given data buffer.
+ * 
+ * The result matches the reference xxHash implementation. Unlike the checksums above, hashing two
+ * buffers by passing the first hash as the seed of the second does not equal the hash of their concatenation.
+ * 
+ * @param pData The data buffer.
+ * @param size The size of the data buffer.
+ * @param seed The seed of the hash. Use 0 for the default seed.
+ */
+PM_UInt64 PICOMEDIA_API PM_XXHash64(const PM_UInt8* pData, PM_Size size, PM_UInt64 seed);
+
 
 
 
-#endif // PICOMEDIA_COMMON_CHECKSUMS_H
\ No newline at end of file
+#endif // PICOMEDIA_COMMON_CHECKSUMS_H
@@ -5,6 +5,9 @@
 #include "libpicomedia/common/stream.h"
 #include "libpicomedia/common/utils.h"
 #include "libpicomedia/common/checksums.h"
+#include "libpicomedia/common/atomic.h"
 #include "libpicomedia/common/thread.h"
+#include "libpicomedia/common/compression.h"
+#include "libpicomedia/common/cpu.h"
 
-#endif // LIBPICOMEDIA_COMMON_H
\ No newline at end of file
+#endif // LIBPICOMEDIA_COMMON_H
\ No newline at end of file
@@ -59,6 +59,42 @@ typedef bool     PM_Bool;
     #define PM_COMPILER_UNKNOWN
 #endif
 
+// Architecture Detection
+#if defined(__x86_64__) || defined(_M_X64) || defined(_M_AMD64)
+    // x86-64
+    #define PM_ARCH_X86
+    #define PM_ARCH_X86_64
+#elif defined(__i386__) || defined(_M_IX86)
+    // x86
+    #define PM_ARCH_X86
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    // ARM64 (NEON is always available)
+    #define PM_ARCH_ARM64
+#else
+    #define PM_ARCH_UNKNOWN
+#endif
+
+// Allows a single function to be compiled for an instruction set extension, selected at runtime
+#if defined(PM_COMPILER_CLANG) || defined(PM_COMPILER_GCC)
+    #define PM_TARGET(features) __attribute__((target(features)))
+#else
+    #define PM_TARGET(features)
+#endif
+
+// The ARMv8 CRC32 instructions, GCC spells the feature as an extension of the base architecture
+#if defined(PM_COMPILER_GCC)
+    #define PM_TARGET_ARM_CRC32 PM_TARGET("+crc")
+#else
+    #define PM_TARGET_ARM_CRC32 PM_TARGET("crc")
+#endif
+
+// Variables with one instance per thread
+#if defined(PM_COMPILER_MSVC)
+    #define PM_THREAD_LOCAL __declspec(thread)
+#else
+    #define PM_THREAD_LOCAL __thread
+#endif
+
 #ifdef PM_COMPILER_MSVC
     #pragma warning(disable: 4201) // nonstandard extension used: nameless struct/union
 #elif defined(PM_COMPILER_CLANG) || defined(PM_COMPILER_GCC)
@@ -74,12 +110,24 @@ typedef bool     PM_Bool;
 #define PM_Delete(ptr) PM_Free(ptr)
 #define PM_Memcpy(dest, src, size) memcpy(dest, src, size)
 #define PM_Memset(ptr, value, size) memset(ptr, value, size)
+#define PM_Memmove(dest, src, size) memmove(dest, src, size)
 #define PM_Malloc(size) malloc(size)
 #define PM_Memcmp(ptr1, ptr2, size) memcmp(ptr1, ptr2, size)
+#define PM_Memchr(ptr, value, size) memchr(ptr, value, size)
 
 #define PM_Max(a, b) ((a) > (b) ? (a) : (b))
 #define PM_Min(a, b)  ((a) < (b) ? (a) : (b))
 
+// Bit scanning, the value must not be 0
+#if defined(PM_COMPILER_MSVC)
+    #include <intrin.h>
+    static __forceinline PM_UInt32 PM_CountTrailingZeros32(PM_UInt32 value) { unsigned long index; _BitScanForward(&index, value); return (PM_UInt32)index; }
+    static __forceinline PM_UInt32 PM_CountLeadingZeros32(PM_UInt32 value) { unsigned long index; _BitScanReverse(&index, value); return 31 - (PM_UInt32)index; }
+#else
+    #define PM_CountTrailingZeros32(value) ((PM_UInt32)__builtin_ctz(value))
+    #define PM_CountLeadingZeros32(value) ((PM_UInt32)__builtin_clz(value))
+#endif
+
 #define PM_TRUE true
 #define PM_FALSE false
 
@@ -123,4 +171,4 @@ typedef bool     PM_Bool;
     #define PICOMEDIA_API
 #endif // PICOMEDIA_SHARED
 
-#endif // PICOMEDIA_COMMON_BASE_H
\ No newline at end of file
+#endif // PICOMEDIA_COMMON_BASE_H
\ No newline at end of file
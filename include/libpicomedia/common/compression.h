@@ -0,0 +1,125 @@
+#ifndef PICOMEDIA_COMMON_COMPRESSION_H
+#define PICOMEDIA_COMMON_COMPRESSION_H
+
+#include "libpicomedia/common/common_base.h"
+
+/**
+ * @file compression.h
+ * @brief Functions for decompressing DEFLATE (RFC 1951) and zlib (RFC 1950) streams.
+ */
+
+#define PICOMEDIA_INFLATE_STATUS_DONE           0x00000000
+#define PICOMEDIA_INFLATE_STATUS_NEEDS_INPUT    0x00000001
+#define PICOMEDIA_INFLATE_STATUS_ERROR          0x00000002
+
+// Number of bits resolved with a single lookup in the huffman fast table
+#define PICOMEDIA_INFLATE_FAST_BITS             10
+// Maximum number of symbols in any of the DEFLATE alphabets (literal/length)
+#define PICOMEDIA_INFLATE_MAX_SYMBOLS           288
+
+/**
+ * @brief Structure representing a canonical huffman decoding table.
+ *
+ * Codes of up to PICOMEDIA_INFLATE_FAST_BITS bits are resolved with a single lookup in the fast table,
+ * longer codes fall back to a canonical search over the code lengths.
+ */
+struct PM_InflateHuffman
+{
+    PM_UInt16 fast[1 << PICOMEDIA_INFLATE_FAST_BITS];   /**< Fast lookup table, each entry is (codeLength << 9) | symbol, or 0 if the code is longer than the fast bits. */
+    PM_UInt32 maxCode[17];                              /**< Left aligned (16 bit) upper bound of the codes of each length. */
+    PM_UInt16 firstCode[16];                            /**< First canonical code of each length. */
+    PM_UInt16 firstSymbol[16];                          /**< Index in the sorted symbol table of the first code of each length. */
+    PM_UInt16 symbols[PICOMEDIA_INFLATE_MAX_SYMBOLS];   /**< Symbols sorted by their canonical code. */
+    PM_UInt8 sizes[PICOMEDIA_INFLATE_MAX_SYMBOLS];      /**< Code lengths of the sorted symbols. */
+};
+typedef struct PM_InflateHuffman PM_InflateHuffman;
+
+/**
+ * @brief Structure representing the state of a streaming inflate operation.
+ *
+ * The compressed input can be fed in arbitrarily sized pieces (for example one PNG IDAT chunk at a time),
+ * the decoder keeps all the state needed to resume at any bit position. The decompressed data is written
+ * to a single caller provided buffer which also serves as the 32 KB history window for back references,
+ * so no data is ever copied through an intermediate window.
+ */
+struct PM_InflateContext
+{
+    PM_InflateHuffman literalLengthTable;   /**< Huffman table for the literal/length alphabet of the current block. */
+    PM_InflateHuffman distanceTable;        /**< Huffman table for the distance alphabet of the current block. */
+    PM_InflateHuffman codeLengthTable;      /**< Huffman table for the code length alphabet of the current dynamic block header. */
+    PM_UInt8 codeLengths[286 + 32];         /**< Code lengths of the current dynamic block header. */
+    PM_UInt64 bitBuffer;                    /**< Bits pulled from the input but not yet consumed (LSB first). */
+    PM_UInt32 bitCount;                     /**< Number of valid bits in the bit buffer. */
+    const PM_UInt8* input;                  /**< Current position in the input being fed. */
+    const PM_UInt8* inputEnd;               /**< End of the input being fed. */
+    PM_UInt8* output;                       /**< Start of the output buffer. */
+    PM_UInt8* outputCursor;                 /**< Current write position in the output buffer. */
+    PM_UInt8* outputEnd;                    /**< End of the output buffer. */
+    PM_UInt32 state;                        /**< Current state of the decoder. */
+    PM_UInt32 storedRemaining;              /**< Number of bytes left to copy in the current stored block. */
+    PM_UInt32 literalCount;                 /**< Number of literal/length codes of the current dynamic block. */
+    PM_UInt32 distanceCount;                /**< Number of distance codes of the current dynamic block. */
+    PM_UInt32 codeLengthCount;              /**< Number of code length codes of the current dynamic block. */
+    PM_UInt32 codeLengthIndex;              /**< Index of the next code length to read in the current dynamic block header. */
+    PM_UInt32 adler32;                      /**< Adler-32 checksum read from the zlib trailer, verified against the decompressed data. */
+    PM_Bool isFinalBlock;                   /**< Flag indicating whether the current block is the last one of the stream. */
+    PM_Bool hasZlibWrapper;                 /**< Flag indicating whether the stream has a zlib header and trailer. */
+};
+typedef struct PM_InflateContext PM_InflateContext;
+
+
+/**
+ * @brief Initializes an inflate context.
+ *
+ * @param context Pointer to the PM_InflateContext struct to initialize.
+ * @param hasZlibWrapper PM_TRUE if the stream is a zlib stream (as in PNG), PM_FALSE for a raw DEFLATE stream.
+ */
+void PICOMEDIA_API PM_InflateContextInit(PM_InflateContext* context, PM_Bool hasZlibWrapper);
+
+/**
+ * @brief Sets the output buffer of an inflate context.
+ *
+ * The whole decompressed stream is written to this buffer, it must stay valid until the stream is
+ * completely decoded. Decompressing more data than the buffer can hold is treated as an error.
+ *
+ * @param context Pointer to the PM_InflateContext struct.
+ * @param output Pointer to the output buffer.
+ * @param outputSize Size of the output buffer, in bytes.
+ */
+void PICOMEDIA_API PM_InflateContextSetOutput(PM_InflateContext* context, PM_UInt8* output, PM_Size outputSize);
+
+/**
+ * @brief Feeds the next piece of compressed data to an inflate context.
+ *
+ * All of the provided data is consumed (kept in the context if it can not be decoded yet), so the caller
+ * can release or reuse the input buffer as soon as this function returns.
+ *
+ * @param context Pointer to the PM_InflateContext struct.
+ * @param data Pointer to the compressed data.
+ * @param dataSize Size of the compressed data, in bytes.
+ * @return PM_UInt32 PICOMEDIA_INFLATE_STATUS_DONE if the end of the stream was reached, PICOMEDIA_INFLATE_STATUS_NEEDS_INPUT if more data is required, PICOMEDIA_INFLATE_STATUS_ERROR otherwise.
+ */
+PM_UInt32 PICOMEDIA_API PM_InflateFeed(PM_InflateContext* context, const PM_UInt8* data, PM_Size dataSize);
+
+/**
+ * @brief Gets the number of bytes decompressed so far.
+ *
+ * @param context Pointer to the PM_InflateContext struct.
+ * @return PM_Size Number of bytes written to the output buffer.
+ */
+PM_Size PICOMEDIA_API PM_InflateGetOutputSize(const PM_InflateContext* context);
+
+/**
+ * @brief Decompresses a complete DEFLATE or zlib stream held in memory.
+ *
+ * @param data Pointer to the compressed data.
+ * @param dataSize Size of the compressed data, in bytes.
+ * @param output Pointer to the output buffer.
+ * @param outputSize Size of the output buffer, in bytes.
+ * @param outputWritten Pointer to a variable receiving the number of decompressed bytes. Ignored if NULL.
+ * @param hasZlibWrapper PM_TRUE if the stream is a zlib stream, PM_FALSE for a raw DEFLATE stream.
+ * @return PM_Bool PM_TRUE if the stream was successfully decompressed, PM_FALSE otherwise.
+ */
+PM_Bool PICOMEDIA_API PM_Inflate(const PM_UInt8* data, PM_Size dataSize, PM_UInt8* output, PM_Size outputSize, PM_Size* outputWritten, PM_Bool hasZlibWrapper);
+
+#endif // PICOMEDIA_COMMON_COMPRESSION_H
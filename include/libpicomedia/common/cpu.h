@@ -0,0 +1,42 @@
+#ifndef PICOMEDIA_COMMON_CPU_H
+#define PICOMEDIA_COMMON_CPU_H
+
+#include "libpicomedia/common/common_base.h"
+
+/**
+ * @file cpu.h
+ * @brief Functions for querying the instruction set extensions supported by the CPU at runtime.
+ */
+
+#define PICOMEDIA_CPU_FEATURE_SSE2      0x00000001
+#define PICOMEDIA_CPU_FEATURE_SSSE3     0x00000002
+#define PICOMEDIA_CPU_FEATURE_SSE41     0x00000004
+#define PICOMEDIA_CPU_FEATURE_SSE42     0x00000008
+#define PICOMEDIA_CPU_FEATURE_PCLMUL    0x00000010
+#define PICOMEDIA_CPU_FEATURE_AVX       0x00000020
+#define PICOMEDIA_CPU_FEATURE_AVX2      0x00000040
+#define PICOMEDIA_CPU_FEATURE_NEON      0x00000100
+#define PICOMEDIA_CPU_FEATURE_ARM_CRC32 0x00000200
+#define PICOMEDIA_CPU_FEATURE_ARM_PMULL 0x00000400
+
+
+/**
+ * @brief Gets the instruction set extensions supported by the CPU.
+ *
+ * The features are detected on the first call (cpuid on x86, hwcaps on ARM) and cached afterwards.
+ * Extensions that need operating system support (like the AVX register state) are only reported
+ * if the operating system has enabled them.
+ *
+ * @return PM_UInt32 Bitmask of PICOMEDIA_CPU_FEATURE_* flags.
+ */
+PM_UInt32 PICOMEDIA_API PM_CPUGetFeatures();
+
+/**
+ * @brief Checks if the CPU supports all of the given instruction set extensions.
+ *
+ * @param features Bitmask of PICOMEDIA_CPU_FEATURE_* flags to check.
+ * @return PM_Bool Returns PM_TRUE if all of the features are supported, PM_FALSE otherwise.
+ */
+PM_Bool PICOMEDIA_API PM_CPUHasFeature(PM_UInt32 features);
+
+#endif // PICOMEDIA_COMMON_CPU_H
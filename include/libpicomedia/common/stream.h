@@ -7,11 +7,14 @@
 #define PICOMEDIA_STREAM_SOURCE_TYPE_MEMORY      0x00000002
 #define PICOMEDIA_STREAM_SOURCE_TYPE_NETWORK     0x00000004 // for future use
 #define PICOMEDIA_STREAM_SOURCE_TYPE_UNKNOWN     0x00000008
+#define PICOMEDIA_STREAM_SOURCE_TYPE_MMAP        0x00000010
 
 #define PICOMEDIA_STREAM_FLAG_READ               0x00000001
 #define PICOMEDIA_STREAM_FLAG_WRITE              0x00000002
 #define PICOMEDIA_STREAM_FLAG_APPEND             0x00000004
 
+#define PICOMEDIA_STREAM_DEFAULT_BUFFER_SIZE     (64 * 1024)
+
 
 /**
  * @brief Structure representing a stream of data.
@@ -22,7 +25,8 @@
 struct PM_Stream
 {
     FILE* fileSource;       /**< Pointer to the file source, if applicable. */
-    PM_Byte* memorySource;  /**< Pointer to the memory source, if applicable. */
+    PM_Byte* memorySource;  /**< Pointer to the memory source, if applicable (also the mapped view of a memory-mapped file). */
+    void* mappingHandle;    /**< Platform handle of the file mapping of a memory-mapped file, if applicable. */
     PM_Size sourceSize;     /**< Size of the source data, in bytes. */
     PM_Int64 cursorPosition;/**< Current position of the stream's cursor. */
     PM_UInt32 sourceType;   /**< Type of the stream's source, such as file or memory. */
@@ -31,6 +35,14 @@ struct PM_Stream
     PM_Bool isSourceOwner;  /**< Flag indicating whether the stream is the owner of its source data. */
     PM_Bool requireReverse; /**< Flag indicating whether the stream's data should be reversed when reading if target endianess is different from host endianess. */
     PM_Size sizeForReverse; /**< Max size of data that will be reversed when reading if target endianess is different from host endianess. */
+    PM_Byte* acquireBuffer; /**< Buffer backing the data borrowed with PM_StreamAcquire for sources that can not be accessed in place. */
+    PM_Size acquireBufferCapacity; /**< Capacity of the acquire buffer, in bytes. */
+    PM_Bool isAcquired;     /**< Flag indicating whether data is currently borrowed with PM_StreamAcquire. */
+    PM_Byte* buffer;        /**< Read-ahead (or write-behind) buffer of file streams, allocated on first use. */
+    PM_Size bufferCapacity; /**< Capacity of the read-ahead/write-behind buffer, in bytes (0 disables buffering). */
+    PM_Size bufferOffset;   /**< Position in the file of the first byte held by the buffer. */
+    PM_Size bufferLength;   /**< Number of bytes held by the buffer (read ahead, or waiting to be written). */
+    PM_Size filePosition;   /**< Position of the underlying file, which lags behind the cursor for buffered streams. */
 };
 
 /** Typedef for PM_Stream struct. */
@@ -62,6 +74,22 @@ void PICOMEDIA_API PM_StreamInit(PM_Stream* stream);
 */
 PM_Bool PICOMEDIA_API PM_StreamInitFromFile(PM_Stream* stream, const char* fileName, PM_UInt8 flags);
 
+/**
+ * @brief Initializes a read-only PM_Stream struct from a memory-mapped file.
+ * 
+ * The whole file is mapped into the address space, so reads are served straight from the page cache
+ * and the data can be accessed in place through memorySource, without any copies through stdio buffers.
+ * The mapping is hinted for sequential access and read-ahead.
+ * 
+ * If the file exists but can not be mapped (for example an empty file or a pipe) the stream falls back to
+ * a regular file stream, as if PM_StreamInitFromFile had been used.
+ * 
+ * @param stream Pointer to the PM_Stream struct to initialize.
+ * @param fileName Name of the file to map.
+ * @return PM_Bool PM_TRUE if the stream was successfully initialized, PM_FALSE otherwise.
+ */
+PM_Bool PICOMEDIA_API PM_StreamInitFromFileMapped(PM_Stream* stream, const char* fileName);
+
 /**
  * @brief Initializes a PM_Stream struct from a file descriptor.
  * 
@@ -148,7 +176,8 @@ PM_Size PICOMEDIA_API PM_StreamWrite(PM_Stream* stream, const PM_Byte* buffer, P
  * This function peeks at data from a stream into a buffer. The amount of data peeked is determined by the
  * size parameter. The stream's cursor is not advanced.
  * 
- * NOTE: This function internally calls PM_StreamRead
+ * NOTE: This function internally calls PM_StreamRead, for file streams small peeks are served from the
+ * read-ahead buffer, so they do not touch the file.
  * 
  * @param stream Pointer to the PM_Stream struct to peek from.
  * @param buffer Pointer to the buffer to peek into.
@@ -157,6 +186,61 @@ PM_Size PICOMEDIA_API PM_StreamWrite(PM_Stream* stream, const PM_Byte* buffer, P
 */
 PM_Size PICOMEDIA_API PM_StreamPeek(PM_Stream* stream, PM_Byte* buffer, PM_Size size);
 
+/**
+ * @brief Borrows the next bytes of a stream without copying them.
+ * 
+ * This function returns a pointer to the next size bytes of the stream and advances the stream's cursor
+ * past them. For memory and memory-mapped streams the pointer points straight into the source, for file
+ * streams the data is read into a buffer owned by the stream, which is reused by later calls.
+ * If the end of the stream is reached fewer bytes are returned.
+ * 
+ * The data is returned as stored in the source, no endianess conversion is applied, and must not be modified.
+ * It stays valid until PM_StreamRelease is called, which must follow every call to this function (even
+ * if no bytes could be borrowed). Other reads are allowed while the data is borrowed,
+ * but only one acquire can be active on a stream at a time.
+ * 
+ * @param stream Pointer to the PM_Stream struct to borrow from.
+ * @param size Number of bytes to borrow.
+ * @param data Pointer that receives the address of the borrowed bytes.
+ * @return PM_Size Number of bytes borrowed.
+*/
+PM_Size PICOMEDIA_API PM_StreamAcquire(PM_Stream* stream, PM_Size size, PM_Byte** data);
+
+/**
+ * @brief Ends the borrow started with PM_StreamAcquire.
+ * 
+ * The pointer returned by PM_StreamAcquire must not be used after this call.
+ * 
+ * @param stream Pointer to the PM_Stream struct the data was borrowed from.
+*/
+void PICOMEDIA_API PM_StreamRelease(PM_Stream* stream);
+
+/**
+ * @brief Writes the buffered data of a stream to its source.
+ * 
+ * File streams keep small writes in a write-behind buffer, which is written out when it fills up, when the
+ * cursor is moved away from it, and when the stream is destroyed. This function writes it out right away
+ * (and flushes the stdio buffers). For read streams the read-ahead buffer is dropped, so data changed
+ * by someone else is read again from the file.
+ * 
+ * @param stream Pointer to the PM_Stream struct to flush.
+ * @return PM_Bool PM_TRUE if all of the buffered data was written, PM_FALSE otherwise.
+*/
+PM_Bool PICOMEDIA_API PM_StreamFlush(PM_Stream* stream);
+
+/**
+ * @brief Sets the size of the read-ahead/write-behind buffer of a file stream.
+ * 
+ * File streams serve reads, peeks and small writes from an internal buffer of
+ * PICOMEDIA_STREAM_DEFAULT_BUFFER_SIZE bytes, so that byte by byte parsing does not go through stdio and
+ * seeking for every access. Reads and writes that are at least as large as the buffer bypass it.
+ * Any buffered data is flushed before the size is changed. Memory streams do not use the buffer.
+ * 
+ * @param stream Pointer to the PM_Stream struct to configure.
+ * @param size Size of the buffer, in bytes. 0 disables buffering.
+*/
+void PICOMEDIA_API PM_StreamSetBufferSize(PM_Stream* stream, PM_Size size);
+
 /**
  * @brief Gets the current position of the stream's cursor.
  * 
@@ -2,6 +2,7 @@
 #define PICOMEDIA_COMMON_THREAD_H
 
 #include "libpicomedia/common/common_base.h"
+#include "libpicomedia/common/atomic.h"
 
 /**
  * @file thread.h
@@ -22,6 +23,43 @@ struct PM_Mutex;
 typedef struct PM_Mutex PM_Mutex;
 typedef PM_Mutex* PM_MutexHandle; // This is just a wrapper to avoid typing out the pointer syntax.
 
+/**
+ * @brief Structure representing a condition variable.
+ */
+struct PM_ConditionVariable;
+typedef struct PM_ConditionVariable PM_ConditionVariable;
+
+/**
+ * @brief Structure representing a counting semaphore.
+ */
+struct PM_Semaphore;
+typedef struct PM_Semaphore PM_Semaphore;
+
+/**
+ * @brief Structure representing a bounded multi-producer multi-consumer queue.
+ *
+ * Pushing and popping never take a lock, each slot carries a sequence number telling producers and
+ * consumers whether it is free or filled, so threads only contend on a single compare-and-swap.
+ */
+struct PM_MPMCQueue;
+typedef struct PM_MPMCQueue PM_MPMCQueue;
+
+/**
+ * @brief Structure representing a pool of persistent worker threads.
+ *
+ * Each worker owns a deque of tasks, it pushes and pops its own tasks at the back and steals from
+ * the front of the other workers' deques when it runs out of work. Tasks submitted from threads
+ * outside of the pool go through a shared queue.
+ */
+struct PM_ThreadPool;
+typedef struct PM_ThreadPool PM_ThreadPool;
+
+/**
+ * @brief Structure representing a group of tasks that can be waited on together.
+ */
+struct PM_TaskGroup;
+typedef struct PM_TaskGroup PM_TaskGroup;
+
 /**
  * @brief Function pointer type for thread function.
  *
@@ -36,6 +74,22 @@ typedef PM_Bool (*PM_ThreadFunc)(PM_Thread* thread, void* data);
  */
 typedef PM_UInt64 PM_ThreadID;
 
+/**
+ * @brief Function pointer type for a task run by a thread pool.
+ *
+ * @param data Additional data passed to the task.
+ */
+typedef void (*PM_TaskFunc)(void* data);
+
+/**
+ * @brief Function pointer type for the body of a parallel for loop.
+ *
+ * @param begin The first index of the range to process.
+ * @param end One past the last index of the range to process.
+ * @param data Additional data passed to PM_ParallelFor.
+ */
+typedef void (*PM_ParallelForFunc)(PM_Size begin, PM_Size end, void* data);
+
 
 /**
  * @brief Creates a new thread and associates it with the specified function. After creation, the thread is immediately started.
@@ -84,6 +138,13 @@ PM_Bool PICOMEDIA_API PM_ThreadIsRunning(PM_Thread* thread);
  */
 PM_ThreadID PICOMEDIA_API PM_ThreadGetCurrrentID();
 
+/**
+ * @brief Retrieves the number of logical processors available to the process.
+ * 
+ * @return The number of logical processors, at least 1.
+ */
+PM_Size PICOMEDIA_API PM_ThreadGetProcessorCount();
+
 /**
  * @brief Logs a message from the specified thread.
  * 
@@ -124,4 +185,210 @@ PM_Bool PICOMEDIA_API PM_MutexLock(PM_Mutex* mutex);
  */
 PM_Bool PICOMEDIA_API PM_MutexUnlock(PM_Mutex* mutex);
 
-#endif // PICOMEDIA_COMMON_THREAD_H
\ No newline at end of file
+
+/**
+ * @brief Creates a new condition variable.
+ *
+ * @return A pointer to the newly created condition variable.
+ */
+PM_ConditionVariable* PICOMEDIA_API PM_ConditionVariableCreate();
+
+/**
+ * @brief Destroys a condition variable.
+ *
+ * @param conditionVariable A pointer to the condition variable to be destroyed.
+ */
+void PICOMEDIA_API PM_ConditionVariableDestroy(PM_ConditionVariable* conditionVariable);
+
+/**
+ * @brief Atomically unlocks the mutex and waits until the condition variable is signaled, the mutex is locked again before returning.
+ *
+ * Wake ups can be spurious, so the condition being waited for must be checked again in a loop.
+ *
+ * @param conditionVariable A pointer to the condition variable.
+ * @param mutex A pointer to the mutex, which must be locked by the calling thread.
+ * @return PM_TRUE if the wait succeeded, PM_FALSE otherwise.
+ */
+PM_Bool PICOMEDIA_API PM_ConditionVariableWait(PM_ConditionVariable* conditionVariable, PM_Mutex* mutex);
+
+/**
+ * @brief Wakes up one thread waiting on the condition variable.
+ *
+ * @param conditionVariable A pointer to the condition variable.
+ */
+void PICOMEDIA_API PM_ConditionVariableSignal(PM_ConditionVariable* conditionVariable);
+
+/**
+ * @brief Wakes up all the threads waiting on the condition variable.
+ *
+ * @param conditionVariable A pointer to the condition variable.
+ */
+void PICOMEDIA_API PM_ConditionVariableBroadcast(PM_ConditionVariable* conditionVariable);
+
+
+/**
+ * @brief Creates a new counting semaphore.
+ *
+ * @param initialCount The initial count of the semaphore.
+ * @return A pointer to the newly created semaphore.
+ */
+PM_Semaphore* PICOMEDIA_API PM_SemaphoreCreate(PM_UInt32 initialCount);
+
+/**
+ * @brief Destroys a semaphore.
+ *
+ * @param semaphore A pointer to the semaphore to be destroyed.
+ */
+void PICOMEDIA_API PM_SemaphoreDestroy(PM_Semaphore* semaphore);
+
+/**
+ * @brief Waits until the count of the semaphore is positive, then decrements it.
+ *
+ * @param semaphore A pointer to the semaphore.
+ * @return PM_TRUE if the semaphore was acquired, PM_FALSE otherwise.
+ */
+PM_Bool PICOMEDIA_API PM_SemaphoreWait(PM_Semaphore* semaphore);
+
+/**
+ * @brief Decrements the count of the semaphore if it is positive, without blocking.
+ *
+ * @param semaphore A pointer to the semaphore.
+ * @return PM_TRUE if the semaphore was acquired, PM_FALSE if its count was 0.
+ */
+PM_Bool PICOMEDIA_API PM_SemaphoreTryWait(PM_Semaphore* semaphore);
+
+/**
+ * @brief Increments the count of the semaphore, waking up as many waiting threads.
+ *
+ * @param semaphore A pointer to the semaphore.
+ * @param count The amount to add to the count.
+ */
+void PICOMEDIA_API PM_SemaphorePost(PM_Semaphore* semaphore, PM_UInt32 count);
+
+
+/**
+ * @brief Creates a new bounded multi-producer multi-consumer queue.
+ *
+ * @param capacity The maximum number of elements in the queue, rounded up to a power of two.
+ * @param elementSize The size of an element, in bytes. Elements are copied in and out of the queue.
+ * @return A pointer to the created PM_MPMCQueue object, or NULL if the creation fails.
+ */
+PM_MPMCQueue* PICOMEDIA_API PM_MPMCQueueCreate(PM_Size capacity, PM_Size elementSize);
+
+/**
+ * @brief Destroys a queue, any elements still in it are discarded.
+ *
+ * @param queue A pointer to the PM_MPMCQueue object to be destroyed.
+ */
+void PICOMEDIA_API PM_MPMCQueueDestroy(PM_MPMCQueue* queue);
+
+/**
+ * @brief Copies an element to the back of the queue, without blocking.
+ *
+ * @param queue A pointer to the PM_MPMCQueue object.
+ * @param element A pointer to the element to copy.
+ * @return PM_TRUE if the element was pushed, PM_FALSE if the queue is full.
+ */
+PM_Bool PICOMEDIA_API PM_MPMCQueuePush(PM_MPMCQueue* queue, const void* element);
+
+/**
+ * @brief Copies the element at the front of the queue out and removes it, without blocking.
+ *
+ * @param queue A pointer to the PM_MPMCQueue object.
+ * @param element A pointer receiving the element.
+ * @return PM_TRUE if an element was popped, PM_FALSE if the queue is empty.
+ */
+PM_Bool PICOMEDIA_API PM_MPMCQueuePop(PM_MPMCQueue* queue, void* element);
+
+/**
+ * @brief Gets the capacity of a queue.
+ *
+ * @param queue A pointer to the PM_MPMCQueue object.
+ * @return PM_Size The maximum number of elements in the queue.
+ */
+PM_Size PICOMEDIA_API PM_MPMCQueueGetCapacity(const PM_MPMCQueue* queue);
+
+
+/**
+ * @brief Creates a new thread pool and starts its worker threads.
+ *
+ * @param threadCount The number of worker threads. Use 0 for one per logical processor.
+ * @return A pointer to the created PM_ThreadPool object, or NULL if the creation fails.
+ */
+PM_ThreadPool* PICOMEDIA_API PM_ThreadPoolCreate(PM_Size threadCount);
+
+/**
+ * @brief Waits for all the submitted tasks to finish, then stops and destroys the thread pool.
+ *
+ * @param pool A pointer to the PM_ThreadPool object to be destroyed.
+ */
+void PICOMEDIA_API PM_ThreadPoolDestroy(PM_ThreadPool* pool);
+
+/**
+ * @brief Gets the process wide thread pool, which is created with one worker per logical processor on first use.
+ *
+ * All the functions taking a pool use this one when they are given NULL.
+ *
+ * @return A pointer to the default PM_ThreadPool object, or NULL if it could not be created.
+ */
+PM_ThreadPool* PICOMEDIA_API PM_ThreadPoolGetDefault();
+
+/**
+ * @brief Retrieves the number of worker threads of a thread pool.
+ *
+ * @param pool A pointer to the PM_ThreadPool object, or NULL for the default pool.
+ * @return The number of worker threads.
+ */
+PM_Size PICOMEDIA_API PM_ThreadPoolGetThreadCount(PM_ThreadPool* pool);
+
+/**
+ * @brief Creates a new task group on a thread pool.
+ *
+ * @param pool A pointer to the PM_ThreadPool object, or NULL for the default pool.
+ * @return A pointer to the created PM_TaskGroup object, or NULL if the creation fails.
+ */
+PM_TaskGroup* PICOMEDIA_API PM_TaskGroupCreate(PM_ThreadPool* pool);
+
+/**
+ * @brief Waits for all the tasks of the group to finish and destroys it.
+ *
+ * @param group A pointer to the PM_TaskGroup object to be destroyed.
+ */
+void PICOMEDIA_API PM_TaskGroupDestroy(PM_TaskGroup* group);
+
+/**
+ * @brief Submits a task to the pool of a task group.
+ *
+ * If the task can not be queued it is run immediately on the calling thread.
+ *
+ * @param group A pointer to the PM_TaskGroup object.
+ * @param func The function to be executed by the task.
+ * @param data A pointer to the data that will be passed to the task function.
+ */
+void PICOMEDIA_API PM_TaskGroupRun(PM_TaskGroup* group, PM_TaskFunc func, void* data);
+
+/**
+ * @brief Waits for all the tasks of a group to finish.
+ *
+ * The calling thread runs queued tasks while it waits, so it is safe to wait from inside a task.
+ *
+ * @param group A pointer to the PM_TaskGroup object.
+ */
+void PICOMEDIA_API PM_TaskGroupWait(PM_TaskGroup* group);
+
+/**
+ * @brief Runs a function over the range [begin, end) split into chunks, in parallel on a thread pool.
+ *
+ * The calling thread processes chunks as well and the function returns once the whole range is processed.
+ * It is safe to call from inside a task or another parallel for.
+ *
+ * @param pool A pointer to the PM_ThreadPool object, or NULL for the default pool.
+ * @param begin The first index of the range.
+ * @param end One past the last index of the range.
+ * @param grain The number of indices in a chunk. Use 0 to pick one from the range size and the number of threads.
+ * @param func The function called for each chunk.
+ * @param data A pointer to the data that will be passed to the function.
+ */
+void PICOMEDIA_API PM_ParallelFor(PM_ThreadPool* pool, PM_Size begin, PM_Size end, PM_Size grain, PM_ParallelForFunc func, void* data);
+
+#endif // PICOMEDIA_COMMON_THREAD_H
\ No newline at end of file
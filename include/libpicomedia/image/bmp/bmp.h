@@ -7,6 +7,20 @@
  * @file bmp.h
  * @brief Functions for reading and writing BMP images.
  */
+
+// BMP compression methods, as stored in the info header
+#define PICOMEDIA_BMP_COMPRESSION_RGB       0x00
+#define PICOMEDIA_BMP_COMPRESSION_RLE8      0x01
+#define PICOMEDIA_BMP_COMPRESSION_RLE4      0x02
+#define PICOMEDIA_BMP_COMPRESSION_BITFIELDS 0x03
+
+// Pixel formats for writing BMP files
+#define PICOMEDIA_BMP_FORMAT_AUTO           0x00 // BGRA32 for images with alpha, BGR24 otherwise
+#define PICOMEDIA_BMP_FORMAT_BGR24          0x01
+#define PICOMEDIA_BMP_FORMAT_BGRA32         0x02 // BI_BITFIELDS with an alpha mask
+#define PICOMEDIA_BMP_FORMAT_PALETTE8       0x03 // 8-bit indices into a palette of up to 256 colors
+#define PICOMEDIA_BMP_FORMAT_RLE8           0x04 // 8-bit indices, run length encoded
+#define PICOMEDIA_BMP_FORMAT_RLE4           0x05 // 4-bit indices into a palette of up to 16 colors, run length encoded
  
 /**
  * @brief The BMP header structure.
@@ -37,6 +51,10 @@ struct PM_BMPInfoHeader
     PM_Int32 yPixelsPerMeter; /**< The vertical resolution of the image in pixels per meter. */
     PM_UInt32 colorsUsed; /**< The number of colors used in the image. */
     PM_UInt32 colorsImportant; /**< The number of important colors used in the image. */
+    PM_UInt32 redMask; /**< The mask of the red bits of a pixel, only set for PICOMEDIA_BMP_COMPRESSION_BITFIELDS. */
+    PM_UInt32 greenMask; /**< The mask of the green bits of a pixel, only set for PICOMEDIA_BMP_COMPRESSION_BITFIELDS. */
+    PM_UInt32 blueMask; /**< The mask of the blue bits of a pixel, only set for PICOMEDIA_BMP_COMPRESSION_BITFIELDS. */
+    PM_UInt32 alphaMask; /**< The mask of the alpha bits of a pixel, only set for PICOMEDIA_BMP_COMPRESSION_BITFIELDS with a V3 or later header. */
 };
 typedef struct PM_BMPInfoHeader PM_BMPInfoHeader;
 
@@ -64,6 +82,7 @@ struct PM_BMPContext
     PM_Size colorTableCapacity; /**< The BMP color table capacity. */
     PM_Byte* imageData; /**< The BMP image data. */
     PM_Size imageDataCapacity; /**< The BMP image data capacity. */
+    PM_Bool isImageDataBorrowed; /**< Whether the image data points into the stream (see PM_StreamAcquire) instead of being owned by the context. */
 };
 typedef struct PM_BMPContext PM_BMPContext;
 
@@ -195,6 +214,9 @@ PM_Bool PICOMEDIA_API PM_ImageBMPReadColorTable(PM_Stream* stream, const PM_BMPI
 /**
  * Reads the BMP image data from the given stream.
  *
+ * The image data is not copied, it is borrowed from the stream with PM_StreamAcquire. The caller must
+ * call PM_StreamRelease on the stream once it is done with the data, also when this function fails.
+ *
  * @param stream The stream to read from.
  * @param header Pointer to the BMP header structure.
  * @param imageData Pointer to the variable storing the image data.
@@ -206,12 +228,25 @@ PM_Bool PICOMEDIA_API PM_ImageBMPReadImageData(PM_Stream* stream, const PM_BMPHe
 /**
  * Decodes the BMP image using the provided context.
  *
+ * Supports 1, 2, 4 and 8-bit palettized images, uncompressed or RLE8/RLE4, 16, 24 and 32-bit images,
+ * with or without color masks, stored bottom-up or top-down. The image must already be allocated with
+ * the size of the BMP image and 8-bit channels, RGBA when the color masks include an alpha mask, RGB otherwise.
+ *
  * @param context Pointer to the BMP decoding context.
  * @param image Pointer to the image structure to fill.
  * @return True if the image was successfully decoded, false otherwise.
  */
 PM_Bool PICOMEDIA_API PM_ImageBMPDecode(const PM_BMPContext* context, PM_Image* image);
 
+/**
+ * Describes the BMP image in the given stream from its file and info headers, without reading the color table or the pixels.
+ *
+ * @param stream The stream to read from.
+ * @param info Pointer to the image info structure to fill.
+ * @return True if the headers are valid, false otherwise.
+ */
+PM_Bool PICOMEDIA_API PM_ImageBMPProbe(PM_Stream* stream, PM_ImageInfo* info);
+
 /**
  * Reads the BMP image from the given stream.
  *
@@ -270,9 +305,20 @@ PM_Bool PICOMEDIA_API PM_ImageBMPWriteInfoHeader(PM_Stream* stream, const PM_BMP
  */
 PM_Bool PICOMEDIA_API PM_ImageBMPWriteColorTable(PM_Stream* stream, const PM_BMPColorTableItem* colorTable, PM_Size colorTableSize);
 
+/**
+ * Fills the headers of the provided context for the specified image, without encoding the image data.
+ *
+ * @param image The image to encode.
+ * @param context The BMP encoding context.
+ * @return Returns true if the headers were successfully encoded, false otherwise.
+ */
+PM_Bool PICOMEDIA_API PM_ImageBMPEncodeHeaders(const PM_Image* image, PM_BMPContext* context);
+
 /**
  * Encodes the specified image in BMP format using the provided context.
  *
+ * This keeps a full copy of the image data in the context, PM_ImageBMPWrite() streams the rows instead.
+ *
  * @param image The image to encode.
  * @param context The BMP encoding context.
  * @return Returns true if the image was successfully encoded, false otherwise.
@@ -281,15 +327,43 @@ PM_Bool PICOMEDIA_API PM_ImageBMPEncode(const PM_Image* image, PM_BMPContext* co
 
 PM_Bool PICOMEDIA_API PM_ImageBMPWriteContext(PM_Stream* stream, const PM_BMPContext* context);
 
+/**
+ * Writes the image data of the specified image to the specified stream, after the headers.
+ *
+ * The rows are written bottom up straight from the image, each followed by its padding.
+ *
+ * @param stream The stream to write the image data to.
+ * @param image The image to write.
+ * @return Returns true if the image data was successfully written, false otherwise.
+ */
+PM_Bool PICOMEDIA_API PM_ImageBMPWriteImageData(PM_Stream* stream, const PM_Image* image);
+
 /**
  * Writes the specified image to the specified stream in BMP format.
  *
+ * Same as PM_ImageBMPWriteEx() with PICOMEDIA_BMP_FORMAT_AUTO.
+ *
  * @param image The image to write.
  * @param stream The stream to write the image to.
  * @return Returns true if the image was successfully written, false otherwise.
  */
 PM_Bool PICOMEDIA_API PM_ImageBMPWrite(const PM_Image* image, PM_Stream* stream);
 
+/**
+ * Writes the specified image to the specified stream in the specified BMP pixel format.
+ *
+ * The image must have 8-bit unsigned channels in the RGB, BGR, RGBA, BGRA, GRAY or GRAYA format.
+ * Pixels are converted one row at a time, the image data is never copied as a whole.
+ * Palettized formats keep the colors of the image when they fit in the palette,
+ * otherwise the colors are quantized with a median cut.
+ *
+ * @param image The image to write.
+ * @param stream The stream to write the image to.
+ * @param bmpFormat The pixel format to write (PICOMEDIA_BMP_FORMAT_*).
+ * @return Returns true if the image was successfully written, false otherwise.
+ */
+PM_Bool PICOMEDIA_API PM_ImageBMPWriteEx(const PM_Image* image, PM_Stream* stream, PM_UInt32 bmpFormat);
+
 /**
  * Writes the specified image to the specified file path in BMP format.
  *
@@ -299,6 +373,16 @@ PM_Bool PICOMEDIA_API PM_ImageBMPWrite(const PM_Image* image, PM_Stream* stream)
  */
 PM_Bool PICOMEDIA_API PM_ImageBMPWriteToFile(const PM_Image* image, const PM_Byte* filePath);
 
+/**
+ * Writes the specified image to the specified file path in the specified BMP pixel format.
+ *
+ * @param image The image to write.
+ * @param filePath The file path to write the image to.
+ * @param bmpFormat The pixel format to write (PICOMEDIA_BMP_FORMAT_*).
+ * @return Returns true if the image was successfully written, false otherwise.
+ */
+PM_Bool PICOMEDIA_API PM_ImageBMPWriteToFileEx(const PM_Image* image, const PM_Byte* filePath, PM_UInt32 bmpFormat);
+
 /**
  * Writes the specified image to the specified memory buffer in BMP format.
  *
@@ -310,5 +394,17 @@ PM_Bool PICOMEDIA_API PM_ImageBMPWriteToFile(const PM_Image* image, const PM_Byt
  */
 PM_Bool PICOMEDIA_API PM_ImageBMPWriteToMemory(const PM_Image* image, PM_Byte* data, PM_Size* dataSize, PM_Size maxDataSize);
 
+/**
+ * Writes the specified image to the specified memory buffer in the specified BMP pixel format.
+ *
+ * @param image The image to write.
+ * @param data The memory buffer to write the image to.
+ * @param dataSize The size of the memory buffer. On success, this will be updated with the actual size of the written data.
+ * @param maxDataSize The maximum size of the memory buffer.
+ * @param bmpFormat The pixel format to write (PICOMEDIA_BMP_FORMAT_*).
+ * @return Returns true if the image was successfully written, false otherwise.
+ */
+PM_Bool PICOMEDIA_API PM_ImageBMPWriteToMemoryEx(const PM_Image* image, PM_Byte* data, PM_Size* dataSize, PM_Size maxDataSize, PM_UInt32 bmpFormat);
+
 
 #endif // PICOMEDIA_IMAGE_BMP_H
@@ -42,6 +42,11 @@
 #define PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT64      0x0CA5
 #define PICOIMEDIA_IMAGE_DATA_TYPE_UNKNOWN      0x0CA6
 
+// Largest decoded image data size in bytes the readers accept, larger images are rejected before allocating
+#ifndef PICOMEDIA_IMAGE_MAX_DATA_SIZE
+#define PICOMEDIA_IMAGE_MAX_DATA_SIZE           ((PM_Size)1 << 31)
+#endif
+
 /**
  * @file image_base.h
  * @brief This file contains the definition of the PM_Image struct and its associated typedef.
@@ -65,6 +70,23 @@ struct PM_Image
  /** Typedef for PM_Image struct. */
 typedef struct PM_Image PM_Image;
 
+/**
+ * @brief A struct describing an image as far as its header tells, without the pixel data.
+ */
+struct PM_ImageInfo
+{
+    PM_UInt32  fileFormat;     /**< The file format of the image (PICOMEDIA_IMAGE_FILE_FORMAT_*). */
+    PM_UInt32  width;          /**< The width of the image in pixels. */
+    PM_UInt32  height;         /**< The height of the image in pixels. */
+    PM_UInt32  channelFormat;  /**< The channel format the image decodes to. */
+    PM_UInt32  dataType;       /**< The data type the image decodes to. */
+    PM_UInt8   numChannels;    /**< The number of channels the image decodes to. */
+    PM_UInt8   bitsPerChannel; /**< The number of bits per channel the image decodes to. */
+    PM_Size    decodedSize;    /**< Estimated size of the decoded image data in bytes, saturated at SIZE_MAX. */
+};
+/** Typedef for PM_ImageInfo struct. */
+typedef struct PM_ImageInfo PM_ImageInfo;
+
 /**
  * Initializes a PM_Image struct with default values.
  * 
@@ -109,6 +131,20 @@ PM_Bool PICOMEDIA_API PM_ImageCopy(PM_Image* dest, const PM_Image* src);
 PM_Bool PICOMEDIA_API PM_ImageAllocate(PM_Image* image, PM_UInt32 width, PM_UInt32 height, PM_UInt32 channelFormat, PM_UInt32 dataType, PM_UInt8 numChannels);
 
 
+/**
+ * @brief Makes sure the image data buffer can hold at least the given number of bytes.
+ * 
+ * Unlike PM_ImageAllocate() this does not change any of the image properties, and the existing
+ * contents of the buffer are preserved if it has to grow. This is useful for decoders that need
+ * some scratch space in the image buffer before producing the final pixels.
+ * 
+ * @param image Pointer to the PM_Image struct.
+ * @param capacity Minimum required capacity of the image data buffer, in bytes.
+ * @return PM_TRUE if the buffer is large enough, PM_FALSE if the allocation failed.
+ */
+PM_Bool PICOMEDIA_API PM_ImageReserve(PM_Image* image, PM_Size capacity);
+
+
 /**
  * Returns the size of the data type for the given image data type.
  *
@@ -168,4 +204,57 @@ PM_Float64 PICOMEDIA_API PM_ImageGetPixelValue(const PM_Image* image, PM_UInt32
  */
 PM_Bool PICOMEDIA_API PM_ImageSetPixelValue(PM_Image* image, PM_UInt32 x, PM_UInt32 y, PM_UInt8 channel, PM_Float64 pixelValue);
 
+/**
+ * Initializes a PM_ImageInfo struct with default values.
+ *
+ * @param info Pointer to a PM_ImageInfo struct to be initialized.
+ */
+void PICOMEDIA_API PM_ImageInfoInit(PM_ImageInfo* info);
+
+/**
+ * @brief Computes the size in bytes of the image data described by an info struct.
+ * 
+ * The product of width, height, number of channels and data type size is saturated at SIZE_MAX
+ * instead of wrapping around, so hostile headers cannot make a huge image look small.
+ * 
+ * @param info Pointer to the PM_ImageInfo struct.
+ * @return The size of the described image data in bytes, or SIZE_MAX if it does not fit.
+ */
+PM_Size PICOMEDIA_API PM_ImageInfoGetDataSize(const PM_ImageInfo* info);
+
+/**
+ * @brief Reads only the header of an image and describes it without decoding any pixel data.
+ * 
+ * The file format is detected from the magic number at the beginning of the stream, then only the
+ * header bytes of that format are read (the BMP file and info headers, the PPM header or the PNG IHDR
+ * chunk). This is meant to reject or queue oversized images before committing to a full decode.
+ * 
+ * NOTE: For PNG the transparency of palette, gray and RGB images is only known after reading the
+ *       chunks that follow IHDR, so decodedSize accounts for a possible alpha channel and is an upper bound.
+ * 
+ * @param stream Pointer to the stream to probe, it is read from the beginning.
+ * @param info Pointer to a PM_ImageInfo struct that receives the description.
+ * @return PM_TRUE if the format was recognized and its header is valid, PM_FALSE otherwise.
+ */
+PM_Bool PICOMEDIA_API PM_ImageProbe(PM_Stream* stream, PM_ImageInfo* info);
+
+/**
+ * @brief Describes an image stored in memory without decoding it, see PM_ImageProbe().
+ * 
+ * @param data Pointer to the image file data.
+ * @param dataSize Size of the image file data in bytes.
+ * @param info Pointer to a PM_ImageInfo struct that receives the description.
+ * @return PM_TRUE if the format was recognized and its header is valid, PM_FALSE otherwise.
+ */
+PM_Bool PICOMEDIA_API PM_ImageProbeFromMemory(PM_Byte* data, PM_Size dataSize, PM_ImageInfo* info);
+
+/**
+ * @brief Describes an image file without decoding it, see PM_ImageProbe().
+ * 
+ * @param filePath Path to the image file.
+ * @param info Pointer to a PM_ImageInfo struct that receives the description.
+ * @return PM_TRUE if the format was recognized and its header is valid, PM_FALSE otherwise.
+ */
+PM_Bool PICOMEDIA_API PM_ImageProbeFromFile(const PM_Char* filePath, PM_ImageInfo* info);
+
 #endif // LIBPICOMEDIA_IMAGE_BASE_H
@@ -4,10 +4,138 @@
 #include "libpicomedia/common/common.h"
 #include "libpicomedia/image/image_base.h"
 
+// Options of PM_ImageTransformsChangeChannelFormatEx()
+#define PICOMEDIA_IMAGE_CONVERSION_FLAG_REC709                0x00000001  /**< Gray values use the Rec.709 luma weights instead of the Rec.601 ones. */
+#define PICOMEDIA_IMAGE_CONVERSION_FLAG_PREMULTIPLY_ALPHA     0x00000002  /**< The color channels of the source are multiplied by its alpha channel. */
+#define PICOMEDIA_IMAGE_CONVERSION_FLAG_UNPREMULTIPLY_ALPHA   0x00000004  /**< The color channels of the source are divided by its alpha channel. */
+
+// Filters of PM_ImageTransformsResize()
+#define PICOMEDIA_IMAGE_RESIZE_FILTER_BOX                     0x0DA0  /**< Average of the source pixels covered by a destination pixel. */
+#define PICOMEDIA_IMAGE_RESIZE_FILTER_BILINEAR                0x0DA1  /**< Triangle filter, linear interpolation when upscaling. */
+#define PICOMEDIA_IMAGE_RESIZE_FILTER_BICUBIC                 0x0DA2  /**< Catmull-Rom cubic filter. */
+#define PICOMEDIA_IMAGE_RESIZE_FILTER_LANCZOS                 0x0DA3  /**< Lanczos filter with 3 lobes, the sharpest and slowest one. */
+
+/**
+ * @brief Converts the channels of an image to another channel format, in place.
+ *
+ * Channels are reordered, dropped or added without a second buffer. Missing alpha channels are filled
+ * as fully opaque, color images converted to gray use the Rec.601 luma weights and gray images converted
+ * to color replicate the gray value in every color channel.
+ *
+ * @param image Pointer to the image to convert.
+ * @param newChannelFormat The new channel format, one of the PICOMEDIA_IMAGE_CHANNEL_FORMAT_* values.
+ * @return PM_TRUE if the image was converted, PM_FALSE otherwise.
+ */
 PM_Bool PICOMEDIA_API PM_ImageTransformsChangeChannelFormat(PM_Image* image, PM_UInt32 newChannelFormat);
+
+/**
+ * @brief Converts the channels of an image to another channel format, in place, with extra options.
+ *
+ * Premultiplying or unpremultiplying is applied to the source alpha channel before the channels are
+ * converted, so converting to the same channel format only changes the alpha representation. A source
+ * without alpha is left as is, and dropping a premultiplied alpha channel is the same as composing the
+ * image over black. Unpremultiplied pixels with a zero alpha become black.
+ *
+ * @param image Pointer to the image to convert.
+ * @param newChannelFormat The new channel format, one of the PICOMEDIA_IMAGE_CHANNEL_FORMAT_* values.
+ * @param flags A combination of the PICOMEDIA_IMAGE_CONVERSION_FLAG_* values, premultiplying and unpremultiplying are exclusive.
+ * @return PM_TRUE if the image was converted, PM_FALSE otherwise.
+ */
+PM_Bool PICOMEDIA_API PM_ImageTransformsChangeChannelFormatEx(PM_Image* image, PM_UInt32 newChannelFormat, PM_UInt32 flags);
+
+/**
+ * @brief Converts the samples of an image to another data type.
+ *
+ * Integer samples are normalized to [0.0, 1.0] when converted to floating point, and floating point samples
+ * are clamped to [0.0, 1.0] and rounded to nearest when converted to integers. Conversions between integer
+ * types are exact when widening and round to nearest when narrowing. Large images are converted in bands
+ * of rows on the default thread pool.
+ *
+ * @param image Pointer to the image to convert.
+ * @param newDataType The new data type, one of the PICOIMEDIA_IMAGE_DATA_TYPE_* values.
+ * @return PM_TRUE if the image was converted, PM_FALSE otherwise.
+ */
 PM_Bool PICOMEDIA_API PM_ImageTransformsChangeDataType(PM_Image* image, PM_UInt32 newDataType);
+
+/**
+ * @brief Converts a run of samples from one data type to another, using the same rules as PM_ImageTransformsChangeDataType().
+ *
+ * @param src Pointer to the source samples.
+ * @param srcDataType The data type of the source samples.
+ * @param dst Pointer to the destination samples, must not overlap with the source ones.
+ * @param dstDataType The data type of the destination samples.
+ * @param count The number of samples to convert.
+ * @return PM_TRUE if the samples were converted, PM_FALSE if the conversion is not supported.
+ */
+PM_Bool PICOMEDIA_API PM_ImageTransformsConvertSamples(const void* src, PM_UInt32 srcDataType, void* dst, PM_UInt32 dstDataType, PM_Size count);
+
 PM_Bool PICOMEDIA_API PM_ImageTransformsFlipHorizontal(PM_Image* image);
 PM_Bool PICOMEDIA_API PM_ImageTransformsFlipVertical(PM_Image* image);
 
+/**
+ * @brief Transposes an image, in place, so its rows become its columns.
+ *
+ * The image is moved by cache sized tiles on the default thread pool. Square images are transposed within
+ * their buffer, other ones are moved to a new buffer of the same size which replaces the current one.
+ *
+ * @param image Pointer to the image to transpose.
+ * @return PM_TRUE if the image was transposed, PM_FALSE otherwise.
+ */
+PM_Bool PICOMEDIA_API PM_ImageTransformsTranspose(PM_Image* image);
+
+/**
+ * @brief Rotates an image by a quarter turn clockwise, in place, in the same way as PM_ImageTransformsTranspose().
+ *
+ * @param image Pointer to the image to rotate.
+ * @return PM_TRUE if the image was rotated, PM_FALSE otherwise.
+ */
+PM_Bool PICOMEDIA_API PM_ImageTransformsRotate90(PM_Image* image);
+
+/**
+ * @brief Rotates an image by a half turn, in place, within its buffer.
+ *
+ * @param image Pointer to the image to rotate.
+ * @return PM_TRUE if the image was rotated, PM_FALSE otherwise.
+ */
+PM_Bool PICOMEDIA_API PM_ImageTransformsRotate180(PM_Image* image);
+
+/**
+ * @brief Rotates an image by a quarter turn counterclockwise, in place, in the same way as PM_ImageTransformsTranspose().
+ *
+ * @param image Pointer to the image to rotate.
+ * @return PM_TRUE if the image was rotated, PM_FALSE otherwise.
+ */
+PM_Bool PICOMEDIA_API PM_ImageTransformsRotate270(PM_Image* image);
+
+/**
+ * @brief Resizes an image into another one with a separable filter.
+ *
+ * The filter weights are computed once per row and column, and are stretched when downscaling so every
+ * source pixel contributes. 8-bit images are resampled in fixed point, 16-bit and 32-bit float images in
+ * single precision and the other ones in double precision. Integer results are clamped and rounded to nearest,
+ * floating point ones are not clamped. Bands of destination rows are resized on the default thread pool.
+ *
+ * @param dest Pointer to the destination image, (re)allocated with the channel format and data type of the source.
+ * @param src Pointer to the source image, must not be the destination image.
+ * @param width The width of the destination image in pixels.
+ * @param height The height of the destination image in pixels.
+ * @param filter The filter, one of the PICOMEDIA_IMAGE_RESIZE_FILTER_* values.
+ * @return PM_TRUE if the image was resized, PM_FALSE otherwise.
+ */
+PM_Bool PICOMEDIA_API PM_ImageTransformsResize(PM_Image* dest, const PM_Image* src, PM_UInt32 width, PM_UInt32 height, PM_UInt32 filter);
+
+/**
+ * @brief Downscales an image into another one by averaging square blocks of pixels, a fast path for thumbnails.
+ *
+ * The destination is the size of the source divided by the factor and rounded up, the blocks on the right and
+ * bottom edges averaging only the pixels they cover.
+ *
+ * @param dest Pointer to the destination image, (re)allocated with the channel format and data type of the source.
+ * @param src Pointer to the source image, must not be the destination image.
+ * @param factor The side of the blocks, a power of two up to 65536.
+ * @return PM_TRUE if the image was downscaled, PM_FALSE otherwise.
+ */
+PM_Bool PICOMEDIA_API PM_ImageTransformsDownscaleBox(PM_Image* dest, const PM_Image* src, PM_UInt32 factor);
+
 
 #endif // LIBPICOMEDIA_IMAGE_TRANSFORMS_H
\ No newline at end of file
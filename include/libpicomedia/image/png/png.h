@@ -8,6 +8,12 @@
  * @brief Functions for reading and writing PNG images.
 */
 
+#define PICOMEDIA_PNG_FILTER_NONE       0x00
+#define PICOMEDIA_PNG_FILTER_SUB        0x01
+#define PICOMEDIA_PNG_FILTER_UP         0x02
+#define PICOMEDIA_PNG_FILTER_AVERAGE    0x03
+#define PICOMEDIA_PNG_FILTER_PAETH      0x04
+
 
 /**
  * @brief Structure representing the header information of a PNG image.
@@ -152,8 +158,9 @@ struct PM_PNGContext
     PM_UInt8* exifData;                      /**< Pointer to the EXIF data */
     PM_Size exifDataSize;                    /**< Size of the EXIF data */
     PM_PNGTimeChunk* timeChunk;              /**< Pointer to the PNG time chunk */
-    PM_UInt8* rawData;                       /**< Pointer to the image data */
-    PM_Size dataSize;                        /**< Size of the image data */
+    PM_UInt8* rawData;                       /**< Pointer to the filtered image data (when it is not decoded directly into the image) */
+    PM_Size dataSize;                        /**< Size of the filtered image data */
+    PM_InflateContext* inflateContext;       /**< Pointer to the inflate context decoding the IDAT chunks */
 };
 typedef struct PM_PNGContext PM_PNGContext;
 
@@ -309,6 +316,46 @@ void PICOMEDIA_API PM_ImagePNGContextPrint(const PM_PNGContext* context);
 
 
 
+// Filtering Functions
+
+
+/**
+ * @brief Reverses the PNG filter of a single scanline.
+ * 
+ * The fastest implementation supported by the CPU (SSE2/SSSE3/AVX2 on x86, NEON on ARM64) is selected
+ * on the first call.
+ * 
+ * The destination may alias the source or start before it (as long as it doesn't start after it),
+ * which allows unfiltering a whole image in place while stripping the filter type bytes.
+ * 
+ * @param filterType The filter type byte of the scanline.
+ * @param dst Pointer to the buffer receiving the reconstructed scanline.
+ * @param src Pointer to the filtered scanline (without the filter type byte).
+ * @param prev Pointer to the previous reconstructed scanline, or NULL for the first scanline of a pass.
+ * @param rowSize Size of the scanline, in bytes.
+ * @param bytesPerPixel Number of bytes per complete pixel, rounded up to one.
+ * @return PM_Bool Returns PM_TRUE if the scanline was unfiltered, PM_FALSE if the filter type is invalid.
+ */
+PM_Bool PICOMEDIA_API PM_ImagePNGUnfilterScanline(PM_UInt8 filterType, PM_UInt8* dst, const PM_UInt8* src, const PM_UInt8* prev, PM_Size rowSize, PM_Size bytesPerPixel);
+
+/**
+ * @brief Reverses the PNG filter of a single scanline using the portable scalar implementation.
+ * 
+ * This is the reference the SIMD kernels of PM_ImagePNGUnfilterScanline() are verified against,
+ * it takes the same parameters and produces exactly the same output.
+ * 
+ * @param filterType The filter type byte of the scanline.
+ * @param dst Pointer to the buffer receiving the reconstructed scanline.
+ * @param src Pointer to the filtered scanline (without the filter type byte).
+ * @param prev Pointer to the previous reconstructed scanline, or NULL for the first scanline of a pass.
+ * @param rowSize Size of the scanline, in bytes.
+ * @param bytesPerPixel Number of bytes per complete pixel, rounded up to one.
+ * @return PM_Bool Returns PM_TRUE if the scanline was unfiltered, PM_FALSE if the filter type is invalid.
+ */
+PM_Bool PICOMEDIA_API PM_ImagePNGUnfilterScanlineScalar(PM_UInt8 filterType, PM_UInt8* dst, const PM_UInt8* src, const PM_UInt8* prev, PM_Size rowSize, PM_Size bytesPerPixel);
+
+
+
 // Detection Function
 
 
@@ -343,6 +390,18 @@ PM_Bool PICOMEDIA_API PM_ImagePNGDetectFromFile(const char* filePath);
 
 // Reading Functions
 
+/**
+ * @brief Describes a PNG image from its signature and IHDR chunk, without reading the rest of the file.
+ *
+ * The tRNS chunk comes after IHDR, so gray, RGB and palette images are reported without alpha while
+ * the decoded size accounts for the alpha channel a tRNS chunk would add.
+ *
+ * @param stream The stream from which to read the PNG header.
+ * @param info The PM_ImageInfo structure to fill.
+ * @return PM_Bool Returns PM_TRUE if the PNG header is valid, PM_FALSE otherwise.
+ */
+PM_Bool PICOMEDIA_API PM_ImagePNGProbe(PM_Stream* stream, PM_ImageInfo* info);
+
 
 /**
  * @brief Reads a PNG image from a stream.
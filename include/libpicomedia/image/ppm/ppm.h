@@ -7,6 +7,8 @@
 #define PICOMEDIA_PPM_FORMAT_P6      0x02
 #define PICOMEDIA_PPM_FORMAT_UNKNOWN 0x03
 
+#define PICOMEDIA_PPM_ASCII_MAX_VALUE_SIZE 6 // "65535 "
+
 // Utility Functions
 
 /**
@@ -49,8 +51,70 @@ PM_UInt32 PICOMEDIA_API PM_ImagePPMDetectFromFile(const char* filePath);
 
 
 
+// ASCII Functions
+
+/**
+ * @brief Parses the whitespace separated decimal numbers of P3 image data.
+ * 
+ * The text is classified 16 bytes at a time with SIMD instructions (selected at runtime) and the numbers
+ * are converted several digits at once. Comments are skipped. Parsing stops once maxValues numbers are
+ * parsed or the text runs out; unless isLastBlock is set, a number or comment that touches the end of the
+ * text is not consumed, so it can be parsed again once more text follows it.
+ * 
+ * @param text Pointer to the text to parse.
+ * @param textSize Size of the text in bytes.
+ * @param isLastBlock Whether the text runs up to the end of the data.
+ * @param values Pointer to the array receiving the parsed numbers.
+ * @param maxValues Maximum number of numbers to parse.
+ * @param bytesConsumed Pointer to the variable receiving the number of bytes of text consumed.
+ * @param valuesParsed Pointer to the variable receiving the number of numbers parsed.
+ * @return PM_Bool Returns PM_FALSE if the text contains invalid characters or numbers above 65535, PM_TRUE otherwise.
+ */
+PM_Bool PICOMEDIA_API PM_ImagePPMParseASCII(const PM_UInt8* text, PM_Size textSize, PM_Bool isLastBlock, PM_UInt16* values, PM_Size maxValues, PM_Size* bytesConsumed, PM_Size* valuesParsed);
+
+/**
+ * @brief Parses the numbers of P3 image data using the portable scalar implementation.
+ * 
+ * This is the reference the SIMD parser of PM_ImagePPMParseASCII() is verified against,
+ * it takes the same parameters and produces exactly the same output.
+ * 
+ * @param text Pointer to the text to parse.
+ * @param textSize Size of the text in bytes.
+ * @param isLastBlock Whether the text runs up to the end of the data.
+ * @param values Pointer to the array receiving the parsed numbers.
+ * @param maxValues Maximum number of numbers to parse.
+ * @param bytesConsumed Pointer to the variable receiving the number of bytes of text consumed.
+ * @param valuesParsed Pointer to the variable receiving the number of numbers parsed.
+ * @return PM_Bool Returns PM_FALSE if the text contains invalid characters or numbers above 65535, PM_TRUE otherwise.
+ */
+PM_Bool PICOMEDIA_API PM_ImagePPMParseASCIIScalar(const PM_UInt8* text, PM_Size textSize, PM_Bool isLastBlock, PM_UInt16* values, PM_Size maxValues, PM_Size* bytesConsumed, PM_Size* valuesParsed);
+
+/**
+ * @brief Formats color values as the text of P3 image data.
+ * 
+ * Every value is written in decimal followed by a single space. The text of 8 bit values comes from a
+ * precomputed table, 16 bit values are converted two digits at a time.
+ * 
+ * @param values Pointer to the values to format (PM_UInt8 or PM_UInt16 depending on the data type).
+ * @param dataType PICOIMEDIA_IMAGE_DATA_TYPE_UINT8 or PICOIMEDIA_IMAGE_DATA_TYPE_UINT16.
+ * @param valueCount Number of values to format.
+ * @param text Pointer to the buffer receiving the text, it must have room for valueCount * PICOMEDIA_PPM_ASCII_MAX_VALUE_SIZE bytes.
+ * @return PM_Size Number of bytes of text written.
+ */
+PM_Size PICOMEDIA_API PM_ImagePPMFormatASCII(const PM_Byte* values, PM_UInt32 dataType, PM_Size valueCount, PM_Char* text);
+
+
 // Reading Functions
 
+/**
+ * @brief Describes a P3 or P6 image from its header, without reading the image data.
+ * 
+ * @param stream The stream to read the header from.
+ * @param info The image info structure to fill.
+ * @return PM_Bool Returns PM_TRUE if the header is valid, PM_FALSE otherwise.
+ */
+PM_Bool PICOMEDIA_API PM_ImagePPMProbe(PM_Stream* stream, PM_ImageInfo* info);
+
 /**
  * @brief Reads a PPM image file in P6 format from a stream.
  * 
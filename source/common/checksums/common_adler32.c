@@ -0,0 +1,293 @@
+#include "libpicomedia/common/checksums.h"
+#include "libpicomedia/common/cpu.h"
+
+#if defined(PM_ARCH_X86)
+    #include <immintrin.h>
+#elif defined(PM_ARCH_ARM64)
+    #include <arm_neon.h>
+#endif
+
+// Largest prime smaller than 65536
+#define PM_ADLER32_MOD 65521
+
+// Largest n such that 255 * n * (n + 1) / 2 + (n + 1) * (PM_ADLER32_MOD - 1) fits in 32 bits,
+// so the sums only have to be reduced once every PM_ADLER32_NMAX bytes
+#define PM_ADLER32_NMAX 5552
+
+// Bytes consumed per iteration of the vectorized kernels
+#define PM_ADLER32_BLOCK_SIZE 32
+
+typedef PM_UInt32 (*PM__Adler32Function)(const PM_UInt8* pData, PM_Size size, PM_UInt32 previousAdler32);
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_UInt32 PM__Adler32Scalar(const PM_UInt8* pData, PM_Size size, PM_UInt32 previousAdler32)
+{
+    PM_UInt32 s1 = previousAdler32 & 0xFFFF;
+    PM_UInt32 s2 = previousAdler32 >> 16;
+
+    while (size > 0)
+    {
+        PM_Size blockSize = PM_Min(size, (PM_Size)PM_ADLER32_NMAX);
+        size -= blockSize;
+
+        while (blockSize >= 8)
+        {
+            s1 += pData[0]; s2 += s1;
+            s1 += pData[1]; s2 += s1;
+            s1 += pData[2]; s2 += s1;
+            s1 += pData[3]; s2 += s1;
+            s1 += pData[4]; s2 += s1;
+            s1 += pData[5]; s2 += s1;
+            s1 += pData[6]; s2 += s1;
+            s1 += pData[7]; s2 += s1;
+            pData += 8;
+            blockSize -= 8;
+        }
+
+        while (blockSize-- > 0)
+        {
+            s1 += *pData++;
+            s2 += s1;
+        }
+
+        s1 %= PM_ADLER32_MOD;
+        s2 %= PM_ADLER32_MOD;
+    }
+
+    return (s2 << 16) | s1;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+#if defined(PM_ARCH_X86)
+
+// Each 32 byte block adds sum(bytes) to s1 and sum((32 - i) * bytes[i]) + 32 * s1 to s2.
+// The s1 contributions are accumulated in ps and multiplied by 32 once at the end of the run.
+// This follows the approach of adler32_simd.c from Chromium's copy of zlib.
+static PM_TARGET("ssse3") PM_UInt32 PM__Adler32SSSE3(const PM_UInt8* pData, PM_Size size, PM_UInt32 previousAdler32)
+{
+    PM_UInt32 s1 = previousAdler32 & 0xFFFF;
+    PM_UInt32 s2 = previousAdler32 >> 16;
+
+    const __m128i tap1 = _mm_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17);
+    const __m128i tap2 = _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi16(1);
+
+    PM_Size blocks = size / PM_ADLER32_BLOCK_SIZE;
+    size -= blocks * PM_ADLER32_BLOCK_SIZE;
+
+    while (blocks > 0)
+    {
+        PM_Size n = PM_Min(blocks, (PM_Size)(PM_ADLER32_NMAX / PM_ADLER32_BLOCK_SIZE));
+        blocks -= n;
+
+        __m128i vps = _mm_setr_epi32((PM_Int32)(s1 * n), 0, 0, 0);
+        __m128i vs2 = _mm_setr_epi32((PM_Int32)s2, 0, 0, 0);
+        __m128i vs1 = _mm_setzero_si128();
+
+        do
+        {
+            const __m128i bytes1 = _mm_loadu_si128((const __m128i*)(pData));
+            const __m128i bytes2 = _mm_loadu_si128((const __m128i*)(pData + 16));
+
+            vps = _mm_add_epi32(vps, vs1);
+
+            vs1 = _mm_add_epi32(vs1, _mm_sad_epu8(bytes1, zero));
+            vs1 = _mm_add_epi32(vs1, _mm_sad_epu8(bytes2, zero));
+
+            vs2 = _mm_add_epi32(vs2, _mm_madd_epi16(_mm_maddubs_epi16(bytes1, tap1), ones));
+            vs2 = _mm_add_epi32(vs2, _mm_madd_epi16(_mm_maddubs_epi16(bytes2, tap2), ones));
+
+            pData += PM_ADLER32_BLOCK_SIZE;
+        } while (--n);
+
+        vs2 = _mm_add_epi32(vs2, _mm_slli_epi32(vps, 5));
+
+        // Horizontal sums
+        vs1 = _mm_add_epi32(vs1, _mm_shuffle_epi32(vs1, _MM_SHUFFLE(1, 0, 3, 2)));
+        s1 += (PM_UInt32)_mm_cvtsi128_si32(vs1);
+
+        vs2 = _mm_add_epi32(vs2, _mm_shuffle_epi32(vs2, _MM_SHUFFLE(2, 3, 0, 1)));
+        vs2 = _mm_add_epi32(vs2, _mm_shuffle_epi32(vs2, _MM_SHUFFLE(1, 0, 3, 2)));
+        s2 = (PM_UInt32)_mm_cvtsi128_si32(vs2);
+
+        s1 %= PM_ADLER32_MOD;
+        s2 %= PM_ADLER32_MOD;
+    }
+
+    return PM__Adler32Scalar(pData, size, (s2 << 16) | s1);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Same as the SSSE3 kernel, but a whole 32 byte block fits in one register
+static PM_TARGET("avx2") PM_UInt32 PM__Adler32AVX2(const PM_UInt8* pData, PM_Size size, PM_UInt32 previousAdler32)
+{
+    PM_UInt32 s1 = previousAdler32 & 0xFFFF;
+    PM_UInt32 s2 = previousAdler32 >> 16;
+
+    const __m256i tap = _mm256_setr_epi8(
+        32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17,
+        16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ones = _mm256_set1_epi16(1);
+
+    PM_Size blocks = size / PM_ADLER32_BLOCK_SIZE;
+    size -= blocks * PM_ADLER32_BLOCK_SIZE;
+
+    while (blocks > 0)
+    {
+        PM_Size n = PM_Min(blocks, (PM_Size)(PM_ADLER32_NMAX / PM_ADLER32_BLOCK_SIZE));
+        blocks -= n;
+
+        __m256i vps = _mm256_setr_epi32((PM_Int32)(s1 * n), 0, 0, 0, 0, 0, 0, 0);
+        __m256i vs2 = _mm256_setr_epi32((PM_Int32)s2, 0, 0, 0, 0, 0, 0, 0);
+        __m256i vs1 = _mm256_setzero_si256();
+
+        do
+        {
+            const __m256i bytes = _mm256_loadu_si256((const __m256i*)pData);
+
+            vps = _mm256_add_epi32(vps, vs1);
+            vs1 = _mm256_add_epi32(vs1, _mm256_sad_epu8(bytes, zero));
+            vs2 = _mm256_add_epi32(vs2, _mm256_madd_epi16(_mm256_maddubs_epi16(bytes, tap), ones));
+
+            pData += PM_ADLER32_BLOCK_SIZE;
+        } while (--n);
+
+        vs2 = _mm256_add_epi32(vs2, _mm256_slli_epi32(vps, 5));
+
+        // Horizontal sums
+        __m128i hs1 = _mm_add_epi32(_mm256_castsi256_si128(vs1), _mm256_extracti128_si256(vs1, 1));
+        hs1 = _mm_add_epi32(hs1, _mm_shuffle_epi32(hs1, _MM_SHUFFLE(1, 0, 3, 2)));
+        s1 += (PM_UInt32)_mm_cvtsi128_si32(hs1);
+
+        __m128i hs2 = _mm_add_epi32(_mm256_castsi256_si128(vs2), _mm256_extracti128_si256(vs2, 1));
+        hs2 = _mm_add_epi32(hs2, _mm_shuffle_epi32(hs2, _MM_SHUFFLE(2, 3, 0, 1)));
+        hs2 = _mm_add_epi32(hs2, _mm_shuffle_epi32(hs2, _MM_SHUFFLE(1, 0, 3, 2)));
+        s2 = (PM_UInt32)_mm_cvtsi128_si32(hs2);
+
+        s1 %= PM_ADLER32_MOD;
+        s2 %= PM_ADLER32_MOD;
+    }
+
+    return PM__Adler32Scalar(pData, size, (s2 << 16) | s1);
+}
+
+#elif defined(PM_ARCH_ARM64)
+
+// Per column byte sums are kept in 16 bit lanes and weighted once at the end of each run
+static PM_UInt32 PM__Adler32NEON(const PM_UInt8* pData, PM_Size size, PM_UInt32 previousAdler32)
+{
+    PM_UInt32 s1 = previousAdler32 & 0xFFFF;
+    PM_UInt32 s2 = previousAdler32 >> 16;
+
+    static const PM_UInt16 taps[32] = {
+        32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17,
+        16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1
+    };
+
+    PM_Size blocks = size / PM_ADLER32_BLOCK_SIZE;
+    size -= blocks * PM_ADLER32_BLOCK_SIZE;
+
+    while (blocks > 0)
+    {
+        PM_Size n = PM_Min(blocks, (PM_Size)(PM_ADLER32_NMAX / PM_ADLER32_BLOCK_SIZE));
+        blocks -= n;
+
+        uint32x4_t vps = vsetq_lane_u32(s1 * (PM_UInt32)n, vdupq_n_u32(0), 0);
+        uint32x4_t vs2 = vsetq_lane_u32(s2, vdupq_n_u32(0), 0);
+        uint32x4_t vs1 = vdupq_n_u32(0);
+        uint16x8_t column1 = vdupq_n_u16(0);
+        uint16x8_t column2 = vdupq_n_u16(0);
+        uint16x8_t column3 = vdupq_n_u16(0);
+        uint16x8_t column4 = vdupq_n_u16(0);
+
+        do
+        {
+            const uint8x16_t bytes1 = vld1q_u8(pData);
+            const uint8x16_t bytes2 = vld1q_u8(pData + 16);
+
+            vps = vaddq_u32(vps, vs1);
+            vs1 = vpadalq_u16(vs1, vpadalq_u8(vpaddlq_u8(bytes1), bytes2));
+
+            column1 = vaddw_u8(column1, vget_low_u8(bytes1));
+            column2 = vaddw_u8(column2, vget_high_u8(bytes1));
+            column3 = vaddw_u8(column3, vget_low_u8(bytes2));
+            column4 = vaddw_u8(column4, vget_high_u8(bytes2));
+
+            pData += PM_ADLER32_BLOCK_SIZE;
+        } while (--n);
+
+        vs2 = vaddq_u32(vs2, vshlq_n_u32(vps, 5));
+
+        vs2 = vmlal_u16(vs2, vget_low_u16(column1), vld1_u16(taps + 0));
+        vs2 = vmlal_u16(vs2, vget_high_u16(column1), vld1_u16(taps + 4));
+        vs2 = vmlal_u16(vs2, vget_low_u16(column2), vld1_u16(taps + 8));
+        vs2 = vmlal_u16(vs2, vget_high_u16(column2), vld1_u16(taps + 12));
+        vs2 = vmlal_u16(vs2, vget_low_u16(column3), vld1_u16(taps + 16));
+        vs2 = vmlal_u16(vs2, vget_high_u16(column3), vld1_u16(taps + 20));
+        vs2 = vmlal_u16(vs2, vget_low_u16(column4), vld1_u16(taps + 24));
+        vs2 = vmlal_u16(vs2, vget_high_u16(column4), vld1_u16(taps + 28));
+
+        s1 += vaddvq_u32(vs1);
+        s2 = vaddvq_u32(vs2);
+
+        s1 %= PM_ADLER32_MOD;
+        s2 %= PM_ADLER32_MOD;
+    }
+
+    return PM__Adler32Scalar(pData, size, (s2 << 16) | s1);
+}
+
+#endif
+
+// -----------------------------------------------------------------------------------------------
+
+// Starts out with the scalar implementation so it is always safe to use
+static PM__Adler32Function PM_ADLER32_FUNCTION = PM__Adler32Scalar;
+static volatile PM_Bool PM_ADLER32_FUNCTION_SELECTED = PM_FALSE;
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__Adler32SelectFunction()
+{
+#if defined(PM_ARCH_X86)
+    if (PM_CPUHasFeature(PICOMEDIA_CPU_FEATURE_SSSE3))
+    {
+        PM_ADLER32_FUNCTION = PM__Adler32SSSE3;
+    }
+
+    if (PM_CPUHasFeature(PICOMEDIA_CPU_FEATURE_AVX2))
+    {
+        PM_ADLER32_FUNCTION = PM__Adler32AVX2;
+    }
+#elif defined(PM_ARCH_ARM64)
+    PM_ADLER32_FUNCTION = PM__Adler32NEON;
+#endif
+
+    PM_ADLER32_FUNCTION_SELECTED = PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_UInt32 PM_Adler32Scalar(const PM_UInt8* pData, PM_Size size, PM_UInt32 previousAdler32)
+{
+    return PM__Adler32Scalar(pData, size, previousAdler32);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_UInt32 PM_Adler32(const PM_UInt8* pData, PM_Size size, PM_UInt32 previousAdler32)
+{
+    if (!PM_ADLER32_FUNCTION_SELECTED)
+    {
+        PM__Adler32SelectFunction();
+    }
+
+    return PM_ADLER32_FUNCTION(pData, size, previousAdler32);
+}
+
+// -----------------------------------------------------------------------------------------------
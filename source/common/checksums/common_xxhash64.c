@@ -0,0 +1,113 @@
+#include "libpicomedia/common/checksums.h"
+
+// The algorithm used in this file is XXH64 from : https://github.com/Cyan4973/xxHash
+
+#define PM_XXHASH64_PRIME1 0x9E3779B185EBCA87ULL
+#define PM_XXHASH64_PRIME2 0xC2B2AE3D27D4EB4FULL
+#define PM_XXHASH64_PRIME3 0x165667B19E3779F9ULL
+#define PM_XXHASH64_PRIME4 0x85EBCA77C2B2AE63ULL
+#define PM_XXHASH64_PRIME5 0x27D4EB2F165667C5ULL
+
+#define PM_ROTL64(x, r) (((x) << (r)) | ((x) >> (64 - (r))))
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_UInt64 PM__XXHash64Load64(const PM_UInt8* pData)
+{
+    return (PM_UInt64)pData[0]         | ((PM_UInt64)pData[1] << 8)  | ((PM_UInt64)pData[2] << 16) | ((PM_UInt64)pData[3] << 24) |
+           ((PM_UInt64)pData[4] << 32) | ((PM_UInt64)pData[5] << 40) | ((PM_UInt64)pData[6] << 48) | ((PM_UInt64)pData[7] << 56);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_UInt32 PM__XXHash64Load32(const PM_UInt8* pData)
+{
+    return (PM_UInt32)pData[0] | ((PM_UInt32)pData[1] << 8) | ((PM_UInt32)pData[2] << 16) | ((PM_UInt32)pData[3] << 24);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_UInt64 PM__XXHash64Round(PM_UInt64 accumulator, PM_UInt64 input)
+{
+    accumulator += input * PM_XXHASH64_PRIME2;
+    accumulator = PM_ROTL64(accumulator, 31);
+    return accumulator * PM_XXHASH64_PRIME1;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_UInt64 PM__XXHash64MergeRound(PM_UInt64 accumulator, PM_UInt64 value)
+{
+    accumulator ^= PM__XXHash64Round(0, value);
+    return accumulator * PM_XXHASH64_PRIME1 + PM_XXHASH64_PRIME4;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_UInt64 PM_XXHash64(const PM_UInt8* pData, PM_Size size, PM_UInt64 seed)
+{
+    const PM_UInt8* pEnd = pData + size;
+    PM_UInt64 hash = 0;
+
+    if (size >= 32)
+    {
+        // Four independent lanes, the multiplications of one stripe overlap with the next
+        PM_UInt64 v1 = seed + PM_XXHASH64_PRIME1 + PM_XXHASH64_PRIME2;
+        PM_UInt64 v2 = seed + PM_XXHASH64_PRIME2;
+        PM_UInt64 v3 = seed;
+        PM_UInt64 v4 = seed - PM_XXHASH64_PRIME1;
+
+        const PM_UInt8* pLimit = pEnd - 32;
+        do
+        {
+            v1 = PM__XXHash64Round(v1, PM__XXHash64Load64(pData));
+            v2 = PM__XXHash64Round(v2, PM__XXHash64Load64(pData + 8));
+            v3 = PM__XXHash64Round(v3, PM__XXHash64Load64(pData + 16));
+            v4 = PM__XXHash64Round(v4, PM__XXHash64Load64(pData + 24));
+            pData += 32;
+        } while (pData <= pLimit);
+
+        hash = PM_ROTL64(v1, 1) + PM_ROTL64(v2, 7) + PM_ROTL64(v3, 12) + PM_ROTL64(v4, 18);
+        hash = PM__XXHash64MergeRound(hash, v1);
+        hash = PM__XXHash64MergeRound(hash, v2);
+        hash = PM__XXHash64MergeRound(hash, v3);
+        hash = PM__XXHash64MergeRound(hash, v4);
+    }
+    else
+    {
+        hash = seed + PM_XXHASH64_PRIME5;
+    }
+
+    hash += (PM_UInt64)size;
+
+    while (pData + 8 <= pEnd)
+    {
+        hash ^= PM__XXHash64Round(0, PM__XXHash64Load64(pData));
+        hash = PM_ROTL64(hash, 27) * PM_XXHASH64_PRIME1 + PM_XXHASH64_PRIME4;
+        pData += 8;
+    }
+
+    if (pData + 4 <= pEnd)
+    {
+        hash ^= (PM_UInt64)PM__XXHash64Load32(pData) * PM_XXHASH64_PRIME1;
+        hash = PM_ROTL64(hash, 23) * PM_XXHASH64_PRIME2 + PM_XXHASH64_PRIME3;
+        pData += 4;
+    }
+
+    while (pData < pEnd)
+    {
+        hash ^= (*pData++) * PM_XXHASH64_PRIME5;
+        hash = PM_ROTL64(hash, 11) * PM_XXHASH64_PRIME1;
+    }
+
+    // Final avalanche
+    hash ^= hash >> 33;
+    hash *= PM_XXHASH64_PRIME2;
+    hash ^= hash >> 29;
+    hash *= PM_XXHASH64_PRIME3;
+    hash ^= hash >> 32;
+
+    return hash;
+}
+
+// -----------------------------------------------------------------------------------------------
@@ -0,0 +1,148 @@
+#include "libpicomedia/common/cpu.h"
+
+#if defined(PM_ARCH_X86)
+    #if defined(PM_COMPILER_MSVC)
+        #include <intrin.h>
+    #else
+        #include <cpuid.h>
+    #endif
+#elif defined(PM_ARCH_ARM64) && defined(PM_PLATFORM_LINUX)
+    #include <sys/auxv.h>
+    #include <asm/hwcap.h>
+#elif defined(PM_ARCH_ARM64) && defined(PM_PLATFORM_WINDOWS)
+    #include <windows.h>
+#endif
+
+// The top bit marks the features as detected, so the cache is a single word
+#define PM_CPU_FEATURES_DETECTED 0x80000000
+
+static volatile PM_UInt32 PM_CPU_FEATURES = 0;
+
+// -----------------------------------------------------------------------------------------------
+
+#if defined(PM_ARCH_X86)
+
+static void PM__CPUQuery(PM_UInt32 leaf, PM_UInt32 subLeaf, PM_UInt32 registers[4])
+{
+#if defined(PM_COMPILER_MSVC)
+    int info[4] = {0};
+    __cpuidex(info, (int)leaf, (int)subLeaf);
+    for (PM_Size i = 0; i < 4; i++)
+    {
+        registers[i] = (PM_UInt32)info[i];
+    }
+#else
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    __cpuid_count(leaf, subLeaf, eax, ebx, ecx, edx);
+    registers[0] = eax;
+    registers[1] = ebx;
+    registers[2] = ecx;
+    registers[3] = edx;
+#endif
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_UInt64 PM__CPUGetExtendedControlRegister()
+{
+#if defined(PM_COMPILER_MSVC)
+    return (PM_UInt64)_xgetbv(0);
+#else
+    PM_UInt32 eax = 0, edx = 0;
+    __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((PM_UInt64)edx << 32) | eax;
+#endif
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_UInt32 PM__CPUDetectFeatures()
+{
+    PM_UInt32 registers[4] = {0};
+    PM_UInt32 features = 0;
+
+    PM__CPUQuery(0, 0, registers);
+    PM_UInt32 maxLeaf = registers[0];
+    if (maxLeaf < 1)
+    {
+        return 0;
+    }
+
+    PM__CPUQuery(1, 0, registers);
+    if (registers[3] & (1u << 26)) features |= PICOMEDIA_CPU_FEATURE_SSE2;
+    if (registers[2] & (1u << 9))  features |= PICOMEDIA_CPU_FEATURE_SSSE3;
+    if (registers[2] & (1u << 19)) features |= PICOMEDIA_CPU_FEATURE_SSE41;
+    if (registers[2] & (1u << 20)) features |= PICOMEDIA_CPU_FEATURE_SSE42;
+    if (registers[2] & (1u << 1))  features |= PICOMEDIA_CPU_FEATURE_PCLMUL;
+
+    // AVX needs the operating system to save the YMM registers on context switches
+    PM_Bool hasOSXSave = (registers[2] & (1u << 27)) != 0;
+    PM_Bool hasYMMState = hasOSXSave && ((PM__CPUGetExtendedControlRegister() & 0x06) == 0x06);
+
+    if (hasYMMState && (registers[2] & (1u << 28)))
+    {
+        features |= PICOMEDIA_CPU_FEATURE_AVX;
+
+        if (maxLeaf >= 7)
+        {
+            PM__CPUQuery(7, 0, registers);
+            if (registers[1] & (1u << 5)) features |= PICOMEDIA_CPU_FEATURE_AVX2;
+        }
+    }
+
+    return features;
+}
+
+#elif defined(PM_ARCH_ARM64)
+
+static PM_UInt32 PM__CPUDetectFeatures()
+{
+    PM_UInt32 features = PICOMEDIA_CPU_FEATURE_NEON;
+
+#if defined(PM_PLATFORM_LINUX)
+    unsigned long hwcaps = getauxval(AT_HWCAP);
+    if (hwcaps & HWCAP_CRC32) features |= PICOMEDIA_CPU_FEATURE_ARM_CRC32;
+    if (hwcaps & HWCAP_PMULL) features |= PICOMEDIA_CPU_FEATURE_ARM_PMULL;
+#elif defined(PM_PLATFORM_MACOS)
+    // Every Apple silicon CPU implements the ARMv8 CRC32 and crypto extensions
+    features |= PICOMEDIA_CPU_FEATURE_ARM_CRC32 | PICOMEDIA_CPU_FEATURE_ARM_PMULL;
+#elif defined(PM_PLATFORM_WINDOWS)
+    if (IsProcessorFeaturePresent(PF_ARM_V8_CRC32_INSTRUCTIONS_AVAILABLE)) features |= PICOMEDIA_CPU_FEATURE_ARM_CRC32;
+    if (IsProcessorFeaturePresent(PF_ARM_V8_CRYPTO_INSTRUCTIONS_AVAILABLE)) features |= PICOMEDIA_CPU_FEATURE_ARM_PMULL;
+#endif
+
+    return features;
+}
+
+#else
+
+static PM_UInt32 PM__CPUDetectFeatures()
+{
+    return 0;
+}
+
+#endif
+
+// -----------------------------------------------------------------------------------------------
+
+PM_UInt32 PM_CPUGetFeatures()
+{
+    // Detection is idempotent, so racing threads at worst detect the features twice
+    PM_UInt32 features = PM_CPU_FEATURES;
+    if (!(features & PM_CPU_FEATURES_DETECTED))
+    {
+        features = PM__CPUDetectFeatures() | PM_CPU_FEATURES_DETECTED;
+        PM_CPU_FEATURES = features;
+    }
+
+    return features & ~(PM_UInt32)PM_CPU_FEATURES_DETECTED;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PM_CPUHasFeature(PM_UInt32 features)
+{
+    return (PM_CPUGetFeatures() & features) == features;
+}
+
+// -----------------------------------------------------------------------------------------------
@@ -1,6 +1,15 @@
 #include "libpicomedia/common/stream.h"
 #include "libpicomedia/common/utils.h"
 
+#if defined(PM_PLATFORM_WINDOWS)
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
 // -----------------------------------------------------------------------------------------------
 
 PM_Bool PM__StreamApplyEndianess(PM_Stream* stream, PM_Byte* data, PM_Size size)
@@ -27,6 +36,7 @@ void PM_StreamInit(PM_Stream* stream)
     
     stream->fileSource = NULL;
     stream->memorySource = NULL;
+    stream->mappingHandle = NULL;
     stream->sourceSize = 0;
     stream->cursorPosition = 0;
     stream->flags = 0;
@@ -36,6 +46,155 @@ void PM_StreamInit(PM_Stream* stream)
     // by default it works with little endian
     stream->requireReverse = PM_IsBigEndian();
     stream->sizeForReverse = sizeof(PM_UInt32);
+    stream->acquireBuffer = NULL;
+    stream->acquireBufferCapacity = 0;
+    stream->isAcquired = PM_FALSE;
+    stream->buffer = NULL;
+    stream->bufferCapacity = PICOMEDIA_STREAM_DEFAULT_BUFFER_SIZE;
+    stream->bufferOffset = 0;
+    stream->bufferLength = 0;
+    stream->filePosition = 0;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Bool PM__StreamEnsureBuffer(PM_Stream* stream)
+{
+    if (stream->buffer == NULL && stream->bufferCapacity > 0)
+    {
+        stream->buffer = (PM_Byte*)PM_Malloc(stream->bufferCapacity);
+        if (stream->buffer == NULL)
+        {
+            // Not fatal, the stream just goes straight to the file from now on
+            PM_LogWarning("PM_Stream: Failed to allocate %zu bytes for the stream buffer.", (size_t)stream->bufferCapacity);
+            stream->bufferCapacity = 0;
+        }
+    }
+
+    return stream->buffer != NULL;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Bool PM__StreamSeekFile(PM_Stream* stream, PM_Size position)
+{
+    // The file position is tracked so that sequential access never needs to seek
+    if (stream->filePosition != position)
+    {
+        if (fseek(stream->fileSource, (long)position, SEEK_SET) != 0)
+        {
+            return PM_FALSE;
+        }
+        stream->filePosition = position;
+    }
+
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Size PM__StreamReadFile(PM_Stream* stream, PM_Byte* buffer, PM_Size size)
+{
+    PM_Size position = (PM_Size)stream->cursorPosition;
+    PM_Size bytesRead = 0;
+
+    // Serve as much as possible from the read-ahead buffer
+    if (position >= stream->bufferOffset && position < stream->bufferOffset + stream->bufferLength)
+    {
+        PM_Size available = stream->bufferOffset + stream->bufferLength - position;
+        bytesRead = size < available ? size : available;
+        PM_Memcpy(buffer, stream->buffer + (position - stream->bufferOffset), bytesRead);
+        position += bytesRead;
+    }
+
+    if (bytesRead < size && PM__StreamSeekFile(stream, position))
+    {
+        PM_Size remaining = size - bytesRead;
+
+        if (remaining >= stream->bufferCapacity || !PM__StreamEnsureBuffer(stream))
+        {
+            // Large reads would only be copied twice through the buffer
+            PM_Size read = fread(buffer + bytesRead, 1, remaining, stream->fileSource);
+            stream->filePosition += read;
+            bytesRead += read;
+        }
+        else
+        {
+            PM_Size read = fread(stream->buffer, 1, stream->bufferCapacity, stream->fileSource);
+            stream->filePosition += read;
+            stream->bufferOffset = position;
+            stream->bufferLength = read;
+
+            PM_Size toCopy = remaining < read ? remaining : read;
+            PM_Memcpy(buffer + bytesRead, stream->buffer, toCopy);
+            bytesRead += toCopy;
+        }
+    }
+
+    stream->cursorPosition += bytesRead;
+    return bytesRead;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Bool PM__StreamFlushFile(PM_Stream* stream)
+{
+    PM_Bool result = PM_TRUE;
+
+    if (stream->bufferLength > 0 && !(stream->flags & PICOMEDIA_STREAM_FLAG_READ))
+    {
+        result = PM__StreamSeekFile(stream, stream->bufferOffset);
+        if (result)
+        {
+            PM_Size written = fwrite(stream->buffer, 1, stream->bufferLength, stream->fileSource);
+            stream->filePosition += written;
+            result = written == stream->bufferLength;
+        }
+    }
+
+    // For read streams this just drops the data that was read ahead
+    stream->bufferLength = 0;
+    return result;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Size PM__StreamWriteFile(PM_Stream* stream, const PM_Byte* buffer, PM_Size size)
+{
+    PM_Size position = (PM_Size)stream->cursorPosition;
+    PM_Size written = 0;
+
+    // The pending data can only be extended by a write that continues it
+    if (stream->bufferLength > 0 && (position != stream->bufferOffset + stream->bufferLength || stream->bufferLength + size > stream->bufferCapacity))
+    {
+        PM__StreamFlushFile(stream);
+    }
+
+    if (size >= stream->bufferCapacity || !PM__StreamEnsureBuffer(stream))
+    {
+        if (PM__StreamSeekFile(stream, position))
+        {
+            written = fwrite(buffer, 1, size, stream->fileSource);
+            stream->filePosition += written;
+        }
+    }
+    else
+    {
+        if (stream->bufferLength == 0)
+        {
+            stream->bufferOffset = position;
+        }
+        PM_Memcpy(stream->buffer + stream->bufferLength, buffer, size);
+        stream->bufferLength += size;
+        written = size;
+    }
+
+    stream->cursorPosition += written;
+    if ((PM_Size)stream->cursorPosition > stream->sourceSize)
+    {
+        stream->sourceSize = stream->cursorPosition;
+    }
+    return written;
 }
 
 // -----------------------------------------------------------------------------------------------
@@ -56,7 +215,8 @@ PM_Bool PM_StreamInitFromFileDescriptor(PM_Stream* stream, FILE* file, PM_UInt8
     // get size of file
     fseek(file, 0, SEEK_END); // seek to end of file 
     stream->sourceSize = ftell(file); // get current file pointer
-    // fseek(file, 0, SEEK_SET); // seek back to beginning of file
+    fseek(file, 0, SEEK_SET); // seek back to beginning of file
+    stream->filePosition = 0;
     PM_StreamSetCursorPosition(stream, 0);
 
     
@@ -79,6 +239,129 @@ PM_Bool PM_StreamInitFromFile(PM_Stream* stream, const char* fileName, PM_UInt8
 
 // -----------------------------------------------------------------------------------------------
 
+#if defined(PM_PLATFORM_WINDOWS)
+
+static PM_Bool PM__StreamMapFile(PM_Stream* stream, const char* fileName)
+{
+    HANDLE file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return PM_FALSE;
+    }
+
+    LARGE_INTEGER fileSize = {0};
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return PM_FALSE;
+    }
+
+    // The mapping keeps the file open, so the file handle is not needed after this
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (mapping == NULL)
+    {
+        return PM_FALSE;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == NULL)
+    {
+        CloseHandle(mapping);
+        return PM_FALSE;
+    }
+
+    stream->memorySource = (PM_Byte*)view;
+    stream->mappingHandle = (void*)mapping;
+    stream->sourceSize = (PM_Size)fileSize.QuadPart;
+
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__StreamUnmapFile(PM_Stream* stream)
+{
+    UnmapViewOfFile(stream->memorySource);
+    CloseHandle((HANDLE)stream->mappingHandle);
+}
+
+#else
+
+static PM_Bool PM__StreamMapFile(PM_Stream* stream, const char* fileName)
+{
+    int file = open(fileName, O_RDONLY);
+    if (file < 0)
+    {
+        return PM_FALSE;
+    }
+
+    struct stat fileStat;
+    if (fstat(file, &fileStat) != 0 || !S_ISREG(fileStat.st_mode) || fileStat.st_size == 0)
+    {
+        close(file);
+        return PM_FALSE;
+    }
+
+    // The mapping keeps the file open, so the descriptor is not needed after this
+    void* view = mmap(NULL, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (view == MAP_FAILED)
+    {
+        return PM_FALSE;
+    }
+
+    // Decoders walk the file front to back, so ask for aggressive read-ahead
+    madvise(view, (size_t)fileStat.st_size, MADV_SEQUENTIAL);
+    madvise(view, (size_t)fileStat.st_size, MADV_WILLNEED);
+
+    stream->memorySource = (PM_Byte*)view;
+    stream->mappingHandle = NULL;
+    stream->sourceSize = (PM_Size)fileStat.st_size;
+
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__StreamUnmapFile(PM_Stream* stream)
+{
+    munmap(stream->memorySource, stream->sourceSize);
+}
+
+#endif
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PM_StreamInitFromFileMapped(PM_Stream* stream, const char* fileName)
+{
+    PM_Assert(stream != NULL);
+    PM_Assert(fileName != NULL);
+
+    PM_StreamInit(stream);
+
+    if (!PM__StreamMapFile(stream, fileName))
+    {
+        // Files that can not be mapped are still readable through stdio
+        FILE* file = fopen(fileName, "rb");
+        if (file == NULL)
+        {
+            PM_LogWarning("PM_StreamInitFromFileMapped: Failed to open file %s.", fileName);
+            return PM_FALSE;
+        }
+        return PM_StreamInitFromFileDescriptor(stream, file, PICOMEDIA_STREAM_FLAG_READ, PM_TRUE);
+    }
+
+    stream->sourceType = PICOMEDIA_STREAM_SOURCE_TYPE_MMAP;
+    stream->flags = PICOMEDIA_STREAM_FLAG_READ;
+    stream->isSourceOwner = PM_TRUE;
+    stream->isInitialized = PM_TRUE;
+
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
 PM_Bool PM_StreamInitFromMemory(PM_Stream* stream, PM_Byte* memory, PM_Size size, PM_UInt8 flags, PM_Bool isSourceOwner)
 {
     PM_Assert(stream != NULL);
@@ -112,16 +395,42 @@ void PM_StreamDestroy(PM_Stream* stream)
 {
     PM_Assert(stream != NULL);
 
+    if (stream->sourceType == PICOMEDIA_STREAM_SOURCE_TYPE_FILE && stream->isInitialized && stream->fileSource)
+    {
+        if (!PM__StreamFlushFile(stream))
+        {
+            PM_LogWarning("PM_StreamDestroy: Failed to write the buffered data.");
+        }
+
+        // A file that is not owned by the stream is left where the cursor is, as if it was used unbuffered
+        if (!stream->isSourceOwner)
+        {
+            PM__StreamSeekFile(stream, stream->cursorPosition);
+        }
+    }
+
     if (stream->isSourceOwner && stream->isInitialized)
     {
         if(stream->sourceType == PICOMEDIA_STREAM_SOURCE_TYPE_FILE && stream->fileSource)
             fclose(stream->fileSource);
         else if (stream->sourceType == PICOMEDIA_STREAM_SOURCE_TYPE_MEMORY && stream->memorySource)
             PM_Free(stream->memorySource);
+        else if (stream->sourceType == PICOMEDIA_STREAM_SOURCE_TYPE_MMAP && stream->memorySource)
+            PM__StreamUnmapFile(stream);
         else
             PM_LogWarning("Invalid Stream Source Type %u", stream->sourceType);
     }
 
+    if (stream->acquireBuffer)
+    {
+        PM_Free(stream->acquireBuffer);
+    }
+
+    if (stream->buffer)
+    {
+        PM_Free(stream->buffer);
+    }
+
     PM_StreamInit(stream);
 }
 
@@ -135,12 +444,11 @@ PM_Size PM_StreamRead(PM_Stream* stream, PM_Byte* buffer, PM_Size size)
 
     if (stream->sourceType == PICOMEDIA_STREAM_SOURCE_TYPE_FILE)
     {
-        PM_Size read = fread(buffer, 1, size, stream->fileSource);
-        stream->cursorPosition += read;
+        PM_Size read = PM__StreamReadFile(stream, buffer, size);
         PM__StreamApplyEndianess(stream, buffer, read);
         return read;
     }
-    else if (stream->sourceType == PICOMEDIA_STREAM_SOURCE_TYPE_MEMORY)
+    else if (stream->sourceType == PICOMEDIA_STREAM_SOURCE_TYPE_MEMORY || stream->sourceType == PICOMEDIA_STREAM_SOURCE_TYPE_MMAP)
     {
         PM_Size bytesToRead = size;
         if (stream->cursorPosition + size > stream->sourceSize)
@@ -168,9 +476,7 @@ PM_Size PM_StreamWrite(PM_Stream* stream, const PM_Byte* buffer, PM_Size size)
 
     if (stream->sourceType == PICOMEDIA_STREAM_SOURCE_TYPE_FILE)
     {
-        PM_Size written = fwrite(buffer, 1, size, stream->fileSource);
-        stream->cursorPosition += written;
-        return written;
+        return PM__StreamWriteFile(stream, buffer, size);
     }
     else if (stream->sourceType == PICOMEDIA_STREAM_SOURCE_TYPE_MEMORY)
     {
@@ -204,6 +510,108 @@ PM_Size PM_StreamPeek(PM_Stream* stream, PM_Byte* buffer, PM_Size size)
 
 // -----------------------------------------------------------------------------------------------
 
+PM_Size PM_StreamAcquire(PM_Stream* stream, PM_Size size, PM_Byte** data)
+{
+    PM_Assert(stream != NULL);
+    PM_Assert(data != NULL);
+    PM_Assert(stream->flags & PICOMEDIA_STREAM_FLAG_READ && !(stream->flags & PICOMEDIA_STREAM_FLAG_WRITE || stream->flags & PICOMEDIA_STREAM_FLAG_APPEND));
+    PM_Assert(!stream->isAcquired);
+
+    // Every acquire has to be paired with a release, even when nothing could be borrowed
+    stream->isAcquired = PM_TRUE;
+    *data = NULL;
+
+    if (stream->sourceType == PICOMEDIA_STREAM_SOURCE_TYPE_MEMORY || stream->sourceType == PICOMEDIA_STREAM_SOURCE_TYPE_MMAP)
+    {
+        PM_Size bytesToRead = size;
+        if (stream->cursorPosition + size > stream->sourceSize)
+            bytesToRead = stream->sourceSize - stream->cursorPosition;
+        *data = stream->memorySource + stream->cursorPosition;
+        stream->cursorPosition += bytesToRead;
+        return bytesToRead;
+    }
+    else if (stream->sourceType == PICOMEDIA_STREAM_SOURCE_TYPE_FILE)
+    {
+        // Never allocate more than what is left in the file, so bogus sizes from headers are harmless
+        PM_Size bytesLeft = stream->sourceSize - stream->cursorPosition;
+        PM_Size bytesToRead = size > bytesLeft ? bytesLeft : size;
+
+        if (bytesToRead > stream->acquireBufferCapacity)
+        {
+            PM_Byte* buffer = (PM_Byte*)PM_Realloc(stream->acquireBuffer, bytesToRead);
+            if (buffer == NULL)
+            {
+                PM_LogWarning("PM_StreamAcquire: Failed to allocate %zu bytes.", (size_t)bytesToRead);
+                return 0;
+            }
+            stream->acquireBuffer = buffer;
+            stream->acquireBufferCapacity = bytesToRead;
+        }
+
+        PM_Size read = PM__StreamReadFile(stream, stream->acquireBuffer, bytesToRead);
+        *data = stream->acquireBuffer;
+        return read;
+    }
+    else
+    {
+        PM_LogWarning("Invalid Stream Source Type %u", stream->sourceType);
+        return 0;
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+void PM_StreamRelease(PM_Stream* stream)
+{
+    PM_Assert(stream != NULL);
+    PM_Assert(stream->isAcquired);
+
+    stream->isAcquired = PM_FALSE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PM_StreamFlush(PM_Stream* stream)
+{
+    PM_Assert(stream != NULL);
+
+    if (stream->sourceType != PICOMEDIA_STREAM_SOURCE_TYPE_FILE)
+    {
+        return PM_TRUE;
+    }
+
+    PM_Bool result = PM__StreamFlushFile(stream);
+    if (!(stream->flags & PICOMEDIA_STREAM_FLAG_READ) && fflush(stream->fileSource) != 0)
+    {
+        result = PM_FALSE;
+    }
+
+    return result;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+void PM_StreamSetBufferSize(PM_Stream* stream, PM_Size size)
+{
+    PM_Assert(stream != NULL);
+
+    if (stream->sourceType == PICOMEDIA_STREAM_SOURCE_TYPE_FILE && stream->isInitialized && !PM__StreamFlushFile(stream))
+    {
+        PM_LogWarning("PM_StreamSetBufferSize: Failed to write the buffered data.");
+    }
+
+    if (stream->buffer)
+    {
+        PM_Free(stream->buffer);
+        stream->buffer = NULL;
+    }
+
+    stream->bufferCapacity = size;
+    stream->bufferLength = 0;
+}
+
+// -----------------------------------------------------------------------------------------------
+
 PM_Size PM_StreamGetCursorPosition(PM_Stream* stream)
 {
     PM_Assert(stream != NULL);
@@ -220,11 +628,8 @@ PM_Size PM_StreamSetCursorPosition(PM_Stream* stream, PM_Size position)
     if (position > stream->sourceSize)
         position = stream->sourceSize;
     
+    // File streams seek lazily, on the next access that can not be served from the buffer
     stream->cursorPosition = position;
-    long offset = (long)stream->cursorPosition;
-
-    if (stream->sourceType == PICOMEDIA_STREAM_SOURCE_TYPE_FILE)
-        fseek(stream->fileSource, offset, SEEK_SET);
     
     return stream->cursorPosition;
 }
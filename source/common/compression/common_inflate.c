@@ -0,0 +1,793 @@
+#include "libpicomedia/common/compression.h"
+#include "libpicomedia/common/utils.h"
+#include "libpicomedia/common/checksums.h"
+
+// Decoder states
+#define PM_INFLATE_STATE_ZLIB_HEADER            0x00
+#define PM_INFLATE_STATE_BLOCK_HEADER           0x01
+#define PM_INFLATE_STATE_STORED_HEADER          0x02
+#define PM_INFLATE_STATE_STORED_COPY            0x03
+#define PM_INFLATE_STATE_DYNAMIC_HEADER         0x04
+#define PM_INFLATE_STATE_DYNAMIC_CODE_LENGTHS   0x05
+#define PM_INFLATE_STATE_DYNAMIC_LENGTHS        0x06
+#define PM_INFLATE_STATE_BLOCK_DATA             0x07
+#define PM_INFLATE_STATE_ZLIB_TRAILER           0x08
+#define PM_INFLATE_STATE_DONE                   0x09
+#define PM_INFLATE_STATE_ERROR                  0x0A
+
+// Returned by the symbol decoder
+#define PM_INFLATE_SYMBOL_NEEDS_INPUT           -1
+#define PM_INFLATE_SYMBOL_INVALID               -2
+
+// Internal status used while stepping through the states
+#define PM_INFLATE_STEP_CONTINUE                0xFF
+
+static const PM_UInt16 PM_INFLATE_LENGTH_BASE[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+
+static const PM_UInt8 PM_INFLATE_LENGTH_EXTRA[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+static const PM_UInt16 PM_INFLATE_DISTANCE_BASE[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+
+static const PM_UInt8 PM_INFLATE_DISTANCE_EXTRA[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+static const PM_UInt8 PM_INFLATE_CODE_LENGTH_ORDER[19] = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_UInt32 PM__InflateReverseBits(PM_UInt32 value, PM_UInt32 bitCount)
+{
+    value = ((value & 0xAAAA) >> 1) | ((value & 0x5555) << 1);
+    value = ((value & 0xCCCC) >> 2) | ((value & 0x3333) << 2);
+    value = ((value & 0xF0F0) >> 4) | ((value & 0x0F0F) << 4);
+    value = ((value & 0xFF00) >> 8) | ((value & 0x00FF) << 8);
+    return value >> (16 - bitCount);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Bool PM__InflateBuildHuffman(PM_InflateHuffman* huffman, const PM_UInt8* codeLengths, PM_UInt32 symbolCount)
+{
+    PM_UInt32 lengthCounts[16] = {0};
+    PM_UInt32 nextCode[16] = {0};
+    PM_UInt32 code = 0;
+    PM_UInt32 sortedIndex = 0;
+
+    PM_Memset(huffman->fast, 0, sizeof(huffman->fast));
+
+    for (PM_UInt32 i = 0; i < symbolCount; i++)
+    {
+        lengthCounts[codeLengths[i]]++;
+    }
+    lengthCounts[0] = 0;
+
+    for (PM_UInt32 i = 1; i < 16; i++)
+    {
+        if (lengthCounts[i] > (1u << i))
+        {
+            return PM_FALSE;
+        }
+    }
+
+    for (PM_UInt32 i = 1; i < 16; i++)
+    {
+        nextCode[i] = code;
+        huffman->firstCode[i] = (PM_UInt16)code;
+        huffman->firstSymbol[i] = (PM_UInt16)sortedIndex;
+        code += lengthCounts[i];
+        if (lengthCounts[i] && (code - 1 >= (1u << i)))
+        {
+            return PM_FALSE; // over-subscribed
+        }
+        huffman->maxCode[i] = code << (16 - i); // pre-shifted for the slow path search
+        code <<= 1;
+        sortedIndex += lengthCounts[i];
+    }
+    huffman->maxCode[16] = 0x10000; // sentinel
+
+    for (PM_UInt32 i = 0; i < symbolCount; i++)
+    {
+        PM_UInt32 length = codeLengths[i];
+        if (length == 0)
+        {
+            continue;
+        }
+
+        PM_UInt32 index = nextCode[length] - huffman->firstCode[length] + huffman->firstSymbol[length];
+        huffman->sizes[index] = (PM_UInt8)length;
+        huffman->symbols[index] = (PM_UInt16)i;
+
+        if (length <= PICOMEDIA_INFLATE_FAST_BITS)
+        {
+            PM_UInt16 fastValue = (PM_UInt16)((length << 9) | i);
+            for (PM_UInt32 j = PM__InflateReverseBits(nextCode[length], length); j < (1u << PICOMEDIA_INFLATE_FAST_BITS); j += (1u << length))
+            {
+                huffman->fast[j] = fastValue;
+            }
+        }
+
+        nextCode[length]++;
+    }
+
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Decodes a symbol from the given bits without consuming them, bits above bitCount are ignored
+static PM_Int32 PM__InflateDecodeSymbol(const PM_InflateHuffman* huffman, PM_UInt64 bits, PM_UInt32 bitCount, PM_UInt32* codeLengthOut)
+{
+    PM_UInt32 fastValue = huffman->fast[bits & ((1u << PICOMEDIA_INFLATE_FAST_BITS) - 1)];
+    if (fastValue)
+    {
+        PM_UInt32 length = fastValue >> 9;
+        if (length > bitCount)
+        {
+            return PM_INFLATE_SYMBOL_NEEDS_INPUT;
+        }
+        *codeLengthOut = length;
+        return (PM_Int32)(fastValue & 511);
+    }
+
+    // Slow path, canonical search for codes longer than the fast bits
+    PM_UInt32 key = PM__InflateReverseBits((PM_UInt32)(bits & 0xFFFF), 16);
+    PM_UInt32 length = PICOMEDIA_INFLATE_FAST_BITS + 1;
+    while (key >= huffman->maxCode[length])
+    {
+        length++;
+    }
+
+    if (length > bitCount)
+    {
+        return PM_INFLATE_SYMBOL_NEEDS_INPUT;
+    }
+
+    if (length >= 16)
+    {
+        return PM_INFLATE_SYMBOL_INVALID;
+    }
+
+    PM_UInt32 index = (key >> (16 - length)) - huffman->firstCode[length] + huffman->firstSymbol[length];
+    if (index >= PICOMEDIA_INFLATE_MAX_SYMBOLS || huffman->sizes[index] != length)
+    {
+        return PM_INFLATE_SYMBOL_INVALID;
+    }
+
+    *codeLengthOut = length;
+    return (PM_Int32)huffman->symbols[index];
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__InflateRefill(PM_InflateContext* context)
+{
+    if (context->bitCount > 56)
+    {
+        return;
+    }
+
+    // Bits above bitCount may hold stale data from a previous wide refill
+    context->bitBuffer &= ((PM_UInt64)1 << context->bitCount) - 1;
+
+    if (context->inputEnd - context->input >= 8)
+    {
+        PM_UInt64 word = 0;
+        if (PM_IsBigEndian())
+        {
+            for (PM_UInt32 i = 0; i < 8; i++)
+            {
+                word |= (PM_UInt64)context->input[i] << (i * 8);
+            }
+        }
+        else
+        {
+            PM_Memcpy(&word, context->input, sizeof(word));
+        }
+
+        context->bitBuffer |= word << context->bitCount;
+        context->input += (63 - context->bitCount) >> 3;
+        context->bitCount |= 56;
+    }
+    else
+    {
+        while (context->bitCount <= 56 && context->input < context->inputEnd)
+        {
+            context->bitBuffer |= (PM_UInt64)(*context->input++) << context->bitCount;
+            context->bitCount += 8;
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Bool PM__InflateNeedBits(PM_InflateContext* context, PM_UInt32 bitCount)
+{
+    if (context->bitCount < bitCount)
+    {
+        PM__InflateRefill(context);
+    }
+    return context->bitCount >= bitCount;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_UInt32 PM__InflateTakeBits(PM_InflateContext* context, PM_UInt32 bitCount)
+{
+    PM_UInt32 value = (PM_UInt32)(context->bitBuffer & (((PM_UInt64)1 << bitCount) - 1));
+    context->bitBuffer >>= bitCount;
+    context->bitCount -= bitCount;
+    return value;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_UInt32 PM__InflateFail(PM_InflateContext* context, const PM_Char* reason)
+{
+    PM_LogWarning("PM_InflateFeed: %s", reason);
+    context->state = PM_INFLATE_STATE_ERROR;
+    return PICOMEDIA_INFLATE_STATUS_ERROR;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Bool PM__InflateBuildFixedTables(PM_InflateContext* context)
+{
+    PM_UInt8 lengths[PICOMEDIA_INFLATE_MAX_SYMBOLS];
+    PM_UInt32 i = 0;
+
+    for (i = 0; i < 144; i++) lengths[i] = 8;
+    for (; i < 256; i++) lengths[i] = 9;
+    for (; i < 280; i++) lengths[i] = 7;
+    for (; i < 288; i++) lengths[i] = 8;
+
+    if (!PM__InflateBuildHuffman(&context->literalLengthTable, lengths, 288))
+    {
+        return PM_FALSE;
+    }
+
+    for (i = 0; i < 30; i++) lengths[i] = 5;
+
+    return PM__InflateBuildHuffman(&context->distanceTable, lengths, 30);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__InflateCopyMatch(PM_UInt8* out, PM_UInt32 distance, PM_UInt32 length, const PM_UInt8* outEnd)
+{
+    const PM_UInt8* src = out - distance;
+
+    if (distance == 1)
+    {
+        PM_Memset(out, *src, length);
+    }
+    else if (distance >= 8 && (PM_Size)(outEnd - out) >= (PM_Size)length + 8)
+    {
+        // Chunks never overlap within themselves as the distance is at least 8 bytes
+        PM_UInt8* end = out + length;
+        while (out < end)
+        {
+            PM_Memcpy(out, src, 8);
+            out += 8;
+            src += 8;
+        }
+    }
+    else
+    {
+        while (length--)
+        {
+            *out++ = *src++;
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_UInt32 PM__InflateDecodeBlockData(PM_InflateContext* context)
+{
+    PM_UInt8* out = context->outputCursor;
+    PM_UInt8* outEnd = context->outputEnd;
+
+    for (;;)
+    {
+        PM__InflateRefill(context);
+
+        // Work on a copy of the bit buffer so that a partially available symbol pair is never consumed
+        PM_UInt64 bits = context->bitBuffer;
+        PM_UInt32 bitCount = context->bitCount;
+        PM_UInt32 codeLength = 0;
+
+        PM_Int32 symbol = PM__InflateDecodeSymbol(&context->literalLengthTable, bits, bitCount, &codeLength);
+        if (symbol < 0)
+        {
+            context->outputCursor = out;
+            return symbol == PM_INFLATE_SYMBOL_NEEDS_INPUT ? PICOMEDIA_INFLATE_STATUS_NEEDS_INPUT : PM__InflateFail(context, "Invalid literal/length code.");
+        }
+        bits >>= codeLength;
+        bitCount -= codeLength;
+
+        if (symbol < 256)
+        {
+            if (out >= outEnd)
+            {
+                context->outputCursor = out;
+                return PM__InflateFail(context, "Output buffer overflow.");
+            }
+            *out++ = (PM_UInt8)symbol;
+            context->bitBuffer = bits;
+            context->bitCount = bitCount;
+            continue;
+        }
+
+        if (symbol == 256)
+        {
+            context->bitBuffer = bits;
+            context->bitCount = bitCount;
+            context->outputCursor = out;
+            if (context->isFinalBlock)
+            {
+                context->state = context->hasZlibWrapper ? PM_INFLATE_STATE_ZLIB_TRAILER : PM_INFLATE_STATE_DONE;
+            }
+            else
+            {
+                context->state = PM_INFLATE_STATE_BLOCK_HEADER;
+            }
+            return PM_INFLATE_STEP_CONTINUE;
+        }
+
+        symbol -= 257;
+        if (symbol >= 29)
+        {
+            context->outputCursor = out;
+            return PM__InflateFail(context, "Invalid length symbol.");
+        }
+
+        PM_UInt32 extraBits = PM_INFLATE_LENGTH_EXTRA[symbol];
+        if (bitCount < extraBits)
+        {
+            context->outputCursor = out;
+            return PICOMEDIA_INFLATE_STATUS_NEEDS_INPUT;
+        }
+        PM_UInt32 length = PM_INFLATE_LENGTH_BASE[symbol] + (PM_UInt32)(bits & ((1u << extraBits) - 1));
+        bits >>= extraBits;
+        bitCount -= extraBits;
+
+        symbol = PM__InflateDecodeSymbol(&context->distanceTable, bits, bitCount, &codeLength);
+        if (symbol < 0)
+        {
+            context->outputCursor = out;
+            return symbol == PM_INFLATE_SYMBOL_NEEDS_INPUT ? PICOMEDIA_INFLATE_STATUS_NEEDS_INPUT : PM__InflateFail(context, "Invalid distance code.");
+        }
+        if (symbol >= 30)
+        {
+            context->outputCursor = out;
+            return PM__InflateFail(context, "Invalid distance symbol.");
+        }
+        bits >>= codeLength;
+        bitCount -= codeLength;
+
+        extraBits = PM_INFLATE_DISTANCE_EXTRA[symbol];
+        if (bitCount < extraBits)
+        {
+            context->outputCursor = out;
+            return PICOMEDIA_INFLATE_STATUS_NEEDS_INPUT;
+        }
+        PM_UInt32 distance = PM_INFLATE_DISTANCE_BASE[symbol] + (PM_UInt32)(bits & ((1u << extraBits) - 1));
+        bits >>= extraBits;
+        bitCount -= extraBits;
+
+        if ((PM_Size)distance > (PM_Size)(out - context->output))
+        {
+            context->outputCursor = out;
+            return PM__InflateFail(context, "Distance too far back.");
+        }
+
+        if ((PM_Size)length > (PM_Size)(outEnd - out))
+        {
+            context->outputCursor = out;
+            return PM__InflateFail(context, "Output buffer overflow.");
+        }
+
+        context->bitBuffer = bits;
+        context->bitCount = bitCount;
+
+        PM__InflateCopyMatch(out, distance, length, outEnd);
+        out += length;
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_UInt32 PM__InflateDecodeDynamicLengths(PM_InflateContext* context)
+{
+    PM_UInt32 totalCount = context->literalCount + context->distanceCount;
+
+    while (context->codeLengthIndex < totalCount)
+    {
+        PM__InflateRefill(context);
+
+        PM_UInt64 bits = context->bitBuffer;
+        PM_UInt32 bitCount = context->bitCount;
+        PM_UInt32 codeLength = 0;
+
+        PM_Int32 symbol = PM__InflateDecodeSymbol(&context->codeLengthTable, bits, bitCount, &codeLength);
+        if (symbol < 0)
+        {
+            return symbol == PM_INFLATE_SYMBOL_NEEDS_INPUT ? PICOMEDIA_INFLATE_STATUS_NEEDS_INPUT : PM__InflateFail(context, "Invalid code length code.");
+        }
+        bits >>= codeLength;
+        bitCount -= codeLength;
+
+        PM_UInt32 repeatCount = 1;
+        PM_UInt8 repeatValue = 0;
+
+        if (symbol < 16)
+        {
+            repeatValue = (PM_UInt8)symbol;
+        }
+        else
+        {
+            static const PM_UInt8 extraBitsTable[3] = { 2, 3, 7 };
+            static const PM_UInt8 repeatBaseTable[3] = { 3, 3, 11 };
+
+            PM_UInt32 extraBits = extraBitsTable[symbol - 16];
+            if (bitCount < extraBits)
+            {
+                return PICOMEDIA_INFLATE_STATUS_NEEDS_INPUT;
+            }
+            repeatCount = repeatBaseTable[symbol - 16] + (PM_UInt32)(bits & ((1u << extraBits) - 1));
+            bits >>= extraBits;
+            bitCount -= extraBits;
+
+            if (symbol == 16)
+            {
+                if (context->codeLengthIndex == 0)
+                {
+                    return PM__InflateFail(context, "Repeat code without a previous length.");
+                }
+                repeatValue = context->codeLengths[context->codeLengthIndex - 1];
+            }
+        }
+
+        if (context->codeLengthIndex + repeatCount > totalCount)
+        {
+            return PM__InflateFail(context, "Too many code lengths.");
+        }
+
+        PM_Memset(context->codeLengths + context->codeLengthIndex, repeatValue, repeatCount);
+        context->codeLengthIndex += repeatCount;
+        context->bitBuffer = bits;
+        context->bitCount = bitCount;
+    }
+
+    if (context->codeLengths[256] == 0)
+    {
+        return PM__InflateFail(context, "Missing end of block code.");
+    }
+
+    if (!PM__InflateBuildHuffman(&context->literalLengthTable, context->codeLengths, context->literalCount)
+        || !PM__InflateBuildHuffman(&context->distanceTable, context->codeLengths + context->literalCount, context->distanceCount))
+    {
+        return PM__InflateFail(context, "Invalid dynamic huffman tables.");
+    }
+
+    context->state = PM_INFLATE_STATE_BLOCK_DATA;
+    return PM_INFLATE_STEP_CONTINUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_UInt32 PM__InflateStep(PM_InflateContext* context)
+{
+    switch (context->state)
+    {
+        case PM_INFLATE_STATE_ZLIB_HEADER:
+        {
+            if (!PM__InflateNeedBits(context, 16))
+            {
+                return PICOMEDIA_INFLATE_STATUS_NEEDS_INPUT;
+            }
+            PM_UInt32 cmf = PM__InflateTakeBits(context, 8);
+            PM_UInt32 flg = PM__InflateTakeBits(context, 8);
+
+            if (((cmf << 8) | flg) % 31 != 0)
+            {
+                return PM__InflateFail(context, "Invalid zlib header checksum.");
+            }
+            if ((cmf & 0x0F) != 8 || (cmf >> 4) > 7)
+            {
+                return PM__InflateFail(context, "Unsupported zlib compression method.");
+            }
+            if (flg & 0x20)
+            {
+                return PM__InflateFail(context, "Preset dictionaries are not supported.");
+            }
+
+            context->state = PM_INFLATE_STATE_BLOCK_HEADER;
+            return PM_INFLATE_STEP_CONTINUE;
+        }
+        case PM_INFLATE_STATE_BLOCK_HEADER:
+        {
+            if (!PM__InflateNeedBits(context, 3))
+            {
+                return PICOMEDIA_INFLATE_STATUS_NEEDS_INPUT;
+            }
+            context->isFinalBlock = PM__InflateTakeBits(context, 1) != 0;
+            PM_UInt32 blockType = PM__InflateTakeBits(context, 2);
+
+            switch (blockType)
+            {
+                case 0: context->state = PM_INFLATE_STATE_STORED_HEADER; break;
+                case 1:
+                {
+                    if (!PM__InflateBuildFixedTables(context))
+                    {
+                        return PM__InflateFail(context, "Failed to build fixed huffman tables.");
+                    }
+                    context->state = PM_INFLATE_STATE_BLOCK_DATA;
+                    break;
+                }
+                case 2: context->state = PM_INFLATE_STATE_DYNAMIC_HEADER; break;
+                default: return PM__InflateFail(context, "Invalid block type.");
+            }
+            return PM_INFLATE_STEP_CONTINUE;
+        }
+        case PM_INFLATE_STATE_STORED_HEADER:
+        {
+            // Stored blocks start at a byte boundary
+            PM__InflateTakeBits(context, context->bitCount & 7);
+
+            if (!PM__InflateNeedBits(context, 32))
+            {
+                return PICOMEDIA_INFLATE_STATUS_NEEDS_INPUT;
+            }
+            PM_UInt32 length = PM__InflateTakeBits(context, 16);
+            PM_UInt32 lengthComplement = PM__InflateTakeBits(context, 16);
+
+            if ((length ^ 0xFFFF) != lengthComplement)
+            {
+                return PM__InflateFail(context, "Stored block length mismatch.");
+            }
+
+            context->storedRemaining = length;
+            context->state = PM_INFLATE_STATE_STORED_COPY;
+            return PM_INFLATE_STEP_CONTINUE;
+        }
+        case PM_INFLATE_STATE_STORED_COPY:
+        {
+            if ((PM_Size)(context->outputEnd - context->outputCursor) < context->storedRemaining)
+            {
+                return PM__InflateFail(context, "Output buffer overflow.");
+            }
+
+            // First drain the whole bytes already pulled into the bit buffer
+            while (context->storedRemaining > 0 && context->bitCount >= 8)
+            {
+                *context->outputCursor++ = (PM_UInt8)PM__InflateTakeBits(context, 8);
+                context->storedRemaining--;
+            }
+
+            PM_Size available = (PM_Size)(context->inputEnd - context->input);
+            PM_Size toCopy = PM_Min(available, (PM_Size)context->storedRemaining);
+            PM_Memcpy(context->outputCursor, context->input, toCopy);
+            context->outputCursor += toCopy;
+            context->input += toCopy;
+            context->storedRemaining -= (PM_UInt32)toCopy;
+
+            if (context->storedRemaining > 0)
+            {
+                return PICOMEDIA_INFLATE_STATUS_NEEDS_INPUT;
+            }
+
+            if (context->isFinalBlock)
+            {
+                context->state = context->hasZlibWrapper ? PM_INFLATE_STATE_ZLIB_TRAILER : PM_INFLATE_STATE_DONE;
+            }
+            else
+            {
+                context->state = PM_INFLATE_STATE_BLOCK_HEADER;
+            }
+            return PM_INFLATE_STEP_CONTINUE;
+        }
+        case PM_INFLATE_STATE_DYNAMIC_HEADER:
+        {
+            if (!PM__InflateNeedBits(context, 14))
+            {
+                return PICOMEDIA_INFLATE_STATUS_NEEDS_INPUT;
+            }
+            context->literalCount = PM__InflateTakeBits(context, 5) + 257;
+            context->distanceCount = PM__InflateTakeBits(context, 5) + 1;
+            context->codeLengthCount = PM__InflateTakeBits(context, 4) + 4;
+
+            if (context->literalCount > 286 || context->distanceCount > 30)
+            {
+                return PM__InflateFail(context, "Invalid dynamic block header.");
+            }
+
+            PM_Memset(context->codeLengths, 0, sizeof(context->codeLengths));
+            context->codeLengthIndex = 0;
+            context->state = PM_INFLATE_STATE_DYNAMIC_CODE_LENGTHS;
+            return PM_INFLATE_STEP_CONTINUE;
+        }
+        case PM_INFLATE_STATE_DYNAMIC_CODE_LENGTHS:
+        {
+            while (context->codeLengthIndex < context->codeLengthCount)
+            {
+                if (!PM__InflateNeedBits(context, 3))
+                {
+                    return PICOMEDIA_INFLATE_STATUS_NEEDS_INPUT;
+                }
+                context->codeLengths[PM_INFLATE_CODE_LENGTH_ORDER[context->codeLengthIndex++]] = (PM_UInt8)PM__InflateTakeBits(context, 3);
+            }
+
+            if (!PM__InflateBuildHuffman(&context->codeLengthTable, context->codeLengths, 19))
+            {
+                return PM__InflateFail(context, "Invalid code length huffman table.");
+            }
+
+            PM_Memset(context->codeLengths, 0, sizeof(context->codeLengths));
+            context->codeLengthIndex = 0;
+            context->state = PM_INFLATE_STATE_DYNAMIC_LENGTHS;
+            return PM_INFLATE_STEP_CONTINUE;
+        }
+        case PM_INFLATE_STATE_DYNAMIC_LENGTHS:
+        {
+            return PM__InflateDecodeDynamicLengths(context);
+        }
+        case PM_INFLATE_STATE_BLOCK_DATA:
+        {
+            return PM__InflateDecodeBlockData(context);
+        }
+        case PM_INFLATE_STATE_ZLIB_TRAILER:
+        {
+            PM__InflateTakeBits(context, context->bitCount & 7);
+
+            if (!PM__InflateNeedBits(context, 32))
+            {
+                return PICOMEDIA_INFLATE_STATUS_NEEDS_INPUT;
+            }
+
+            // The Adler-32 checksum is stored in network byte order
+            context->adler32 = 0;
+            for (PM_UInt32 i = 0; i < 4; i++)
+            {
+                context->adler32 = (context->adler32 << 8) | PM__InflateTakeBits(context, 8);
+            }
+
+            // The whole stream is in the output buffer, so it is checksummed in a single pass
+            if (PM_Adler32(context->output, (PM_Size)(context->outputCursor - context->output), 1) != context->adler32)
+            {
+                return PM__InflateFail(context, "Adler-32 checksum mismatch.");
+            }
+
+            context->state = PM_INFLATE_STATE_DONE;
+            return PM_INFLATE_STEP_CONTINUE;
+        }
+        case PM_INFLATE_STATE_DONE:
+        {
+            return PICOMEDIA_INFLATE_STATUS_DONE;
+        }
+        default:
+        {
+            return PICOMEDIA_INFLATE_STATUS_ERROR;
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+void PM_InflateContextInit(PM_InflateContext* context, PM_Bool hasZlibWrapper)
+{
+    PM_Assert(context != NULL);
+
+    context->bitBuffer = 0;
+    context->bitCount = 0;
+    context->input = NULL;
+    context->inputEnd = NULL;
+    context->output = NULL;
+    context->outputCursor = NULL;
+    context->outputEnd = NULL;
+    context->state = hasZlibWrapper ? PM_INFLATE_STATE_ZLIB_HEADER : PM_INFLATE_STATE_BLOCK_HEADER;
+    context->storedRemaining = 0;
+    context->literalCount = 0;
+    context->distanceCount = 0;
+    context->codeLengthCount = 0;
+    context->codeLengthIndex = 0;
+    context->adler32 = 0;
+    context->isFinalBlock = PM_FALSE;
+    context->hasZlibWrapper = hasZlibWrapper;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+void PM_InflateContextSetOutput(PM_InflateContext* context, PM_UInt8* output, PM_Size outputSize)
+{
+    PM_Assert(context != NULL);
+    PM_Assert(output != NULL || outputSize == 0);
+
+    context->output = output;
+    context->outputCursor = output;
+    context->outputEnd = output + outputSize;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_UInt32 PM_InflateFeed(PM_InflateContext* context, const PM_UInt8* data, PM_Size dataSize)
+{
+    PM_Assert(context != NULL);
+    PM_Assert(data != NULL || dataSize == 0);
+
+    if (context->state == PM_INFLATE_STATE_ERROR)
+    {
+        return PICOMEDIA_INFLATE_STATUS_ERROR;
+    }
+
+    context->input = data;
+    context->inputEnd = data + dataSize;
+
+    PM_UInt32 status = PM_INFLATE_STEP_CONTINUE;
+    while (status == PM_INFLATE_STEP_CONTINUE)
+    {
+        status = PM__InflateStep(context);
+    }
+
+    // Whatever could not be decoded yet is held in the bit buffer
+    PM__InflateRefill(context);
+    if (status == PICOMEDIA_INFLATE_STATUS_NEEDS_INPUT && context->input != context->inputEnd)
+    {
+        return PM__InflateFail(context, "Input could not be buffered.");
+    }
+
+    context->input = NULL;
+    context->inputEnd = NULL;
+
+    return status;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Size PM_InflateGetOutputSize(const PM_InflateContext* context)
+{
+    PM_Assert(context != NULL);
+
+    return (PM_Size)(context->outputCursor - context->output);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PM_Inflate(const PM_UInt8* data, PM_Size dataSize, PM_UInt8* output, PM_Size outputSize, PM_Size* outputWritten, PM_Bool hasZlibWrapper)
+{
+    PM_Assert(data != NULL);
+    PM_Assert(output != NULL);
+
+    PM_InflateContext* context = PM_New(PM_InflateContext);
+    if (context == NULL)
+    {
+        PM_LogWarning("PM_Inflate: Failed to allocate inflate context.");
+        return PM_FALSE;
+    }
+
+    PM_InflateContextInit(context, hasZlibWrapper);
+    PM_InflateContextSetOutput(context, output, outputSize);
+
+    PM_Bool result = PM_InflateFeed(context, data, dataSize) == PICOMEDIA_INFLATE_STATUS_DONE;
+
+    if (outputWritten != NULL)
+    {
+        *outputWritten = PM_InflateGetOutputSize(context);
+    }
+
+    PM_Delete(context);
+
+    return result;
+}
+
+// -----------------------------------------------------------------------------------------------
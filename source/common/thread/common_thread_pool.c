@@ -0,0 +1,585 @@
+#include "libpicomedia/common/thread.h"
+
+// Number of tasks a deque can hold before it has to grow, must be a power of two
+#define PM_THREAD_POOL_DEQUE_INITIAL_CAPACITY 64
+
+// Number of chunks per thread PM_ParallelFor aims for when no grain is given, so uneven chunks can be balanced
+#define PM_PARALLEL_FOR_CHUNKS_PER_THREAD 4
+
+typedef struct
+{
+    PM_TaskFunc func;
+    void* data;
+    PM_TaskGroup* group;
+} PM__ThreadPoolTask;
+
+// The owner pushes and pops at the tail, other threads steal from the head
+typedef struct
+{
+    PM_Mutex* mutex;
+    PM__ThreadPoolTask* tasks;
+    PM_Size capacity;
+    PM_Size head;
+    PM_Size tail;
+    volatile PM_Int64 count; // Read without the lock to skip empty deques
+} PM__ThreadPoolDeque;
+
+typedef struct
+{
+    PM_ThreadPool* pool;
+    PM_Thread* thread;
+    PM__ThreadPoolDeque deque;
+} PM__ThreadPoolWorker;
+
+struct PM_ThreadPool
+{
+    PM__ThreadPoolWorker* workers;
+    PM_Size workerCount;
+    PM__ThreadPoolDeque sharedQueue;        // Tasks submitted from threads outside of the pool
+    PM_Mutex* mutex;                        // Only protects sleeping and waking up
+    PM_ConditionVariable* workAvailable;    // Idle workers sleep on this
+    PM_ConditionVariable* taskCompleted;    // Threads in PM_TaskGroupWait sleep on this
+    volatile PM_Int64 queuedTasks;
+    volatile PM_Int64 sleepingWorkers;
+    volatile PM_Int64 waitingThreads;
+    volatile PM_Int64 shutdown;
+};
+
+struct PM_TaskGroup
+{
+    PM_ThreadPool* pool;
+    volatile PM_Int64 pendingTasks;
+};
+
+typedef struct
+{
+    PM_ParallelForFunc func;
+    void* data;
+    PM_Size begin;
+    PM_Size end;
+    PM_Size grain;
+    PM_Int64 chunkCount;
+    volatile PM_Int64 nextChunk;
+} PM__ParallelForState;
+
+static PM_THREAD_LOCAL PM__ThreadPoolWorker* PM_THREAD_POOL_CURRENT_WORKER = NULL;
+static PM_ThreadPool* volatile PM_THREAD_POOL_DEFAULT = NULL;
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Bool PM__ThreadPoolDequeInit(PM__ThreadPoolDeque* deque)
+{
+    deque->mutex = PM_MutexCreate();
+    deque->tasks = PM_NewN(PM__ThreadPoolTask, PM_THREAD_POOL_DEQUE_INITIAL_CAPACITY);
+    deque->capacity = PM_THREAD_POOL_DEQUE_INITIAL_CAPACITY;
+    deque->head = 0;
+    deque->tail = 0;
+    deque->count = 0;
+
+    return deque->mutex != NULL && deque->tasks != NULL;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ThreadPoolDequeDestroy(PM__ThreadPoolDeque* deque)
+{
+    if (deque->mutex != NULL)
+    {
+        PM_MutexDestroy(deque->mutex);
+        deque->mutex = NULL;
+    }
+
+    if (deque->tasks != NULL)
+    {
+        PM_Free(deque->tasks);
+        deque->tasks = NULL;
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Bool PM__ThreadPoolDequePush(PM__ThreadPoolDeque* deque, const PM__ThreadPoolTask* task)
+{
+    PM_MutexLock(deque->mutex);
+
+    if (deque->tail - deque->head == deque->capacity)
+    {
+        PM_Size newCapacity = deque->capacity * 2;
+        PM__ThreadPoolTask* newTasks = PM_NewN(PM__ThreadPoolTask, newCapacity);
+        if (newTasks == NULL)
+        {
+            PM_MutexUnlock(deque->mutex);
+            return PM_FALSE;
+        }
+
+        for (PM_Size i = deque->head; i != deque->tail; i++)
+        {
+            newTasks[i & (newCapacity - 1)] = deque->tasks[i & (deque->capacity - 1)];
+        }
+
+        PM_Free(deque->tasks);
+        deque->tasks = newTasks;
+        deque->capacity = newCapacity;
+    }
+
+    deque->tasks[deque->tail & (deque->capacity - 1)] = *task;
+    deque->tail++;
+    PM_AtomicAddInt64(&deque->count, 1);
+
+    PM_MutexUnlock(deque->mutex);
+
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Bool PM__ThreadPoolDequePop(PM__ThreadPoolDeque* deque, PM__ThreadPoolTask* task, PM_Bool fromTail)
+{
+    if (PM_AtomicLoadInt64(&deque->count) <= 0)
+    {
+        return PM_FALSE;
+    }
+
+    PM_MutexLock(deque->mutex);
+
+    PM_Bool found = deque->head != deque->tail;
+    if (found)
+    {
+        if (fromTail)
+        {
+            deque->tail--;
+            *task = deque->tasks[deque->tail & (deque->capacity - 1)];
+        }
+        else
+        {
+            *task = deque->tasks[deque->head & (deque->capacity - 1)];
+            deque->head++;
+        }
+        PM_AtomicAddInt64(&deque->count, -1);
+    }
+
+    PM_MutexUnlock(deque->mutex);
+
+    return found;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Own deque first (newest task, its data is likely still in cache), then the shared queue, then steal the oldest task of another worker
+static PM_Bool PM__ThreadPoolFindTask(PM_ThreadPool* pool, PM__ThreadPoolWorker* self, PM__ThreadPoolTask* task)
+{
+    if (PM_AtomicLoadInt64(&pool->queuedTasks) <= 0)
+    {
+        return PM_FALSE;
+    }
+
+    PM_Bool found = PM_FALSE;
+    PM_Size start = 0;
+
+    if (self != NULL)
+    {
+        found = PM__ThreadPoolDequePop(&self->deque, task, PM_TRUE);
+        start = (PM_Size)(self - pool->workers) + 1;
+    }
+
+    if (!found)
+    {
+        found = PM__ThreadPoolDequePop(&pool->sharedQueue, task, PM_FALSE);
+    }
+
+    for (PM_Size i = 0; i < pool->workerCount && !found; i++)
+    {
+        PM__ThreadPoolWorker* victim = &pool->workers[(start + i) % pool->workerCount];
+        if (victim != self)
+        {
+            found = PM__ThreadPoolDequePop(&victim->deque, task, PM_FALSE);
+        }
+    }
+
+    if (found)
+    {
+        PM_AtomicAddInt64(&pool->queuedTasks, -1);
+    }
+
+    return found;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ThreadPoolRunTask(const PM__ThreadPoolTask* task)
+{
+    // The group may be destroyed as soon as its last task is done, so the pool is read beforehand
+    PM_TaskGroup* group = task->group;
+    PM_ThreadPool* pool = group->pool;
+
+    task->func(task->data);
+
+    if (PM_AtomicAddInt64(&group->pendingTasks, -1) == 0 && PM_AtomicLoadInt64(&pool->waitingThreads) > 0)
+    {
+        PM_MutexLock(pool->mutex);
+        PM_ConditionVariableBroadcast(pool->taskCompleted);
+        PM_MutexUnlock(pool->mutex);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Bool PM__ThreadPoolWorkerProc(PM_Thread* thread, void* data)
+{
+    (void)thread;
+
+    PM__ThreadPoolWorker* self = (PM__ThreadPoolWorker*)data;
+    PM_ThreadPool* pool = self->pool;
+    PM_THREAD_POOL_CURRENT_WORKER = self;
+
+    for (;;)
+    {
+        PM__ThreadPoolTask task;
+        if (PM__ThreadPoolFindTask(pool, self, &task))
+        {
+            PM__ThreadPoolRunTask(&task);
+            continue;
+        }
+
+        // Publishing the sleeping worker before checking for tasks pairs with the submitting side,
+        // which publishes the task before checking for sleeping workers, so no wake up is lost
+        PM_MutexLock(pool->mutex);
+        PM_AtomicAddInt64(&pool->sleepingWorkers, 1);
+        while (PM_AtomicLoadInt64(&pool->queuedTasks) <= 0 && !PM_AtomicLoadInt64(&pool->shutdown))
+        {
+            PM_ConditionVariableWait(pool->workAvailable, pool->mutex);
+        }
+        PM_AtomicAddInt64(&pool->sleepingWorkers, -1);
+        PM_Bool stop = PM_AtomicLoadInt64(&pool->shutdown) && PM_AtomicLoadInt64(&pool->queuedTasks) <= 0;
+        PM_MutexUnlock(pool->mutex);
+
+        if (stop)
+        {
+            break;
+        }
+    }
+
+    PM_THREAD_POOL_CURRENT_WORKER = NULL;
+
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM__ThreadPoolWorker* PM__ThreadPoolGetCurrentWorker(PM_ThreadPool* pool)
+{
+    PM__ThreadPoolWorker* worker = PM_THREAD_POOL_CURRENT_WORKER;
+    return (worker != NULL && worker->pool == pool) ? worker : NULL;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ParallelForRunChunks(void* data)
+{
+    PM__ParallelForState* state = (PM__ParallelForState*)data;
+
+    for (;;)
+    {
+        PM_Int64 chunk = PM_AtomicAddInt64(&state->nextChunk, 1) - 1;
+        if (chunk >= state->chunkCount)
+        {
+            break;
+        }
+
+        PM_Size chunkBegin = state->begin + (PM_Size)chunk * state->grain;
+        PM_Size chunkEnd = PM_Min(chunkBegin + state->grain, state->end);
+        state->func(chunkBegin, chunkEnd, state->data);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_ThreadPool* PICOMEDIA_API PM_ThreadPoolCreate(PM_Size threadCount)
+{
+    if (threadCount == 0)
+    {
+        threadCount = PM_ThreadGetProcessorCount();
+    }
+
+    PM_ThreadPool* pool = PM_New(PM_ThreadPool);
+    if (pool == NULL)
+    {
+        return NULL;
+    }
+    PM_Memset(pool, 0, sizeof(PM_ThreadPool));
+
+    pool->mutex = PM_MutexCreate();
+    pool->workAvailable = PM_ConditionVariableCreate();
+    pool->taskCompleted = PM_ConditionVariableCreate();
+    pool->workers = PM_NewN(PM__ThreadPoolWorker, threadCount);
+
+    PM_Bool valid = PM__ThreadPoolDequeInit(&pool->sharedQueue) &&
+        pool->mutex != NULL && pool->workAvailable != NULL && pool->taskCompleted != NULL && pool->workers != NULL;
+
+    if (pool->workers != NULL)
+    {
+        PM_Memset(pool->workers, 0, sizeof(PM__ThreadPoolWorker) * threadCount);
+        for (PM_Size i = 0; i < threadCount; i++)
+        {
+            pool->workers[i].pool = pool;
+            valid = PM__ThreadPoolDequeInit(&pool->workers[i].deque) && valid;
+        }
+        pool->workerCount = threadCount;
+    }
+
+    // All the workers must be set up before the first one starts stealing
+    for (PM_Size i = 0; i < threadCount && valid; i++)
+    {
+        pool->workers[i].thread = PM_ThreadCreate(PM__ThreadPoolWorkerProc, &pool->workers[i]);
+        valid = pool->workers[i].thread != NULL;
+    }
+
+    if (!valid)
+    {
+        PM_LogWarning("PM_ThreadPoolCreate: Failed to create the thread pool.");
+        PM_ThreadPoolDestroy(pool);
+        return NULL;
+    }
+
+    return pool;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+void PICOMEDIA_API PM_ThreadPoolDestroy(PM_ThreadPool* pool)
+{
+    PM_Assert(pool != NULL);
+
+    if (pool->mutex != NULL && pool->workAvailable != NULL)
+    {
+        PM_MutexLock(pool->mutex);
+        PM_AtomicAddInt64(&pool->shutdown, 1);
+        PM_ConditionVariableBroadcast(pool->workAvailable);
+        PM_MutexUnlock(pool->mutex);
+    }
+
+    if (pool->workers != NULL)
+    {
+        // The workers only exit once every queued task is done
+        for (PM_Size i = 0; i < pool->workerCount; i++)
+        {
+            if (pool->workers[i].thread != NULL)
+            {
+                PM_ThreadDestroy(pool->workers[i].thread);
+            }
+        }
+
+        for (PM_Size i = 0; i < pool->workerCount; i++)
+        {
+            PM__ThreadPoolDequeDestroy(&pool->workers[i].deque);
+        }
+
+        PM_Free(pool->workers);
+    }
+
+    PM__ThreadPoolDequeDestroy(&pool->sharedQueue);
+
+    if (pool->taskCompleted != NULL) PM_ConditionVariableDestroy(pool->taskCompleted);
+    if (pool->workAvailable != NULL) PM_ConditionVariableDestroy(pool->workAvailable);
+    if (pool->mutex != NULL) PM_MutexDestroy(pool->mutex);
+
+    PM_Free(pool);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_ThreadPool* PICOMEDIA_API PM_ThreadPoolGetDefault()
+{
+    PM_ThreadPool* pool = (PM_ThreadPool*)PM_AtomicLoadPointer((void* volatile*)&PM_THREAD_POOL_DEFAULT);
+    if (pool != NULL)
+    {
+        return pool;
+    }
+
+    // Racing threads may each create a pool, only the first one to be published is kept
+    pool = PM_ThreadPoolCreate(0);
+    if (pool == NULL)
+    {
+        return NULL;
+    }
+
+    if (!PM_AtomicCompareExchangePointer((void* volatile*)&PM_THREAD_POOL_DEFAULT, NULL, pool))
+    {
+        PM_ThreadPoolDestroy(pool);
+        return (PM_ThreadPool*)PM_AtomicLoadPointer((void* volatile*)&PM_THREAD_POOL_DEFAULT);
+    }
+
+    return pool;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Size PICOMEDIA_API PM_ThreadPoolGetThreadCount(PM_ThreadPool* pool)
+{
+    if (pool == NULL)
+    {
+        pool = PM_ThreadPoolGetDefault();
+    }
+
+    return pool != NULL ? pool->workerCount : 0;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_TaskGroup* PICOMEDIA_API PM_TaskGroupCreate(PM_ThreadPool* pool)
+{
+    if (pool == NULL)
+    {
+        pool = PM_ThreadPoolGetDefault();
+    }
+
+    PM_TaskGroup* group = PM_New(PM_TaskGroup);
+    if (group == NULL)
+    {
+        return NULL;
+    }
+
+    group->pool = pool;
+    group->pendingTasks = 0;
+
+    return group;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+void PICOMEDIA_API PM_TaskGroupDestroy(PM_TaskGroup* group)
+{
+    PM_Assert(group != NULL);
+
+    PM_TaskGroupWait(group);
+
+    PM_Free(group);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+void PICOMEDIA_API PM_TaskGroupRun(PM_TaskGroup* group, PM_TaskFunc func, void* data)
+{
+    PM_Assert(group != NULL);
+    PM_Assert(func != NULL);
+
+    PM_ThreadPool* pool = group->pool;
+    if (pool == NULL)
+    {
+        func(data);
+        return;
+    }
+
+    PM__ThreadPoolTask task = { func, data, group };
+    PM__ThreadPoolWorker* self = PM__ThreadPoolGetCurrentWorker(pool);
+
+    PM_AtomicAddInt64(&group->pendingTasks, 1);
+    PM_AtomicAddInt64(&pool->queuedTasks, 1);
+
+    if (!PM__ThreadPoolDequePush(self != NULL ? &self->deque : &pool->sharedQueue, &task))
+    {
+        PM_AtomicAddInt64(&pool->queuedTasks, -1);
+        PM__ThreadPoolRunTask(&task);
+        return;
+    }
+
+    if (PM_AtomicLoadInt64(&pool->sleepingWorkers) > 0 || PM_AtomicLoadInt64(&pool->waitingThreads) > 0)
+    {
+        PM_MutexLock(pool->mutex);
+        PM_ConditionVariableSignal(pool->workAvailable);
+        PM_ConditionVariableBroadcast(pool->taskCompleted);
+        PM_MutexUnlock(pool->mutex);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+void PICOMEDIA_API PM_TaskGroupWait(PM_TaskGroup* group)
+{
+    PM_Assert(group != NULL);
+
+    PM_ThreadPool* pool = group->pool;
+    if (pool == NULL)
+    {
+        return;
+    }
+
+    PM__ThreadPoolWorker* self = PM__ThreadPoolGetCurrentWorker(pool);
+
+    while (PM_AtomicLoadInt64(&group->pendingTasks) > 0)
+    {
+        // Helping with any queued task (not only the ones of this group) keeps nested waits from deadlocking
+        PM__ThreadPoolTask task;
+        if (PM__ThreadPoolFindTask(pool, self, &task))
+        {
+            PM__ThreadPoolRunTask(&task);
+            continue;
+        }
+
+        PM_MutexLock(pool->mutex);
+        PM_AtomicAddInt64(&pool->waitingThreads, 1);
+        while (PM_AtomicLoadInt64(&group->pendingTasks) > 0 && PM_AtomicLoadInt64(&pool->queuedTasks) <= 0)
+        {
+            PM_ConditionVariableWait(pool->taskCompleted, pool->mutex);
+        }
+        PM_AtomicAddInt64(&pool->waitingThreads, -1);
+        PM_MutexUnlock(pool->mutex);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+void PICOMEDIA_API PM_ParallelFor(PM_ThreadPool* pool, PM_Size begin, PM_Size end, PM_Size grain, PM_ParallelForFunc func, void* data)
+{
+    PM_Assert(func != NULL);
+
+    if (begin >= end)
+    {
+        return;
+    }
+
+    if (pool == NULL)
+    {
+        pool = PM_ThreadPoolGetDefault();
+    }
+
+    PM_Size workerCount = pool != NULL ? pool->workerCount : 0;
+    PM_Size count = end - begin;
+
+    if (grain == 0)
+    {
+        grain = PM_Max(count / ((workerCount + 1) * PM_PARALLEL_FOR_CHUNKS_PER_THREAD), (PM_Size)1);
+    }
+
+    PM__ParallelForState state;
+    state.func = func;
+    state.data = data;
+    state.begin = begin;
+    state.end = end;
+    state.grain = grain;
+    state.chunkCount = (PM_Int64)((count + grain - 1) / grain);
+    state.nextChunk = 0;
+
+    // The calling thread takes chunks as well, so one chunk or no workers means no tasks at all
+    PM_Size helperCount = PM_Min(workerCount, (PM_Size)state.chunkCount - 1);
+    if (helperCount == 0)
+    {
+        func(begin, end, data);
+        return;
+    }
+
+    PM_TaskGroup group;
+    group.pool = pool;
+    group.pendingTasks = 0;
+
+    for (PM_Size i = 0; i < helperCount; i++)
+    {
+        PM_TaskGroupRun(&group, PM__ParallelForRunChunks, &state);
+    }
+
+    PM__ParallelForRunChunks(&state);
+
+    PM_TaskGroupWait(&group);
+}
+
+// -----------------------------------------------------------------------------------------------
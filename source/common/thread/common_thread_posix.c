@@ -2,7 +2,7 @@
 #include "libpicomedia/common/utils.h"
 
 #include <pthread.h>
-#include <signal.h>
+#include <unistd.h>
 
 
 struct PM_Thread
@@ -11,6 +11,8 @@ struct PM_Thread
     PM_ThreadID id;
     PM_ThreadFunc function;
     void* data;
+    volatile PM_Int32 isRunning;
+    PM_Bool isJoined;
 };
 
 struct PM_Mutex
@@ -18,6 +20,19 @@ struct PM_Mutex
     pthread_mutex_t handle;
 };
 
+struct PM_ConditionVariable
+{
+    pthread_cond_t handle;
+};
+
+// Unnamed POSIX semaphores are not available on macOS, so this is built on a mutex and a condition variable
+struct PM_Semaphore
+{
+    pthread_mutex_t mutex;
+    pthread_cond_t condition;
+    PM_UInt32 count;
+};
+
 // -----------------------------------------------------------------------------------------------
 
 static void*  PM__ThreadProc(void* args)
@@ -31,6 +46,8 @@ static void*  PM__ThreadProc(void* args)
         thread->function(thread, thread->data);
     }
 
+    PM_AtomicStoreInt32(&thread->isRunning, 0);
+
     return 0;
 }
 
@@ -49,8 +66,14 @@ PM_Thread* PICOMEDIA_API PM_ThreadCreate(PM_ThreadFunc func, void* data)
     thread->handle = 0;
     thread->function = func;
     thread->data = data;
+    thread->isRunning = 1;
+    thread->isJoined = PM_FALSE;
 
-    thread->handle = pthread_create(&thread->handle, NULL, PM__ThreadProc, thread);
+    if (pthread_create(&thread->handle, NULL, PM__ThreadProc, thread) != 0)
+    {
+        PM_Free(thread);
+        return NULL;
+    }
 
     return thread;
 }
@@ -61,7 +84,7 @@ void PICOMEDIA_API PM_ThreadDestroy(PM_Thread* thread)
 {
     PM_Assert(thread != NULL);
 
-    if (thread->handle != 0)
+    if (!thread->isJoined)
     {
         PM_ThreadJoin(thread);
     }
@@ -81,15 +104,22 @@ PM_ThreadID PICOMEDIA_API PM_ThreadGetID(PM_Thread* thread)
 
 PM_Bool PICOMEDIA_API PM_ThreadJoin(PM_Thread* thread)
 {
-    return pthread_join(thread->handle, NULL) == 0;
+    if (thread->isJoined)
+    {
+        return PM_TRUE;
+    }
+
+    thread->isJoined = pthread_join(thread->handle, NULL) == 0;
+
+    return thread->isJoined;
 }
 
 // -----------------------------------------------------------------------------------------------
 
 PM_Bool PICOMEDIA_API PM_ThreadIsRunning(PM_Thread* thread)
 {
-    // NOTE: The thread here is joinable
-    return pthread_kill(thread->handle, 0) == 0;    
+    // Cleared by the thread itself once its function returns
+    return PM_AtomicLoadInt32(&thread->isRunning) != 0;
 }
 
 // -----------------------------------------------------------------------------------------------
@@ -101,6 +131,14 @@ PM_ThreadID PICOMEDIA_API PM_ThreadGetCurrrentID()
 
 // -----------------------------------------------------------------------------------------------
 
+PM_Size PICOMEDIA_API PM_ThreadGetProcessorCount()
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (PM_Size)count : 1;
+}
+
+// -----------------------------------------------------------------------------------------------
+
 void PICOMEDIA_API PM_ThreadLog(PM_Thread* thread, const PM_Char* format, ...)
 {
     (void)thread; (void)format; // Unused
@@ -152,3 +190,150 @@ PM_Bool PICOMEDIA_API PM_MutexUnlock(PM_Mutex* mutex)
 }
 
 // -----------------------------------------------------------------------------------------------
+
+PM_ConditionVariable* PICOMEDIA_API PM_ConditionVariableCreate()
+{
+    PM_ConditionVariable* conditionVariable = PM_Malloc(sizeof(PM_ConditionVariable));
+    if (conditionVariable == NULL)
+    {
+        return NULL;
+    }
+
+    pthread_cond_init(&conditionVariable->handle, NULL);
+
+    return conditionVariable;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+void PICOMEDIA_API PM_ConditionVariableDestroy(PM_ConditionVariable* conditionVariable)
+{
+    PM_Assert(conditionVariable != NULL);
+
+    pthread_cond_destroy(&conditionVariable->handle);
+
+    PM_Free(conditionVariable);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PICOMEDIA_API PM_ConditionVariableWait(PM_ConditionVariable* conditionVariable, PM_Mutex* mutex)
+{
+    PM_Assert(conditionVariable != NULL);
+    PM_Assert(mutex != NULL);
+
+    return pthread_cond_wait(&conditionVariable->handle, &mutex->handle) == 0;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+void PICOMEDIA_API PM_ConditionVariableSignal(PM_ConditionVariable* conditionVariable)
+{
+    PM_Assert(conditionVariable != NULL);
+
+    pthread_cond_signal(&conditionVariable->handle);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+void PICOMEDIA_API PM_ConditionVariableBroadcast(PM_ConditionVariable* conditionVariable)
+{
+    PM_Assert(conditionVariable != NULL);
+
+    pthread_cond_broadcast(&conditionVariable->handle);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Semaphore* PICOMEDIA_API PM_SemaphoreCreate(PM_UInt32 initialCount)
+{
+    PM_Semaphore* semaphore = PM_Malloc(sizeof(PM_Semaphore));
+    if (semaphore == NULL)
+    {
+        return NULL;
+    }
+
+    pthread_mutex_init(&semaphore->mutex, NULL);
+    pthread_cond_init(&semaphore->condition, NULL);
+    semaphore->count = initialCount;
+
+    return semaphore;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+void PICOMEDIA_API PM_SemaphoreDestroy(PM_Semaphore* semaphore)
+{
+    PM_Assert(semaphore != NULL);
+
+    pthread_cond_destroy(&semaphore->condition);
+    pthread_mutex_destroy(&semaphore->mutex);
+
+    PM_Free(semaphore);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PICOMEDIA_API PM_SemaphoreWait(PM_Semaphore* semaphore)
+{
+    PM_Assert(semaphore != NULL);
+
+    if (pthread_mutex_lock(&semaphore->mutex) != 0)
+    {
+        return PM_FALSE;
+    }
+
+    while (semaphore->count == 0)
+    {
+        pthread_cond_wait(&semaphore->condition, &semaphore->mutex);
+    }
+    semaphore->count--;
+
+    pthread_mutex_unlock(&semaphore->mutex);
+
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PICOMEDIA_API PM_SemaphoreTryWait(PM_Semaphore* semaphore)
+{
+    PM_Assert(semaphore != NULL);
+
+    if (pthread_mutex_lock(&semaphore->mutex) != 0)
+    {
+        return PM_FALSE;
+    }
+
+    PM_Bool acquired = semaphore->count > 0;
+    if (acquired)
+    {
+        semaphore->count--;
+    }
+
+    pthread_mutex_unlock(&semaphore->mutex);
+
+    return acquired;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+void PICOMEDIA_API PM_SemaphorePost(PM_Semaphore* semaphore, PM_UInt32 count)
+{
+    PM_Assert(semaphore != NULL);
+
+    pthread_mutex_lock(&semaphore->mutex);
+    semaphore->count += count;
+    pthread_mutex_unlock(&semaphore->mutex);
+
+    if (count == 1)
+    {
+        pthread_cond_signal(&semaphore->condition);
+    }
+    else if (count > 1)
+    {
+        pthread_cond_broadcast(&semaphore->condition);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
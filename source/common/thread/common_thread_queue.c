@@ -0,0 +1,182 @@
+#include "libpicomedia/common/thread.h"
+
+// Keeps the producer and consumer positions on separate cache lines
+#define PM_MPMC_QUEUE_CACHE_LINE_SIZE 64
+
+// Bounded queue by Dmitry Vyukov : https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+// Slot i is free for the producer at position p when its sequence is p, and filled for the consumer at position p when its sequence is p + 1
+struct PM_MPMCQueue
+{
+    PM_UInt8* slots;
+    PM_Size slotSize;
+    PM_Size elementSize;
+    PM_Size mask;
+    PM_UInt8 padding0[PM_MPMC_QUEUE_CACHE_LINE_SIZE];
+    volatile PM_Int64 enqueuePosition;
+    PM_UInt8 padding1[PM_MPMC_QUEUE_CACHE_LINE_SIZE - sizeof(PM_Int64)];
+    volatile PM_Int64 dequeuePosition;
+    PM_UInt8 padding2[PM_MPMC_QUEUE_CACHE_LINE_SIZE - sizeof(PM_Int64)];
+};
+
+// -----------------------------------------------------------------------------------------------
+
+static volatile PM_Int64* PM__MPMCQueueGetSequence(const PM_MPMCQueue* queue, PM_Int64 position)
+{
+    return (volatile PM_Int64*)(queue->slots + ((PM_Size)position & queue->mask) * queue->slotSize);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_MPMCQueue* PICOMEDIA_API PM_MPMCQueueCreate(PM_Size capacity, PM_Size elementSize)
+{
+    PM_Assert(elementSize > 0);
+
+    // The capacity is rounded up to a power of two, which has to fit in a PM_Size
+    if (capacity > ((PM_Size)1 << (sizeof(PM_Size) * 8 - 1)) || elementSize > SIZE_MAX / 2)
+    {
+        return NULL;
+    }
+
+    PM_Size roundedCapacity = 2;
+    while (roundedCapacity < capacity)
+    {
+        roundedCapacity *= 2;
+    }
+
+    // Each slot is the sequence number followed by the element, padded to keep the sequence numbers aligned
+    PM_Size slotSize = sizeof(PM_Int64) + ((elementSize + sizeof(PM_Int64) - 1) & ~(sizeof(PM_Int64) - 1));
+    if (roundedCapacity > SIZE_MAX / slotSize)
+    {
+        return NULL;
+    }
+
+    PM_MPMCQueue* queue = PM_New(PM_MPMCQueue);
+    if (queue == NULL)
+    {
+        return NULL;
+    }
+
+    queue->elementSize = elementSize;
+    queue->slotSize = slotSize;
+    queue->mask = roundedCapacity - 1;
+    queue->enqueuePosition = 0;
+    queue->dequeuePosition = 0;
+    queue->slots = (PM_UInt8*)PM_Malloc(queue->slotSize * roundedCapacity);
+    if (queue->slots == NULL)
+    {
+        PM_Free(queue);
+        return NULL;
+    }
+
+    for (PM_Size i = 0; i < roundedCapacity; i++)
+    {
+        PM_AtomicStoreInt64(PM__MPMCQueueGetSequence(queue, (PM_Int64)i), (PM_Int64)i);
+    }
+
+    return queue;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+void PICOMEDIA_API PM_MPMCQueueDestroy(PM_MPMCQueue* queue)
+{
+    PM_Assert(queue != NULL);
+
+    PM_Free(queue->slots);
+    PM_Free(queue);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PICOMEDIA_API PM_MPMCQueuePush(PM_MPMCQueue* queue, const void* element)
+{
+    PM_Assert(queue != NULL);
+    PM_Assert(element != NULL);
+
+    PM_Int64 position = PM_AtomicLoadInt64(&queue->enqueuePosition);
+    volatile PM_Int64* sequence = NULL;
+
+    for (;;)
+    {
+        sequence = PM__MPMCQueueGetSequence(queue, position);
+        PM_Int64 difference = PM_AtomicLoadInt64(sequence) - position;
+
+        if (difference == 0)
+        {
+            if (PM_AtomicCompareExchangeInt64(&queue->enqueuePosition, position, position + 1))
+            {
+                break;
+            }
+            position = PM_AtomicLoadInt64(&queue->enqueuePosition);
+        }
+        else if (difference < 0)
+        {
+            // The slot still holds the element from one lap ago
+            return PM_FALSE;
+        }
+        else
+        {
+            // Another producer claimed the slot first
+            position = PM_AtomicLoadInt64(&queue->enqueuePosition);
+        }
+    }
+
+    PM_Memcpy((PM_UInt8*)sequence + sizeof(PM_Int64), element, queue->elementSize);
+    PM_AtomicStoreInt64(sequence, position + 1);
+
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PICOMEDIA_API PM_MPMCQueuePop(PM_MPMCQueue* queue, void* element)
+{
+    PM_Assert(queue != NULL);
+    PM_Assert(element != NULL);
+
+    PM_Int64 position = PM_AtomicLoadInt64(&queue->dequeuePosition);
+    volatile PM_Int64* sequence = NULL;
+
+    for (;;)
+    {
+        sequence = PM__MPMCQueueGetSequence(queue, position);
+        PM_Int64 difference = PM_AtomicLoadInt64(sequence) - (position + 1);
+
+        if (difference == 0)
+        {
+            if (PM_AtomicCompareExchangeInt64(&queue->dequeuePosition, position, position + 1))
+            {
+                break;
+            }
+            position = PM_AtomicLoadInt64(&queue->dequeuePosition);
+        }
+        else if (difference < 0)
+        {
+            // The slot has not been filled yet
+            return PM_FALSE;
+        }
+        else
+        {
+            // Another consumer claimed the slot first
+            position = PM_AtomicLoadInt64(&queue->dequeuePosition);
+        }
+    }
+
+    PM_Memcpy(element, (const PM_UInt8*)sequence + sizeof(PM_Int64), queue->elementSize);
+
+    // Frees the slot for the producer one lap ahead
+    PM_AtomicStoreInt64(sequence, position + (PM_Int64)queue->mask + 1);
+
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Size PICOMEDIA_API PM_MPMCQueueGetCapacity(const PM_MPMCQueue* queue)
+{
+    PM_Assert(queue != NULL);
+
+    return queue->mask + 1;
+}
+
+// -----------------------------------------------------------------------------------------------
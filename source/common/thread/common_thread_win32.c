@@ -12,7 +12,19 @@ struct PM_Thread
     void* data;
 };
 
+// Slim reader/writer locks are used in exclusive mode only, unlike kernel mutexes they can be
+// waited on with condition variables and do not enter the kernel when uncontended
 struct PM_Mutex
+{
+    SRWLOCK handle;
+};
+
+struct PM_ConditionVariable
+{
+    CONDITION_VARIABLE handle;
+};
+
+struct PM_Semaphore
 {
     HANDLE handle;
 };
@@ -107,6 +119,15 @@ PM_ThreadID PICOMEDIA_API PM_ThreadGetCurrrentID()
 
 // -----------------------------------------------------------------------------------------------
 
+PM_Size PICOMEDIA_API PM_ThreadGetProcessorCount()
+{
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo(&systemInfo);
+    return systemInfo.dwNumberOfProcessors > 0 ? (PM_Size)systemInfo.dwNumberOfProcessors : 1;
+}
+
+// -----------------------------------------------------------------------------------------------
+
 void PICOMEDIA_API PM_ThreadLog(PM_Thread* thread, const PM_Char* format, ...)
 {
     (void)thread; (void)format; // Unused
@@ -123,7 +144,7 @@ PM_Mutex* PICOMEDIA_API PM_MutexCreate()
         return NULL;
     }
 
-    mutex->handle = CreateMutex(NULL, FALSE, NULL);
+    InitializeSRWLock(&mutex->handle);
 
     return mutex;
 }
@@ -134,8 +155,6 @@ void PICOMEDIA_API PM_MutexDestroy(PM_Mutex* mutex)
 {
     PM_Assert(mutex != NULL);
 
-    CloseHandle(mutex->handle);
-    
     PM_Free(mutex);
 }
 
@@ -145,7 +164,9 @@ PM_Bool PICOMEDIA_API PM_MutexLock(PM_Mutex* mutex)
 {
     PM_Assert(mutex != NULL);
 
-    return WaitForSingleObject(mutex->handle, INFINITE) == WAIT_OBJECT_0;
+    AcquireSRWLockExclusive(&mutex->handle);
+
+    return PM_TRUE;
 }
 
 // -----------------------------------------------------------------------------------------------
@@ -154,7 +175,123 @@ PM_Bool PICOMEDIA_API PM_MutexUnlock(PM_Mutex* mutex)
 {
     PM_Assert(mutex != NULL);
 
-    return ReleaseMutex(mutex->handle);
+    ReleaseSRWLockExclusive(&mutex->handle);
+
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_ConditionVariable* PICOMEDIA_API PM_ConditionVariableCreate()
+{
+    PM_ConditionVariable* conditionVariable = PM_Malloc(sizeof(PM_ConditionVariable));
+    if (conditionVariable == NULL)
+    {
+        return NULL;
+    }
+
+    InitializeConditionVariable(&conditionVariable->handle);
+
+    return conditionVariable;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+void PICOMEDIA_API PM_ConditionVariableDestroy(PM_ConditionVariable* conditionVariable)
+{
+    PM_Assert(conditionVariable != NULL);
+
+    // Windows condition variables do not need to be deleted
+    PM_Free(conditionVariable);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PICOMEDIA_API PM_ConditionVariableWait(PM_ConditionVariable* conditionVariable, PM_Mutex* mutex)
+{
+    PM_Assert(conditionVariable != NULL);
+    PM_Assert(mutex != NULL);
+
+    return SleepConditionVariableSRW(&conditionVariable->handle, &mutex->handle, INFINITE, 0) != 0;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+void PICOMEDIA_API PM_ConditionVariableSignal(PM_ConditionVariable* conditionVariable)
+{
+    PM_Assert(conditionVariable != NULL);
+
+    WakeConditionVariable(&conditionVariable->handle);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+void PICOMEDIA_API PM_ConditionVariableBroadcast(PM_ConditionVariable* conditionVariable)
+{
+    PM_Assert(conditionVariable != NULL);
+
+    WakeAllConditionVariable(&conditionVariable->handle);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Semaphore* PICOMEDIA_API PM_SemaphoreCreate(PM_UInt32 initialCount)
+{
+    PM_Semaphore* semaphore = PM_Malloc(sizeof(PM_Semaphore));
+    if (semaphore == NULL)
+    {
+        return NULL;
+    }
+
+    semaphore->handle = CreateSemaphore(NULL, (LONG)initialCount, LONG_MAX, NULL);
+    if (semaphore->handle == NULL)
+    {
+        PM_Free(semaphore);
+        return NULL;
+    }
+
+    return semaphore;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+void PICOMEDIA_API PM_SemaphoreDestroy(PM_Semaphore* semaphore)
+{
+    PM_Assert(semaphore != NULL);
+
+    CloseHandle(semaphore->handle);
+
+    PM_Free(semaphore);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PICOMEDIA_API PM_SemaphoreWait(PM_Semaphore* semaphore)
+{
+    PM_Assert(semaphore != NULL);
+
+    return WaitForSingleObject(semaphore->handle, INFINITE) == WAIT_OBJECT_0;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PICOMEDIA_API PM_SemaphoreTryWait(PM_Semaphore* semaphore)
+{
+    PM_Assert(semaphore != NULL);
+
+    return WaitForSingleObject(semaphore->handle, 0) == WAIT_OBJECT_0;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+void PICOMEDIA_API PM_SemaphorePost(PM_Semaphore* semaphore, PM_UInt32 count)
+{
+    PM_Assert(semaphore != NULL);
+
+    if (count > 0)
+    {
+        ReleaseSemaphore(semaphore->handle, (LONG)count, NULL);
+    }
 }
 
 // -----------------------------------------------------------------------------------------------
@@ -50,6 +50,10 @@ void PM_ImageBMPInfoHeaderInit(PM_BMPInfoHeader* infoHeader)
     infoHeader->yPixelsPerMeter = 0;
     infoHeader->colorsUsed = 0;
     infoHeader->colorsImportant = 0;
+    infoHeader->redMask = 0;
+    infoHeader->greenMask = 0;
+    infoHeader->blueMask = 0;
+    infoHeader->alphaMask = 0;
 }
 
 // -----------------------------------------------------------------------------------------------
@@ -72,6 +76,10 @@ void PM_ImageBMPInfoHeaderPrint(const PM_BMPInfoHeader* infoHeader)
         "    yPixelsPerMeter: %d\n"
         "    colorsUsed: %d\n"
         "    colorsImportant: %d\n"
+        "    redMask: 0x%08X\n"
+        "    greenMask: 0x%08X\n"
+        "    blueMask: 0x%08X\n"
+        "    alphaMask: 0x%08X\n"
         "}",
         infoHeader->headerSize,
         infoHeader->width,
@@ -83,7 +91,11 @@ void PM_ImageBMPInfoHeaderPrint(const PM_BMPInfoHeader* infoHeader)
         infoHeader->xPixelsPerMeter,
         infoHeader->yPixelsPerMeter,
         infoHeader->colorsUsed,
-        infoHeader->colorsImportant
+        infoHeader->colorsImportant,
+        infoHeader->redMask,
+        infoHeader->greenMask,
+        infoHeader->blueMask,
+        infoHeader->alphaMask
     );
 }
 
@@ -133,6 +145,7 @@ void PM_ImageBMPContextInit(PM_BMPContext* context)
     context->colorTableCapacity = 0;
     context->imageData = NULL;
     context->imageDataCapacity = 0;
+    context->isImageDataBorrowed = PM_FALSE;
 }
 
 // -----------------------------------------------------------------------------------------------
@@ -146,7 +159,7 @@ void PM_ImageBMPContextDestroy(PM_BMPContext* context)
         PM_Free(context->colorTable);
     }
 
-    if (context->imageData != NULL)
+    if (context->imageData != NULL && !context->isImageDataBorrowed)
     {
         PM_Free(context->imageData);
     }
@@ -6,7 +6,7 @@ PM_Bool PM_ImageBMPDetect(PM_Stream* stream)
 {
     PM_Assert(stream != NULL);
 
-    static PM_Byte magicNumber[2] = {0};
+    PM_Byte magicNumber[2] = {0};
     PM_StreamRead(stream, magicNumber, 2);
 
     return ( (magicNumber[0] == 'B') && (magicNumber[1] == 'M'));
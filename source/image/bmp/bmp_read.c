@@ -1,4 +1,54 @@
 #include "libpicomedia/image/bmp/bmp.h"
+#include "libpicomedia/common/cpu.h"
+
+#if defined(PM_ARCH_X86)
+#include <immintrin.h>
+#elif defined(PM_ARCH_ARM64)
+#include <arm_neon.h>
+#endif
+
+// Pixels unpacked at once from 1, 2 and 4-bit rows
+#define PM_BMP_INDEX_CHUNK_SIZE 256
+
+// Smallest number of pixels decoded by a single task
+#define PM_BMP_MIN_BAND_PIXELS (1 << 15)
+
+typedef struct PM__ImageBMPRowDecoder PM__ImageBMPRowDecoder;
+
+// Decodes a row of the BMP image data into a row of the RGB or RGBA image
+typedef void (*PM__ImageBMPDecodeRowFunction)(const PM__ImageBMPRowDecoder* decoder, const PM_Byte* src, PM_Byte* dst);
+
+// Looks up palette indices into RGB pixels
+typedef void (*PM__ImageBMPLookupPaletteFunction)(const PM__ImageBMPRowDecoder* decoder, const PM_UInt8* indices, PM_Byte* dst, PM_Size count);
+
+// Everything the rows of an image are decoded with, set up once so the row loops never test the pixel format
+struct PM__ImageBMPRowDecoder
+{
+    PM__ImageBMPDecodeRowFunction decodeRow;
+    PM_Size width;
+    PM_Size dstChannels;
+    PM_Size bitsPerPixel;
+    PM_UInt8 palette[256 * 4]; // RGBX, the colors missing from the color table are black
+    PM_UInt8 palettePlanes[3][256];
+    PM_UInt8 offsets[4]; // Byte of each channel in a pixel, for byte aligned color masks
+    PM_UInt8 shuffle[16]; // Byte shuffle decoding 4 pixels, 0x80 clears a byte
+    PM_UInt32 shifts[4]; // Bitfields, reduced to at most 8 bits
+    PM_UInt32 masks[4];
+    PM_UInt32 bits[4];
+    PM_UInt8 scales[4][256]; // Bitfield values expanded to 8 bits
+};
+
+// Rows are at known offsets of the image data, so bands of rows are decoded independently
+typedef struct PM__ImageBMPDecodeBand
+{
+    const PM__ImageBMPRowDecoder* decoder;
+    const PM_Byte* src;
+    PM_Size srcScanLineSize;
+    PM_Byte* dst;
+    PM_Size dstScanLineSize;
+    PM_Size height;
+    PM_Bool isTopDown;
+} PM__ImageBMPDecodeBand;
 
 // -----------------------------------------------------------------------------------------------
 
@@ -62,6 +112,13 @@ PM_Bool PM_ImageBMPReadInfoHeader(PM_Stream* stream, PM_BMPInfoHeader* infoHeade
         return PM_FALSE;
     }
 
+    // OS/2 core headers store 16-bit dimensions, every later header starts like BITMAPINFOHEADER
+    if (infoHeader->headerSize < 40)
+    {
+        PM_LogWarning("PM_ImageBMPReadInfoHeader: Unsupported header size(%d).", infoHeader->headerSize);
+        return PM_FALSE;
+    }
+
     if(PM_StreamRead(stream, (PM_Byte*)&infoHeader->width, sizeof(PM_Int32)) != sizeof(PM_Int32))
     {
         PM_LogWarning("PM_ImageBMPReadInfoHeader: Failed to read image width.");
@@ -74,6 +131,13 @@ PM_Bool PM_ImageBMPReadInfoHeader(PM_Stream* stream, PM_BMPInfoHeader* infoHeade
         return PM_FALSE;
     }
 
+    // A negative height marks an image stored top-down
+    if (infoHeader->width <= 0 || infoHeader->height == 0 || infoHeader->height == (PM_Int32)0x80000000)
+    {
+        PM_LogWarning("PM_ImageBMPReadInfoHeader: Invalid image dimensions(%d x %d).", infoHeader->width, infoHeader->height);
+        return PM_FALSE;
+    }
+
     if(PM_StreamRead(stream, (PM_Byte*)&infoHeader->planes, sizeof(PM_UInt16)) != sizeof(PM_UInt16))
     {
         PM_LogWarning("PM_ImageBMPReadInfoHeader: Failed to read planes.");
@@ -92,7 +156,7 @@ PM_Bool PM_ImageBMPReadInfoHeader(PM_Stream* stream, PM_BMPInfoHeader* infoHeade
         return PM_FALSE;
     }
 
-    if (infoHeader->bitsPerPixel != 1 && infoHeader->bitsPerPixel != 4 && infoHeader->bitsPerPixel != 8 && infoHeader->bitsPerPixel != 16 && infoHeader->bitsPerPixel != 24)
+    if (infoHeader->bitsPerPixel != 1 && infoHeader->bitsPerPixel != 4 && infoHeader->bitsPerPixel != 8 && infoHeader->bitsPerPixel != 16 && infoHeader->bitsPerPixel != 24 && infoHeader->bitsPerPixel != 32)
     {
         PM_LogWarning("PM_ImageBMPReadInfoHeader: Invalid bits per pixel value(%d).", infoHeader->bitsPerPixel);
         return PM_FALSE;
@@ -104,7 +168,8 @@ PM_Bool PM_ImageBMPReadInfoHeader(PM_Stream* stream, PM_BMPInfoHeader* infoHeade
         return PM_FALSE;
     }
 
-    if (infoHeader->compression != 0 && infoHeader->compression != 1 && infoHeader->compression != 2)
+    if (infoHeader->compression != PICOMEDIA_BMP_COMPRESSION_RGB && infoHeader->compression != PICOMEDIA_BMP_COMPRESSION_RLE8 &&
+        infoHeader->compression != PICOMEDIA_BMP_COMPRESSION_RLE4 && infoHeader->compression != PICOMEDIA_BMP_COMPRESSION_BITFIELDS)
     {
         PM_LogWarning("PM_ImageBMPReadInfoHeader: Invalid compression value(%d).", infoHeader->compression);
         return PM_FALSE;
@@ -116,9 +181,9 @@ PM_Bool PM_ImageBMPReadInfoHeader(PM_Stream* stream, PM_BMPInfoHeader* infoHeade
         return PM_FALSE;
     }
 
-    if (infoHeader->imageSize == 0 && infoHeader->compression != 0)
+    if (infoHeader->imageSize == 0 && (infoHeader->compression == PICOMEDIA_BMP_COMPRESSION_RLE8 || infoHeader->compression == PICOMEDIA_BMP_COMPRESSION_RLE4))
     {
-        PM_LogWarning("PM_ImageBMPReadInfoHeader: Invalid image size value(0 when compress is non zero).");
+        PM_LogWarning("PM_ImageBMPReadInfoHeader: Invalid image size value(0 when compressed with RLE).");
         return PM_FALSE;
     }
 
@@ -146,6 +211,24 @@ PM_Bool PM_ImageBMPReadInfoHeader(PM_Stream* stream, PM_BMPInfoHeader* infoHeade
         return PM_FALSE;
     }
 
+    // The color masks follow a BITMAPINFOHEADER, and are part of the V2 and later headers, which add the alpha mask from V3
+    if (infoHeader->compression == PICOMEDIA_BMP_COMPRESSION_BITFIELDS)
+    {
+        if(PM_StreamRead(stream, (PM_Byte*)&infoHeader->redMask, sizeof(PM_UInt32)) != sizeof(PM_UInt32) ||
+           PM_StreamRead(stream, (PM_Byte*)&infoHeader->greenMask, sizeof(PM_UInt32)) != sizeof(PM_UInt32) ||
+           PM_StreamRead(stream, (PM_Byte*)&infoHeader->blueMask, sizeof(PM_UInt32)) != sizeof(PM_UInt32))
+        {
+            PM_LogWarning("PM_ImageBMPReadInfoHeader: Failed to read color masks.");
+            return PM_FALSE;
+        }
+
+        if (infoHeader->headerSize >= 56 && PM_StreamRead(stream, (PM_Byte*)&infoHeader->alphaMask, sizeof(PM_UInt32)) != sizeof(PM_UInt32))
+        {
+            PM_LogWarning("PM_ImageBMPReadInfoHeader: Failed to read alpha mask.");
+            return PM_FALSE;
+        }
+    }
+
     return PM_TRUE;
 }
 
@@ -161,7 +244,7 @@ PM_Bool PM_ImageBMPReadColorTable(PM_Stream* stream, const PM_BMPInfoHeader* inf
     *colorTable = NULL;
     *colorTableCapacity = 0;
 
-    if(infoHeader->colorsUsed == 0 || infoHeader->bitsPerPixel > 8)
+    if(infoHeader->bitsPerPixel > 8)
     {
         return PM_TRUE;
     }
@@ -172,7 +255,20 @@ PM_Bool PM_ImageBMPReadColorTable(PM_Stream* stream, const PM_BMPInfoHeader* inf
         return PM_FALSE;
     }
 
-    *colorTableCapacity = infoHeader->colorsUsed;
+    // The table follows the info header, whatever its version, and holds every color when colorsUsed is 0
+    PM_Size colorTableOffset = 0x000E + infoHeader->headerSize;
+    PM_Size sourceSize = PM_StreamGetSourceSize(stream);
+    PM_Size colorCount = infoHeader->colorsUsed != 0 ? infoHeader->colorsUsed : (PM_Size)1 << infoHeader->bitsPerPixel;
+
+    // Some writers declare more colors than they store, only the ones in the stream are read
+    colorCount = PM_Min(colorCount, colorTableOffset < sourceSize ? (sourceSize - colorTableOffset) / sizeof(PM_BMPColorTableItem) : 0);
+    if(colorCount == 0)
+    {
+        PM_LogWarning("PM_ImageBMPReadColorTable: Missing color table.");
+        return PM_FALSE;
+    }
+
+    *colorTableCapacity = colorCount;
 
     *colorTable = (PM_BMPColorTableItem*)PM_Malloc(sizeof(PM_BMPColorTableItem) * (*colorTableCapacity));
 
@@ -182,7 +278,7 @@ PM_Bool PM_ImageBMPReadColorTable(PM_Stream* stream, const PM_BMPInfoHeader* inf
         return PM_FALSE;
     }
 
-    PM_StreamSetCursorPosition(stream, 0x0036); // 0x0036 is the offset of the color table in the file
+    PM_StreamSetCursorPosition(stream, colorTableOffset);
 
     if(PM_StreamRead(stream, (PM_Byte*)(*colorTable), sizeof(PM_BMPColorTableItem) * (*colorTableCapacity)) != sizeof(PM_BMPColorTableItem) * (*colorTableCapacity))
     {
@@ -205,19 +301,19 @@ PM_Bool PM_ImageBMPReadImageData(PM_Stream* stream, const PM_BMPHeader* header,
     *imageData = NULL;
     *imageDataSize = 0;
 
-    *imageDataSize = header->fileSize - header->dataOffset;
-
-    *imageData = (PM_Byte*)PM_Malloc(*imageDataSize);
+    PM_Size sourceSize = PM_StreamGetSourceSize(stream);
+    PM_Size dataSize = header->dataOffset < sourceSize ? sourceSize - header->dataOffset : 0;
 
-    if (*imageData == NULL)
+    // Some writers leave the file size empty, the data then extends up to the end of the stream
+    if (header->fileSize > header->dataOffset && header->fileSize - header->dataOffset < dataSize)
     {
-        PM_LogWarning("PM_ImageBMPReadImageData: Failed to allocate image data.");
-        return PM_FALSE;
+        dataSize = header->fileSize - header->dataOffset;
     }
 
     PM_StreamSetCursorPosition(stream, header->dataOffset);
 
-    if(PM_StreamRead(stream, *imageData, *imageDataSize) != *imageDataSize)
+    *imageDataSize = PM_StreamAcquire(stream, dataSize, imageData);
+    if(dataSize == 0 || *imageDataSize != dataSize)
     {
         PM_LogWarning("PM_ImageBMPReadImageData: Failed to read image data.");
         return PM_FALSE;
@@ -228,6 +324,593 @@ PM_Bool PM_ImageBMPReadImageData(PM_Stream* stream, const PM_BMPHeader* header,
 
 // -----------------------------------------------------------------------------------------------
 
+static PM_Size PM__ImageBMPGetNumChannels(const PM_BMPInfoHeader* infoHeader)
+{
+    return infoHeader->compression == PICOMEDIA_BMP_COMPRESSION_BITFIELDS && infoHeader->alphaMask != 0 ? 4 : 3;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Size PM__ImageBMPGetHeight(const PM_BMPInfoHeader* infoHeader)
+{
+    return infoHeader->height < 0 ? (PM_Size)(-(PM_Int64)infoHeader->height) : (PM_Size)infoHeader->height;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageBMPLookupPalette(const PM__ImageBMPRowDecoder* decoder, const PM_UInt8* indices, PM_Byte* dst, PM_Size count)
+{
+    for ( PM_Size x = 0; x < count; ++x )
+    {
+        const PM_UInt8* color = decoder->palette + indices[x] * 4;
+
+        dst[x * 3 + 0] = color[0];
+        dst[x * 3 + 1] = color[1];
+        dst[x * 3 + 2] = color[2];
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageBMPShufflePixels(const PM__ImageBMPRowDecoder* decoder, const PM_Byte* src, PM_Byte* dst)
+{
+    PM_Size srcBytes = decoder->bitsPerPixel / 8;
+
+    for ( PM_Size x = 0; x < decoder->width; ++x )
+    {
+        for ( PM_Size c = 0; c < decoder->dstChannels; ++c )
+        {
+            dst[x * decoder->dstChannels + c] = src[x * srcBytes + decoder->offsets[c]];
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageBMPDecodeBitfields16Span(const PM__ImageBMPRowDecoder* decoder, const PM_Byte* src, PM_Byte* dst, PM_Size begin)
+{
+    for ( PM_Size x = begin; x < decoder->width; ++x )
+    {
+        PM_UInt32 pixel = (PM_UInt32)(PM_UInt8)src[x * 2] | ((PM_UInt32)(PM_UInt8)src[x * 2 + 1] << 8);
+
+        for ( PM_Size c = 0; c < decoder->dstChannels; ++c )
+        {
+            dst[x * decoder->dstChannels + c] = decoder->scales[c][(pixel >> decoder->shifts[c]) & decoder->masks[c]];
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageBMPDecodeBitfields16(const PM__ImageBMPRowDecoder* decoder, const PM_Byte* src, PM_Byte* dst)
+{
+    PM__ImageBMPDecodeBitfields16Span(decoder, src, dst, 0);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageBMPDecodeBitfields32(const PM__ImageBMPRowDecoder* decoder, const PM_Byte* src, PM_Byte* dst)
+{
+    for ( PM_Size x = 0; x < decoder->width; ++x )
+    {
+        const PM_UInt8* bytes = (const PM_UInt8*)src + x * 4;
+        PM_UInt32 pixel = (PM_UInt32)bytes[0] | ((PM_UInt32)bytes[1] << 8) | ((PM_UInt32)bytes[2] << 16) | ((PM_UInt32)bytes[3] << 24);
+
+        for ( PM_Size c = 0; c < decoder->dstChannels; ++c )
+        {
+            dst[x * decoder->dstChannels + c] = decoder->scales[c][(pixel >> decoder->shifts[c]) & decoder->masks[c]];
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+#if defined(PM_ARCH_X86)
+
+// Each gather gives 8 RGBX colors, every 128-bit lane is stored as 12 RGB bytes and 4 bytes overwritten by the next store
+static PM_TARGET("avx2") void PM__ImageBMPLookupPaletteAVX2(const PM__ImageBMPRowDecoder* decoder, const PM_UInt8* indices, PM_Byte* dst, PM_Size count)
+{
+    const __m256i compact = _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1, 0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    PM_Size x = 0;
+
+    for ( ; x + 10 <= count; x += 8 )
+    {
+        __m256i lanes = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(indices + x)));
+        __m256i colors = _mm256_shuffle_epi8(_mm256_i32gather_epi32((const int*)decoder->palette, lanes, 4), compact);
+
+        _mm_storeu_si128((__m128i*)(dst + x * 3), _mm256_castsi256_si128(colors));
+        _mm_storeu_si128((__m128i*)(dst + x * 3 + 12), _mm256_extracti128_si256(colors, 1));
+    }
+
+    PM__ImageBMPLookupPalette(decoder, indices + x, dst + x * 3, count - x);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// 4 pixels per shuffle, 3-byte outputs are stored as 16 bytes the next store partly overwrites
+static PM_TARGET("ssse3") void PM__ImageBMPShufflePixelsSSSE3(const PM__ImageBMPRowDecoder* decoder, const PM_Byte* src, PM_Byte* dst)
+{
+    const __m128i shuffle = _mm_loadu_si128((const __m128i*)decoder->shuffle);
+    PM_Size srcBytes = decoder->bitsPerPixel / 8;
+    PM_Size dstChannels = decoder->dstChannels;
+    PM_Size x = 0;
+
+    for ( ; x + 6 <= decoder->width; x += 4 )
+    {
+        __m128i pixels = _mm_loadu_si128((const __m128i*)(src + x * srcBytes));
+        _mm_storeu_si128((__m128i*)(dst + x * dstChannels), _mm_shuffle_epi8(pixels, shuffle));
+    }
+
+    for ( ; x < decoder->width; ++x )
+    {
+        for ( PM_Size c = 0; c < dstChannels; ++c )
+        {
+            dst[x * dstChannels + c] = src[x * srcBytes + decoder->offsets[c]];
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Every field of 4 to 8 bits is expanded to 8 bits by repeating its high bits below it, as the scales do
+static PM_TARGET("ssse3") __m128i PM__ImageBMPExpandFieldSSSE3(const PM__ImageBMPRowDecoder* decoder, __m128i pixels, PM_Size channel)
+{
+    __m128i field = _mm_and_si128(_mm_srl_epi16(pixels, _mm_cvtsi32_si128((int)decoder->shifts[channel])), _mm_set1_epi16((short)decoder->masks[channel]));
+
+    return _mm_or_si128(_mm_sll_epi16(field, _mm_cvtsi32_si128((int)(8 - decoder->bits[channel]))), _mm_srl_epi16(field, _mm_cvtsi32_si128((int)(2 * decoder->bits[channel] - 8))));
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("ssse3") void PM__ImageBMPDecodeBitfields16SSSE3(const PM__ImageBMPRowDecoder* decoder, const PM_Byte* src, PM_Byte* dst)
+{
+    const __m128i compact = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    PM_Size dstChannels = decoder->dstChannels;
+    PM_Size x = 0;
+
+    for ( ; x + 10 <= decoder->width; x += 8 )
+    {
+        __m128i pixels = _mm_loadu_si128((const __m128i*)(src + x * 2));
+        __m128i red = PM__ImageBMPExpandFieldSSSE3(decoder, pixels, 0);
+        __m128i green = PM__ImageBMPExpandFieldSSSE3(decoder, pixels, 1);
+        __m128i blue = PM__ImageBMPExpandFieldSSSE3(decoder, pixels, 2);
+        __m128i alpha = dstChannels == 4 ? PM__ImageBMPExpandFieldSSSE3(decoder, pixels, 3) : _mm_set1_epi16(0xFF);
+
+        __m128i redGreen = _mm_or_si128(red, _mm_slli_epi16(green, 8));
+        __m128i blueAlpha = _mm_or_si128(blue, _mm_slli_epi16(alpha, 8));
+        __m128i low = _mm_unpacklo_epi16(redGreen, blueAlpha);
+        __m128i high = _mm_unpackhi_epi16(redGreen, blueAlpha);
+
+        if ( dstChannels == 4 )
+        {
+            _mm_storeu_si128((__m128i*)(dst + x * 4), low);
+            _mm_storeu_si128((__m128i*)(dst + x * 4 + 16), high);
+        }
+        else
+        {
+            _mm_storeu_si128((__m128i*)(dst + x * 3), _mm_shuffle_epi8(low, compact));
+            _mm_storeu_si128((__m128i*)(dst + x * 3 + 12), _mm_shuffle_epi8(high, compact));
+        }
+    }
+
+    PM__ImageBMPDecodeBitfields16Span(decoder, src, dst, x);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+#elif defined(PM_ARCH_ARM64)
+
+// 256 entry lookup with four 64 byte tables, indices out of a table keep the previous result
+static uint8x16_t PM__ImageBMPLookupPlaneNEON(const PM_UInt8* plane, uint8x16_t indices)
+{
+    const uint8x16_t step = vdupq_n_u8(64);
+    uint8x16x4_t table0 = { { vld1q_u8(plane), vld1q_u8(plane + 16), vld1q_u8(plane + 32), vld1q_u8(plane + 48) } };
+    uint8x16x4_t table1 = { { vld1q_u8(plane + 64), vld1q_u8(plane + 80), vld1q_u8(plane + 96), vld1q_u8(plane + 112) } };
+    uint8x16x4_t table2 = { { vld1q_u8(plane + 128), vld1q_u8(plane + 144), vld1q_u8(plane + 160), vld1q_u8(plane + 176) } };
+    uint8x16x4_t table3 = { { vld1q_u8(plane + 192), vld1q_u8(plane + 208), vld1q_u8(plane + 224), vld1q_u8(plane + 240) } };
+
+    uint8x16_t result = vqtbl4q_u8(table0, indices);
+    indices = vsubq_u8(indices, step);
+    result = vqtbx4q_u8(result, table1, indices);
+    indices = vsubq_u8(indices, step);
+    result = vqtbx4q_u8(result, table2, indices);
+    indices = vsubq_u8(indices, step);
+    return vqtbx4q_u8(result, table3, indices);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageBMPLookupPaletteNEON(const PM__ImageBMPRowDecoder* decoder, const PM_UInt8* indices, PM_Byte* dst, PM_Size count)
+{
+    PM_Size x = 0;
+
+    for ( ; x + 16 <= count; x += 16 )
+    {
+        uint8x16_t lanes = vld1q_u8(indices + x);
+        uint8x16x3_t colors;
+
+        colors.val[0] = PM__ImageBMPLookupPlaneNEON(decoder->palettePlanes[0], lanes);
+        colors.val[1] = PM__ImageBMPLookupPlaneNEON(decoder->palettePlanes[1], lanes);
+        colors.val[2] = PM__ImageBMPLookupPlaneNEON(decoder->palettePlanes[2], lanes);
+        vst3q_u8((uint8_t*)dst + x * 3, colors);
+    }
+
+    PM__ImageBMPLookupPalette(decoder, indices + x, dst + x * 3, count - x);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageBMPShufflePixelsNEON(const PM__ImageBMPRowDecoder* decoder, const PM_Byte* src, PM_Byte* dst)
+{
+    const uint8x16_t shuffle = vld1q_u8(decoder->shuffle);
+    PM_Size srcBytes = decoder->bitsPerPixel / 8;
+    PM_Size dstChannels = decoder->dstChannels;
+    PM_Size x = 0;
+
+    for ( ; x + 6 <= decoder->width; x += 4 )
+    {
+        vst1q_u8((uint8_t*)dst + x * dstChannels, vqtbl1q_u8(vld1q_u8((const uint8_t*)src + x * srcBytes), shuffle));
+    }
+
+    for ( ; x < decoder->width; ++x )
+    {
+        for ( PM_Size c = 0; c < dstChannels; ++c )
+        {
+            dst[x * dstChannels + c] = src[x * srcBytes + decoder->offsets[c]];
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static uint8x8_t PM__ImageBMPExpandFieldNEON(const PM__ImageBMPRowDecoder* decoder, uint16x8_t pixels, PM_Size channel)
+{
+    uint16x8_t field = vandq_u16(vshlq_u16(pixels, vdupq_n_s16(-(PM_Int16)decoder->shifts[channel])), vdupq_n_u16((PM_UInt16)decoder->masks[channel]));
+    uint16x8_t high = vshlq_u16(field, vdupq_n_s16((PM_Int16)(8 - decoder->bits[channel])));
+    uint16x8_t low = vshlq_u16(field, vdupq_n_s16((PM_Int16)(8 - 2 * decoder->bits[channel])));
+
+    return vmovn_u16(vorrq_u16(high, low));
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageBMPDecodeBitfields16NEON(const PM__ImageBMPRowDecoder* decoder, const PM_Byte* src, PM_Byte* dst)
+{
+    PM_Size x = 0;
+
+    for ( ; x + 8 <= decoder->width; x += 8 )
+    {
+        uint16x8_t pixels = vreinterpretq_u16_u8(vld1q_u8((const uint8_t*)src + x * 2));
+
+        if ( decoder->dstChannels == 4 )
+        {
+            uint8x8x4_t colors = { { PM__ImageBMPExpandFieldNEON(decoder, pixels, 0), PM__ImageBMPExpandFieldNEON(decoder, pixels, 1),
+                PM__ImageBMPExpandFieldNEON(decoder, pixels, 2), PM__ImageBMPExpandFieldNEON(decoder, pixels, 3) } };
+            vst4_u8((uint8_t*)dst + x * 4, colors);
+        }
+        else
+        {
+            uint8x8x3_t colors = { { PM__ImageBMPExpandFieldNEON(decoder, pixels, 0), PM__ImageBMPExpandFieldNEON(decoder, pixels, 1),
+                PM__ImageBMPExpandFieldNEON(decoder, pixels, 2) } };
+            vst3_u8((uint8_t*)dst + x * 3, colors);
+        }
+    }
+
+    PM__ImageBMPDecodeBitfields16Span(decoder, src, dst, x);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+#endif
+
+static PM__ImageBMPLookupPaletteFunction PM_BMP_LOOKUP_PALETTE = PM__ImageBMPLookupPalette;
+static PM__ImageBMPDecodeRowFunction PM_BMP_SHUFFLE_PIXELS = PM__ImageBMPShufflePixels;
+static PM__ImageBMPDecodeRowFunction PM_BMP_DECODE_BITFIELDS16 = PM__ImageBMPDecodeBitfields16;
+static volatile PM_Bool PM_BMP_ROW_FUNCTIONS_SELECTED = PM_FALSE;
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageBMPSelectRowFunctions()
+{
+#if defined(PM_ARCH_X86)
+    if ( PM_CPUHasFeature(PICOMEDIA_CPU_FEATURE_SSSE3) )
+    {
+        PM_BMP_SHUFFLE_PIXELS = PM__ImageBMPShufflePixelsSSSE3;
+        PM_BMP_DECODE_BITFIELDS16 = PM__ImageBMPDecodeBitfields16SSSE3;
+    }
+
+    if ( PM_CPUHasFeature(PICOMEDIA_CPU_FEATURE_AVX2) )
+    {
+        PM_BMP_LOOKUP_PALETTE = PM__ImageBMPLookupPaletteAVX2;
+    }
+#elif defined(PM_ARCH_ARM64)
+    PM_BMP_LOOKUP_PALETTE = PM__ImageBMPLookupPaletteNEON;
+    PM_BMP_SHUFFLE_PIXELS = PM__ImageBMPShufflePixelsNEON;
+    PM_BMP_DECODE_BITFIELDS16 = PM__ImageBMPDecodeBitfields16NEON;
+#endif
+
+    PM_BMP_ROW_FUNCTIONS_SELECTED = PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageBMPDecodeIndexed8(const PM__ImageBMPRowDecoder* decoder, const PM_Byte* src, PM_Byte* dst)
+{
+    PM_BMP_LOOKUP_PALETTE(decoder, (const PM_UInt8*)src, dst, decoder->width);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// 1, 2 and 4-bit indices are unpacked in chunks, high bits first, then looked up like 8-bit ones
+static void PM__ImageBMPDecodeIndexedPacked(const PM__ImageBMPRowDecoder* decoder, const PM_Byte* src, PM_Byte* dst)
+{
+    PM_UInt8 indices[PM_BMP_INDEX_CHUNK_SIZE];
+    PM_Size bits = decoder->bitsPerPixel;
+    PM_UInt32 mask = (1u << bits) - 1;
+
+    for ( PM_Size x = 0; x < decoder->width; x += PM_BMP_INDEX_CHUNK_SIZE )
+    {
+        PM_Size count = PM_Min(decoder->width - x, (PM_Size)PM_BMP_INDEX_CHUNK_SIZE);
+
+        for ( PM_Size i = 0; i < count; ++i )
+        {
+            PM_Size bitPosition = (x + i) * bits;
+            indices[i] = (PM_UInt8)(((PM_UInt8)src[bitPosition >> 3] >> (8 - bits - (bitPosition & 7))) & mask);
+        }
+
+        PM_BMP_LOOKUP_PALETTE(decoder, indices, dst + x * 3, count);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Splits a color mask into its shift and width, the bits below the 8 highest ones of wider fields are dropped
+static PM_Bool PM__ImageBMPInitBitfield(PM__ImageBMPRowDecoder* decoder, PM_Size channel, PM_UInt32 mask)
+{
+    if ( mask == 0 )
+    {
+        decoder->shifts[channel] = 0;
+        decoder->masks[channel] = 0;
+        decoder->bits[channel] = 0;
+        PM_Memset(decoder->scales[channel], 0, sizeof(decoder->scales[channel]));
+        return PM_TRUE;
+    }
+
+    PM_UInt32 shift = PM_CountTrailingZeros32(mask);
+    PM_UInt32 field = mask >> shift;
+    if ( (field & (field + 1)) != 0 )
+    {
+        PM_LogWarning("PM_ImageBMPDecode: Color mask(0x%08X) is not contiguous.", mask);
+        return PM_FALSE;
+    }
+
+    PM_UInt32 bits = 32 - PM_CountLeadingZeros32(field);
+    if ( bits > 8 )
+    {
+        shift += bits - 8;
+        bits = 8;
+    }
+
+    decoder->shifts[channel] = shift;
+    decoder->masks[channel] = (1u << bits) - 1;
+    decoder->bits[channel] = bits;
+
+    for ( PM_UInt32 value = 0; value < 256; ++value )
+    {
+        PM_UInt32 expanded = 0;
+        PM_UInt32 reduced = value & decoder->masks[channel];
+
+        for ( PM_Int32 position = 8 - (PM_Int32)bits; position > -(PM_Int32)bits; position -= (PM_Int32)bits )
+        {
+            expanded |= position >= 0 ? reduced << position : reduced >> -position;
+        }
+
+        decoder->scales[channel][value] = (PM_UInt8)expanded;
+    }
+
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Bool PM__ImageBMPInitRowDecoder(PM__ImageBMPRowDecoder* decoder, const PM_BMPContext* context)
+{
+    const PM_BMPInfoHeader* infoHeader = &context->infoHeader;
+    PM_UInt32 compression = infoHeader->compression;
+
+    if ( ! PM_BMP_ROW_FUNCTIONS_SELECTED )
+    {
+        PM__ImageBMPSelectRowFunctions();
+    }
+
+    decoder->width = (PM_Size)infoHeader->width;
+    decoder->dstChannels = PM__ImageBMPGetNumChannels(infoHeader);
+    decoder->bitsPerPixel = infoHeader->bitsPerPixel;
+
+    if ( (compression == PICOMEDIA_BMP_COMPRESSION_RLE8 && infoHeader->bitsPerPixel != 8) ||
+         (compression == PICOMEDIA_BMP_COMPRESSION_RLE4 && infoHeader->bitsPerPixel != 4) ||
+         (compression == PICOMEDIA_BMP_COMPRESSION_BITFIELDS && infoHeader->bitsPerPixel != 16 && infoHeader->bitsPerPixel != 32) )
+    {
+        PM_LogWarning("PM_ImageBMPDecode: Unsupported compression type(%d) for bitsPerPixel(%d).", compression, infoHeader->bitsPerPixel);
+        return PM_FALSE;
+    }
+
+    if ( infoHeader->height < 0 && (compression == PICOMEDIA_BMP_COMPRESSION_RLE8 || compression == PICOMEDIA_BMP_COMPRESSION_RLE4) )
+    {
+        PM_LogWarning("PM_ImageBMPDecode: Top-down images cannot be compressed.");
+        return PM_FALSE;
+    }
+
+    if ( infoHeader->bitsPerPixel <= 8 )
+    {
+        PM_Memset(decoder->palette, 0, sizeof(decoder->palette));
+
+        for ( PM_Size i = 0; i < context->colorTableCapacity && i < 256; ++i )
+        {
+            decoder->palette[i * 4 + 0] = context->colorTable[i].red;
+            decoder->palette[i * 4 + 1] = context->colorTable[i].green;
+            decoder->palette[i * 4 + 2] = context->colorTable[i].blue;
+        }
+
+        for ( PM_Size i = 0; i < 256; ++i )
+        {
+            decoder->palettePlanes[0][i] = decoder->palette[i * 4 + 0];
+            decoder->palettePlanes[1][i] = decoder->palette[i * 4 + 1];
+            decoder->palettePlanes[2][i] = decoder->palette[i * 4 + 2];
+        }
+
+        decoder->decodeRow = infoHeader->bitsPerPixel == 8 ? PM__ImageBMPDecodeIndexed8 : PM__ImageBMPDecodeIndexedPacked;
+        return PM_TRUE;
+    }
+
+    // Without color masks, 16-bit pixels are 5-5-5 and 24 and 32-bit ones are BGR with an unused byte for 32 bits
+    PM_UInt32 masks[4] = { infoHeader->redMask, infoHeader->greenMask, infoHeader->blueMask, infoHeader->alphaMask };
+    if ( compression != PICOMEDIA_BMP_COMPRESSION_BITFIELDS )
+    {
+        masks[0] = infoHeader->bitsPerPixel == 16 ? 0x7C00 : 0x00FF0000;
+        masks[1] = infoHeader->bitsPerPixel == 16 ? 0x03E0 : 0x0000FF00;
+        masks[2] = infoHeader->bitsPerPixel == 16 ? 0x001F : 0x000000FF;
+        masks[3] = 0;
+    }
+
+    PM_Bool isByteAligned = infoHeader->bitsPerPixel != 16;
+    PM_Bool isExpandable = PM_TRUE;
+
+    for ( PM_Size c = 0; c < decoder->dstChannels; ++c )
+    {
+        if ( ! PM__ImageBMPInitBitfield(decoder, c, masks[c]) )
+        {
+            return PM_FALSE;
+        }
+
+        isByteAligned &= masks[c] == (0xFFu << decoder->shifts[c]) && (decoder->shifts[c] & 7) == 0;
+        isExpandable &= decoder->bits[c] >= 4;
+        decoder->offsets[c] = (PM_UInt8)(decoder->shifts[c] / 8);
+    }
+
+    if ( isByteAligned )
+    {
+        // 24 and 32-bit pixels with 8-bit channels only move bytes around
+        PM_Size srcBytes = infoHeader->bitsPerPixel / 8;
+        PM_Memset(decoder->shuffle, 0x80, sizeof(decoder->shuffle));
+
+        for ( PM_Size pixel = 0; pixel < 4; ++pixel )
+        {
+            for ( PM_Size c = 0; c < decoder->dstChannels; ++c )
+            {
+                decoder->shuffle[pixel * decoder->dstChannels + c] = (PM_UInt8)(pixel * srcBytes + decoder->offsets[c]);
+            }
+        }
+
+        decoder->decodeRow = PM_BMP_SHUFFLE_PIXELS;
+    }
+    else if ( infoHeader->bitsPerPixel == 16 )
+    {
+        decoder->decodeRow = isExpandable ? PM_BMP_DECODE_BITFIELDS16 : PM__ImageBMPDecodeBitfields16;
+    }
+    else if ( infoHeader->bitsPerPixel == 32 )
+    {
+        decoder->decodeRow = PM__ImageBMPDecodeBitfields32;
+    }
+    else
+    {
+        PM_LogWarning("PM_ImageBMPDecode: Unsupported bits per pixel value(%d).", infoHeader->bitsPerPixel);
+        return PM_FALSE;
+    }
+
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageBMPDecodeBandWorker(PM_Size begin, PM_Size end, void* data)
+{
+    const PM__ImageBMPDecodeBand* band = (const PM__ImageBMPDecodeBand*)data;
+
+    for ( PM_Size y = begin; y < end; ++y )
+    {
+        const PM_Byte* src = band->src + (band->isTopDown ? y : band->height - 1 - y) * band->srcScanLineSize;
+        band->decoder->decodeRow(band->decoder, src, band->dst + y * band->dstScanLineSize);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Expands RLE8 or RLE4 data into top-down rows of indices, the pixels skipped by the data keep index 0
+static PM_Bool PM__ImageBMPExpandRLE(const PM_Byte* data, PM_Size dataSize, PM_Size width, PM_Size height, PM_Size bitsPerPixel, PM_UInt8* indices)
+{
+    PM_Size position = 0;
+    PM_Size x = 0;
+    PM_Size y = 0;
+
+    while ( position + 2 <= dataSize && y < height )
+    {
+        PM_UInt8 count = (PM_UInt8)data[position];
+        PM_UInt8 value = (PM_UInt8)data[position + 1];
+        PM_UInt8* row = indices + (height - 1 - y) * width;
+        position += 2;
+
+        if ( count > 0 )
+        {
+            // Encoded run, with RLE4 it alternates the two indices of the byte
+            PM_UInt8 pair[2] = { bitsPerPixel == 8 ? value : (PM_UInt8)(value >> 4), bitsPerPixel == 8 ? value : (PM_UInt8)(value & 0x0F) };
+
+            for ( PM_Size i = 0; i < count && x + i < width; ++i )
+            {
+                row[x + i] = pair[i & 1];
+            }
+
+            x += count;
+            continue;
+        }
+
+        if ( value == 0 )
+        {
+            x = 0;
+            y++;
+        }
+        else if ( value == 1 )
+        {
+            return PM_TRUE;
+        }
+        else if ( value == 2 )
+        {
+            if ( position + 2 > dataSize )
+            {
+                break;
+            }
+
+            x += (PM_UInt8)data[position];
+            y += (PM_UInt8)data[position + 1];
+            position += 2;
+        }
+        else
+        {
+            // Absolute mode, the indices are stored as they are and padded to 16 bits
+            PM_Size size = bitsPerPixel == 8 ? value : ((PM_Size)value + 1) / 2;
+            if ( position + size > dataSize )
+            {
+                PM_LogWarning("PM_ImageBMPDecode: RLE data is truncated.");
+                return PM_FALSE;
+            }
+
+            const PM_UInt8* literal = (const PM_UInt8*)data + position;
+            for ( PM_Size i = 0; i < value && x + i < width; ++i )
+            {
+                row[x + i] = bitsPerPixel == 8 ? literal[i] : (PM_UInt8)((i & 1) ? literal[i / 2] & 0x0F : literal[i / 2] >> 4);
+            }
+
+            x += value;
+            position += (size + 1) & ~(PM_Size)1;
+        }
+    }
+
+    // Files without an end of bitmap code are accepted, the missing pixels stay at index 0
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
 PM_Bool PM_ImageBMPDecode(const PM_BMPContext* context, PM_Image* image)
 {
     PM_Assert(context != NULL);
@@ -236,68 +919,111 @@ PM_Bool PM_ImageBMPDecode(const PM_BMPContext* context, PM_Image* image)
     PM_Assert(image->dataSize > 0);
     PM_Assert(context->imageData != NULL);
 
-    if (context->infoHeader.bitsPerPixel <= 8)
+    PM__ImageBMPRowDecoder decoder;
+    if ( ! PM__ImageBMPInitRowDecoder(&decoder, context) )
     {
-        PM_Size divBits = 8 / context->infoHeader.bitsPerPixel;
-        PM_Size scanLineSize = (context->infoHeader.width) / divBits + ((context->infoHeader.width % divBits) ? 1 : 0);
-        scanLineSize = (scanLineSize + 3) & ~3; // align to 4 bytes
-        
-        for (PM_Int64 y = image->height - 1 ; y >= 0 ; y --)
-        {
-            PM_Byte* scanLine = context->imageData + y * scanLineSize;
-            PM_Byte* dst = image->data + (image->height - 1 - y) * image->width * image->bitsPerChannel / 8 * 3;
+        return PM_FALSE;
+    }
 
-            for (PM_Int64 x = 0 ; x < image->width ; x ++)
-            {
-                PM_Byte bit = 0;
+    PM_Size width = decoder.width;
+    PM_Size height = PM__ImageBMPGetHeight(&context->infoHeader);
 
-                switch(context->infoHeader.bitsPerPixel)
-                {
-                    case 1: bit = (scanLine[x / 8] >> (7 - (x % 8))) & 0x01; break;
-                    case 2: bit = (scanLine[x / 4] >> ((3 - (x % 4)) * 2)) & 0x03; break;
-                    case 4: bit = (scanLine[x / 2] >> ((1 - (x % 2)) * 4)) & 0x0F; break;
-                    case 8: bit = scanLine[x]; break;
-                }
+    PM__ImageBMPDecodeBand band;
+    band.decoder = &decoder;
+    band.dst = image->data;
+    band.dstScanLineSize = width * decoder.dstChannels;
+    band.height = height;
 
-                dst[0] = context->colorTable[(PM_UInt16)bit].red;
-                dst[1] = context->colorTable[(PM_UInt16)bit].green;
-                dst[2] = context->colorTable[(PM_UInt16)bit].blue;
+    PM_Size grain = PM_Max(PM_BMP_MIN_BAND_PIXELS / width, (PM_Size)1);
 
-                dst += image->bitsPerChannel / 8 * 3;
-            }
-        }
+    if ( image->width != width || image->height != height || image->numChannels != decoder.dstChannels || image->dataType != PICOIMEDIA_IMAGE_DATA_TYPE_UINT8 || image->dataSize < band.dstScanLineSize * height )
+    {
+        PM_LogWarning("PM_ImageBMPDecode: Image does not match the BMP image.");
+        return PM_FALSE;
     }
-    else if (context->infoHeader.bitsPerPixel == 24)
+
+    if ( context->infoHeader.compression == PICOMEDIA_BMP_COMPRESSION_RLE8 || context->infoHeader.compression == PICOMEDIA_BMP_COMPRESSION_RLE4 )
     {
-        if (context->infoHeader.compression != 0)
+        PM_UInt8* indices = (PM_UInt8*)PM_Malloc(width * height);
+        if ( indices == NULL )
         {
-            PM_LogWarning("PM_ImageBMPDecode: Unsupported compression type(%d) for bitsPerPixel(%d).", context->infoHeader.compression, context->infoHeader.bitsPerPixel);
+            PM_LogWarning("PM_ImageBMPDecode: Failed to allocate indices.");
             return PM_FALSE;
         }
+        PM_Memset(indices, 0, width * height);
 
-        PM_Size scanLineSize = (context->infoHeader.width * 3 + 3) & ~3; // align to 4 bytes
-        for (PM_Int64 y = image->height - 1 ; y >= 0 ; y --)
+        // Only the expansion is serial, the indices are then looked up by bands like 8-bit rows
+        PM_Bool expandResult = PM__ImageBMPExpandRLE(context->imageData, context->imageDataCapacity, width, height, decoder.bitsPerPixel, indices);
+
+        if ( expandResult )
         {
-            PM_Byte* scanLine = context->imageData + y * scanLineSize;
-            PM_Byte* dst = image->data + (image->height - 1 - y) * image->width * image->bitsPerChannel / 8 * 3;
+            decoder.decodeRow = PM__ImageBMPDecodeIndexed8;
+            band.src = (const PM_Byte*)indices;
+            band.srcScanLineSize = width;
+            band.isTopDown = PM_TRUE;
+            PM_ParallelFor(NULL, 0, height, grain, PM__ImageBMPDecodeBandWorker, &band);
+        }
 
-            for (PM_Int64 x = 0 ; x < image->width ; x ++)
-            {
-                dst[0] = scanLine[x * 3 + 2];
-                dst[1] = scanLine[x * 3 + 1];
-                dst[2] = scanLine[x * 3 + 0];
+        PM_Free(indices);
+        return expandResult;
+    }
 
-                dst += image->bitsPerChannel / 8 * 3;
-            }
-        }
+    PM_Size scanLineSize = ((width * decoder.bitsPerPixel + 31) / 32) * 4; // align to 4 bytes
+
+    if ( scanLineSize * height > context->imageDataCapacity )
+    {
+        PM_LogWarning("PM_ImageBMPDecode: Image data is too small for the image size.");
+        return PM_FALSE;
     }
-    // NOTE: 16 bits per pixel is not supported yet
-    else
+
+    // Rows are stored bottom-up, unless the height is negative
+    band.src = context->imageData;
+    band.srcScanLineSize = scanLineSize;
+    band.isTopDown = context->infoHeader.height < 0;
+    PM_ParallelFor(NULL, 0, height, grain, PM__ImageBMPDecodeBandWorker, &band);
+
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageBMPGetInfo(const PM_BMPInfoHeader* infoHeader, PM_ImageInfo* info)
+{
+    info->fileFormat = PICOMEDIA_IMAGE_FILE_FORMAT_BMP;
+    info->width = infoHeader->width;
+    info->height = (PM_UInt32)PM__ImageBMPGetHeight(infoHeader);
+    info->numChannels = (PM_UInt8)PM__ImageBMPGetNumChannels(infoHeader);
+    info->channelFormat = info->numChannels == 4 ? PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGBA : PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGB;
+    info->dataType = PICOIMEDIA_IMAGE_DATA_TYPE_UINT8;
+    info->bitsPerChannel = 8;
+    info->decodedSize = PM_ImageInfoGetDataSize(info);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PM_ImageBMPProbe(PM_Stream* stream, PM_ImageInfo* info)
+{
+    PM_Assert(stream != NULL);
+    PM_Assert(info != NULL);
+
+    PM_ImageInfoInit(info);
+
+    PM_BMPHeader header;
+    if ( ! PM_ImageBMPReadHeader(stream, &header) )
+    {
+        PM_LogWarning("PM_ImageBMPProbe: Failed to read header.");
+        return PM_FALSE;
+    }
+
+    PM_BMPInfoHeader infoHeader;
+    if ( ! PM_ImageBMPReadInfoHeader(stream, &infoHeader) )
     {
-        PM_LogWarning("PM_ImageBMPDecode: Unsupported bits per pixel value(%d).", context->infoHeader.bitsPerPixel);
+        PM_LogWarning("PM_ImageBMPProbe: Failed to read info header.");
         return PM_FALSE;
     }
 
+    PM__ImageBMPGetInfo(&infoHeader, info);
+
     return PM_TRUE;
 }
 
@@ -322,6 +1048,16 @@ PM_Bool PM_ImageBMPRead(PM_Stream* stream, PM_Image* image)
         return PM_FALSE;
     }
 
+    // The dimensions come from the file, so the decoded size is checked before anything is allocated for it
+    PM_ImageInfo info;
+    PM__ImageBMPGetInfo(&bmpContext.infoHeader, &info);
+    if ( info.decodedSize == SIZE_MAX || info.decodedSize > PICOMEDIA_IMAGE_MAX_DATA_SIZE )
+    {
+        PM_LogWarning("PM_ImageBMPRead: Image is too large(%u x %u).", info.width, info.height);
+        PM_ImageBMPContextDestroy(&bmpContext);
+        return PM_FALSE;
+    }
+
     if ( ! PM_ImageBMPReadColorTable(stream, &bmpContext.infoHeader, &bmpContext.colorTable, &bmpContext.colorTableCapacity) )
     {
         PM_LogWarning("PM_ImageBMPRead: Failed to read color table.");
@@ -329,24 +1065,20 @@ PM_Bool PM_ImageBMPRead(PM_Stream* stream, PM_Image* image)
         return PM_FALSE;
     }
 
+    // The image data is decoded straight from the stream, so it has to be released on every path from here
+    bmpContext.isImageDataBorrowed = PM_TRUE;
     if ( ! PM_ImageBMPReadImageData(stream, &bmpContext.header, &bmpContext.imageData, &bmpContext.imageDataCapacity) )
     {
         PM_LogWarning("PM_ImageBMPRead: Failed to read image data.");
+        PM_StreamRelease(stream);
         PM_ImageBMPContextDestroy(&bmpContext);
         return PM_FALSE;
     }
 
-    image->bitsPerChannel = 8;
-    image->numChannels = 3;
-    image->width = bmpContext.infoHeader.width;
-    image->height = bmpContext.infoHeader.height;
-    image->dataType = PICOIMEDIA_IMAGE_DATA_TYPE_UINT8;
-    image->channelFormat = PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGB;
-
-
-    if (! PM_ImageAllocate(image, image->width, image->height, image->channelFormat, image->dataType, image->numChannels))
+    if (! PM_ImageAllocate(image, info.width, info.height, info.channelFormat, info.dataType, info.numChannels))
     {
         PM_LogWarning("PM_ImageBMPRead: Failed to allocate image.");
+        PM_StreamRelease(stream);
         PM_ImageBMPContextDestroy(&bmpContext);
         return PM_FALSE;
     }
@@ -354,12 +1086,13 @@ PM_Bool PM_ImageBMPRead(PM_Stream* stream, PM_Image* image)
     if ( ! PM_ImageBMPDecode(&bmpContext, image) )
     {
         PM_LogWarning("PM_ImageBMPRead: Failed to decode image.");
+        PM_StreamRelease(stream);
         PM_ImageBMPContextDestroy(&bmpContext);
         PM_ImageDestroy(image);
         return PM_FALSE;
     }
 
-
+    PM_StreamRelease(stream);
     PM_ImageBMPContextDestroy(&bmpContext);
 
     return PM_TRUE;
@@ -373,7 +1106,7 @@ PM_Bool PM_ImageBMPReadFromFile(const PM_Byte* filePath, PM_Image* image)
     PM_Assert(image != NULL);
     
     PM_Stream stream = {0};
-    if ( ! PM_StreamInitFromFile(&stream, filePath, PICOMEDIA_STREAM_FLAG_READ) ) 
+    if ( ! PM_StreamInitFromFileMapped(&stream, filePath) ) 
     {
         PM_LogWarning("Failed to initialize stream from file! \n");
         return PM_FALSE;
@@ -1,4 +1,56 @@
 #include "libpicomedia/image/bmp/bmp.h"
+#include "libpicomedia/common/cpu.h"
+
+#if defined(PM_ARCH_X86)
+    #include <immintrin.h>
+#elif defined(PM_ARCH_ARM64)
+    #include <arm_neon.h>
+#endif
+
+#define PM_BMP_FILE_HEADER_SIZE 14
+#define PM_BMP_INFO_HEADER_SIZE 40
+#define PM_BMP_V4_HEADER_SIZE 108
+
+// Palettes are built from a histogram of 5 bits per channel
+#define PM_BMP_HISTOGRAM_BITS 5
+#define PM_BMP_HISTOGRAM_SIZE (1 << (3 * PM_BMP_HISTOGRAM_BITS))
+
+// Open addressing table of the colors of images with few enough colors to be stored exactly
+#define PM_BMP_EXACT_TABLE_SIZE 1024
+#define PM_BMP_EXACT_TABLE_USED 0x01000000
+
+// Longest run, or literal, of one RLE code
+#define PM_BMP_RLE_MAX_RUN 255
+
+typedef struct PM__ImageBMPHistogramBin
+{
+    PM_UInt64 count;
+    PM_UInt64 sums[3];          // Sums of the red, green and blue values of the pixels in the bin
+} PM__ImageBMPHistogramBin;
+
+typedef struct PM__ImageBMPBox
+{
+    PM_UInt32 min[3];           // Inclusive bounds of the box in the histogram, red, green and blue
+    PM_UInt32 max[3];
+    PM_UInt64 count;
+} PM__ImageBMPBox;
+
+typedef struct PM__ImageBMPPalette
+{
+    PM_BMPColorTableItem colors[256];
+    PM_Size colorCount;
+    PM_Size maxColors;
+    PM_Bool isExact;                                    // Whether every color of the image is in the palette
+    PM_UInt32 exactColors[PM_BMP_EXACT_TABLE_SIZE];     // 0x00RRGGBB | PM_BMP_EXACT_TABLE_USED
+    PM_UInt8 exactIndices[PM_BMP_EXACT_TABLE_SIZE];
+    PM_UInt8 binIndices[PM_BMP_HISTOGRAM_SIZE];         // Nearest palette color of each histogram bin
+} PM__ImageBMPPalette;
+
+// Returns the first index from begin up to end that differs from the index period before it
+typedef PM_Size (*PM__ImageBMPFindMismatchFunction)(const PM_UInt8* indices, PM_Size begin, PM_Size end, PM_Size period);
+
+// Returns the first index from begin up to end where a run of period + 2 repeating indices starts, or end
+typedef PM_Size (*PM__ImageBMPFindRunFunction)(const PM_UInt8* indices, PM_Size begin, PM_Size end, PM_Size period);
 
 // -----------------------------------------------------------------------------------------------
 
@@ -146,46 +198,82 @@ PM_Bool PM_ImageBMPWriteColorTable(PM_Stream* stream, const PM_BMPColorTableItem
 
 // -----------------------------------------------------------------------------------------------
 
-PM_Bool PM_ImageBMPEncode(const PM_Image* image, PM_BMPContext* context)
+// Fills the headers for the given pixel format, the image data following the info header and color table
+static PM_Bool PM__ImageBMPInitHeaders(PM_BMPContext* context, const PM_Image* image, PM_UInt16 bitsPerPixel, PM_UInt32 compression, PM_UInt32 infoHeaderSize, PM_Size colorCount, PM_Size imageDataSize)
 {
-    PM_Assert(image != NULL);
-    PM_Assert(image->channelFormat == PICOMEDIA_IMAGE_CHANNEL_FORMAT_BGR); // BMP exporter only allows BGR format
-    PM_Assert(image->dataType == PICOIMEDIA_IMAGE_DATA_TYPE_UINT8); // BMP exporter only allows 8-bit per channel
-    PM_Assert(image->bitsPerChannel == 8); // BMP exporter only allows 8-bit per channel
-    PM_Assert(image->numChannels == 3); // BMP exporter only allows 3 channels (BGR)
-    PM_Assert(context != NULL);
+    PM_ImageBMPContextInit(context);
 
-    PM_ImageBMPContextInit(context); 
+    PM_Size dataOffset = PM_BMP_FILE_HEADER_SIZE + infoHeaderSize + colorCount * sizeof(PM_BMPColorTableItem);
 
-    PM_Size scanLineSize = image->width * image->bitsPerChannel / 8 * image->numChannels;
-    PM_Size scanLinePadding = (4 - (scanLineSize % 4)) % 4;
-    PM_Size scanLineSizeWithPadding = scanLineSize + scanLinePadding;
-    PM_Size imageDataSize = scanLineSizeWithPadding * image->height;
+    // The sizes in the headers are 32-bit
+    if ( imageDataSize > 0xFFFFFFFFu - dataOffset || image->width > 0x7FFFFFFF || image->height > 0x7FFFFFFF )
+    {
+        PM_LogWarning("Image is too large for the BMP format! \n");
+        return PM_FALSE;
+    }
 
     // prepare header
     ((PM_Byte*)&context->header.signature)[0] = 'B';
     ((PM_Byte*)&context->header.signature)[1] = 'M';
-    context->header.fileSize = 14 /*sizeof(PM_BMPHeader)*/ + 40 /*sizeof(PM_BMPInfoHeader)*/ + (PM_UInt32)imageDataSize;
+    context->header.fileSize = (PM_UInt32)(dataOffset + imageDataSize);
     context->header.reserved = 0;
-    context->header.dataOffset = 14 /*sizeof(PM_BMPHeader)*/ + 40 /*sizeof(PM_BMPInfoHeader)*/; // for our case, we won't have color table as we are using 24-bit color depth
+    context->header.dataOffset = (PM_UInt32)dataOffset;
 
     // prepare info header
-    context->infoHeader.headerSize = sizeof(PM_BMPInfoHeader);
+    context->infoHeader.headerSize = infoHeaderSize;
     context->infoHeader.width = image->width;
     context->infoHeader.height = image->height;
     context->infoHeader.planes = 1;
-    context->infoHeader.bitsPerPixel = 24; // for now we only support 24-bit color depth
-    context->infoHeader.compression = 0; // no compression
+    context->infoHeader.bitsPerPixel = bitsPerPixel;
+    context->infoHeader.compression = compression;
     context->infoHeader.imageSize = (PM_UInt32)imageDataSize;
     context->infoHeader.xPixelsPerMeter = 2835; // 72 DPI
     context->infoHeader.yPixelsPerMeter = 2835; // 72 DPI
-    context->infoHeader.colorsUsed = 0; // no color table
+    context->infoHeader.colorsUsed = (PM_UInt32)colorCount;
     context->infoHeader.colorsImportant = 0; // all colors are important
 
-    // prepare color table
+    // the color table is written separately, it is not owned by the context
     context->colorTable = NULL;
     context->colorTableCapacity = 0;
 
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PM_ImageBMPEncodeHeaders(const PM_Image* image, PM_BMPContext* context)
+{
+    PM_Assert(image != NULL);
+    PM_Assert(image->channelFormat == PICOMEDIA_IMAGE_CHANNEL_FORMAT_BGR); // BMP exporter only allows BGR format
+    PM_Assert(image->dataType == PICOIMEDIA_IMAGE_DATA_TYPE_UINT8); // BMP exporter only allows 8-bit per channel
+    PM_Assert(image->bitsPerChannel == 8); // BMP exporter only allows 8-bit per channel
+    PM_Assert(image->numChannels == 3); // BMP exporter only allows 3 channels (BGR)
+    PM_Assert(context != NULL);
+
+    PM_Size scanLineSize = (PM_Size)image->width * image->bitsPerChannel / 8 * image->numChannels;
+    PM_Size scanLinePadding = (4 - (scanLineSize % 4)) % 4;
+    PM_Size scanLineSizeWithPadding = scanLineSize + scanLinePadding;
+    PM_Size imageDataSize = scanLineSizeWithPadding * image->height;
+
+    return PM__ImageBMPInitHeaders(context, image, 24, PICOMEDIA_BMP_COMPRESSION_RGB, PM_BMP_INFO_HEADER_SIZE, 0, imageDataSize);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PM_ImageBMPEncode(const PM_Image* image, PM_BMPContext* context)
+{
+    PM_Assert(image != NULL);
+    PM_Assert(context != NULL);
+
+    if ( ! PM_ImageBMPEncodeHeaders(image, context) )
+    {
+        return PM_FALSE;
+    }
+
+    PM_Size scanLineSize = (PM_Size)image->width * image->bitsPerChannel / 8 * image->numChannels;
+    PM_Size scanLineSizeWithPadding = (scanLineSize + 3) & ~(PM_Size)3;
+    PM_Size imageDataSize = context->infoHeader.imageSize;
+
     // prepare data
     context->imageData = (PM_Byte*)PM_Malloc(imageDataSize);
     if ( context->imageData == NULL )
@@ -193,16 +281,16 @@ PM_Bool PM_ImageBMPEncode(const PM_Image* image, PM_BMPContext* context)
         PM_LogWarning("Failed to allocate memory for image data! \n");
         return PM_FALSE;
     }
-    PM_Memset(context->imageData, 0, imageDataSize);
     context->imageDataCapacity = imageDataSize;    
 
-    // copy image data
+    // copy image data, only the padding needs to be cleared
     for ( PM_Size y = 0; y < image->height; ++y )
     {
-        PM_Size srcOffset = (image->height - 1 - y) * image->width * image->numChannels;
+        PM_Size srcOffset = (image->height - 1 - y) * scanLineSize;
         PM_Size dstOffset = y * scanLineSizeWithPadding;
 
         PM_Memcpy(context->imageData + dstOffset, image->data + srcOffset, scanLineSize);
+        PM_Memset(context->imageData + dstOffset + scanLineSize, 0, scanLineSizeWithPadding - scanLineSize);
     }
 
 
@@ -211,10 +299,18 @@ PM_Bool PM_ImageBMPEncode(const PM_Image* image, PM_BMPContext* context)
 
 // -----------------------------------------------------------------------------------------------
 
-PM_Bool PICOMEDIA_API PM_ImageBMPWriteContext(PM_Stream* stream, const PM_BMPContext* context)
+// Writes everything up to the image data
+static PM_Bool PM__ImageBMPWriteHeaders(PM_Stream* stream, const PM_BMPContext* context)
 {
     PM_Bool writeResult = PM_TRUE;
 
+    // Memory streams cannot grow, they must at least hold everything before the image data
+    if ( stream->sourceType == PICOMEDIA_STREAM_SOURCE_TYPE_MEMORY && context->header.dataOffset > PM_StreamGetSourceSize(stream) )
+    {
+        PM_LogWarning("Stream is too small for BMP headers! \n");
+        return PM_FALSE;
+    }
+
     PM_StreamSetCursorPosition(stream, 0);
     PM_StreamSetRequireReverse(stream, PM_IsBigEndian());
 
@@ -236,6 +332,15 @@ PM_Bool PICOMEDIA_API PM_ImageBMPWriteContext(PM_Stream* stream, const PM_BMPCon
         writeResult = PM_FALSE;
     }
 
+    return writeResult;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PICOMEDIA_API PM_ImageBMPWriteContext(PM_Stream* stream, const PM_BMPContext* context)
+{
+    PM_Bool writeResult = PM__ImageBMPWriteHeaders(stream, context);
+
     if ( PM_StreamWrite(stream, context->imageData, context->imageDataCapacity) != context->imageDataCapacity )
     {
         PM_LogWarning("Failed to write image data! \n");
@@ -247,30 +352,842 @@ PM_Bool PICOMEDIA_API PM_ImageBMPWriteContext(PM_Stream* stream, const PM_BMPCon
 
 // -----------------------------------------------------------------------------------------------
 
-PM_Bool PM_ImageBMPWrite(const PM_Image* image, PM_Stream* stream)
+PM_Bool PM_ImageBMPWriteImageData(PM_Stream* stream, const PM_Image* image)
 {
     PM_Assert(stream != NULL);
     PM_Assert(image != NULL);
 
+    static const PM_Byte padding[4] = {0};
+
+    PM_Size scanLineSize = (PM_Size)image->width * image->bitsPerChannel / 8 * image->numChannels;
+    PM_Size scanLinePadding = (4 - (scanLineSize % 4)) % 4;
+
+    // The rows are stored bottom up, each one is written straight from the image followed by its padding,
+    // the stream coalesces the small writes
+    for ( PM_Size y = image->height; y > 0; --y )
+    {
+        const PM_Byte* scanLine = image->data + (y - 1) * scanLineSize;
+
+        if ( PM_StreamWrite(stream, scanLine, scanLineSize) != scanLineSize )
+        {
+            PM_LogWarning("Failed to write image data! \n");
+            return PM_FALSE;
+        }
+
+        if ( scanLinePadding > 0 && PM_StreamWrite(stream, padding, scanLinePadding) != scanLinePadding )
+        {
+            PM_LogWarning("Failed to write image data! \n");
+            return PM_FALSE;
+        }
+    }
+
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Memory streams cannot grow, writes past their end are refused instead of overflowing them
+static PM_Bool PM__ImageBMPStreamWrite(PM_Stream* stream, const PM_Byte* data, PM_Size size)
+{
+    if ( stream->sourceType == PICOMEDIA_STREAM_SOURCE_TYPE_MEMORY && PM_StreamGetCursorPosition(stream) + size > PM_StreamGetSourceSize(stream) )
+    {
+        return PM_FALSE;
+    }
+
+    return PM_StreamWrite(stream, data, size) == size;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Bool PM__ImageBMPCheckOkForWrite(const PM_Image* image)
+{
+    if ( image->dataType != PICOIMEDIA_IMAGE_DATA_TYPE_UINT8 || image->bitsPerChannel != 8 )
+    {
+        PM_LogWarning("BMP exporter only allows 8-bit per channel! \n");
+        return PM_FALSE;
+    }
+
+    switch ( image->channelFormat )
+    {
+    case PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGB:
+    case PICOMEDIA_IMAGE_CHANNEL_FORMAT_BGR:
+        return image->numChannels == 3;
+    case PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGBA:
+    case PICOMEDIA_IMAGE_CHANNEL_FORMAT_BGRA:
+        return image->numChannels == 4;
+    case PICOMEDIA_IMAGE_CHANNEL_FORMAT_GRAY:
+        return image->numChannels == 1;
+    case PICOMEDIA_IMAGE_CHANNEL_FORMAT_GRAYA:
+        return image->numChannels == 2;
+    default:
+        PM_LogWarning("Unsupported channel format for BMP export! \n");
+        return PM_FALSE;
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Bool PM__ImageBMPHasAlpha(const PM_Image* image)
+{
+    return image->channelFormat == PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGBA || image->channelFormat == PICOMEDIA_IMAGE_CHANNEL_FORMAT_BGRA || image->channelFormat == PICOMEDIA_IMAGE_CHANNEL_FORMAT_GRAYA;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Converts a row of the image to the BGR or BGRA layout of BMP files, opaque when the image has no alpha
+static void PM__ImageBMPConvertRow(const PM_Image* image, const PM_Byte* src, PM_Byte* dst, PM_Size dstChannels)
+{
+    PM_Size srcChannels = image->numChannels;
+    PM_Size red = 0, green = 1, blue = 2, alpha = 3;
+    PM_Bool hasAlpha = PM__ImageBMPHasAlpha(image);
+
+    switch ( image->channelFormat )
+    {
+    case PICOMEDIA_IMAGE_CHANNEL_FORMAT_BGR:
+    case PICOMEDIA_IMAGE_CHANNEL_FORMAT_BGRA:
+        red = 2;
+        blue = 0;
+        break;
+    case PICOMEDIA_IMAGE_CHANNEL_FORMAT_GRAY:
+    case PICOMEDIA_IMAGE_CHANNEL_FORMAT_GRAYA:
+        red = green = blue = 0;
+        alpha = 1;
+        break;
+    default:
+        break;
+    }
+
+    for ( PM_Size x = 0; x < image->width; ++x )
+    {
+        const PM_Byte* pixel = src + x * srcChannels;
+        PM_Byte* out = dst + x * dstChannels;
+
+        out[0] = pixel[blue];
+        out[1] = pixel[green];
+        out[2] = pixel[red];
+
+        if ( dstChannels == 4 )
+        {
+            out[3] = hasAlpha ? pixel[alpha] : (PM_Byte)0xFF;
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Writes 24-bit BGR or 32-bit BGRA pixels, the rows of images already in that layout are written as they are
+static PM_Bool PM__ImageBMPWriteTrueColor(const PM_Image* image, PM_Stream* stream, PM_Size channels)
+{
+    PM_Size scanLineSize = (PM_Size)image->width * channels;
+    PM_Size scanLineSizeWithPadding = (scanLineSize + 3) & ~(PM_Size)3;
+
+    // 32-bit pixels use a V4 header, so the alpha mask can be given along the color masks
     PM_BMPContext context = {0};
-    PM_ImageBMPContextInit(&context);
+    if ( ! PM__ImageBMPInitHeaders(&context, image, (PM_UInt16)(channels * 8), channels == 4 ? PICOMEDIA_BMP_COMPRESSION_BITFIELDS : PICOMEDIA_BMP_COMPRESSION_RGB,
+        channels == 4 ? PM_BMP_V4_HEADER_SIZE : PM_BMP_INFO_HEADER_SIZE, 0, scanLineSizeWithPadding * image->height) )
+    {
+        return PM_FALSE;
+    }
+
+    if ( ! PM__ImageBMPWriteHeaders(stream, &context) )
+    {
+        return PM_FALSE;
+    }
+
+    if ( channels == 4 )
+    {
+        PM_Bool writeResult = PM_TRUE;
+
+        writeResult &= PM_StreamWriteUInt32(stream, 0x00FF0000); // red mask
+        writeResult &= PM_StreamWriteUInt32(stream, 0x0000FF00); // green mask
+        writeResult &= PM_StreamWriteUInt32(stream, 0x000000FF); // blue mask
+        writeResult &= PM_StreamWriteUInt32(stream, 0xFF000000); // alpha mask
+        writeResult &= PM_StreamWriteUInt32(stream, 0x73524742); // 'sRGB' color space, the endpoints and gammas are unused
+
+        for ( PM_Size i = 0; i < 12; ++i )
+        {
+            writeResult &= PM_StreamWriteUInt32(stream, 0);
+        }
+
+        if ( ! writeResult )
+        {
+            PM_LogWarning("Failed to write color masks! \n");
+            return PM_FALSE;
+        }
+    }
+
+    if ( (channels == 3 && image->channelFormat == PICOMEDIA_IMAGE_CHANNEL_FORMAT_BGR) || (channels == 4 && image->channelFormat == PICOMEDIA_IMAGE_CHANNEL_FORMAT_BGRA) )
+    {
+        return PM_ImageBMPWriteImageData(stream, image);
+    }
+
+    // Other layouts are converted one row at a time, the padding of the row buffer stays cleared
+    PM_Byte* scanLine = (PM_Byte*)PM_Malloc(scanLineSizeWithPadding);
+    if ( scanLine == NULL )
+    {
+        PM_LogWarning("Failed to allocate memory for scan line! \n");
+        return PM_FALSE;
+    }
+    PM_Memset(scanLine, 0, scanLineSizeWithPadding);
+
+    PM_Size srcScanLineSize = (PM_Size)image->width * image->numChannels;
+    PM_Bool writeResult = PM_TRUE;
+
+    for ( PM_Size y = image->height; y > 0 && writeResult; --y )
+    {
+        PM__ImageBMPConvertRow(image, image->data + (y - 1) * srcScanLineSize, scanLine, channels);
+        writeResult = PM__ImageBMPStreamWrite(stream, scanLine, scanLineSizeWithPadding);
+    }
+
+    if ( ! writeResult )
+    {
+        PM_LogWarning("Failed to write image data! \n");
+    }
+
+    PM_Free(scanLine);
+    return writeResult;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Size PM__ImageBMPFindMismatch(const PM_UInt8* indices, PM_Size begin, PM_Size end, PM_Size period)
+{
+    for ( PM_Size i = begin; i < end; ++i )
+    {
+        if ( indices[i] != indices[i - period] )
+        {
+            return i;
+        }
+    }
+
+    return end;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Size PM__ImageBMPFindRun(const PM_UInt8* indices, PM_Size begin, PM_Size end, PM_Size period)
+{
+    for ( PM_Size i = begin; i + period + 1 < end; ++i )
+    {
+        if ( indices[i] == indices[i + period] && indices[i + 1] == indices[i + 1 + period] )
+        {
+            return i;
+        }
+    }
+
+    return end;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+#if defined(PM_ARCH_X86)
+
+static PM_TARGET("sse2") PM_Size PM__ImageBMPFindMismatchSSE2(const PM_UInt8* indices, PM_Size begin, PM_Size end, PM_Size period)
+{
+    PM_Size i = begin;
+
+    for ( ; i + 16 <= end; i += 16 )
+    {
+        __m128i current = _mm_loadu_si128((const __m128i*)(indices + i));
+        __m128i previous = _mm_loadu_si128((const __m128i*)(indices + i - period));
+        PM_UInt32 mismatches = ~(PM_UInt32)_mm_movemask_epi8(_mm_cmpeq_epi8(current, previous)) & 0xFFFF;
+
+        if ( mismatches != 0 )
+        {
+            return i + PM_CountTrailingZeros32(mismatches);
+        }
+    }
+
+    return PM__ImageBMPFindMismatch(indices, i, end, period);
+}
+
+// -----------------------------------------------------------------------------------------------
 
-    if ( ! PM_ImageBMPEncode(image, &context) )
+static PM_TARGET("sse2") PM_Size PM__ImageBMPFindRunSSE2(const PM_UInt8* indices, PM_Size begin, PM_Size end, PM_Size period)
+{
+    PM_Size i = begin;
+
+    for ( ; i + period + 17 <= end; i += 16 )
+    {
+        __m128i first = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(indices + i)), _mm_loadu_si128((const __m128i*)(indices + i + period)));
+        __m128i second = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(indices + i + 1)), _mm_loadu_si128((const __m128i*)(indices + i + 1 + period)));
+        PM_UInt32 starts = (PM_UInt32)_mm_movemask_epi8(_mm_and_si128(first, second));
+
+        if ( starts != 0 )
+        {
+            return i + PM_CountTrailingZeros32(starts);
+        }
+    }
+
+    return PM__ImageBMPFindRun(indices, i, end, period);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+#elif defined(PM_ARCH_ARM64)
+
+// Index of the first set byte of a comparison result, or 16 when there is none
+static PM_Size PM__ImageBMPFirstSetByteNEON(uint8x16_t mask)
+{
+    PM_UInt64 bits = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(mask), 4)), 0);
+
+    if ( (PM_UInt32)bits != 0 )
+    {
+        return PM_CountTrailingZeros32((PM_UInt32)bits) / 4;
+    }
+
+    return (PM_UInt32)(bits >> 32) != 0 ? 8 + PM_CountTrailingZeros32((PM_UInt32)(bits >> 32)) / 4 : 16;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Size PM__ImageBMPFindMismatchNEON(const PM_UInt8* indices, PM_Size begin, PM_Size end, PM_Size period)
+{
+    PM_Size i = begin;
+
+    for ( ; i + 16 <= end; i += 16 )
+    {
+        PM_Size first = PM__ImageBMPFirstSetByteNEON(vmvnq_u8(vceqq_u8(vld1q_u8(indices + i), vld1q_u8(indices + i - period))));
+
+        if ( first < 16 )
+        {
+            return i + first;
+        }
+    }
+
+    return PM__ImageBMPFindMismatch(indices, i, end, period);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Size PM__ImageBMPFindRunNEON(const PM_UInt8* indices, PM_Size begin, PM_Size end, PM_Size period)
+{
+    PM_Size i = begin;
+
+    for ( ; i + period + 17 <= end; i += 16 )
+    {
+        uint8x16_t first = vceqq_u8(vld1q_u8(indices + i), vld1q_u8(indices + i + period));
+        uint8x16_t second = vceqq_u8(vld1q_u8(indices + i + 1), vld1q_u8(indices + i + 1 + period));
+        PM_Size start = PM__ImageBMPFirstSetByteNEON(vandq_u8(first, second));
+
+        if ( start < 16 )
+        {
+            return i + start;
+        }
+    }
+
+    return PM__ImageBMPFindRun(indices, i, end, period);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+#endif
+
+static PM__ImageBMPFindMismatchFunction PM_BMP_FIND_MISMATCH = PM__ImageBMPFindMismatch;
+static PM__ImageBMPFindRunFunction PM_BMP_FIND_RUN = PM__ImageBMPFindRun;
+static volatile PM_Bool PM_BMP_RUN_FUNCTIONS_SELECTED = PM_FALSE;
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageBMPSelectRunFunctions()
+{
+#if defined(PM_ARCH_X86)
+    if ( PM_CPUHasFeature(PICOMEDIA_CPU_FEATURE_SSE2) )
+    {
+        PM_BMP_FIND_MISMATCH = PM__ImageBMPFindMismatchSSE2;
+        PM_BMP_FIND_RUN = PM__ImageBMPFindRunSSE2;
+    }
+#elif defined(PM_ARCH_ARM64)
+    PM_BMP_FIND_MISMATCH = PM__ImageBMPFindMismatchNEON;
+    PM_BMP_FIND_RUN = PM__ImageBMPFindRunNEON;
+#endif
+
+    PM_BMP_RUN_FUNCTIONS_SELECTED = PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Encodes a row of palette indices with RLE8 (period 1) or RLE4 (period 2, where runs alternate two indices),
+// returns the size of the encoded row which is at most twice the width
+static PM_Size PM__ImageBMPEncodeRLERow(const PM_UInt8* indices, PM_Size width, PM_Size period, PM_Byte* dst)
+{
+    PM_Byte* out = dst;
+    PM_Size x = 0;
+
+    while ( x < width )
+    {
+        PM_Size limit = PM_Min(width, x + PM_BMP_RLE_MAX_RUN);
+        PM_Size run = x + period >= limit ? limit - x : PM_BMP_FIND_MISMATCH(indices, x + period, limit, period) - x;
+
+        // A shorter run costs as much as storing its indices
+        if ( run < period + 2 )
+        {
+            PM_Size literal = PM_BMP_FIND_RUN(indices, x + 1, limit, period) - x;
+
+            // Absolute mode needs at least 3 indices, its data is padded to 16 bits
+            if ( literal >= 3 )
+            {
+                *out++ = 0;
+                *out++ = (PM_Byte)literal;
+
+                if ( period == 1 )
+                {
+                    PM_Memcpy(out, indices + x, literal);
+                    out += literal;
+                }
+                else
+                {
+                    for ( PM_Size k = 0; k < literal; k += 2 )
+                    {
+                        *out++ = (PM_Byte)((indices[x + k] << 4) | (k + 1 < literal ? indices[x + k + 1] : 0));
+                    }
+                }
+
+                if ( (out - dst) & 1 )
+                {
+                    *out++ = 0;
+                }
+
+                x += literal;
+                continue;
+            }
+
+            run = PM_Min(run, literal);
+        }
+
+        *out++ = (PM_Byte)run;
+        *out++ = period == 1 ? (PM_Byte)indices[x] : (PM_Byte)((indices[x] << 4) | (x + 1 < width ? indices[x + 1] : 0));
+        x += run;
+    }
+
+    return (PM_Size)(out - dst);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_UInt32 PM__ImageBMPHistogramKey(const PM_Byte* bgr)
+{
+    const PM_UInt32 shift = 8 - PM_BMP_HISTOGRAM_BITS;
+    return (((PM_UInt32)(PM_UInt8)bgr[2] >> shift) << (2 * PM_BMP_HISTOGRAM_BITS)) | (((PM_UInt32)(PM_UInt8)bgr[1] >> shift) << PM_BMP_HISTOGRAM_BITS) | ((PM_UInt32)(PM_UInt8)bgr[0] >> shift);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Slot of a color in the exact color table, either holding it or the empty slot where it belongs
+static PM_Size PM__ImageBMPExactSlot(const PM__ImageBMPPalette* palette, PM_UInt32 color)
+{
+    PM_Size slot = (PM_Size)((color * 2654435761u) >> 22) & (PM_BMP_EXACT_TABLE_SIZE - 1);
+
+    while ( palette->exactColors[slot] != 0 && palette->exactColors[slot] != (color | PM_BMP_EXACT_TABLE_USED) )
+    {
+        slot = (slot + 1) & (PM_BMP_EXACT_TABLE_SIZE - 1);
+    }
+
+    return slot;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageBMPShrinkBox(const PM__ImageBMPHistogramBin* histogram, PM__ImageBMPBox* box)
+{
+    PM__ImageBMPBox shrunk = { { 0xFF, 0xFF, 0xFF }, { 0, 0, 0 }, 0 };
+
+    for ( PM_UInt32 r = box->min[0]; r <= box->max[0]; ++r )
+    {
+        for ( PM_UInt32 g = box->min[1]; g <= box->max[1]; ++g )
+        {
+            for ( PM_UInt32 b = box->min[2]; b <= box->max[2]; ++b )
+            {
+                const PM__ImageBMPHistogramBin* bin = &histogram[(r << (2 * PM_BMP_HISTOGRAM_BITS)) | (g << PM_BMP_HISTOGRAM_BITS) | b];
+                if ( bin->count == 0 )
+                {
+                    continue;
+                }
+
+                PM_UInt32 position[3] = { r, g, b };
+                for ( PM_Size c = 0; c < 3; ++c )
+                {
+                    shrunk.min[c] = PM_Min(shrunk.min[c], position[c]);
+                    shrunk.max[c] = PM_Max(shrunk.max[c], position[c]);
+                }
+                shrunk.count += bin->count;
+            }
+        }
+    }
+
+    *box = shrunk;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Median cut : the box with the most pixels times its longest side is split at the median of that side,
+// until there are as many boxes as colors. Every box then gives the average color of its pixels.
+static void PM__ImageBMPMedianCut(const PM__ImageBMPHistogramBin* histogram, PM__ImageBMPPalette* palette)
+{
+    PM__ImageBMPBox boxes[256];
+    PM_Size boxCount = 1;
+
+    boxes[0].min[0] = boxes[0].min[1] = boxes[0].min[2] = 0;
+    boxes[0].max[0] = boxes[0].max[1] = boxes[0].max[2] = (1 << PM_BMP_HISTOGRAM_BITS) - 1;
+    PM__ImageBMPShrinkBox(histogram, &boxes[0]);
+
+    while ( boxCount < palette->maxColors )
+    {
+        PM_Size selected = boxCount;
+        PM_Size axis = 0;
+        PM_UInt64 bestScore = 0;
+
+        for ( PM_Size i = 0; i < boxCount; ++i )
+        {
+            for ( PM_Size c = 0; c < 3; ++c )
+            {
+                PM_UInt64 score = boxes[i].count * (boxes[i].max[c] - boxes[i].min[c]);
+                if ( score > bestScore )
+                {
+                    bestScore = score;
+                    selected = i;
+                    axis = c;
+                }
+            }
+        }
+
+        // Every box is a single bin
+        if ( selected == boxCount )
+        {
+            break;
+        }
+
+        // Pixels per slice of the box along the axis
+        PM_UInt64 slices[1 << PM_BMP_HISTOGRAM_BITS] = {0};
+        PM__ImageBMPBox* box = &boxes[selected];
+
+        for ( PM_UInt32 r = box->min[0]; r <= box->max[0]; ++r )
+        {
+            for ( PM_UInt32 g = box->min[1]; g <= box->max[1]; ++g )
+            {
+                for ( PM_UInt32 b = box->min[2]; b <= box->max[2]; ++b )
+                {
+                    PM_UInt32 position[3] = { r, g, b };
+                    slices[position[axis]] += histogram[(r << (2 * PM_BMP_HISTOGRAM_BITS)) | (g << PM_BMP_HISTOGRAM_BITS) | b].count;
+                }
+            }
+        }
+
+        // Both halves keep at least one slice, the box being shrunk its first and last slices are populated
+        PM_UInt32 cut = box->min[axis];
+        PM_UInt64 below = slices[cut];
+        while ( cut + 1 < box->max[axis] && below * 2 < box->count )
+        {
+            below += slices[++cut];
+        }
+
+        boxes[boxCount] = *box;
+        box->max[axis] = cut;
+        boxes[boxCount].min[axis] = cut + 1;
+        PM__ImageBMPShrinkBox(histogram, box);
+        PM__ImageBMPShrinkBox(histogram, &boxes[boxCount]);
+        boxCount++;
+    }
+
+    for ( PM_Size i = 0; i < boxCount; ++i )
+    {
+        PM_UInt64 sums[3] = {0};
+
+        for ( PM_UInt32 r = boxes[i].min[0]; r <= boxes[i].max[0]; ++r )
+        {
+            for ( PM_UInt32 g = boxes[i].min[1]; g <= boxes[i].max[1]; ++g )
+            {
+                for ( PM_UInt32 b = boxes[i].min[2]; b <= boxes[i].max[2]; ++b )
+                {
+                    const PM__ImageBMPHistogramBin* bin = &histogram[(r << (2 * PM_BMP_HISTOGRAM_BITS)) | (g << PM_BMP_HISTOGRAM_BITS) | b];
+                    sums[0] += bin->sums[0];
+                    sums[1] += bin->sums[1];
+                    sums[2] += bin->sums[2];
+                }
+            }
+        }
+
+        palette->colors[i].red = (PM_UInt8)((sums[0] + boxes[i].count / 2) / boxes[i].count);
+        palette->colors[i].green = (PM_UInt8)((sums[1] + boxes[i].count / 2) / boxes[i].count);
+        palette->colors[i].blue = (PM_UInt8)((sums[2] + boxes[i].count / 2) / boxes[i].count);
+        palette->colors[i].reserved = 0;
+    }
+    palette->colorCount = boxCount;
+
+    // Every populated bin maps to the palette color nearest to the average of its pixels
+    for ( PM_Size key = 0; key < PM_BMP_HISTOGRAM_SIZE; ++key )
+    {
+        const PM__ImageBMPHistogramBin* bin = &histogram[key];
+        if ( bin->count == 0 )
+        {
+            continue;
+        }
+
+        PM_Int32 red = (PM_Int32)(bin->sums[0] / bin->count);
+        PM_Int32 green = (PM_Int32)(bin->sums[1] / bin->count);
+        PM_Int32 blue = (PM_Int32)(bin->sums[2] / bin->count);
+        PM_Int32 bestDistance = 0x7FFFFFFF;
+
+        for ( PM_Size i = 0; i < boxCount; ++i )
+        {
+            PM_Int32 dr = red - palette->colors[i].red;
+            PM_Int32 dg = green - palette->colors[i].green;
+            PM_Int32 db = blue - palette->colors[i].blue;
+            PM_Int32 distance = dr * dr + dg * dg + db * db;
+
+            if ( distance < bestDistance )
+            {
+                bestDistance = distance;
+                palette->binIndices[key] = (PM_UInt8)i;
+            }
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Builds a palette of at most palette->maxColors colors. Images with that few colors keep them exactly,
+// which is the common case for screen captures, the other ones are quantized with a median cut.
+static PM_Bool PM__ImageBMPBuildPalette(const PM_Image* image, PM_Byte* scanLine, PM__ImageBMPPalette* palette)
+{
+    PM__ImageBMPHistogramBin* histogram = (PM__ImageBMPHistogramBin*)PM_Malloc(PM_BMP_HISTOGRAM_SIZE * sizeof(PM__ImageBMPHistogramBin));
+    if ( histogram == NULL )
     {
-        PM_LogWarning("Failed to encode image! \n");
+        PM_LogWarning("Failed to allocate memory for color histogram! \n");
         return PM_FALSE;
     }
 
-    PM_Bool writeResult = PM_ImageBMPWriteContext(stream, &context);    
+    PM_Memset(histogram, 0, PM_BMP_HISTOGRAM_SIZE * sizeof(PM__ImageBMPHistogramBin));
+    PM_Memset(palette->exactColors, 0, sizeof(palette->exactColors));
+    palette->colorCount = 0;
+    palette->isExact = PM_TRUE;
+
+    PM_Size srcScanLineSize = (PM_Size)image->width * image->numChannels;
+    PM_UInt32 lastColor = 0xFFFFFFFF;
+
+    for ( PM_Size y = 0; y < image->height; ++y )
+    {
+        PM__ImageBMPConvertRow(image, image->data + y * srcScanLineSize, scanLine, 3);
+
+        for ( PM_Size x = 0; x < image->width; ++x )
+        {
+            const PM_Byte* pixel = scanLine + x * 3;
+            PM_UInt32 color = ((PM_UInt32)(PM_UInt8)pixel[2] << 16) | ((PM_UInt32)(PM_UInt8)pixel[1] << 8) | (PM_UInt32)(PM_UInt8)pixel[0];
+            PM__ImageBMPHistogramBin* bin = &histogram[PM__ImageBMPHistogramKey(pixel)];
+
+            bin->count++;
+            bin->sums[0] += (PM_UInt8)pixel[2];
+            bin->sums[1] += (PM_UInt8)pixel[1];
+            bin->sums[2] += (PM_UInt8)pixel[0];
+
+            if ( ! palette->isExact || color == lastColor )
+            {
+                continue;
+            }
+
+            lastColor = color;
+            PM_Size slot = PM__ImageBMPExactSlot(palette, color);
+            if ( palette->exactColors[slot] != 0 )
+            {
+                continue;
+            }
+
+            if ( palette->colorCount == palette->maxColors )
+            {
+                palette->isExact = PM_FALSE;
+                continue;
+            }
+
+            palette->exactColors[slot] = color | PM_BMP_EXACT_TABLE_USED;
+            palette->exactIndices[slot] = (PM_UInt8)palette->colorCount;
+            palette->colors[palette->colorCount].red = (PM_UInt8)pixel[2];
+            palette->colors[palette->colorCount].green = (PM_UInt8)pixel[1];
+            palette->colors[palette->colorCount].blue = (PM_UInt8)pixel[0];
+            palette->colors[palette->colorCount].reserved = 0;
+            palette->colorCount++;
+        }
+    }
+
+    if ( ! palette->isExact )
+    {
+        PM__ImageBMPMedianCut(histogram, palette);
+    }
+
+    PM_Free(histogram);
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageBMPMapRow(const PM__ImageBMPPalette* palette, const PM_Byte* scanLine, PM_UInt8* indices, PM_Size width)
+{
+    if ( ! palette->isExact )
+    {
+        for ( PM_Size x = 0; x < width; ++x )
+        {
+            indices[x] = palette->binIndices[PM__ImageBMPHistogramKey(scanLine + x * 3)];
+        }
+        return;
+    }
+
+    PM_UInt32 lastColor = 0xFFFFFFFF;
+    PM_UInt8 lastIndex = 0;
+
+    for ( PM_Size x = 0; x < width; ++x )
+    {
+        const PM_Byte* pixel = scanLine + x * 3;
+        PM_UInt32 color = ((PM_UInt32)(PM_UInt8)pixel[2] << 16) | ((PM_UInt32)(PM_UInt8)pixel[1] << 8) | (PM_UInt32)(PM_UInt8)pixel[0];
+
+        if ( color != lastColor )
+        {
+            lastColor = color;
+            lastIndex = palette->exactIndices[PM__ImageBMPExactSlot(palette, color)];
+        }
+
+        indices[x] = lastIndex;
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Writes 8-bit palette indices, either uncompressed or with RLE8, or 4-bit ones with RLE4
+static PM_Bool PM__ImageBMPWritePalettized(const PM_Image* image, PM_Stream* stream, PM_UInt32 bmpFormat)
+{
+    PM_Size width = image->width;
+    PM_Size period = bmpFormat == PICOMEDIA_BMP_FORMAT_RLE4 ? 2 : 1;
+    PM_Bool isCompressed = bmpFormat != PICOMEDIA_BMP_FORMAT_PALETTE8;
+    PM_Size scanLineSizeWithPadding = (width + 3) & ~(PM_Size)3;
+
+    if ( ! PM_BMP_RUN_FUNCTIONS_SELECTED )
+    {
+        PM__ImageBMPSelectRunFunctions();
+    }
+
+    // One buffer for the converted row, its indices and its encoding
+    PM__ImageBMPPalette* palette = (PM__ImageBMPPalette*)PM_Malloc(sizeof(PM__ImageBMPPalette));
+    PM_Byte* scanLine = (PM_Byte*)PM_Malloc(width * 3 + scanLineSizeWithPadding + width * 2 + 2);
+    if ( palette == NULL || scanLine == NULL )
+    {
+        PM_LogWarning("Failed to allocate memory for palette encoding! \n");
+        PM_Free(palette);
+        PM_Free(scanLine);
+        return PM_FALSE;
+    }
+
+    PM_UInt8* indices = (PM_UInt8*)(scanLine + width * 3);
+    PM_Byte* encoded = (PM_Byte*)indices + scanLineSizeWithPadding;
+    PM_Memset(indices, 0, scanLineSizeWithPadding);
+
+    palette->maxColors = bmpFormat == PICOMEDIA_BMP_FORMAT_RLE4 ? 16 : 256;
+
+    PM_BMPContext context = {0};
+    PM_Bool writeResult = PM__ImageBMPBuildPalette(image, scanLine, palette) &&
+        PM__ImageBMPInitHeaders(&context, image, bmpFormat == PICOMEDIA_BMP_FORMAT_RLE4 ? 4 : 8,
+            bmpFormat == PICOMEDIA_BMP_FORMAT_RLE8 ? PICOMEDIA_BMP_COMPRESSION_RLE8 : bmpFormat == PICOMEDIA_BMP_FORMAT_RLE4 ? PICOMEDIA_BMP_COMPRESSION_RLE4 : PICOMEDIA_BMP_COMPRESSION_RGB,
+            PM_BMP_INFO_HEADER_SIZE, palette->colorCount, isCompressed ? 0 : scanLineSizeWithPadding * image->height) &&
+        PM__ImageBMPWriteHeaders(stream, &context) &&
+        PM_ImageBMPWriteColorTable(stream, palette->colors, palette->colorCount);
+
+    PM_Size srcScanLineSize = width * image->numChannels;
+
+    for ( PM_Size y = image->height; y > 0 && writeResult; --y )
+    {
+        PM__ImageBMPConvertRow(image, image->data + (y - 1) * srcScanLineSize, scanLine, 3);
+        PM__ImageBMPMapRow(palette, scanLine, indices, width);
+
+        if ( ! isCompressed )
+        {
+            writeResult = PM__ImageBMPStreamWrite(stream, (const PM_Byte*)indices, scanLineSizeWithPadding);
+            continue;
+        }
+
+        // Every row ends with an end of line code, but the last one which ends the bitmap
+        PM_Size encodedSize = PM__ImageBMPEncodeRLERow(indices, width, period, encoded);
+        encoded[encodedSize++] = 0;
+        encoded[encodedSize++] = y > 1 ? 0 : 1;
+        writeResult = PM__ImageBMPStreamWrite(stream, encoded, encodedSize);
+    }
+
+    // The compressed size is only known now, the headers are written again with it
+    if ( writeResult && isCompressed )
+    {
+        PM_Size end = PM_StreamGetCursorPosition(stream);
+
+        if ( end > 0xFFFFFFFFu )
+        {
+            PM_LogWarning("Image is too large for the BMP format! \n");
+            writeResult = PM_FALSE;
+        }
+        else
+        {
+            context.header.fileSize = (PM_UInt32)end;
+            context.infoHeader.imageSize = (PM_UInt32)(end - context.header.dataOffset);
+            writeResult = PM__ImageBMPWriteHeaders(stream, &context);
+            PM_StreamSetCursorPosition(stream, end);
+        }
+    }
 
-    PM_ImageBMPContextDestroy(&context);
+    if ( ! writeResult )
+    {
+        PM_LogWarning("Failed to write palettized image! \n");
+    }
 
+    PM_Free(palette);
+    PM_Free(scanLine);
     return writeResult;
 }
 
 // -----------------------------------------------------------------------------------------------
 
+PM_Bool PM_ImageBMPWriteEx(const PM_Image* image, PM_Stream* stream, PM_UInt32 bmpFormat)
+{
+    PM_Assert(stream != NULL);
+    PM_Assert(image != NULL);
+
+    if ( ! PM__ImageBMPCheckOkForWrite(image) )
+    {
+        PM_LogWarning("Image cannot be written as BMP! \n");
+        return PM_FALSE;
+    }
+
+    if ( bmpFormat == PICOMEDIA_BMP_FORMAT_AUTO )
+    {
+        bmpFormat = PM__ImageBMPHasAlpha(image) ? PICOMEDIA_BMP_FORMAT_BGRA32 : PICOMEDIA_BMP_FORMAT_BGR24;
+    }
+
+    switch ( bmpFormat )
+    {
+    case PICOMEDIA_BMP_FORMAT_BGR24:
+        return PM__ImageBMPWriteTrueColor(image, stream, 3);
+    case PICOMEDIA_BMP_FORMAT_BGRA32:
+        return PM__ImageBMPWriteTrueColor(image, stream, 4);
+    case PICOMEDIA_BMP_FORMAT_PALETTE8:
+    case PICOMEDIA_BMP_FORMAT_RLE8:
+    case PICOMEDIA_BMP_FORMAT_RLE4:
+        return PM__ImageBMPWritePalettized(image, stream, bmpFormat);
+    default:
+        PM_LogWarning("Unsupported BMP format(%u)! \n", bmpFormat);
+        return PM_FALSE;
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PM_ImageBMPWrite(const PM_Image* image, PM_Stream* stream)
+{
+    return PM_ImageBMPWriteEx(image, stream, PICOMEDIA_BMP_FORMAT_AUTO);
+}
+
+// -----------------------------------------------------------------------------------------------
+
 PM_Bool PM_ImageBMPWriteToFile(const PM_Image* image, const PM_Byte* filePath)
+{
+    return PM_ImageBMPWriteToFileEx(image, filePath, PICOMEDIA_BMP_FORMAT_AUTO);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PM_ImageBMPWriteToFileEx(const PM_Image* image, const PM_Byte* filePath, PM_UInt32 bmpFormat)
 {
     PM_Assert(filePath != NULL);
     PM_Assert(image != NULL);
@@ -282,7 +1199,7 @@ PM_Bool PM_ImageBMPWriteToFile(const PM_Image* image, const PM_Byte* filePath)
         return PM_FALSE;
     }
 
-    PM_Bool writeResult = PM_ImageBMPWrite(image, &stream);
+    PM_Bool writeResult = PM_ImageBMPWriteEx(image, &stream, bmpFormat);
 
     PM_StreamDestroy(&stream);
 
@@ -292,6 +1209,13 @@ PM_Bool PM_ImageBMPWriteToFile(const PM_Image* image, const PM_Byte* filePath)
 // -----------------------------------------------------------------------------------------------
 
 PM_Bool PM_ImageBMPWriteToMemory(const PM_Image* image, PM_Byte* data, PM_Size* dataSize, PM_Size maxDataSize)
+{
+    return PM_ImageBMPWriteToMemoryEx(image, data, dataSize, maxDataSize, PICOMEDIA_BMP_FORMAT_AUTO);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PM_ImageBMPWriteToMemoryEx(const PM_Image* image, PM_Byte* data, PM_Size* dataSize, PM_Size maxDataSize, PM_UInt32 bmpFormat)
 {
     PM_Assert(data != NULL);
     PM_Assert(maxDataSize > 0);
@@ -305,7 +1229,7 @@ PM_Bool PM_ImageBMPWriteToMemory(const PM_Image* image, PM_Byte* data, PM_Size*
         return PM_FALSE;
     }
 
-    PM_Bool writeResult = PM_ImageBMPWrite(image, &stream);
+    PM_Bool writeResult = PM_ImageBMPWriteEx(image, &stream, bmpFormat);
 
     if (writeResult && dataSize != NULL)
     {
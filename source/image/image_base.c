@@ -82,6 +82,30 @@ PM_Bool PM_ImageCopy(PM_Image* dest, const PM_Image* src)
 
 // -----------------------------------------------------------------------------------------------
 
+PM_Bool PM_ImageReserve(PM_Image* image, PM_Size capacity)
+{
+    PM_Assert(image != NULL);
+
+    if ( (image->data != NULL) && (image->dataCapacity >= capacity) )
+    {
+        return PM_TRUE;
+    }
+
+    PM_Byte* newData = (PM_Byte*)PM_Realloc(image->data, capacity);
+    if (newData == NULL)
+    {
+        PM_LogWarning("PM_ImageReserve: Failed to allocate %zu bytes for image data.", capacity);
+        return PM_FALSE;
+    }
+
+    image->data = newData;
+    image->dataCapacity = capacity;
+
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
 PM_Size PM_ImageGetDataTypeSize(PM_UInt32 dataType)
 {
     switch (dataType)
@@ -99,14 +123,61 @@ PM_Size PM_ImageGetDataTypeSize(PM_UInt32 dataType)
 
 // -----------------------------------------------------------------------------------------------
 
+void PM_ImageInfoInit(PM_ImageInfo* info)
+{
+    PM_Assert(info != NULL);
+
+    info->fileFormat = PICOMEDIA_IMAGE_FILE_FORMAT_UNKNOWN;
+    info->width = 0;
+    info->height = 0;
+    info->channelFormat = PICOMEDIA_IMAGE_CHANNEL_FORMAT_UNKNOWN;
+    info->dataType = PICOIMEDIA_IMAGE_DATA_TYPE_UNKNOWN;
+    info->numChannels = 0;
+    info->bitsPerChannel = 0;
+    info->decodedSize = 0;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Size PM_ImageInfoGetDataSize(const PM_ImageInfo* info)
+{
+    PM_Assert(info != NULL);
+
+    PM_Size factors[4] = { info->width, info->height, info->numChannels, PM_ImageGetDataTypeSize(info->dataType) };
+    PM_Size size = 1;
+    for (PM_Size i = 0; i < 4; ++i)
+    {
+        if (factors[i] == 0)
+        {
+            return 0;
+        }
+        if (size > SIZE_MAX / factors[i])
+        {
+            return SIZE_MAX;
+        }
+        size *= factors[i];
+    }
+    return size;
+}
+
+// -----------------------------------------------------------------------------------------------
+
 PM_Bool PM_ImageAllocate(PM_Image* image, PM_UInt32 width, PM_UInt32 height, PM_UInt32 channelFormat, PM_UInt32 dataType, PM_UInt8 numChannels)
 {
     PM_Assert( image != NULL );
     PM_Assert( (width > 0) && (height > 0) );
     PM_Assert( numChannels > 0 );
 
-    PM_Size requiredSize = width * height * numChannels * PM_ImageGetDataTypeSize(dataType);
-    
+    // Computed in PM_Size with overflow checks, a wrapped product would allocate a buffer smaller than the image
+    PM_Size pixelSize = numChannels * PM_ImageGetDataTypeSize(dataType);
+    if ( (pixelSize == 0) || ((PM_Size)width > SIZE_MAX / height) || ((PM_Size)width * height > SIZE_MAX / pixelSize) )
+    {
+        PM_LogWarning("PM_ImageAllocate: Invalid image size(%u x %u x %u).", width, height, (PM_UInt32)pixelSize);
+        return PM_FALSE;
+    }
+
+    PM_Size requiredSize = (PM_Size)width * height * pixelSize;
+
     if (! PM__ImageEnsureSize(image, requiredSize) )
     {
         PM_LogError("PM_ImageAllocate: Failed to allocate %zu bytes for image data.", requiredSize);
@@ -0,0 +1,72 @@
+#include "libpicomedia/image/image.h"
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PM_ImageProbe(PM_Stream* stream, PM_ImageInfo* info)
+{
+    PM_Assert(stream != NULL);
+    PM_Assert(info != NULL);
+
+    // Every detection reads the magic number from the current cursor, so each one starts over
+    PM_StreamSetCursorPosition(stream, 0);
+    if ( PM_ImagePNGDetect(stream) )
+    {
+        return PM_ImagePNGProbe(stream, info);
+    }
+
+    PM_StreamSetCursorPosition(stream, 0);
+    if ( PM_ImageBMPDetect(stream) )
+    {
+        return PM_ImageBMPProbe(stream, info);
+    }
+
+    PM_StreamSetCursorPosition(stream, 0);
+    if ( PM_ImagePPMDetect(stream) != PICOMEDIA_PPM_FORMAT_UNKNOWN )
+    {
+        return PM_ImagePPMProbe(stream, info);
+    }
+
+    PM_ImageInfoInit(info);
+    PM_LogWarning("PM_ImageProbe: Unknown image format.");
+    return PM_FALSE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PM_ImageProbeFromMemory(PM_Byte* data, PM_Size dataSize, PM_ImageInfo* info)
+{
+    PM_Assert(data != NULL);
+    PM_Assert(dataSize > 0);
+    PM_Assert(info != NULL);
+
+    PM_Stream stream = {0};
+    if ( ! PM_StreamInitFromMemory(&stream, data, dataSize, PICOMEDIA_STREAM_FLAG_READ, PM_FALSE) )
+    {
+        PM_LogWarning("PM_ImageProbeFromMemory: PM_StreamInitFromMemory failed.");
+        return PM_FALSE;
+    }
+    PM_Bool probeResult = PM_ImageProbe(&stream, info);
+    PM_StreamDestroy(&stream);
+    return probeResult;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PM_ImageProbeFromFile(const PM_Char* filePath, PM_ImageInfo* info)
+{
+    PM_Assert(filePath != NULL);
+    PM_Assert(info != NULL);
+
+    // Only the header is needed, so the file is read through the buffered stream instead of being mapped
+    PM_Stream stream = {0};
+    if ( ! PM_StreamInitFromFile(&stream, filePath, PICOMEDIA_STREAM_FLAG_READ) )
+    {
+        PM_LogWarning("PM_ImageProbeFromFile: PM_StreamInitFromFile failed.");
+        return PM_FALSE;
+    }
+    PM_Bool probeResult = PM_ImageProbe(&stream, info);
+    PM_StreamDestroy(&stream);
+    return probeResult;
+}
+
+// -----------------------------------------------------------------------------------------------
@@ -1,167 +1,332 @@
 #include "libpicomedia/image/image_transforms.h"
+#include "libpicomedia/common/cpu.h"
 
-// -----------------------------------------------------------------------------------------------
+#if defined(PM_ARCH_X86)
+    #include <immintrin.h>
+#elif defined(PM_ARCH_ARM64)
+    #include <arm_neon.h>
+#endif
+
+// Largest pixel size, four 64-bit channels
+#define PM_IMAGE_MAX_PIXEL_SIZE 32
+
+// Number of bytes shuffled at once by the vectorized reversals
+#define PM_IMAGE_REVERSE_SIZE 16
+
+// Smallest number of pixels flipped by a single task
+#define PM_IMAGE_FLIP_MIN_BAND_PIXELS (1 << 15)
+
+// Images are transposed by square tiles, the largest ones up to PM_IMAGE_TRANSPOSE_MAX_TILE_SIZE pixels on a
+// side for which a tile fits in PM_IMAGE_TRANSPOSE_TILE_BYTES, so the source and destination tiles stay in cache
+#define PM_IMAGE_TRANSPOSE_MAX_TILE_SIZE 64
+#define PM_IMAGE_TRANSPOSE_TILE_BYTES (1 << 14)
 
-static void PM__ImageTransformsRGBToBGR(PM_Byte* srcPixel, PM_Byte* destPixel, PM_Size channelSize)
+// Swaps the pixels of two regions of the same size, with the order of the pixels reversed, which reverses a row
+// when the regions are its two halves
+typedef struct PM__ImageReverse
 {
-    PM_Memcpy(destPixel, srcPixel + channelSize * 2, channelSize);
-    PM_Memcpy(destPixel + channelSize, srcPixel + channelSize, channelSize);
-    PM_Memcpy(destPixel + channelSize * 2, srcPixel, channelSize);
-}
+    PM_Size pixelSize;
 
-// -----------------------------------------------------------------------------------------------
+    // Vectorized form, valid when blockSize is not 0. A register loaded in the front region holds a block
+    // of whole pixels at its start, one loaded in the back region holds it at its end.
+    PM_Size blockSize;
+    PM_UInt8 front[PM_IMAGE_REVERSE_SIZE];      // Reversed back block moved to the front of the register
+    PM_UInt8 back[PM_IMAGE_REVERSE_SIZE];       // Reversed front block moved to the back of the register
+    PM_UInt8 frontKeep[PM_IMAGE_REVERSE_SIZE];  // Bytes of the front register past its block, kept as they are
+    PM_UInt8 backKeep[PM_IMAGE_REVERSE_SIZE];   // Bytes of the back register before its block, kept as they are
+} PM__ImageReverse;
 
-static void PM__ImageTransformsRGBAToBGRA(PM_Byte* srcPixel, PM_Byte* destPixel, PM_Size channelSize)
+// The front region starts at front and the back region ends right before back, they must not overlap
+typedef void (*PM__ImageReverseFunction)(const PM__ImageReverse* reverse, PM_Byte* front, PM_Byte* back, PM_Size pixelCount);
+
+typedef struct PM__ImageFlipBand
 {
-    PM_Memcpy(destPixel, srcPixel + channelSize * 2, channelSize);
-    PM_Memcpy(destPixel + channelSize, srcPixel + channelSize, channelSize);
-    PM_Memcpy(destPixel + channelSize * 2, srcPixel, channelSize);
-    PM_Memcpy(destPixel + channelSize * 3, srcPixel + channelSize * 3, channelSize);
-}
+    const PM__ImageReverse* reverse;
+    PM_Byte* data;
+    PM_Size width;  // Pixels per row, all the pixels of the image when rotating it by a half turn
+} PM__ImageFlipBand;
 
-// -----------------------------------------------------------------------------------------------
+// Moves the pixel at column x and row y of a block of width by height source pixels to
+// dst + x * dstStride + y * dstStep, dstStep being either the pixel size or its opposite
+typedef void (*PM__ImageTransposeFunction)(const PM_Byte* src, PM_Int64 srcStride, PM_Byte* dst, PM_Int64 dstStride, PM_Int64 dstStep, PM_Size width, PM_Size height);
 
-static void PM__ImageTransformsRGBToRGBA(PM_Byte* srcPixel, PM_Byte* destPixel, PM_Size channelSize)
+typedef struct PM__ImageTransposeBand
 {
-    PM_Memcpy(destPixel, srcPixel, channelSize);
-    PM_Memcpy(destPixel + channelSize, srcPixel + channelSize, channelSize);
-    PM_Memcpy(destPixel + channelSize * 2, srcPixel + channelSize * 2, channelSize);
-    PM_Memset(destPixel + channelSize * 3, 255, channelSize);
-}
+    PM__ImageTransposeFunction transpose;
+    const PM_Byte* src;
+    PM_Byte* dst;           // Destination of the first source pixel
+    PM_Int64 dstStride;     // Destination offset between two source columns
+    PM_Int64 dstStep;       // Destination offset between two source rows
+    PM_Size width;
+    PM_Size height;
+    PM_Size pixelSize;
+    PM_Size tileSize;
+} PM__ImageTransposeBand;
+
+// Pixels without a matching integer type, moved as a whole
+#define PM__IMAGE_DEFINE_PIXEL(size) \
+    typedef struct PM__ImagePixel##size \
+    { \
+        PM_UInt8 bytes[size]; \
+    } PM__ImagePixel##size;
+
+PM__IMAGE_DEFINE_PIXEL(3)
+PM__IMAGE_DEFINE_PIXEL(6)
+PM__IMAGE_DEFINE_PIXEL(12)
+PM__IMAGE_DEFINE_PIXEL(16)
+PM__IMAGE_DEFINE_PIXEL(24)
+PM__IMAGE_DEFINE_PIXEL(32)
 
 // -----------------------------------------------------------------------------------------------
 
-PM_Bool PM_ImageTransformsChangeChannelFormat(PM_Image* image, PM_UInt32 newChannelFormat)
+static void PM__ImageBuildReverseShuffle(PM__ImageReverse* reverse)
 {
-    PM_Assert(image != NULL);
+    PM_Size pixelSize = reverse->pixelSize;
+    PM_Size blockPixels = PM_IMAGE_REVERSE_SIZE / pixelSize;
+    PM_Size blockSize = blockPixels * pixelSize;
+    PM_Size offset = PM_IMAGE_REVERSE_SIZE - blockSize;
 
-    if (image->channelFormat == newChannelFormat)
+    reverse->blockSize = blockSize;
+
+    for (PM_Size i = 0; i < PM_IMAGE_REVERSE_SIZE && blockSize > 0; i++)
     {
-        return PM_TRUE;
+        PM_Size front = i < blockSize ? (blockPixels - 1 - i / pixelSize) * pixelSize + i % pixelSize : 0;
+        PM_Size back = i >= offset ? (blockPixels - 1 - (i - offset) / pixelSize) * pixelSize + (i - offset) % pixelSize : 0;
+
+        reverse->front[i] = i < blockSize ? (PM_UInt8)(offset + front) : 0x80;
+        reverse->frontKeep[i] = i < blockSize ? 0x80 : (PM_UInt8)i;
+        reverse->back[i] = i >= offset ? (PM_UInt8)back : 0x80;
+        reverse->backKeep[i] = i >= offset ? 0x80 : (PM_UInt8)i;
     }
+}
 
-    PM_UInt8 newNumChannels = 0;
+// -----------------------------------------------------------------------------------------------
 
-    switch (newChannelFormat)
+#define PM__IMAGE_DEFINE_REVERSE(name, Type) \
+    static void PM__ImageReverse##name(PM_Byte* front, PM_Byte* back, PM_Size pixelCount) \
+    { \
+        Type* frontPixel = (Type*)front; \
+        Type* backPixel = (Type*)back - 1; \
+        for (PM_Size i = 0; i < pixelCount; i++, frontPixel++, backPixel--) \
+        { \
+            Type pixel = *frontPixel; \
+            *frontPixel = *backPixel; \
+            *backPixel = pixel; \
+        } \
+    }
+
+PM__IMAGE_DEFINE_REVERSE(U8, PM_UInt8)
+PM__IMAGE_DEFINE_REVERSE(U16, PM_UInt16)
+PM__IMAGE_DEFINE_REVERSE(U32, PM_UInt32)
+PM__IMAGE_DEFINE_REVERSE(U64, PM_UInt64)
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageReverseScalar(const PM__ImageReverse* reverse, PM_Byte* front, PM_Byte* back, PM_Size pixelCount)
+{
+    PM_Size pixelSize = reverse->pixelSize;
+    PM_Byte pixel[PM_IMAGE_MAX_PIXEL_SIZE];
+
+    switch (pixelSize)
     {
-    case PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGB:
-    case PICOMEDIA_IMAGE_CHANNEL_FORMAT_BGR:
-        newNumChannels = 3;
+    case 1:
+        PM__ImageReverseU8(front, back, pixelCount);
+        break;
+    case 2:
+        PM__ImageReverseU16(front, back, pixelCount);
         break;
-    case PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGBA:
-    case PICOMEDIA_IMAGE_CHANNEL_FORMAT_BGRA:
-        newNumChannels = 4;
+    case 4:
+        PM__ImageReverseU32(front, back, pixelCount);
         break;
-    case PICOMEDIA_IMAGE_CHANNEL_FORMAT_GRAY:
-        newNumChannels = 1;
+    case 8:
+        PM__ImageReverseU64(front, back, pixelCount);
         break;
-    case PICOMEDIA_IMAGE_CHANNEL_FORMAT_GRAYA:
-        newNumChannels = 2;
+    default:
+        for (PM_Size i = 0; i < pixelCount; i++)
+        {
+            PM_Byte* frontPixel = front + i * pixelSize;
+            PM_Byte* backPixel = back - (i + 1) * pixelSize;
+            PM_Memcpy(pixel, frontPixel, pixelSize);
+            PM_Memcpy(frontPixel, backPixel, pixelSize);
+            PM_Memcpy(backPixel, pixel, pixelSize);
+        }
         break;
     }
+}
 
-    PM_Image newImage = {0};
-    PM_ImageInit(&newImage);
+// -----------------------------------------------------------------------------------------------
 
-    if(!PM_ImageAllocate(&newImage, image->width, image->height, newChannelFormat, image->dataType, newNumChannels))
-    {
-        PM_LogError("Failed to allocate memory for new image!");
-        return PM_FALSE;
-    }
+// Both regions are walked one block at a time from their outer ends, swapping their reversed blocks, and the
+// remaining pixels are swapped one by one. When the pixel size does not divide the register size the bytes
+// past the blocks are written back unchanged, so the registers never reach outside of the regions as the
+// bytes around them may belong to another task. The next registers are loaded before the current ones are
+// stored so they never read back the bytes that partially overlap.
+
+#if defined(PM_ARCH_X86)
 
-    PM_Size channelSize = image->bitsPerChannel / 8;
+static PM_TARGET("ssse3") void PM__ImageReverseSSSE3(const PM__ImageReverse* reverse, PM_Byte* front, PM_Byte* back, PM_Size pixelCount)
+{
+    PM_Size blockSize = reverse->blockSize;
+    PM_Size regionSize = pixelCount * reverse->pixelSize;
+    PM_Size done = 0;
 
-    for (PM_UInt32 i = 0; i < image->height; i++)
+    if (blockSize > 0 && regionSize >= PM_IMAGE_REVERSE_SIZE)
     {
-        for (PM_UInt32 j = 0; j < image->width; j++)
-        {
-            PM_Byte* pixelSrc = image->data + (i * image->width * image->numChannels) + (j * image->numChannels);
-            PM_Byte* pixelDst = newImage.data + (i * newImage.width * newImage.numChannels) + (j * newImage.numChannels);
+        const __m128i frontShuffle = _mm_loadu_si128((const __m128i*)reverse->front);
+        const __m128i backShuffle = _mm_loadu_si128((const __m128i*)reverse->back);
+        const __m128i frontKeep = _mm_loadu_si128((const __m128i*)reverse->frontKeep);
+        const __m128i backKeep = _mm_loadu_si128((const __m128i*)reverse->backKeep);
+        PM_Bool partial = blockSize != PM_IMAGE_REVERSE_SIZE;
+        PM_Size last = regionSize - PM_IMAGE_REVERSE_SIZE;
 
-            // Both RGB to BGR and BGR to RGB are the same operation.
-            if ( (image->channelFormat == PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGB && newImage.channelFormat == PICOMEDIA_IMAGE_CHANNEL_FORMAT_BGR)
-            || (image->channelFormat == PICOMEDIA_IMAGE_CHANNEL_FORMAT_BGR && newImage.channelFormat == PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGB))
+        __m128i x = _mm_loadu_si128((const __m128i*)front);
+        __m128i y = _mm_loadu_si128((const __m128i*)(back - PM_IMAGE_REVERSE_SIZE));
+
+        for (;;)
+        {
+            __m128i newFront = _mm_shuffle_epi8(y, frontShuffle);
+            __m128i newBack = _mm_shuffle_epi8(x, backShuffle);
+            if (partial)
             {
-                PM__ImageTransformsRGBToBGR(pixelSrc, pixelDst, channelSize);
+                newFront = _mm_or_si128(newFront, _mm_shuffle_epi8(x, frontKeep));
+                newBack = _mm_or_si128(newBack, _mm_shuffle_epi8(y, backKeep));
             }
-            else if ( (image->channelFormat == PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGBA && newImage.channelFormat == PICOMEDIA_IMAGE_CHANNEL_FORMAT_BGRA)
-            || (image->channelFormat == PICOMEDIA_IMAGE_CHANNEL_FORMAT_BGRA && newImage.channelFormat == PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGBA))
+
+            PM_Size offset = done;
+            done += blockSize;
+
+            PM_Bool more = done <= last;
+            if (more)
             {
-                PM__ImageTransformsRGBAToBGRA(pixelSrc, pixelDst, channelSize);
+                x = _mm_loadu_si128((const __m128i*)(front + done));
+                y = _mm_loadu_si128((const __m128i*)(back - done - PM_IMAGE_REVERSE_SIZE));
             }
-            else if ((image->channelFormat == PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGB && newImage.channelFormat == PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGBA)
-            || (image->channelFormat == PICOMEDIA_IMAGE_CHANNEL_FORMAT_BGR && newImage.channelFormat == PICOMEDIA_IMAGE_CHANNEL_FORMAT_BGRA))
+
+            _mm_storeu_si128((__m128i*)(front + offset), newFront);
+            _mm_storeu_si128((__m128i*)(back - offset - PM_IMAGE_REVERSE_SIZE), newBack);
+
+            if (!more)
             {
-                PM__ImageTransformsRGBToRGBA(pixelSrc, pixelDst, channelSize);
+                break;
             }
-            else if ((image->channelFormat == PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGBA && newImage.channelFormat == PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGB)
-            || (image->channelFormat == PICOMEDIA_IMAGE_CHANNEL_FORMAT_BGRA && newImage.channelFormat == PICOMEDIA_IMAGE_CHANNEL_FORMAT_BGR))
+        }
+    }
+
+    PM__ImageReverseScalar(reverse, front + done, back - done, pixelCount - done / reverse->pixelSize);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+#elif defined(PM_ARCH_ARM64)
+
+static void PM__ImageReverseNEON(const PM__ImageReverse* reverse, PM_Byte* front, PM_Byte* back, PM_Size pixelCount)
+{
+    PM_Size blockSize = reverse->blockSize;
+    PM_Size regionSize = pixelCount * reverse->pixelSize;
+    PM_Size done = 0;
+
+    if (blockSize > 0 && regionSize >= PM_IMAGE_REVERSE_SIZE)
+    {
+        const uint8x16_t frontShuffle = vld1q_u8(reverse->front);
+        const uint8x16_t backShuffle = vld1q_u8(reverse->back);
+        const uint8x16_t frontKeep = vld1q_u8(reverse->frontKeep);
+        const uint8x16_t backKeep = vld1q_u8(reverse->backKeep);
+        PM_Bool partial = blockSize != PM_IMAGE_REVERSE_SIZE;
+        PM_Size last = regionSize - PM_IMAGE_REVERSE_SIZE;
+        PM_UInt8* frontBytes = (PM_UInt8*)front;
+        PM_UInt8* backBytes = (PM_UInt8*)back;
+
+        uint8x16_t x = vld1q_u8(frontBytes);
+        uint8x16_t y = vld1q_u8(backBytes - PM_IMAGE_REVERSE_SIZE);
+
+        for (;;)
+        {
+            uint8x16_t newFront = vqtbl1q_u8(y, frontShuffle);
+            uint8x16_t newBack = vqtbl1q_u8(x, backShuffle);
+            if (partial)
             {
-                PM_Memcpy(pixelDst, pixelSrc, channelSize * 3);
+                newFront = vorrq_u8(newFront, vqtbl1q_u8(x, frontKeep));
+                newBack = vorrq_u8(newBack, vqtbl1q_u8(y, backKeep));
             }
-            else
+
+            PM_Size offset = done;
+            done += blockSize;
+
+            PM_Bool more = done <= last;
+            if (more)
             {
-                PM_LogError("Unsupported channel format conversion!");
-                PM_ImageDestroy(&newImage);
-                return PM_FALSE;
+                x = vld1q_u8(frontBytes + done);
+                y = vld1q_u8(backBytes - done - PM_IMAGE_REVERSE_SIZE);
             }
 
+            vst1q_u8(frontBytes + offset, newFront);
+            vst1q_u8(backBytes - offset - PM_IMAGE_REVERSE_SIZE, newBack);
+
+            if (!more)
+            {
+                break;
+            }
         }
     }
 
+    PM__ImageReverseScalar(reverse, front + done, back - done, pixelCount - done / reverse->pixelSize);
+}
+
+// -----------------------------------------------------------------------------------------------
 
-    if(! PM_ImageCopy(image, &newImage))
+#endif
+
+static PM__ImageReverseFunction PM_IMAGE_REVERSE_FUNCTION = PM__ImageReverseScalar;
+static volatile PM_Bool PM_IMAGE_REVERSE_FUNCTION_SELECTED = PM_FALSE;
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageSelectReverseFunction()
+{
+#if defined(PM_ARCH_X86)
+    if (PM_CPUHasFeature(PICOMEDIA_CPU_FEATURE_SSSE3))
     {
-        PM_LogError("Failed to copy image!");
-        PM_ImageDestroy(&newImage);
-        return PM_FALSE;
+        PM_IMAGE_REVERSE_FUNCTION = PM__ImageReverseSSSE3;
     }
+#elif defined(PM_ARCH_ARM64)
+    PM_IMAGE_REVERSE_FUNCTION = PM__ImageReverseNEON;
+#endif
 
-    PM_ImageDestroy(&newImage);
-
-    return PM_TRUE;
+    PM_IMAGE_REVERSE_FUNCTION_SELECTED = PM_TRUE;
 }
 
 // -----------------------------------------------------------------------------------------------
 
-PM_Bool PM_ImageTransformsChangeDataType(PM_Image* image, PM_UInt32 newDataType)
+static void PM__ImageFlipBandWorker(PM_Size begin, PM_Size end, void* data)
 {
-    PM_Assert(image != NULL);
+    const PM__ImageFlipBand* band = (const PM__ImageFlipBand*)data;
+    PM_Size rowSize = band->width * band->reverse->pixelSize;
 
-    if (image->dataType == newDataType)
+    for (PM_Size i = begin; i < end; i++)
     {
-        return PM_TRUE;
+        PM_Byte* row = band->data + i * rowSize;
+        PM_IMAGE_REVERSE_FUNCTION(band->reverse, row, row + rowSize, band->width / 2);
     }
+}
 
-    PM_Image newImage = {0};
-    PM_ImageInit(&newImage);
+// -----------------------------------------------------------------------------------------------
 
-    if(!PM_ImageAllocate(&newImage, image->width, image->height, image->channelFormat, newDataType, image->numChannels))
-    {
-        PM_LogError("Failed to allocate memory for new image!");
-        return PM_FALSE;
-    }
+static PM_Bool PM__ImageInitReverse(PM__ImageReverse* reverse, const PM_Image* image)
+{
+    reverse->pixelSize = image->bitsPerChannel / 8 * image->numChannels;
 
-    for (PM_UInt32 i = 0; i < image->height; i++)
+    if (reverse->pixelSize == 0 || reverse->pixelSize > PM_IMAGE_MAX_PIXEL_SIZE)
     {
-        for (PM_UInt32 j = 0; j < image->width; j++)
-        {
-            for (PM_UInt8 k = 0; k < image->numChannels; k++)
-            {
-                PM_ImageSetPixelValue(&newImage, j, i, k, PM_ImageGetPixelValue(image, j, i, k, NULL));
-            }
-        }
+        PM_LogError("Unsupported pixel size!");
+        return PM_FALSE;
     }
 
-    if (! PM_ImageCopy(image, &newImage))
+    if (!PM_IMAGE_REVERSE_FUNCTION_SELECTED)
     {
-        PM_LogError("Failed to copy image!");
-        PM_ImageDestroy(&newImage);
-        return PM_FALSE;
+        PM__ImageSelectReverseFunction();
     }
 
-    PM_ImageDestroy(&newImage);
-
+    PM__ImageBuildReverseShuffle(reverse);
     return PM_TRUE;
 }
 
@@ -171,24 +336,20 @@ PM_Bool PM_ImageTransformsFlipHorizontal(PM_Image* image)
 {
     PM_Assert(image != NULL);
 
-    PM_Size pixelSize = image->bitsPerChannel / 8 * image->numChannels;
-    static PM_Byte pixelBuffer[1024] = {0};
-
-    for (PM_UInt32 i = 0; i < image->height; i++)
+    PM__ImageReverse reverse;
+    if (!PM__ImageInitReverse(&reverse, image))
     {
-        PM_Byte* row = image->data + (i * image->width * pixelSize);
+        return PM_FALSE;
+    }
 
-        for (PM_UInt32 j = 0; j < image->width / 2; j++)
-        {
-            PM_Byte* pixel = row + (j * pixelSize);
-            PM_Byte* pixel2 = row + ((image->width - j - 1) * pixelSize);
+    // Rows are flipped independently, so they can be split in bands
+    PM__ImageFlipBand band;
+    band.reverse = &reverse;
+    band.data = image->data;
+    band.width = image->width;
 
-            PM_Memcpy(pixelBuffer, pixel, pixelSize);
-            PM_Memcpy(pixel, pixel2, pixelSize);
-            PM_Memcpy(pixel2, pixelBuffer, pixelSize);
-            
-        }
-    }
+    PM_Size grain = PM_Max(PM_IMAGE_FLIP_MIN_BAND_PIXELS / PM_Max((PM_Size)image->width, (PM_Size)1), (PM_Size)1);
+    PM_ParallelFor(NULL, 0, image->height, grain, PM__ImageFlipBandWorker, &band);
 
     return PM_TRUE;
 }
@@ -224,3 +385,574 @@ PM_Bool PM_ImageTransformsFlipVertical(PM_Image* image)
 }
 
 // -----------------------------------------------------------------------------------------------
+
+#define PM__IMAGE_DEFINE_TRANSPOSE(name, Type) \
+    static void PM__ImageTranspose##name(const PM_Byte* src, PM_Int64 srcStride, PM_Byte* dst, PM_Int64 dstStride, PM_Int64 dstStep, PM_Size width, PM_Size height) \
+    { \
+        for (PM_Size y = 0; y < height; y++, src += srcStride, dst += dstStep) \
+        { \
+            const Type* srcPixel = (const Type*)src; \
+            PM_Byte* dstPixel = dst; \
+            for (PM_Size x = 0; x < width; x++, dstPixel += dstStride) \
+            { \
+                *(Type*)dstPixel = srcPixel[x]; \
+            } \
+        } \
+    }
+
+PM__IMAGE_DEFINE_TRANSPOSE(U8, PM_UInt8)
+PM__IMAGE_DEFINE_TRANSPOSE(U16, PM_UInt16)
+PM__IMAGE_DEFINE_TRANSPOSE(U32, PM_UInt32)
+PM__IMAGE_DEFINE_TRANSPOSE(U64, PM_UInt64)
+PM__IMAGE_DEFINE_TRANSPOSE(Pixel3, PM__ImagePixel3)
+PM__IMAGE_DEFINE_TRANSPOSE(Pixel6, PM__ImagePixel6)
+PM__IMAGE_DEFINE_TRANSPOSE(Pixel12, PM__ImagePixel12)
+PM__IMAGE_DEFINE_TRANSPOSE(Pixel16, PM__ImagePixel16)
+PM__IMAGE_DEFINE_TRANSPOSE(Pixel24, PM__ImagePixel24)
+PM__IMAGE_DEFINE_TRANSPOSE(Pixel32, PM__ImagePixel32)
+
+// -----------------------------------------------------------------------------------------------
+
+// Vectorized forms transpose square blocks of pixels in registers, the destination rows of a block being
+// contiguous. When the destination columns are reversed the source rows of a block are read from the
+// last one, and the pixels past the last whole block are moved by the scalar forms.
+#define PM__IMAGE_DEFINE_TRANSPOSE_BLOCKS(name, target, Type, blockSize, block, edges) \
+    static target void PM__ImageTranspose##name(const PM_Byte* src, PM_Int64 srcStride, PM_Byte* dst, PM_Int64 dstStride, PM_Int64 dstStep, PM_Size width, PM_Size height) \
+    { \
+        PM_Size blockWidth = width / blockSize * blockSize; \
+        PM_Size blockHeight = height / blockSize * blockSize; \
+        PM_Int64 first = dstStep > 0 ? 0 : blockSize - 1; \
+        PM_Int64 blockStride = dstStep > 0 ? srcStride : -srcStride; \
+        for (PM_Size y = 0; y < blockHeight; y += blockSize) \
+        { \
+            const PM_Byte* srcRow = src + ((PM_Int64)y + first) * srcStride; \
+            PM_Byte* dstColumn = dst + ((PM_Int64)y + first) * dstStep; \
+            for (PM_Size x = 0; x < blockWidth; x += blockSize) \
+            { \
+                block(srcRow + x * sizeof(Type), blockStride, dstColumn + (PM_Int64)x * dstStride, dstStride); \
+            } \
+        } \
+        edges(src + blockWidth * sizeof(Type), srcStride, dst + (PM_Int64)blockWidth * dstStride, dstStride, dstStep, width - blockWidth, height); \
+        edges(src + (PM_Int64)blockHeight * srcStride, srcStride, dst + (PM_Int64)blockHeight * dstStep, dstStride, dstStep, blockWidth, height - blockHeight); \
+    }
+
+#if defined(PM_ARCH_X86)
+
+static PM_TARGET("sse2") void PM__ImageTransposeBlockU8SSE2(const PM_Byte* src, PM_Int64 srcStride, PM_Byte* dst, PM_Int64 dstStride)
+{
+    __m128i r0 = _mm_loadl_epi64((const __m128i*)(src));
+    __m128i r1 = _mm_loadl_epi64((const __m128i*)(src + srcStride));
+    __m128i r2 = _mm_loadl_epi64((const __m128i*)(src + 2 * srcStride));
+    __m128i r3 = _mm_loadl_epi64((const __m128i*)(src + 3 * srcStride));
+    __m128i r4 = _mm_loadl_epi64((const __m128i*)(src + 4 * srcStride));
+    __m128i r5 = _mm_loadl_epi64((const __m128i*)(src + 5 * srcStride));
+    __m128i r6 = _mm_loadl_epi64((const __m128i*)(src + 6 * srcStride));
+    __m128i r7 = _mm_loadl_epi64((const __m128i*)(src + 7 * srcStride));
+
+    // Pairs of rows, then quads of rows, then whole columns, two per register
+    __m128i a0 = _mm_unpacklo_epi8(r0, r1);
+    __m128i a1 = _mm_unpacklo_epi8(r2, r3);
+    __m128i a2 = _mm_unpacklo_epi8(r4, r5);
+    __m128i a3 = _mm_unpacklo_epi8(r6, r7);
+
+    __m128i b0 = _mm_unpacklo_epi16(a0, a1);
+    __m128i b1 = _mm_unpackhi_epi16(a0, a1);
+    __m128i b2 = _mm_unpacklo_epi16(a2, a3);
+    __m128i b3 = _mm_unpackhi_epi16(a2, a3);
+
+    __m128i c0 = _mm_unpacklo_epi32(b0, b2);
+    __m128i c1 = _mm_unpackhi_epi32(b0, b2);
+    __m128i c2 = _mm_unpacklo_epi32(b1, b3);
+    __m128i c3 = _mm_unpackhi_epi32(b1, b3);
+
+    _mm_storel_epi64((__m128i*)(dst), c0);
+    _mm_storel_epi64((__m128i*)(dst + dstStride), _mm_unpackhi_epi64(c0, c0));
+    _mm_storel_epi64((__m128i*)(dst + 2 * dstStride), c1);
+    _mm_storel_epi64((__m128i*)(dst + 3 * dstStride), _mm_unpackhi_epi64(c1, c1));
+    _mm_storel_epi64((__m128i*)(dst + 4 * dstStride), c2);
+    _mm_storel_epi64((__m128i*)(dst + 5 * dstStride), _mm_unpackhi_epi64(c2, c2));
+    _mm_storel_epi64((__m128i*)(dst + 6 * dstStride), c3);
+    _mm_storel_epi64((__m128i*)(dst + 7 * dstStride), _mm_unpackhi_epi64(c3, c3));
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("sse2") void PM__ImageTransposeBlockU16SSE2(const PM_Byte* src, PM_Int64 srcStride, PM_Byte* dst, PM_Int64 dstStride)
+{
+    __m128i r0 = _mm_loadu_si128((const __m128i*)(src));
+    __m128i r1 = _mm_loadu_si128((const __m128i*)(src + srcStride));
+    __m128i r2 = _mm_loadu_si128((const __m128i*)(src + 2 * srcStride));
+    __m128i r3 = _mm_loadu_si128((const __m128i*)(src + 3 * srcStride));
+    __m128i r4 = _mm_loadu_si128((const __m128i*)(src + 4 * srcStride));
+    __m128i r5 = _mm_loadu_si128((const __m128i*)(src + 5 * srcStride));
+    __m128i r6 = _mm_loadu_si128((const __m128i*)(src + 6 * srcStride));
+    __m128i r7 = _mm_loadu_si128((const __m128i*)(src + 7 * srcStride));
+
+    __m128i a0 = _mm_unpacklo_epi16(r0, r1);
+    __m128i a1 = _mm_unpackhi_epi16(r0, r1);
+    __m128i a2 = _mm_unpacklo_epi16(r2, r3);
+    __m128i a3 = _mm_unpackhi_epi16(r2, r3);
+    __m128i a4 = _mm_unpacklo_epi16(r4, r5);
+    __m128i a5 = _mm_unpackhi_epi16(r4, r5);
+    __m128i a6 = _mm_unpacklo_epi16(r6, r7);
+    __m128i a7 = _mm_unpackhi_epi16(r6, r7);
+
+    __m128i b0 = _mm_unpacklo_epi32(a0, a2);
+    __m128i b1 = _mm_unpackhi_epi32(a0, a2);
+    __m128i b2 = _mm_unpacklo_epi32(a1, a3);
+    __m128i b3 = _mm_unpackhi_epi32(a1, a3);
+    __m128i b4 = _mm_unpacklo_epi32(a4, a6);
+    __m128i b5 = _mm_unpackhi_epi32(a4, a6);
+    __m128i b6 = _mm_unpacklo_epi32(a5, a7);
+    __m128i b7 = _mm_unpackhi_epi32(a5, a7);
+
+    _mm_storeu_si128((__m128i*)(dst), _mm_unpacklo_epi64(b0, b4));
+    _mm_storeu_si128((__m128i*)(dst + dstStride), _mm_unpackhi_epi64(b0, b4));
+    _mm_storeu_si128((__m128i*)(dst + 2 * dstStride), _mm_unpacklo_epi64(b1, b5));
+    _mm_storeu_si128((__m128i*)(dst + 3 * dstStride), _mm_unpackhi_epi64(b1, b5));
+    _mm_storeu_si128((__m128i*)(dst + 4 * dstStride), _mm_unpacklo_epi64(b2, b6));
+    _mm_storeu_si128((__m128i*)(dst + 5 * dstStride), _mm_unpackhi_epi64(b2, b6));
+    _mm_storeu_si128((__m128i*)(dst + 6 * dstStride), _mm_unpacklo_epi64(b3, b7));
+    _mm_storeu_si128((__m128i*)(dst + 7 * dstStride), _mm_unpackhi_epi64(b3, b7));
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("sse2") void PM__ImageTransposeBlockU32SSE2(const PM_Byte* src, PM_Int64 srcStride, PM_Byte* dst, PM_Int64 dstStride)
+{
+    __m128i r0 = _mm_loadu_si128((const __m128i*)(src));
+    __m128i r1 = _mm_loadu_si128((const __m128i*)(src + srcStride));
+    __m128i r2 = _mm_loadu_si128((const __m128i*)(src + 2 * srcStride));
+    __m128i r3 = _mm_loadu_si128((const __m128i*)(src + 3 * srcStride));
+
+    __m128i a0 = _mm_unpacklo_epi32(r0, r1);
+    __m128i a1 = _mm_unpackhi_epi32(r0, r1);
+    __m128i a2 = _mm_unpacklo_epi32(r2, r3);
+    __m128i a3 = _mm_unpackhi_epi32(r2, r3);
+
+    _mm_storeu_si128((__m128i*)(dst), _mm_unpacklo_epi64(a0, a2));
+    _mm_storeu_si128((__m128i*)(dst + dstStride), _mm_unpackhi_epi64(a0, a2));
+    _mm_storeu_si128((__m128i*)(dst + 2 * dstStride), _mm_unpacklo_epi64(a1, a3));
+    _mm_storeu_si128((__m128i*)(dst + 3 * dstStride), _mm_unpackhi_epi64(a1, a3));
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("sse2") void PM__ImageTransposeBlockU64SSE2(const PM_Byte* src, PM_Int64 srcStride, PM_Byte* dst, PM_Int64 dstStride)
+{
+    __m128i r0 = _mm_loadu_si128((const __m128i*)(src));
+    __m128i r1 = _mm_loadu_si128((const __m128i*)(src + srcStride));
+
+    _mm_storeu_si128((__m128i*)(dst), _mm_unpacklo_epi64(r0, r1));
+    _mm_storeu_si128((__m128i*)(dst + dstStride), _mm_unpackhi_epi64(r0, r1));
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM__IMAGE_DEFINE_TRANSPOSE_BLOCKS(U8SSE2, PM_TARGET("sse2"), PM_UInt8, 8, PM__ImageTransposeBlockU8SSE2, PM__ImageTransposeU8)
+PM__IMAGE_DEFINE_TRANSPOSE_BLOCKS(U16SSE2, PM_TARGET("sse2"), PM_UInt16, 8, PM__ImageTransposeBlockU16SSE2, PM__ImageTransposeU16)
+PM__IMAGE_DEFINE_TRANSPOSE_BLOCKS(U32SSE2, PM_TARGET("sse2"), PM_UInt32, 4, PM__ImageTransposeBlockU32SSE2, PM__ImageTransposeU32)
+PM__IMAGE_DEFINE_TRANSPOSE_BLOCKS(U64SSE2, PM_TARGET("sse2"), PM_UInt64, 2, PM__ImageTransposeBlockU64SSE2, PM__ImageTransposeU64)
+
+// -----------------------------------------------------------------------------------------------
+
+#elif defined(PM_ARCH_ARM64)
+
+static void PM__ImageTransposeBlockU8NEON(const PM_Byte* src, PM_Int64 srcStride, PM_Byte* dst, PM_Int64 dstStride)
+{
+    const PM_UInt8* srcBytes = (const PM_UInt8*)src;
+    PM_UInt8* dstBytes = (PM_UInt8*)dst;
+
+    uint8x8_t r0 = vld1_u8(srcBytes);
+    uint8x8_t r1 = vld1_u8(srcBytes + srcStride);
+    uint8x8_t r2 = vld1_u8(srcBytes + 2 * srcStride);
+    uint8x8_t r3 = vld1_u8(srcBytes + 3 * srcStride);
+    uint8x8_t r4 = vld1_u8(srcBytes + 4 * srcStride);
+    uint8x8_t r5 = vld1_u8(srcBytes + 5 * srcStride);
+    uint8x8_t r6 = vld1_u8(srcBytes + 6 * srcStride);
+    uint8x8_t r7 = vld1_u8(srcBytes + 7 * srcStride);
+
+    // Transposes 1x1, then 2x2, then 4x4 sub-blocks
+    uint8x8x2_t a01 = vtrn_u8(r0, r1);
+    uint8x8x2_t a23 = vtrn_u8(r2, r3);
+    uint8x8x2_t a45 = vtrn_u8(r4, r5);
+    uint8x8x2_t a67 = vtrn_u8(r6, r7);
+
+    uint16x4x2_t b02 = vtrn_u16(vreinterpret_u16_u8(a01.val[0]), vreinterpret_u16_u8(a23.val[0]));
+    uint16x4x2_t b13 = vtrn_u16(vreinterpret_u16_u8(a01.val[1]), vreinterpret_u16_u8(a23.val[1]));
+    uint16x4x2_t b46 = vtrn_u16(vreinterpret_u16_u8(a45.val[0]), vreinterpret_u16_u8(a67.val[0]));
+    uint16x4x2_t b57 = vtrn_u16(vreinterpret_u16_u8(a45.val[1]), vreinterpret_u16_u8(a67.val[1]));
+
+    uint32x2x2_t c04 = vtrn_u32(vreinterpret_u32_u16(b02.val[0]), vreinterpret_u32_u16(b46.val[0]));
+    uint32x2x2_t c26 = vtrn_u32(vreinterpret_u32_u16(b02.val[1]), vreinterpret_u32_u16(b46.val[1]));
+    uint32x2x2_t c15 = vtrn_u32(vreinterpret_u32_u16(b13.val[0]), vreinterpret_u32_u16(b57.val[0]));
+    uint32x2x2_t c37 = vtrn_u32(vreinterpret_u32_u16(b13.val[1]), vreinterpret_u32_u16(b57.val[1]));
+
+    vst1_u8(dstBytes, vreinterpret_u8_u32(c04.val[0]));
+    vst1_u8(dstBytes + dstStride, vreinterpret_u8_u32(c15.val[0]));
+    vst1_u8(dstBytes + 2 * dstStride, vreinterpret_u8_u32(c26.val[0]));
+    vst1_u8(dstBytes + 3 * dstStride, vreinterpret_u8_u32(c37.val[0]));
+    vst1_u8(dstBytes + 4 * dstStride, vreinterpret_u8_u32(c04.val[1]));
+    vst1_u8(dstBytes + 5 * dstStride, vreinterpret_u8_u32(c15.val[1]));
+    vst1_u8(dstBytes + 6 * dstStride, vreinterpret_u8_u32(c26.val[1]));
+    vst1_u8(dstBytes + 7 * dstStride, vreinterpret_u8_u32(c37.val[1]));
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageTransposeBlockU16NEON(const PM_Byte* src, PM_Int64 srcStride, PM_Byte* dst, PM_Int64 dstStride)
+{
+    uint16x8_t r0 = vld1q_u16((const PM_UInt16*)(src));
+    uint16x8_t r1 = vld1q_u16((const PM_UInt16*)(src + srcStride));
+    uint16x8_t r2 = vld1q_u16((const PM_UInt16*)(src + 2 * srcStride));
+    uint16x8_t r3 = vld1q_u16((const PM_UInt16*)(src + 3 * srcStride));
+    uint16x8_t r4 = vld1q_u16((const PM_UInt16*)(src + 4 * srcStride));
+    uint16x8_t r5 = vld1q_u16((const PM_UInt16*)(src + 5 * srcStride));
+    uint16x8_t r6 = vld1q_u16((const PM_UInt16*)(src + 6 * srcStride));
+    uint16x8_t r7 = vld1q_u16((const PM_UInt16*)(src + 7 * srcStride));
+
+    uint16x8x2_t a01 = vtrnq_u16(r0, r1);
+    uint16x8x2_t a23 = vtrnq_u16(r2, r3);
+    uint16x8x2_t a45 = vtrnq_u16(r4, r5);
+    uint16x8x2_t a67 = vtrnq_u16(r6, r7);
+
+    // Columns 0 and 4, 2 and 6, 1 and 5, then 3 and 7, of the top and bottom halves
+    uint32x4x2_t b02 = vtrnq_u32(vreinterpretq_u32_u16(a01.val[0]), vreinterpretq_u32_u16(a23.val[0]));
+    uint32x4x2_t b13 = vtrnq_u32(vreinterpretq_u32_u16(a01.val[1]), vreinterpretq_u32_u16(a23.val[1]));
+    uint32x4x2_t b46 = vtrnq_u32(vreinterpretq_u32_u16(a45.val[0]), vreinterpretq_u32_u16(a67.val[0]));
+    uint32x4x2_t b57 = vtrnq_u32(vreinterpretq_u32_u16(a45.val[1]), vreinterpretq_u32_u16(a67.val[1]));
+
+    vst1q_u16((PM_UInt16*)(dst), vreinterpretq_u16_u32(vcombine_u32(vget_low_u32(b02.val[0]), vget_low_u32(b46.val[0]))));
+    vst1q_u16((PM_UInt16*)(dst + dstStride), vreinterpretq_u16_u32(vcombine_u32(vget_low_u32(b13.val[0]), vget_low_u32(b57.val[0]))));
+    vst1q_u16((PM_UInt16*)(dst + 2 * dstStride), vreinterpretq_u16_u32(vcombine_u32(vget_low_u32(b02.val[1]), vget_low_u32(b46.val[1]))));
+    vst1q_u16((PM_UInt16*)(dst + 3 * dstStride), vreinterpretq_u16_u32(vcombine_u32(vget_low_u32(b13.val[1]), vget_low_u32(b57.val[1]))));
+    vst1q_u16((PM_UInt16*)(dst + 4 * dstStride), vreinterpretq_u16_u32(vcombine_u32(vget_high_u32(b02.val[0]), vget_high_u32(b46.val[0]))));
+    vst1q_u16((PM_UInt16*)(dst + 5 * dstStride), vreinterpretq_u16_u32(vcombine_u32(vget_high_u32(b13.val[0]), vget_high_u32(b57.val[0]))));
+    vst1q_u16((PM_UInt16*)(dst + 6 * dstStride), vreinterpretq_u16_u32(vcombine_u32(vget_high_u32(b02.val[1]), vget_high_u32(b46.val[1]))));
+    vst1q_u16((PM_UInt16*)(dst + 7 * dstStride), vreinterpretq_u16_u32(vcombine_u32(vget_high_u32(b13.val[1]), vget_high_u32(b57.val[1]))));
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageTransposeBlockU32NEON(const PM_Byte* src, PM_Int64 srcStride, PM_Byte* dst, PM_Int64 dstStride)
+{
+    uint32x4_t r0 = vld1q_u32((const PM_UInt32*)(src));
+    uint32x4_t r1 = vld1q_u32((const PM_UInt32*)(src + srcStride));
+    uint32x4_t r2 = vld1q_u32((const PM_UInt32*)(src + 2 * srcStride));
+    uint32x4_t r3 = vld1q_u32((const PM_UInt32*)(src + 3 * srcStride));
+
+    uint32x4x2_t a01 = vtrnq_u32(r0, r1);
+    uint32x4x2_t a23 = vtrnq_u32(r2, r3);
+
+    vst1q_u32((PM_UInt32*)(dst), vcombine_u32(vget_low_u32(a01.val[0]), vget_low_u32(a23.val[0])));
+    vst1q_u32((PM_UInt32*)(dst + dstStride), vcombine_u32(vget_low_u32(a01.val[1]), vget_low_u32(a23.val[1])));
+    vst1q_u32((PM_UInt32*)(dst + 2 * dstStride), vcombine_u32(vget_high_u32(a01.val[0]), vget_high_u32(a23.val[0])));
+    vst1q_u32((PM_UInt32*)(dst + 3 * dstStride), vcombine_u32(vget_high_u32(a01.val[1]), vget_high_u32(a23.val[1])));
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageTransposeBlockU64NEON(const PM_Byte* src, PM_Int64 srcStride, PM_Byte* dst, PM_Int64 dstStride)
+{
+    uint64x2_t r0 = vld1q_u64((const PM_UInt64*)(src));
+    uint64x2_t r1 = vld1q_u64((const PM_UInt64*)(src + srcStride));
+
+    vst1q_u64((PM_UInt64*)(dst), vcombine_u64(vget_low_u64(r0), vget_low_u64(r1)));
+    vst1q_u64((PM_UInt64*)(dst + dstStride), vcombine_u64(vget_high_u64(r0), vget_high_u64(r1)));
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM__IMAGE_DEFINE_TRANSPOSE_BLOCKS(U8NEON, , PM_UInt8, 8, PM__ImageTransposeBlockU8NEON, PM__ImageTransposeU8)
+PM__IMAGE_DEFINE_TRANSPOSE_BLOCKS(U16NEON, , PM_UInt16, 8, PM__ImageTransposeBlockU16NEON, PM__ImageTransposeU16)
+PM__IMAGE_DEFINE_TRANSPOSE_BLOCKS(U32NEON, , PM_UInt32, 4, PM__ImageTransposeBlockU32NEON, PM__ImageTransposeU32)
+PM__IMAGE_DEFINE_TRANSPOSE_BLOCKS(U64NEON, , PM_UInt64, 2, PM__ImageTransposeBlockU64NEON, PM__ImageTransposeU64)
+
+// -----------------------------------------------------------------------------------------------
+
+#endif
+
+// Pixels of 1, 2, 4 and 8 bytes
+static PM__ImageTransposeFunction PM_IMAGE_TRANSPOSE_FUNCTIONS[4] =
+{
+    PM__ImageTransposeU8,
+    PM__ImageTransposeU16,
+    PM__ImageTransposeU32,
+    PM__ImageTransposeU64
+};
+static volatile PM_Bool PM_IMAGE_TRANSPOSE_FUNCTIONS_SELECTED = PM_FALSE;
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageSelectTransposeFunctions()
+{
+#if defined(PM_ARCH_X86)
+    if (PM_CPUHasFeature(PICOMEDIA_CPU_FEATURE_SSE2))
+    {
+        PM_IMAGE_TRANSPOSE_FUNCTIONS[0] = PM__ImageTransposeU8SSE2;
+        PM_IMAGE_TRANSPOSE_FUNCTIONS[1] = PM__ImageTransposeU16SSE2;
+        PM_IMAGE_TRANSPOSE_FUNCTIONS[2] = PM__ImageTransposeU32SSE2;
+        PM_IMAGE_TRANSPOSE_FUNCTIONS[3] = PM__ImageTransposeU64SSE2;
+    }
+#elif defined(PM_ARCH_ARM64)
+    PM_IMAGE_TRANSPOSE_FUNCTIONS[0] = PM__ImageTransposeU8NEON;
+    PM_IMAGE_TRANSPOSE_FUNCTIONS[1] = PM__ImageTransposeU16NEON;
+    PM_IMAGE_TRANSPOSE_FUNCTIONS[2] = PM__ImageTransposeU32NEON;
+    PM_IMAGE_TRANSPOSE_FUNCTIONS[3] = PM__ImageTransposeU64NEON;
+#endif
+
+    PM_IMAGE_TRANSPOSE_FUNCTIONS_SELECTED = PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM__ImageTransposeFunction PM__ImageGetTransposeFunction(PM_Size pixelSize)
+{
+    if (!PM_IMAGE_TRANSPOSE_FUNCTIONS_SELECTED)
+    {
+        PM__ImageSelectTransposeFunctions();
+    }
+
+    switch (pixelSize)
+    {
+    case 1:
+        return PM_IMAGE_TRANSPOSE_FUNCTIONS[0];
+    case 2:
+        return PM_IMAGE_TRANSPOSE_FUNCTIONS[1];
+    case 3:
+        return PM__ImageTransposePixel3;
+    case 4:
+        return PM_IMAGE_TRANSPOSE_FUNCTIONS[2];
+    case 6:
+        return PM__ImageTransposePixel6;
+    case 8:
+        return PM_IMAGE_TRANSPOSE_FUNCTIONS[3];
+    case 12:
+        return PM__ImageTransposePixel12;
+    case 16:
+        return PM__ImageTransposePixel16;
+    case 24:
+        return PM__ImageTransposePixel24;
+    case 32:
+        return PM__ImageTransposePixel32;
+    default:
+        return NULL;
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Transposes a band of tile rows, each tile going through a buffer so the destination is written by
+// contiguous row segments
+static void PM__ImageTransposeBandWorker(PM_Size begin, PM_Size end, void* data)
+{
+    const PM__ImageTransposeBand* band = (const PM__ImageTransposeBand*)data;
+    PM_Size pixelSize = band->pixelSize;
+    PM_Size tileSize = band->tileSize;
+    PM_Int64 srcStride = (PM_Int64)(band->width * pixelSize);
+    PM_Bool reversed = band->dstStep < 0;
+    PM_UInt64 buffer[PM_IMAGE_TRANSPOSE_TILE_BYTES / sizeof(PM_UInt64)];
+    PM_Byte* tile = (PM_Byte*)buffer;
+
+    for (PM_Size i = begin; i < end; i++)
+    {
+        PM_Size y = i * tileSize;
+        PM_Size tileHeight = PM_Min(tileSize, band->height - y);
+        PM_Size tileRowSize = tileHeight * pixelSize;
+
+        // Leftmost destination pixel of the first tile row
+        PM_Byte* dst = band->dst + (PM_Int64)(reversed ? y + tileHeight - 1 : y) * band->dstStep;
+        PM_Byte* tileDst = tile + (reversed ? tileRowSize - pixelSize : 0);
+
+        for (PM_Size x = 0; x < band->width; x += tileSize)
+        {
+            PM_Size tileWidth = PM_Min(tileSize, band->width - x);
+            const PM_Byte* src = band->src + (PM_Int64)y * srcStride + x * pixelSize;
+
+            band->transpose(src, srcStride, tileDst, (PM_Int64)tileRowSize, band->dstStep, tileWidth, tileHeight);
+
+            for (PM_Size row = 0; row < tileWidth; row++)
+            {
+                PM_Memcpy(dst + (PM_Int64)(x + row) * band->dstStride, tile + row * tileRowSize, tileRowSize);
+            }
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Transposes a square image in place, a band of tile rows swapping each of its tiles on or right of the
+// diagonal with the mirrored one, through a buffer
+static void PM__ImageTransposeSquareBandWorker(PM_Size begin, PM_Size end, void* data)
+{
+    const PM__ImageTransposeBand* band = (const PM__ImageTransposeBand*)data;
+    PM_Size pixelSize = band->pixelSize;
+    PM_Size tileSize = band->tileSize;
+    PM_Size size = band->width;
+    PM_Int64 stride = (PM_Int64)(size * pixelSize);
+    PM_UInt64 buffer[PM_IMAGE_TRANSPOSE_TILE_BYTES / sizeof(PM_UInt64)];
+    PM_Byte* tile = (PM_Byte*)buffer;
+
+    for (PM_Size i = begin; i < end; i++)
+    {
+        PM_Size y = i * tileSize;
+        PM_Size tileHeight = PM_Min(tileSize, size - y);
+
+        for (PM_Size x = y; x < size; x += tileSize)
+        {
+            PM_Size tileWidth = PM_Min(tileSize, size - x);
+            PM_Size tileRowSize = tileHeight * pixelSize;
+            PM_Byte* a = band->dst + (PM_Int64)y * stride + x * pixelSize;
+            PM_Byte* b = band->dst + (PM_Int64)x * stride + y * pixelSize;
+
+            band->transpose(a, stride, tile, (PM_Int64)tileRowSize, (PM_Int64)pixelSize, tileWidth, tileHeight);
+            if (a != b)
+            {
+                band->transpose(b, stride, a, stride, (PM_Int64)pixelSize, tileHeight, tileWidth);
+            }
+
+            for (PM_Size row = 0; row < tileWidth; row++)
+            {
+                PM_Memcpy(b + (PM_Int64)row * stride, tile + row * tileRowSize, tileRowSize);
+            }
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Moves the source column x to the destination row x and the source row y to the destination column y,
+// reversing the order of the destination rows or columns when asked
+static PM_Bool PM__ImageTranspose(PM_Image* image, PM_Bool flipRows, PM_Bool flipColumns)
+{
+    PM_Assert(image != NULL);
+
+    PM__ImageTransposeBand band;
+    band.pixelSize = image->bitsPerChannel / 8 * image->numChannels;
+    band.transpose = PM__ImageGetTransposeFunction(band.pixelSize);
+
+    if (band.transpose == NULL)
+    {
+        PM_LogError("Unsupported pixel size!");
+        return PM_FALSE;
+    }
+
+    if (image->width == 0 || image->height == 0)
+    {
+        PM_UInt32 width = image->width;
+        image->width = image->height;
+        image->height = width;
+        return PM_TRUE;
+    }
+
+    band.width = image->width;
+    band.height = image->height;
+    band.tileSize = PM_IMAGE_TRANSPOSE_MAX_TILE_SIZE;
+    while (band.tileSize * band.tileSize * band.pixelSize > PM_IMAGE_TRANSPOSE_TILE_BYTES)
+    {
+        band.tileSize /= 2;
+    }
+
+    PM_Size tileRows = (band.height + band.tileSize - 1) / band.tileSize;
+
+    // Square images keep their size, so they are transposed in place and then flipped
+    if (image->width == image->height)
+    {
+        band.src = image->data;
+        band.dst = image->data;
+        band.dstStride = (PM_Int64)(band.width * band.pixelSize);
+        band.dstStep = (PM_Int64)band.pixelSize;
+
+        PM_ParallelFor(NULL, 0, tileRows, 1, PM__ImageTransposeSquareBandWorker, &band);
+
+        if (flipRows && !PM_ImageTransformsFlipVertical(image))
+        {
+            return PM_FALSE;
+        }
+
+        return flipColumns ? PM_ImageTransformsFlipHorizontal(image) : PM_TRUE;
+    }
+
+    PM_Size dataSize = band.width * band.height * band.pixelSize;
+    PM_Byte* data = (PM_Byte*)PM_Malloc(dataSize);
+
+    if (data == NULL)
+    {
+        PM_LogError("Failed to allocate memory for the transposed image!");
+        return PM_FALSE;
+    }
+
+    PM_Int64 dstRowSize = (PM_Int64)(band.height * band.pixelSize);
+    band.src = image->data;
+    band.dst = data + (flipRows ? (PM_Int64)(band.width - 1) * dstRowSize : 0) + (flipColumns ? (band.height - 1) * band.pixelSize : 0);
+    band.dstStride = flipRows ? -dstRowSize : dstRowSize;
+    band.dstStep = flipColumns ? -(PM_Int64)band.pixelSize : (PM_Int64)band.pixelSize;
+
+    PM_ParallelFor(NULL, 0, tileRows, 1, PM__ImageTransposeBandWorker, &band);
+
+    PM_Free(image->data);
+    image->data = data;
+    image->dataCapacity = dataSize;
+    image->width = (PM_UInt32)band.height;
+    image->height = (PM_UInt32)band.width;
+
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PM_ImageTransformsTranspose(PM_Image* image)
+{
+    return PM__ImageTranspose(image, PM_FALSE, PM_FALSE);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PM_ImageTransformsRotate90(PM_Image* image)
+{
+    return PM__ImageTranspose(image, PM_FALSE, PM_TRUE);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageRotate180BandWorker(PM_Size begin, PM_Size end, void* data)
+{
+    const PM__ImageFlipBand* band = (const PM__ImageFlipBand*)data;
+    PM_Size pixelSize = band->reverse->pixelSize;
+    PM_Byte* back = band->data + band->width * pixelSize;
+
+    PM_IMAGE_REVERSE_FUNCTION(band->reverse, band->data + begin * pixelSize, back - begin * pixelSize, end - begin);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PM_ImageTransformsRotate180(PM_Image* image)
+{
+    PM_Assert(image != NULL);
+
+    PM__ImageReverse reverse;
+    if (!PM__ImageInitReverse(&reverse, image))
+    {
+        return PM_FALSE;
+    }
+
+    // A half turn reverses the order of all the pixels, as if the image was a single row, so the pixels of the
+    // first half are swapped with the mirrored ones of the second half in bands
+    PM__ImageFlipBand band;
+    band.reverse = &reverse;
+    band.data = image->data;
+    band.width = (PM_Size)image->width * image->height;
+
+    PM_ParallelFor(NULL, 0, band.width / 2, PM_IMAGE_FLIP_MIN_BAND_PIXELS, PM__ImageRotate180BandWorker, &band);
+
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PM_ImageTransformsRotate270(PM_Image* image)
+{
+    return PM__ImageTranspose(image, PM_TRUE, PM_FALSE);
+}
+
+// -----------------------------------------------------------------------------------------------
@@ -0,0 +1,1509 @@
+#include "libpicomedia/image/image_transforms.h"
+#include "libpicomedia/common/cpu.h"
+
+#if defined(PM_ARCH_X86)
+    #include <immintrin.h>
+#elif defined(PM_ARCH_ARM64)
+    #include <arm_neon.h>
+#endif
+
+// Meaning of each channel of a channel format
+#define PM_IMAGE_CHANNEL_RED    0
+#define PM_IMAGE_CHANNEL_GREEN  1
+#define PM_IMAGE_CHANNEL_BLUE   2
+#define PM_IMAGE_CHANNEL_ALPHA  3
+#define PM_IMAGE_CHANNEL_GRAY   4
+
+#define PM_IMAGE_MAX_CHANNELS 4
+
+// Channel map entry of a destination channel that is set to fully opaque instead of being copied
+#define PM_IMAGE_CHANNEL_OPAQUE -1
+
+// Number of bytes shuffled at once by the vectorized permutations
+#define PM_IMAGE_SHUFFLE_SIZE 16
+
+// Smallest number of pixels converted by a single task
+#define PM_IMAGE_CHANNEL_MIN_BAND_PIXELS (1 << 15)
+
+// Bands of pixels per thread when converting to gray, a few more than threads to balance the load
+#define PM_IMAGE_CHANNEL_BANDS_PER_THREAD 4
+
+// Moves the channels of every pixel around, the conversion runs in place
+typedef struct PM__ImagePermute
+{
+    PM_Size channelSize;
+    PM_Size srcPixelSize;
+    PM_Size dstPixelSize;
+    PM_UInt8 dstChannels;
+    PM_Int8 map[PM_IMAGE_MAX_CHANNELS];         // Source channel of each destination channel, or PM_IMAGE_CHANNEL_OPAQUE
+    PM_Byte opaque[8];                          // Value of a fully opaque alpha channel for the data type
+
+    // Vectorized form, valid when blockPixels is not 0
+    PM_Size blockPixels;                        // Pixels converted by one shuffle
+    PM_UInt8 shuffle[PM_IMAGE_SHUFFLE_SIZE];    // Source byte of each destination byte, 0x80 for a zero
+    PM_UInt8 fill[PM_IMAGE_SHUFFLE_SIZE];       // Or-ed into the shuffled bytes, sets the opaque alpha channels
+} PM__ImagePermute;
+
+// Weighted sum of the red, green and blue channels into a gray channel, optionally followed by an alpha channel
+typedef struct PM__ImageLuma
+{
+    PM_Size srcChannels;
+    PM_Size dstChannels;
+    PM_Size red;
+    PM_Size green;
+    PM_Size blue;
+    PM_Int8 alpha;              // Source channel of the alpha channel, or PM_IMAGE_CHANNEL_OPAQUE
+    PM_Byte opaque[8];
+    PM_UInt32 weights8[3];      // Red, green and blue weights in fixed point with 8 fractional bits
+    PM_UInt32 weights16[3];     // Same with 16 fractional bits
+    PM_Float64 weights[3];
+} PM__ImageLuma;
+
+// Multiplies or divides the color channels of every pixel by its alpha channel, the conversion runs in place
+typedef struct PM__ImageAlpha
+{
+    PM_Size channels;
+    PM_Size alpha;
+
+    // Vectorized form, for as many pixels as fit in PM_IMAGE_SHUFFLE_SIZE bytes
+    PM_UInt8 broadcast[PM_IMAGE_SHUFFLE_SIZE];  // Alpha byte of the pixel of each byte
+    PM_UInt8 alphaMask[PM_IMAGE_SHUFFLE_SIZE];  // 0xFF on the bytes of the alpha channel
+} PM__ImageAlpha;
+
+typedef void (*PM__ImagePermuteFunction)(const PM__ImagePermute* permute, PM_Byte* data, PM_Size pixelCount);
+typedef void (*PM__ImageLumaFunction)(const PM__ImageLuma* luma, const PM_Byte* src, PM_Byte* dst, PM_Size pixelCount);
+typedef void (*PM__ImageAlphaFunction)(const PM__ImageAlpha* alpha, PM_Byte* data, PM_Size pixelCount);
+
+typedef struct PM__ImagePermuteBand
+{
+    const PM__ImagePermute* permute;
+    PM_Byte* data;
+    PM_Size pixelsPerRow;
+} PM__ImagePermuteBand;
+
+typedef struct PM__ImageAlphaBand
+{
+    const PM__ImageAlpha* alpha;
+    PM__ImageAlphaFunction function;
+    PM_Byte* data;
+    PM_Size pixelsPerRow;
+    PM_Size pixelSize;
+} PM__ImageAlphaBand;
+
+typedef struct PM__ImageLumaBand
+{
+    const PM__ImageLuma* luma;
+    PM__ImageLumaFunction function;
+    PM_Byte* data;
+    PM_Size srcPixelSize;
+    PM_Size bandPixels;
+    PM_Size pixelCount;
+} PM__ImageLumaBand;
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_UInt8 PM__ImageGetChannelLayout(PM_UInt32 channelFormat, PM_UInt8 layout[PM_IMAGE_MAX_CHANNELS])
+{
+    switch (channelFormat)
+    {
+    case PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGB:
+        layout[0] = PM_IMAGE_CHANNEL_RED; layout[1] = PM_IMAGE_CHANNEL_GREEN; layout[2] = PM_IMAGE_CHANNEL_BLUE;
+        return 3;
+    case PICOMEDIA_IMAGE_CHANNEL_FORMAT_BGR:
+        layout[0] = PM_IMAGE_CHANNEL_BLUE; layout[1] = PM_IMAGE_CHANNEL_GREEN; layout[2] = PM_IMAGE_CHANNEL_RED;
+        return 3;
+    case PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGBA:
+        layout[0] = PM_IMAGE_CHANNEL_RED; layout[1] = PM_IMAGE_CHANNEL_GREEN; layout[2] = PM_IMAGE_CHANNEL_BLUE; layout[3] = PM_IMAGE_CHANNEL_ALPHA;
+        return 4;
+    case PICOMEDIA_IMAGE_CHANNEL_FORMAT_BGRA:
+        layout[0] = PM_IMAGE_CHANNEL_BLUE; layout[1] = PM_IMAGE_CHANNEL_GREEN; layout[2] = PM_IMAGE_CHANNEL_RED; layout[3] = PM_IMAGE_CHANNEL_ALPHA;
+        return 4;
+    case PICOMEDIA_IMAGE_CHANNEL_FORMAT_GRAY:
+        layout[0] = PM_IMAGE_CHANNEL_GRAY;
+        return 1;
+    case PICOMEDIA_IMAGE_CHANNEL_FORMAT_GRAYA:
+        layout[0] = PM_IMAGE_CHANNEL_GRAY; layout[1] = PM_IMAGE_CHANNEL_ALPHA;
+        return 2;
+    default:
+        return 0;
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Int8 PM__ImageFindChannel(const PM_UInt8* layout, PM_UInt8 channelCount, PM_UInt8 channel)
+{
+    for (PM_UInt8 i = 0; i < channelCount; i++)
+    {
+        if (layout[i] == channel)
+        {
+            return (PM_Int8)i;
+        }
+    }
+    return -2;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Bool PM__ImageGetOpaqueValue(PM_UInt32 dataType, PM_Byte value[8])
+{
+    PM_Float32 one32 = 1.0f;
+    PM_Float64 one64 = 1.0;
+
+    switch (dataType)
+    {
+    case PICOIMEDIA_IMAGE_DATA_TYPE_UINT8:
+    case PICOIMEDIA_IMAGE_DATA_TYPE_UINT16:
+    case PICOIMEDIA_IMAGE_DATA_TYPE_UINT32:
+    case PICOIMEDIA_IMAGE_DATA_TYPE_UINT64:
+        PM_Memset(value, 0xFF, 8);
+        return PM_TRUE;
+    case PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT32:
+        PM_Memcpy(value, &one32, sizeof(one32));
+        return PM_TRUE;
+    case PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT64:
+        PM_Memcpy(value, &one64, sizeof(one64));
+        return PM_TRUE;
+    default:
+        return PM_FALSE;
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Builds the byte shuffle converting blockPixels pixels at once, the bytes of the register past the
+// converted pixels must be left as they are when the pixel size does not change, must be the final
+// value of the next pixel when expanding back to front, and can be anything when shrinking.
+static void PM__ImageBuildPermuteShuffle(PM__ImagePermute* permute)
+{
+    PM_Size srcPixelSize = permute->srcPixelSize;
+    PM_Size dstPixelSize = permute->dstPixelSize;
+    PM_Size blockPixels = PM_IMAGE_SHUFFLE_SIZE / PM_Max(srcPixelSize, dstPixelSize);
+
+    permute->blockPixels = 0;
+
+    if (blockPixels == 0 || permute->channelSize > 4)
+    {
+        return;
+    }
+
+    // Shrinking forward writes garbage up to the end of the register, it has to stay behind what is left to read
+    if (dstPixelSize < srcPixelSize && blockPixels * srcPixelSize < PM_IMAGE_SHUFFLE_SIZE)
+    {
+        return;
+    }
+
+    for (PM_Size i = 0; i < PM_IMAGE_SHUFFLE_SIZE; i++)
+    {
+        PM_Size pixel = i / dstPixelSize;
+        PM_Size channel = (i % dstPixelSize) / permute->channelSize;
+        PM_Size byte = i % permute->channelSize;
+
+        permute->fill[i] = 0;
+
+        if (pixel >= blockPixels && dstPixelSize == srcPixelSize)
+        {
+            permute->shuffle[i] = (PM_UInt8)i;
+        }
+        else if (pixel >= blockPixels && dstPixelSize < srcPixelSize)
+        {
+            permute->shuffle[i] = 0x80;
+        }
+        else if (permute->map[channel] == PM_IMAGE_CHANNEL_OPAQUE)
+        {
+            permute->shuffle[i] = 0x80;
+            permute->fill[i] = (PM_UInt8)permute->opaque[byte];
+        }
+        else
+        {
+            PM_Size index = pixel * srcPixelSize + (PM_Size)permute->map[channel] * permute->channelSize + byte;
+            if (index >= PM_IMAGE_SHUFFLE_SIZE)
+            {
+                return;
+            }
+            permute->shuffle[i] = (PM_UInt8)index;
+        }
+    }
+
+    // When expanding the pixel right after the block is already converted, its source must not have been overwritten yet
+    if (dstPixelSize > srcPixelSize && blockPixels * dstPixelSize < PM_IMAGE_SHUFFLE_SIZE
+        && blockPixels * dstPixelSize < (blockPixels + 1) * srcPixelSize)
+    {
+        return;
+    }
+
+    permute->blockPixels = blockPixels;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImagePermutePixel(const PM__ImagePermute* permute, const PM_Byte* src, PM_Byte* dst)
+{
+    // The source is read entirely first as the destination overlaps it
+    PM_Byte pixel[PM_IMAGE_MAX_CHANNELS * 8];
+    PM_Memcpy(pixel, src, permute->srcPixelSize);
+
+    for (PM_UInt8 i = 0; i < permute->dstChannels; i++)
+    {
+        const PM_Byte* value = permute->map[i] == PM_IMAGE_CHANNEL_OPAQUE ? permute->opaque : pixel + permute->map[i] * permute->channelSize;
+        PM_Memcpy(dst + i * permute->channelSize, value, permute->channelSize);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Number of leading pixels that can go through the shuffle without reading or writing past the end of the data
+static PM_Size PM__ImageGetPermuteVectorPixels(const PM__ImagePermute* permute, PM_Size pixelCount)
+{
+    PM_Size pixelSize = PM_Max(permute->srcPixelSize, permute->dstPixelSize);
+    PM_Size vectorPixels = 0;
+
+    if (permute->blockPixels == 0 || pixelCount * pixelSize < PM_IMAGE_SHUFFLE_SIZE)
+    {
+        return 0;
+    }
+
+    // The last block starts at the latest at pixelCount * pixelSize - PM_IMAGE_SHUFFLE_SIZE
+    vectorPixels = (pixelCount * pixelSize - PM_IMAGE_SHUFFLE_SIZE) / pixelSize + 1;
+    return vectorPixels / permute->blockPixels * permute->blockPixels;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImagePermuteScalar(const PM__ImagePermute* permute, PM_Byte* data, PM_Size pixelCount)
+{
+    if (permute->dstPixelSize > permute->srcPixelSize)
+    {
+        for (PM_Size i = pixelCount; i > 0; i--)
+        {
+            PM__ImagePermutePixel(permute, data + (i - 1) * permute->srcPixelSize, data + (i - 1) * permute->dstPixelSize);
+        }
+    }
+    else
+    {
+        for (PM_Size i = 0; i < pixelCount; i++)
+        {
+            PM__ImagePermutePixel(permute, data + i * permute->srcPixelSize, data + i * permute->dstPixelSize);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+#if defined(PM_ARCH_X86)
+
+static PM_TARGET("ssse3") void PM__ImagePermuteSSSE3(const PM__ImagePermute* permute, PM_Byte* data, PM_Size pixelCount)
+{
+    PM_Size vectorPixels = PM__ImageGetPermuteVectorPixels(permute, pixelCount);
+    PM_Size blockPixels = permute->blockPixels;
+    const __m128i shuffle = _mm_loadu_si128((const __m128i*)permute->shuffle);
+    const __m128i fill = _mm_loadu_si128((const __m128i*)permute->fill);
+
+    if (permute->dstPixelSize > permute->srcPixelSize)
+    {
+        // Back to front, so every pixel is read before the expanded ones below it overwrite it
+        for (PM_Size i = pixelCount; i > vectorPixels; i--)
+        {
+            PM__ImagePermutePixel(permute, data + (i - 1) * permute->srcPixelSize, data + (i - 1) * permute->dstPixelSize);
+        }
+
+        for (PM_Size i = vectorPixels; i > 0; i -= blockPixels)
+        {
+            PM_Size pixel = i - blockPixels;
+            __m128i x = _mm_loadu_si128((const __m128i*)(data + pixel * permute->srcPixelSize));
+            _mm_storeu_si128((__m128i*)(data + pixel * permute->dstPixelSize), _mm_or_si128(_mm_shuffle_epi8(x, shuffle), fill));
+        }
+    }
+    else
+    {
+        if (vectorPixels > 0)
+        {
+            // The next block is loaded before the current one is stored, the two overlap when the pixel size
+            // does not change and reading back a partially overlapping store stalls on every block
+            __m128i x = _mm_loadu_si128((const __m128i*)data);
+            for (PM_Size i = 0; i + blockPixels < vectorPixels; i += blockPixels)
+            {
+                __m128i next = _mm_loadu_si128((const __m128i*)(data + (i + blockPixels) * permute->srcPixelSize));
+                _mm_storeu_si128((__m128i*)(data + i * permute->dstPixelSize), _mm_or_si128(_mm_shuffle_epi8(x, shuffle), fill));
+                x = next;
+            }
+            _mm_storeu_si128((__m128i*)(data + (vectorPixels - blockPixels) * permute->dstPixelSize), _mm_or_si128(_mm_shuffle_epi8(x, shuffle), fill));
+        }
+
+        for (PM_Size i = vectorPixels; i < pixelCount; i++)
+        {
+            PM__ImagePermutePixel(permute, data + i * permute->srcPixelSize, data + i * permute->dstPixelSize);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+#elif defined(PM_ARCH_ARM64)
+
+static void PM__ImagePermuteNEON(const PM__ImagePermute* permute, PM_Byte* data, PM_Size pixelCount)
+{
+    PM_Size vectorPixels = PM__ImageGetPermuteVectorPixels(permute, pixelCount);
+    PM_Size blockPixels = permute->blockPixels;
+    const uint8x16_t shuffle = vld1q_u8(permute->shuffle);
+    const uint8x16_t fill = vld1q_u8(permute->fill);
+
+    // Out of range indices like 0x80 give a zero with tbl, as with pshufb
+    if (permute->dstPixelSize > permute->srcPixelSize)
+    {
+        for (PM_Size i = pixelCount; i > vectorPixels; i--)
+        {
+            PM__ImagePermutePixel(permute, data + (i - 1) * permute->srcPixelSize, data + (i - 1) * permute->dstPixelSize);
+        }
+
+        for (PM_Size i = vectorPixels; i > 0; i -= blockPixels)
+        {
+            PM_Size pixel = i - blockPixels;
+            uint8x16_t x = vld1q_u8((const PM_UInt8*)data + pixel * permute->srcPixelSize);
+            vst1q_u8((PM_UInt8*)data + pixel * permute->dstPixelSize, vorrq_u8(vqtbl1q_u8(x, shuffle), fill));
+        }
+    }
+    else
+    {
+        if (vectorPixels > 0)
+        {
+            // The next block is loaded before the current one is stored, see the SSSE3 version
+            uint8x16_t x = vld1q_u8((const PM_UInt8*)data);
+            for (PM_Size i = 0; i + blockPixels < vectorPixels; i += blockPixels)
+            {
+                uint8x16_t next = vld1q_u8((const PM_UInt8*)data + (i + blockPixels) * permute->srcPixelSize);
+                vst1q_u8((PM_UInt8*)data + i * permute->dstPixelSize, vorrq_u8(vqtbl1q_u8(x, shuffle), fill));
+                x = next;
+            }
+            vst1q_u8((PM_UInt8*)data + (vectorPixels - blockPixels) * permute->dstPixelSize, vorrq_u8(vqtbl1q_u8(x, shuffle), fill));
+        }
+
+        for (PM_Size i = vectorPixels; i < pixelCount; i++)
+        {
+            PM__ImagePermutePixel(permute, data + i * permute->srcPixelSize, data + i * permute->dstPixelSize);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+#endif
+
+
+// Luma weights of Rec. 601 and Rec. 709, the fixed point ones are rounded so they still add up to exactly 1
+static const PM_Float64 PM_IMAGE_LUMA_WEIGHTS[2][3] = {{0.299, 0.587, 0.114}, {0.2126, 0.7152, 0.0722}};
+static const PM_UInt32 PM_IMAGE_LUMA_WEIGHTS_8[2][3] = {{77, 150, 29}, {54, 183, 19}};
+static const PM_UInt32 PM_IMAGE_LUMA_WEIGHTS_16[2][3] = {{19595, 38470, 7471}, {13933, 46871, 4732}};
+
+// The weights add up to exactly 1 so the result never overflows. The gray value of every pixel is
+// written at or before its own position, so src and dst can be the same buffer.
+
+#define PM__IMAGE_LUMA_U8(luma, Type, r, g, b) \
+    (Type)(((luma)->weights8[0] * (r) + (luma)->weights8[1] * (g) + (luma)->weights8[2] * (b) + 128) >> 8)
+
+#define PM__IMAGE_LUMA_U16(luma, Type, r, g, b) \
+    (Type)(((luma)->weights16[0] * (PM_UInt32)(r) + (luma)->weights16[1] * (PM_UInt32)(g) + (luma)->weights16[2] * (PM_UInt32)(b) + 32768) >> 16)
+
+// The 32 and 64-bit versions split every sample in 16-bit halves so the weighted sums fit in 64 bits
+#define PM__IMAGE_LUMA_WIDE(luma, Type, r, g, b) \
+    (Type)((luma)->weights16[0] * ((PM_UInt64)(r) >> 16) + (luma)->weights16[1] * ((PM_UInt64)(g) >> 16) + (luma)->weights16[2] * ((PM_UInt64)(b) >> 16) \
+           + (((luma)->weights16[0] * ((PM_UInt64)(r) & 0xFFFF) + (luma)->weights16[1] * ((PM_UInt64)(g) & 0xFFFF) \
+               + (luma)->weights16[2] * ((PM_UInt64)(b) & 0xFFFF) + 32768) >> 16))
+
+#define PM__IMAGE_LUMA_FLOAT(luma, Type, r, g, b) \
+    ((Type)(luma)->weights[0] * (r) + (Type)(luma)->weights[1] * (g) + (Type)(luma)->weights[2] * (b))
+
+#define PM__IMAGE_DEFINE_LUMA(name, Type, Weighted) \
+    static void PM__ImageLuma##name##Scalar(const PM__ImageLuma* luma, const PM_Byte* src, PM_Byte* dst, PM_Size pixelCount) \
+    { \
+        const Type* s = (const Type*)src; \
+        Type* d = (Type*)dst; \
+        Type opaque; \
+        PM_Memcpy(&opaque, luma->opaque, sizeof(opaque)); \
+        for (PM_Size i = 0; i < pixelCount; i++) \
+        { \
+            const Type* pixel = s + i * luma->srcChannels; \
+            Type alpha = luma->alpha == PM_IMAGE_CHANNEL_OPAQUE ? opaque : pixel[luma->alpha]; \
+            Type gray = Weighted(luma, Type, pixel[luma->red], pixel[luma->green], pixel[luma->blue]); \
+            d[i * luma->dstChannels] = gray; \
+            if (luma->dstChannels == 2) \
+            { \
+                d[i * 2 + 1] = alpha; \
+            } \
+        } \
+    }
+
+PM__IMAGE_DEFINE_LUMA(U8, PM_UInt8, PM__IMAGE_LUMA_U8)
+PM__IMAGE_DEFINE_LUMA(U16, PM_UInt16, PM__IMAGE_LUMA_U16)
+PM__IMAGE_DEFINE_LUMA(U32, PM_UInt32, PM__IMAGE_LUMA_WIDE)
+PM__IMAGE_DEFINE_LUMA(U64, PM_UInt64, PM__IMAGE_LUMA_WIDE)
+PM__IMAGE_DEFINE_LUMA(F32, PM_Float32, PM__IMAGE_LUMA_FLOAT)
+PM__IMAGE_DEFINE_LUMA(F64, PM_Float64, PM__IMAGE_LUMA_FLOAT)
+
+// -----------------------------------------------------------------------------------------------
+
+// Premultiplied integer samples are rounded to nearest, (t + (t >> N)) >> N is an exact division by 2^N - 1
+// for the products of two N-bit values. Unpremultiplying goes through single precision for 8 and 16-bit
+// samples so the vectorized versions give the same results, and a zero alpha gives a zero color.
+
+static PM_UInt8 PM__ImagePremultiplySampleU8(PM_UInt8 c, PM_UInt8 a)
+{
+    PM_UInt32 t = (PM_UInt32)c * a + 128;
+    return (PM_UInt8)((t + (t >> 8)) >> 8);
+}
+
+static PM_UInt8 PM__ImageUnpremultiplySampleU8(PM_UInt8 c, PM_UInt8 a)
+{
+    return a == 0 ? 0 : (PM_UInt8)PM_Min((PM_Float32)c * (255.0f / (PM_Float32)a) + 0.5f, 255.0f);
+}
+
+static PM_UInt16 PM__ImagePremultiplySampleU16(PM_UInt16 c, PM_UInt16 a)
+{
+    PM_UInt32 t = (PM_UInt32)c * a + 32768;
+    return (PM_UInt16)((t + (t >> 16)) >> 16);
+}
+
+static PM_UInt16 PM__ImageUnpremultiplySampleU16(PM_UInt16 c, PM_UInt16 a)
+{
+    return a == 0 ? 0 : (PM_UInt16)PM_Min((PM_Float32)c * (65535.0f / (PM_Float32)a) + 0.5f, 65535.0f);
+}
+
+static PM_UInt32 PM__ImagePremultiplySampleU32(PM_UInt32 c, PM_UInt32 a)
+{
+    return (PM_UInt32)(((PM_UInt64)c * a + 0x7FFFFFFF) / 0xFFFFFFFF);
+}
+
+static PM_UInt32 PM__ImageUnpremultiplySampleU32(PM_UInt32 c, PM_UInt32 a)
+{
+    return a == 0 ? 0 : (PM_UInt32)PM_Min(((PM_UInt64)c * 0xFFFFFFFF + a / 2) / a, (PM_UInt64)0xFFFFFFFF);
+}
+
+// The products of 64-bit samples do not fit in any integer type, they are computed in double precision
+static PM_UInt64 PM__ImageClampToU64(PM_Float64 value)
+{
+    return value >= 18446744073709551615.0 ? 0xFFFFFFFFFFFFFFFFull : (PM_UInt64)value;
+}
+
+static PM_UInt64 PM__ImagePremultiplySampleU64(PM_UInt64 c, PM_UInt64 a)
+{
+    return PM__ImageClampToU64((PM_Float64)c * ((PM_Float64)a / 18446744073709551615.0) + 0.5);
+}
+
+static PM_UInt64 PM__ImageUnpremultiplySampleU64(PM_UInt64 c, PM_UInt64 a)
+{
+    return a == 0 ? 0 : PM__ImageClampToU64((PM_Float64)c * (18446744073709551615.0 / (PM_Float64)a) + 0.5);
+}
+
+static PM_Float32 PM__ImagePremultiplySampleF32(PM_Float32 c, PM_Float32 a) { return c * a; }
+static PM_Float32 PM__ImageUnpremultiplySampleF32(PM_Float32 c, PM_Float32 a) { return a == 0.0f ? 0.0f : c / a; }
+static PM_Float64 PM__ImagePremultiplySampleF64(PM_Float64 c, PM_Float64 a) { return c * a; }
+static PM_Float64 PM__ImageUnpremultiplySampleF64(PM_Float64 c, PM_Float64 a) { return a == 0.0 ? 0.0 : c / a; }
+
+#define PM__IMAGE_DEFINE_ALPHA(operation, name, Type) \
+    static void PM__Image##operation##name##Scalar(const PM__ImageAlpha* alpha, PM_Byte* data, PM_Size pixelCount) \
+    { \
+        Type* pixel = (Type*)data; \
+        for (PM_Size i = 0; i < pixelCount; i++, pixel += alpha->channels) \
+        { \
+            Type a = pixel[alpha->alpha]; \
+            for (PM_Size channel = 0; channel < alpha->channels; channel++) \
+            { \
+                if (channel != alpha->alpha) \
+                { \
+                    pixel[channel] = PM__Image##operation##Sample##name(pixel[channel], a); \
+                } \
+            } \
+        } \
+    }
+
+PM__IMAGE_DEFINE_ALPHA(Premultiply, U8, PM_UInt8)
+PM__IMAGE_DEFINE_ALPHA(Premultiply, U16, PM_UInt16)
+PM__IMAGE_DEFINE_ALPHA(Premultiply, U32, PM_UInt32)
+PM__IMAGE_DEFINE_ALPHA(Premultiply, U64, PM_UInt64)
+PM__IMAGE_DEFINE_ALPHA(Premultiply, F32, PM_Float32)
+PM__IMAGE_DEFINE_ALPHA(Premultiply, F64, PM_Float64)
+PM__IMAGE_DEFINE_ALPHA(Unpremultiply, U8, PM_UInt8)
+PM__IMAGE_DEFINE_ALPHA(Unpremultiply, U16, PM_UInt16)
+PM__IMAGE_DEFINE_ALPHA(Unpremultiply, U32, PM_UInt32)
+PM__IMAGE_DEFINE_ALPHA(Unpremultiply, U64, PM_UInt64)
+PM__IMAGE_DEFINE_ALPHA(Unpremultiply, F32, PM_Float32)
+PM__IMAGE_DEFINE_ALPHA(Unpremultiply, F64, PM_Float64)
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageBuildAlphaShuffle(PM__ImageAlpha* alpha, PM_Size channelSize)
+{
+    PM_Size pixelSize = alpha->channels * channelSize;
+
+    // Only used by the vectorized versions, which handle pixels that evenly divide a register
+    for (PM_Size i = 0; i < PM_IMAGE_SHUFFLE_SIZE; i++)
+    {
+        PM_Size pixel = i / pixelSize;
+        PM_Size channel = (i % pixelSize) / channelSize;
+
+        alpha->broadcast[i] = (PM_UInt8)(pixel * pixelSize + alpha->alpha * channelSize + i % channelSize);
+        alpha->alphaMask[i] = channel == alpha->alpha ? 0xFF : 0x00;
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+#if defined(PM_ARCH_X86)
+
+static PM_TARGET("ssse3") void PM__ImageLumaU8SSSE3(const PM__ImageLuma* luma, const PM_Byte* src, PM_Byte* dst, PM_Size pixelCount)
+{
+    PM_Size srcChannels = luma->srcChannels;
+    PM_UInt8 shuffleBytes[3][16];
+
+    // Gathers red, green and blue of two pixels as 16-bit values, followed by a zero, and the alpha of all four pixels
+    PM_Memset(shuffleBytes, 0x80, sizeof(shuffleBytes));
+    for (PM_Size half = 0; half < 2; half++)
+    {
+        for (PM_Size pixel = 0; pixel < 2; pixel++)
+        {
+            PM_Size base = (half * 2 + pixel) * srcChannels;
+            shuffleBytes[half][pixel * 8 + 0] = (PM_UInt8)(base + luma->red);
+            shuffleBytes[half][pixel * 8 + 2] = (PM_UInt8)(base + luma->green);
+            shuffleBytes[half][pixel * 8 + 4] = (PM_UInt8)(base + luma->blue);
+        }
+    }
+    for (PM_Size pixel = 0; pixel < 4 && luma->alpha != PM_IMAGE_CHANNEL_OPAQUE; pixel++)
+    {
+        shuffleBytes[2][pixel] = (PM_UInt8)(pixel * srcChannels + (PM_Size)luma->alpha);
+    }
+
+    const __m128i shuffleLow = _mm_loadu_si128((const __m128i*)shuffleBytes[0]);
+    const __m128i shuffleHigh = _mm_loadu_si128((const __m128i*)shuffleBytes[1]);
+    const __m128i shuffleAlpha = _mm_loadu_si128((const __m128i*)shuffleBytes[2]);
+    const __m128i opaque = luma->alpha == PM_IMAGE_CHANNEL_OPAQUE ? _mm_set1_epi8(-1) : _mm_setzero_si128();
+    const __m128i weights = _mm_setr_epi16((PM_Int16)luma->weights8[0], (PM_Int16)luma->weights8[1], (PM_Int16)luma->weights8[2], 0,
+                                           (PM_Int16)luma->weights8[0], (PM_Int16)luma->weights8[1], (PM_Int16)luma->weights8[2], 0);
+    const __m128i half = _mm_set1_epi32(128);
+    PM_Size i = 0;
+
+    // Four pixels per iteration, the 16-byte load must stay within the image
+    for (; i * srcChannels + 16 <= pixelCount * srcChannels; i += 4)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i*)(src + i * srcChannels));
+        __m128i low = _mm_madd_epi16(_mm_shuffle_epi8(x, shuffleLow), weights);
+        __m128i high = _mm_madd_epi16(_mm_shuffle_epi8(x, shuffleHigh), weights);
+        __m128i sum = _mm_srli_epi32(_mm_add_epi32(_mm_hadd_epi32(low, high), half), 8);
+        __m128i gray = _mm_packus_epi16(_mm_packs_epi32(sum, sum), sum);
+
+        if (luma->dstChannels == 2)
+        {
+            __m128i alpha = _mm_or_si128(_mm_shuffle_epi8(x, shuffleAlpha), opaque);
+            _mm_storel_epi64((__m128i*)(dst + i * 2), _mm_unpacklo_epi8(gray, alpha));
+        }
+        else
+        {
+            PM_UInt32 value = (PM_UInt32)_mm_cvtsi128_si32(gray);
+            PM_Memcpy(dst + i, &value, sizeof(value));
+        }
+    }
+
+    PM__ImageLumaU8Scalar(luma, src + i * srcChannels, dst + i * luma->dstChannels, pixelCount - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Gathers one channel of four consecutive 16-bit pixels into the 32-bit lanes of a register, zero extended,
+// the pixels span two registers with the second one loaded secondOffset bytes after the first one
+static void PM__ImageBuildGatherShuffle(PM_Size srcChannels, PM_Int8 channel, PM_Size secondOffset, PM_UInt8 first[16], PM_UInt8 second[16])
+{
+    PM_Memset(first, 0x80, 16);
+    PM_Memset(second, 0x80, 16);
+
+    for (PM_Size pixel = 0; pixel < 4 && channel != PM_IMAGE_CHANNEL_OPAQUE; pixel++)
+    {
+        for (PM_Size byte = 0; byte < 2; byte++)
+        {
+            PM_Size offset = (pixel * srcChannels + (PM_Size)channel) * 2 + byte;
+            if (offset < 16)
+            {
+                first[pixel * 4 + byte] = (PM_UInt8)offset;
+            }
+            else
+            {
+                second[pixel * 4 + byte] = (PM_UInt8)(offset - secondOffset);
+            }
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("sse4.1") void PM__ImageLumaU16SSE41(const PM__ImageLuma* luma, const PM_Byte* src, PM_Byte* dst, PM_Size pixelCount)
+{
+    PM_Size srcChannels = luma->srcChannels;
+    PM_Size secondOffset = srcChannels * 8 - 16;
+    PM_Int8 channels[4] = {(PM_Int8)luma->red, (PM_Int8)luma->green, (PM_Int8)luma->blue, luma->alpha};
+    PM_UInt8 shuffleBytes[4][2][16];
+    __m128i shuffles[4][2];
+
+    for (PM_Size i = 0; i < 4; i++)
+    {
+        PM__ImageBuildGatherShuffle(srcChannels, channels[i], secondOffset, shuffleBytes[i][0], shuffleBytes[i][1]);
+        shuffles[i][0] = _mm_loadu_si128((const __m128i*)shuffleBytes[i][0]);
+        shuffles[i][1] = _mm_loadu_si128((const __m128i*)shuffleBytes[i][1]);
+    }
+
+    const __m128i redWeight = _mm_set1_epi32((PM_Int32)luma->weights16[0]);
+    const __m128i greenWeight = _mm_set1_epi32((PM_Int32)luma->weights16[1]);
+    const __m128i blueWeight = _mm_set1_epi32((PM_Int32)luma->weights16[2]);
+    const __m128i opaque = luma->alpha == PM_IMAGE_CHANNEL_OPAQUE ? _mm_set1_epi32(0xFFFF) : _mm_setzero_si128();
+    const __m128i half = _mm_set1_epi32(32768);
+    const __m128i interleave = _mm_setr_epi8(0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15);
+    PM_Size i = 0;
+
+    // Four pixels per iteration, loaded as 24 or 32 bytes in two overlapping registers
+    for (; i + 4 <= pixelCount; i += 4)
+    {
+        const PM_Byte* pixels = src + i * srcChannels * 2;
+        __m128i x0 = _mm_loadu_si128((const __m128i*)pixels);
+        __m128i x1 = _mm_loadu_si128((const __m128i*)(pixels + secondOffset));
+        __m128i r = _mm_or_si128(_mm_shuffle_epi8(x0, shuffles[0][0]), _mm_shuffle_epi8(x1, shuffles[0][1]));
+        __m128i g = _mm_or_si128(_mm_shuffle_epi8(x0, shuffles[1][0]), _mm_shuffle_epi8(x1, shuffles[1][1]));
+        __m128i b = _mm_or_si128(_mm_shuffle_epi8(x0, shuffles[2][0]), _mm_shuffle_epi8(x1, shuffles[2][1]));
+        __m128i alpha = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(x0, shuffles[3][0]), _mm_shuffle_epi8(x1, shuffles[3][1])), opaque);
+
+        __m128i sum = _mm_add_epi32(_mm_mullo_epi32(r, redWeight), _mm_mullo_epi32(g, greenWeight));
+        sum = _mm_add_epi32(sum, _mm_add_epi32(_mm_mullo_epi32(b, blueWeight), half));
+        __m128i packed = _mm_packus_epi32(_mm_srli_epi32(sum, 16), alpha);
+
+        if (luma->dstChannels == 2)
+        {
+            _mm_storeu_si128((__m128i*)(dst + i * 4), _mm_shuffle_epi8(packed, interleave));
+        }
+        else
+        {
+            _mm_storel_epi64((__m128i*)(dst + i * 2), packed);
+        }
+    }
+
+    PM__ImageLumaU16Scalar(luma, src + i * srcChannels * 2, dst + i * luma->dstChannels * 2, pixelCount - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("sse4.1") void PM__ImageLumaF32SSE41(const PM__ImageLuma* luma, const PM_Byte* src, PM_Byte* dst, PM_Size pixelCount)
+{
+    const PM_Float32* s = (const PM_Float32*)src;
+    PM_Float32* d = (PM_Float32*)dst;
+    const __m128 redWeight = _mm_set1_ps((PM_Float32)luma->weights[0]);
+    const __m128 greenWeight = _mm_set1_ps((PM_Float32)luma->weights[1]);
+    const __m128 blueWeight = _mm_set1_ps((PM_Float32)luma->weights[2]);
+    const __m128 one = _mm_set1_ps(1.0f);
+    PM_Size i = 0;
+
+    for (; i + 4 <= pixelCount; i += 4)
+    {
+        const PM_Float32* pixels = s + i * luma->srcChannels;
+        __m128 c[4];
+
+        if (luma->srcChannels == 4)
+        {
+            c[0] = _mm_loadu_ps(pixels);
+            c[1] = _mm_loadu_ps(pixels + 4);
+            c[2] = _mm_loadu_ps(pixels + 8);
+            c[3] = _mm_loadu_ps(pixels + 12);
+            _MM_TRANSPOSE4_PS(c[0], c[1], c[2], c[3]);
+        }
+        else
+        {
+            // x0 = 0 1 2 0, x1 = 1 2 0 1, x2 = 2 0 1 2
+            __m128 x0 = _mm_loadu_ps(pixels);
+            __m128 x1 = _mm_loadu_ps(pixels + 4);
+            __m128 x2 = _mm_loadu_ps(pixels + 8);
+            c[0] = _mm_shuffle_ps(_mm_shuffle_ps(x0, x0, _MM_SHUFFLE(3, 3, 0, 0)), _mm_shuffle_ps(x1, x2, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0));
+            c[1] = _mm_shuffle_ps(_mm_shuffle_ps(x0, x1, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(x1, x2, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+            c[2] = _mm_shuffle_ps(_mm_shuffle_ps(x0, x1, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(x2, x2, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+            c[3] = one;
+        }
+
+        __m128 gray = _mm_add_ps(_mm_add_ps(_mm_mul_ps(redWeight, c[luma->red]), _mm_mul_ps(greenWeight, c[luma->green])),
+                                 _mm_mul_ps(blueWeight, c[luma->blue]));
+
+        if (luma->dstChannels == 2)
+        {
+            __m128 alpha = luma->alpha == PM_IMAGE_CHANNEL_OPAQUE ? one : c[luma->alpha];
+            _mm_storeu_ps(d + i * 2, _mm_unpacklo_ps(gray, alpha));
+            _mm_storeu_ps(d + i * 2 + 4, _mm_unpackhi_ps(gray, alpha));
+        }
+        else
+        {
+            _mm_storeu_ps(d + i, gray);
+        }
+    }
+
+    PM__ImageLumaF32Scalar(luma, src + i * luma->srcChannels * 4, dst + i * luma->dstChannels * 4, pixelCount - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// The alpha channel is multiplied by the maximum value, which leaves it unchanged
+static PM_TARGET("sse4.1") void PM__ImagePremultiplyU8SSE41(const PM__ImageAlpha* alpha, PM_Byte* data, PM_Size pixelCount)
+{
+    const __m128i broadcast = _mm_loadu_si128((const __m128i*)alpha->broadcast);
+    const __m128i alphaMask = _mm_loadu_si128((const __m128i*)alpha->alphaMask);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i half = _mm_set1_epi16(128);
+    PM_Size pixelSize = alpha->channels;
+    PM_Size blockPixels = PM_IMAGE_SHUFFLE_SIZE / pixelSize;
+    PM_Size i = 0;
+
+    for (; i + blockPixels <= pixelCount; i += blockPixels)
+    {
+        __m128i* block = (__m128i*)(data + i * pixelSize);
+        __m128i x = _mm_loadu_si128(block);
+        __m128i m = _mm_or_si128(_mm_shuffle_epi8(x, broadcast), alphaMask);
+        __m128i low = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(x, zero), _mm_unpacklo_epi8(m, zero)), half);
+        __m128i high = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(x, zero), _mm_unpackhi_epi8(m, zero)), half);
+        low = _mm_srli_epi16(_mm_add_epi16(low, _mm_srli_epi16(low, 8)), 8);
+        high = _mm_srli_epi16(_mm_add_epi16(high, _mm_srli_epi16(high, 8)), 8);
+        _mm_storeu_si128(block, _mm_packus_epi16(low, high));
+    }
+
+    PM__ImagePremultiplyU8Scalar(alpha, data + i * pixelSize, pixelCount - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("sse4.1") void PM__ImagePremultiplyU16SSE41(const PM__ImageAlpha* alpha, PM_Byte* data, PM_Size pixelCount)
+{
+    const __m128i broadcast = _mm_loadu_si128((const __m128i*)alpha->broadcast);
+    const __m128i alphaMask = _mm_loadu_si128((const __m128i*)alpha->alphaMask);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i half = _mm_set1_epi32(32768);
+    PM_Size pixelSize = alpha->channels * 2;
+    PM_Size blockPixels = PM_IMAGE_SHUFFLE_SIZE / pixelSize;
+    PM_Size i = 0;
+
+    for (; i + blockPixels <= pixelCount; i += blockPixels)
+    {
+        __m128i* block = (__m128i*)(data + i * pixelSize);
+        __m128i x = _mm_loadu_si128(block);
+        __m128i m = _mm_or_si128(_mm_shuffle_epi8(x, broadcast), alphaMask);
+        __m128i low = _mm_add_epi32(_mm_mullo_epi32(_mm_cvtepu16_epi32(x), _mm_cvtepu16_epi32(m)), half);
+        __m128i high = _mm_add_epi32(_mm_mullo_epi32(_mm_unpackhi_epi16(x, zero), _mm_unpackhi_epi16(m, zero)), half);
+        low = _mm_srli_epi32(_mm_add_epi32(low, _mm_srli_epi32(low, 16)), 16);
+        high = _mm_srli_epi32(_mm_add_epi32(high, _mm_srli_epi32(high, 16)), 16);
+        _mm_storeu_si128(block, _mm_packus_epi32(low, high));
+    }
+
+    PM__ImagePremultiplyU16Scalar(alpha, data + i * pixelSize, pixelCount - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("sse4.1") void PM__ImagePremultiplyF32SSE41(const PM__ImageAlpha* alpha, PM_Byte* data, PM_Size pixelCount)
+{
+    const __m128i broadcast = _mm_loadu_si128((const __m128i*)alpha->broadcast);
+    const __m128 alphaMask = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)alpha->alphaMask));
+    const __m128 one = _mm_set1_ps(1.0f);
+    PM_Size pixelSize = alpha->channels * 4;
+    PM_Size blockPixels = PM_IMAGE_SHUFFLE_SIZE / pixelSize;
+    PM_Size i = 0;
+
+    for (; i + blockPixels <= pixelCount; i += blockPixels)
+    {
+        PM_Float32* block = (PM_Float32*)(data + i * pixelSize);
+        __m128 x = _mm_loadu_ps(block);
+        __m128 m = _mm_castsi128_ps(_mm_shuffle_epi8(_mm_castps_si128(x), broadcast));
+        _mm_storeu_ps(block, _mm_mul_ps(x, _mm_blendv_ps(m, one, alphaMask)));
+    }
+
+    PM__ImagePremultiplyF32Scalar(alpha, data + i * pixelSize, pixelCount - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Same operations as PM__ImageUnpremultiplySampleU8 and PM__ImageUnpremultiplySampleU16 on four 32-bit lanes
+static PM_TARGET("sse4.1") __m128i PM__ImageUnpremultiplyLanesSSE41(__m128i c, __m128i a, __m128 maximum)
+{
+    __m128 alpha = _mm_cvtepi32_ps(a);
+    __m128 value = _mm_mul_ps(_mm_cvtepi32_ps(c), _mm_div_ps(maximum, alpha));
+    value = _mm_min_ps(_mm_add_ps(value, _mm_set1_ps(0.5f)), maximum);
+    return _mm_and_si128(_mm_cvttps_epi32(value), _mm_castps_si128(_mm_cmpneq_ps(alpha, _mm_setzero_ps())));
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("sse4.1") void PM__ImageUnpremultiplyU8SSE41(const PM__ImageAlpha* alpha, PM_Byte* data, PM_Size pixelCount)
+{
+    const __m128i broadcast = _mm_loadu_si128((const __m128i*)alpha->broadcast);
+    const __m128i alphaMask = _mm_loadu_si128((const __m128i*)alpha->alphaMask);
+    const __m128 maximum = _mm_set1_ps(255.0f);
+    PM_Size pixelSize = alpha->channels;
+    PM_Size blockPixels = PM_IMAGE_SHUFFLE_SIZE / pixelSize;
+    PM_Size i = 0;
+
+    for (; i + blockPixels <= pixelCount; i += blockPixels)
+    {
+        __m128i* block = (__m128i*)(data + i * pixelSize);
+        __m128i x = _mm_loadu_si128(block);
+        __m128i a = _mm_shuffle_epi8(x, broadcast);
+        __m128i q0 = PM__ImageUnpremultiplyLanesSSE41(_mm_cvtepu8_epi32(x), _mm_cvtepu8_epi32(a), maximum);
+        __m128i q1 = PM__ImageUnpremultiplyLanesSSE41(_mm_cvtepu8_epi32(_mm_srli_si128(x, 4)), _mm_cvtepu8_epi32(_mm_srli_si128(a, 4)), maximum);
+        __m128i q2 = PM__ImageUnpremultiplyLanesSSE41(_mm_cvtepu8_epi32(_mm_srli_si128(x, 8)), _mm_cvtepu8_epi32(_mm_srli_si128(a, 8)), maximum);
+        __m128i q3 = PM__ImageUnpremultiplyLanesSSE41(_mm_cvtepu8_epi32(_mm_srli_si128(x, 12)), _mm_cvtepu8_epi32(_mm_srli_si128(a, 12)), maximum);
+        __m128i result = _mm_packus_epi16(_mm_packus_epi32(q0, q1), _mm_packus_epi32(q2, q3));
+        _mm_storeu_si128(block, _mm_blendv_epi8(result, x, alphaMask));
+    }
+
+    PM__ImageUnpremultiplyU8Scalar(alpha, data + i * pixelSize, pixelCount - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("sse4.1") void PM__ImageUnpremultiplyU16SSE41(const PM__ImageAlpha* alpha, PM_Byte* data, PM_Size pixelCount)
+{
+    const __m128i broadcast = _mm_loadu_si128((const __m128i*)alpha->broadcast);
+    const __m128i alphaMask = _mm_loadu_si128((const __m128i*)alpha->alphaMask);
+    const __m128 maximum = _mm_set1_ps(65535.0f);
+    PM_Size pixelSize = alpha->channels * 2;
+    PM_Size blockPixels = PM_IMAGE_SHUFFLE_SIZE / pixelSize;
+    PM_Size i = 0;
+
+    for (; i + blockPixels <= pixelCount; i += blockPixels)
+    {
+        __m128i* block = (__m128i*)(data + i * pixelSize);
+        __m128i x = _mm_loadu_si128(block);
+        __m128i a = _mm_shuffle_epi8(x, broadcast);
+        __m128i low = PM__ImageUnpremultiplyLanesSSE41(_mm_cvtepu16_epi32(x), _mm_cvtepu16_epi32(a), maximum);
+        __m128i high = PM__ImageUnpremultiplyLanesSSE41(_mm_cvtepu16_epi32(_mm_srli_si128(x, 8)), _mm_cvtepu16_epi32(_mm_srli_si128(a, 8)), maximum);
+        _mm_storeu_si128(block, _mm_blendv_epi8(_mm_packus_epi32(low, high), x, alphaMask));
+    }
+
+    PM__ImageUnpremultiplyU16Scalar(alpha, data + i * pixelSize, pixelCount - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("sse4.1") void PM__ImageUnpremultiplyF32SSE41(const PM__ImageAlpha* alpha, PM_Byte* data, PM_Size pixelCount)
+{
+    const __m128i broadcast = _mm_loadu_si128((const __m128i*)alpha->broadcast);
+    const __m128 alphaMask = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)alpha->alphaMask));
+    PM_Size pixelSize = alpha->channels * 4;
+    PM_Size blockPixels = PM_IMAGE_SHUFFLE_SIZE / pixelSize;
+    PM_Size i = 0;
+
+    for (; i + blockPixels <= pixelCount; i += blockPixels)
+    {
+        PM_Float32* block = (PM_Float32*)(data + i * pixelSize);
+        __m128 x = _mm_loadu_ps(block);
+        __m128 a = _mm_castsi128_ps(_mm_shuffle_epi8(_mm_castps_si128(x), broadcast));
+        __m128 value = _mm_and_ps(_mm_div_ps(x, a), _mm_cmpneq_ps(a, _mm_setzero_ps()));
+        _mm_storeu_ps(block, _mm_blendv_ps(value, x, alphaMask));
+    }
+
+    PM__ImageUnpremultiplyF32Scalar(alpha, data + i * pixelSize, pixelCount - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+#elif defined(PM_ARCH_ARM64)
+
+static void PM__ImageLumaU8NEON(const PM__ImageLuma* luma, const PM_Byte* src, PM_Byte* dst, PM_Size pixelCount)
+{
+    const uint8x16_t redWeight = vdupq_n_u8((PM_UInt8)luma->weights8[0]);
+    const uint8x16_t greenWeight = vdupq_n_u8((PM_UInt8)luma->weights8[1]);
+    const uint8x16_t blueWeight = vdupq_n_u8((PM_UInt8)luma->weights8[2]);
+    PM_Size i = 0;
+
+    for (; i + 16 <= pixelCount; i += 16)
+    {
+        uint8x16_t channels[4];
+        if (luma->srcChannels == 4)
+        {
+            uint8x16x4_t x = vld4q_u8((const PM_UInt8*)src + i * 4);
+            channels[0] = x.val[0]; channels[1] = x.val[1]; channels[2] = x.val[2]; channels[3] = x.val[3];
+        }
+        else
+        {
+            uint8x16x3_t x = vld3q_u8((const PM_UInt8*)src + i * 3);
+            channels[0] = x.val[0]; channels[1] = x.val[1]; channels[2] = x.val[2]; channels[3] = vdupq_n_u8(0xFF);
+        }
+
+        uint8x16_t r = channels[luma->red], g = channels[luma->green], b = channels[luma->blue];
+        uint16x8_t low = vmull_u8(vget_low_u8(r), vget_low_u8(redWeight));
+        uint16x8_t high = vmull_high_u8(r, redWeight);
+        low = vmlal_u8(low, vget_low_u8(g), vget_low_u8(greenWeight));
+        high = vmlal_high_u8(high, g, greenWeight);
+        low = vmlal_u8(low, vget_low_u8(b), vget_low_u8(blueWeight));
+        high = vmlal_high_u8(high, b, blueWeight);
+
+        // The rounding shift adds the 128 of the scalar code
+        uint8x16_t gray = vcombine_u8(vrshrn_n_u16(low, 8), vrshrn_n_u16(high, 8));
+
+        if (luma->dstChannels == 2)
+        {
+            uint8x16x2_t y;
+            y.val[0] = gray;
+            y.val[1] = luma->alpha == PM_IMAGE_CHANNEL_OPAQUE ? vdupq_n_u8(0xFF) : channels[luma->alpha];
+            vst2q_u8((PM_UInt8*)dst + i * 2, y);
+        }
+        else
+        {
+            vst1q_u8((PM_UInt8*)dst + i, gray);
+        }
+    }
+
+    PM__ImageLumaU8Scalar(luma, src + i * luma->srcChannels, dst + i * luma->dstChannels, pixelCount - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageLumaU16NEON(const PM__ImageLuma* luma, const PM_Byte* src, PM_Byte* dst, PM_Size pixelCount)
+{
+    const PM_UInt16* s = (const PM_UInt16*)src;
+    PM_UInt16* d = (PM_UInt16*)dst;
+    PM_UInt16 redWeight = (PM_UInt16)luma->weights16[0];
+    PM_UInt16 greenWeight = (PM_UInt16)luma->weights16[1];
+    PM_UInt16 blueWeight = (PM_UInt16)luma->weights16[2];
+    PM_Size i = 0;
+
+    for (; i + 8 <= pixelCount; i += 8)
+    {
+        uint16x8_t channels[4];
+        if (luma->srcChannels == 4)
+        {
+            uint16x8x4_t x = vld4q_u16(s + i * 4);
+            channels[0] = x.val[0]; channels[1] = x.val[1]; channels[2] = x.val[2]; channels[3] = x.val[3];
+        }
+        else
+        {
+            uint16x8x3_t x = vld3q_u16(s + i * 3);
+            channels[0] = x.val[0]; channels[1] = x.val[1]; channels[2] = x.val[2]; channels[3] = vdupq_n_u16(0xFFFF);
+        }
+
+        uint16x8_t r = channels[luma->red], g = channels[luma->green], b = channels[luma->blue];
+        uint32x4_t low = vmull_n_u16(vget_low_u16(r), redWeight);
+        uint32x4_t high = vmull_n_u16(vget_high_u16(r), redWeight);
+        low = vmlal_n_u16(low, vget_low_u16(g), greenWeight);
+        high = vmlal_n_u16(high, vget_high_u16(g), greenWeight);
+        low = vmlal_n_u16(low, vget_low_u16(b), blueWeight);
+        high = vmlal_n_u16(high, vget_high_u16(b), blueWeight);
+
+        uint16x8_t gray = vcombine_u16(vrshrn_n_u32(low, 16), vrshrn_n_u32(high, 16));
+
+        if (luma->dstChannels == 2)
+        {
+            uint16x8x2_t y;
+            y.val[0] = gray;
+            y.val[1] = luma->alpha == PM_IMAGE_CHANNEL_OPAQUE ? vdupq_n_u16(0xFFFF) : channels[luma->alpha];
+            vst2q_u16(d + i * 2, y);
+        }
+        else
+        {
+            vst1q_u16(d + i, gray);
+        }
+    }
+
+    PM__ImageLumaU16Scalar(luma, src + i * luma->srcChannels * 2, dst + i * luma->dstChannels * 2, pixelCount - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageLumaF32NEON(const PM__ImageLuma* luma, const PM_Byte* src, PM_Byte* dst, PM_Size pixelCount)
+{
+    const PM_Float32* s = (const PM_Float32*)src;
+    PM_Float32* d = (PM_Float32*)dst;
+    PM_Float32 redWeight = (PM_Float32)luma->weights[0];
+    PM_Float32 greenWeight = (PM_Float32)luma->weights[1];
+    PM_Float32 blueWeight = (PM_Float32)luma->weights[2];
+    PM_Size i = 0;
+
+    for (; i + 4 <= pixelCount; i += 4)
+    {
+        float32x4_t channels[4];
+        if (luma->srcChannels == 4)
+        {
+            float32x4x4_t x = vld4q_f32(s + i * 4);
+            channels[0] = x.val[0]; channels[1] = x.val[1]; channels[2] = x.val[2]; channels[3] = x.val[3];
+        }
+        else
+        {
+            float32x4x3_t x = vld3q_f32(s + i * 3);
+            channels[0] = x.val[0]; channels[1] = x.val[1]; channels[2] = x.val[2]; channels[3] = vdupq_n_f32(1.0f);
+        }
+
+        float32x4_t gray = vaddq_f32(vaddq_f32(vmulq_n_f32(channels[luma->red], redWeight), vmulq_n_f32(channels[luma->green], greenWeight)),
+                                     vmulq_n_f32(channels[luma->blue], blueWeight));
+
+        if (luma->dstChannels == 2)
+        {
+            float32x4x2_t y;
+            y.val[0] = gray;
+            y.val[1] = luma->alpha == PM_IMAGE_CHANNEL_OPAQUE ? vdupq_n_f32(1.0f) : channels[luma->alpha];
+            vst2q_f32(d + i * 2, y);
+        }
+        else
+        {
+            vst1q_f32(d + i, gray);
+        }
+    }
+
+    PM__ImageLumaF32Scalar(luma, src + i * luma->srcChannels * 4, dst + i * luma->dstChannels * 4, pixelCount - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// The alpha channel is multiplied by the maximum value, which leaves it unchanged
+static void PM__ImagePremultiplyU8NEON(const PM__ImageAlpha* alpha, PM_Byte* data, PM_Size pixelCount)
+{
+    const uint8x16_t broadcast = vld1q_u8(alpha->broadcast);
+    const uint8x16_t alphaMask = vld1q_u8(alpha->alphaMask);
+    const uint16x8_t half = vdupq_n_u16(128);
+    PM_Size pixelSize = alpha->channels;
+    PM_Size blockPixels = PM_IMAGE_SHUFFLE_SIZE / pixelSize;
+    PM_Size i = 0;
+
+    for (; i + blockPixels <= pixelCount; i += blockPixels)
+    {
+        PM_UInt8* block = (PM_UInt8*)data + i * pixelSize;
+        uint8x16_t x = vld1q_u8(block);
+        uint8x16_t m = vorrq_u8(vqtbl1q_u8(x, broadcast), alphaMask);
+        uint16x8_t low = vaddq_u16(vmull_u8(vget_low_u8(x), vget_low_u8(m)), half);
+        uint16x8_t high = vaddq_u16(vmull_high_u8(x, m), half);
+        vst1q_u8(block, vcombine_u8(vshrn_n_u16(vsraq_n_u16(low, low, 8), 8), vshrn_n_u16(vsraq_n_u16(high, high, 8), 8)));
+    }
+
+    PM__ImagePremultiplyU8Scalar(alpha, data + i * pixelSize, pixelCount - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImagePremultiplyU16NEON(const PM__ImageAlpha* alpha, PM_Byte* data, PM_Size pixelCount)
+{
+    const uint8x16_t broadcast = vld1q_u8(alpha->broadcast);
+    const uint8x16_t alphaMask = vld1q_u8(alpha->alphaMask);
+    const uint32x4_t half = vdupq_n_u32(32768);
+    PM_Size pixelSize = alpha->channels * 2;
+    PM_Size blockPixels = PM_IMAGE_SHUFFLE_SIZE / pixelSize;
+    PM_Size i = 0;
+
+    for (; i + blockPixels <= pixelCount; i += blockPixels)
+    {
+        PM_UInt16* block = (PM_UInt16*)(data + i * pixelSize);
+        uint16x8_t x = vld1q_u16(block);
+        uint16x8_t m = vreinterpretq_u16_u8(vorrq_u8(vqtbl1q_u8(vreinterpretq_u8_u16(x), broadcast), alphaMask));
+        uint32x4_t low = vaddq_u32(vmull_u16(vget_low_u16(x), vget_low_u16(m)), half);
+        uint32x4_t high = vaddq_u32(vmull_high_u16(x, m), half);
+        vst1q_u16(block, vcombine_u16(vshrn_n_u32(vsraq_n_u32(low, low, 16), 16), vshrn_n_u32(vsraq_n_u32(high, high, 16), 16)));
+    }
+
+    PM__ImagePremultiplyU16Scalar(alpha, data + i * pixelSize, pixelCount - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImagePremultiplyF32NEON(const PM__ImageAlpha* alpha, PM_Byte* data, PM_Size pixelCount)
+{
+    const uint8x16_t broadcast = vld1q_u8(alpha->broadcast);
+    const uint32x4_t alphaMask = vreinterpretq_u32_u8(vld1q_u8(alpha->alphaMask));
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    PM_Size pixelSize = alpha->channels * 4;
+    PM_Size blockPixels = PM_IMAGE_SHUFFLE_SIZE / pixelSize;
+    PM_Size i = 0;
+
+    for (; i + blockPixels <= pixelCount; i += blockPixels)
+    {
+        PM_Float32* block = (PM_Float32*)(data + i * pixelSize);
+        float32x4_t x = vld1q_f32(block);
+        float32x4_t m = vreinterpretq_f32_u8(vqtbl1q_u8(vreinterpretq_u8_f32(x), broadcast));
+        vst1q_f32(block, vmulq_f32(x, vbslq_f32(alphaMask, one, m)));
+    }
+
+    PM__ImagePremultiplyF32Scalar(alpha, data + i * pixelSize, pixelCount - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Same operations as PM__ImageUnpremultiplySampleU8 and PM__ImageUnpremultiplySampleU16 on four 32-bit lanes
+static uint32x4_t PM__ImageUnpremultiplyLanesNEON(uint32x4_t c, uint32x4_t a, float32x4_t maximum)
+{
+    float32x4_t alpha = vcvtq_f32_u32(a);
+    float32x4_t value = vmulq_f32(vcvtq_f32_u32(c), vdivq_f32(maximum, alpha));
+    value = vminq_f32(vaddq_f32(value, vdupq_n_f32(0.5f)), maximum);
+    return vandq_u32(vcvtq_u32_f32(value), vmvnq_u32(vceqq_f32(alpha, vdupq_n_f32(0.0f))));
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageUnpremultiplyU8NEON(const PM__ImageAlpha* alpha, PM_Byte* data, PM_Size pixelCount)
+{
+    const uint8x16_t broadcast = vld1q_u8(alpha->broadcast);
+    const uint8x16_t alphaMask = vld1q_u8(alpha->alphaMask);
+    const float32x4_t maximum = vdupq_n_f32(255.0f);
+    PM_Size pixelSize = alpha->channels;
+    PM_Size blockPixels = PM_IMAGE_SHUFFLE_SIZE / pixelSize;
+    PM_Size i = 0;
+
+    for (; i + blockPixels <= pixelCount; i += blockPixels)
+    {
+        PM_UInt8* block = (PM_UInt8*)data + i * pixelSize;
+        uint8x16_t x = vld1q_u8(block);
+        uint8x16_t a = vqtbl1q_u8(x, broadcast);
+        uint16x8_t xLow = vmovl_u8(vget_low_u8(x)), xHigh = vmovl_high_u8(x);
+        uint16x8_t aLow = vmovl_u8(vget_low_u8(a)), aHigh = vmovl_high_u8(a);
+        uint32x4_t q0 = PM__ImageUnpremultiplyLanesNEON(vmovl_u16(vget_low_u16(xLow)), vmovl_u16(vget_low_u16(aLow)), maximum);
+        uint32x4_t q1 = PM__ImageUnpremultiplyLanesNEON(vmovl_high_u16(xLow), vmovl_high_u16(aLow), maximum);
+        uint32x4_t q2 = PM__ImageUnpremultiplyLanesNEON(vmovl_u16(vget_low_u16(xHigh)), vmovl_u16(vget_low_u16(aHigh)), maximum);
+        uint32x4_t q3 = PM__ImageUnpremultiplyLanesNEON(vmovl_high_u16(xHigh), vmovl_high_u16(aHigh), maximum);
+        uint8x16_t result = vcombine_u8(vmovn_u16(vcombine_u16(vmovn_u32(q0), vmovn_u32(q1))), vmovn_u16(vcombine_u16(vmovn_u32(q2), vmovn_u32(q3))));
+        vst1q_u8(block, vbslq_u8(alphaMask, x, result));
+    }
+
+    PM__ImageUnpremultiplyU8Scalar(alpha, data + i * pixelSize, pixelCount - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageUnpremultiplyU16NEON(const PM__ImageAlpha* alpha, PM_Byte* data, PM_Size pixelCount)
+{
+    const uint8x16_t broadcast = vld1q_u8(alpha->broadcast);
+    const uint16x8_t alphaMask = vreinterpretq_u16_u8(vld1q_u8(alpha->alphaMask));
+    const float32x4_t maximum = vdupq_n_f32(65535.0f);
+    PM_Size pixelSize = alpha->channels * 2;
+    PM_Size blockPixels = PM_IMAGE_SHUFFLE_SIZE / pixelSize;
+    PM_Size i = 0;
+
+    for (; i + blockPixels <= pixelCount; i += blockPixels)
+    {
+        PM_UInt16* block = (PM_UInt16*)(data + i * pixelSize);
+        uint16x8_t x = vld1q_u16(block);
+        uint16x8_t a = vreinterpretq_u16_u8(vqtbl1q_u8(vreinterpretq_u8_u16(x), broadcast));
+        uint32x4_t low = PM__ImageUnpremultiplyLanesNEON(vmovl_u16(vget_low_u16(x)), vmovl_u16(vget_low_u16(a)), maximum);
+        uint32x4_t high = PM__ImageUnpremultiplyLanesNEON(vmovl_high_u16(x), vmovl_high_u16(a), maximum);
+        vst1q_u16(block, vbslq_u16(alphaMask, x, vcombine_u16(vmovn_u32(low), vmovn_u32(high))));
+    }
+
+    PM__ImageUnpremultiplyU16Scalar(alpha, data + i * pixelSize, pixelCount - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageUnpremultiplyF32NEON(const PM__ImageAlpha* alpha, PM_Byte* data, PM_Size pixelCount)
+{
+    const uint8x16_t broadcast = vld1q_u8(alpha->broadcast);
+    const uint32x4_t alphaMask = vreinterpretq_u32_u8(vld1q_u8(alpha->alphaMask));
+    PM_Size pixelSize = alpha->channels * 4;
+    PM_Size blockPixels = PM_IMAGE_SHUFFLE_SIZE / pixelSize;
+    PM_Size i = 0;
+
+    for (; i + blockPixels <= pixelCount; i += blockPixels)
+    {
+        PM_Float32* block = (PM_Float32*)(data + i * pixelSize);
+        float32x4_t x = vld1q_f32(block);
+        float32x4_t a = vreinterpretq_f32_u8(vqtbl1q_u8(vreinterpretq_u8_f32(x), broadcast));
+        uint32x4_t nonZero = vmvnq_u32(vceqq_f32(a, vdupq_n_f32(0.0f)));
+        float32x4_t value = vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(vdivq_f32(x, a)), nonZero));
+        vst1q_f32(block, vbslq_f32(alphaMask, x, value));
+    }
+
+    PM__ImageUnpremultiplyF32Scalar(alpha, data + i * pixelSize, pixelCount - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+#endif
+
+static PM__ImagePermuteFunction PM_IMAGE_PERMUTE_FUNCTION = PM__ImagePermuteScalar;
+
+// Indexed by data type, starting from PICOIMEDIA_IMAGE_DATA_TYPE_UINT8
+static PM__ImageLumaFunction PM_IMAGE_LUMA_FUNCTIONS[6] = {
+    PM__ImageLumaU8Scalar,
+    PM__ImageLumaU16Scalar,
+    PM__ImageLumaU32Scalar,
+    PM__ImageLumaU64Scalar,
+    PM__ImageLumaF32Scalar,
+    PM__ImageLumaF64Scalar,
+};
+
+static PM__ImageAlphaFunction PM_IMAGE_PREMULTIPLY_FUNCTIONS[6] = {
+    PM__ImagePremultiplyU8Scalar,
+    PM__ImagePremultiplyU16Scalar,
+    PM__ImagePremultiplyU32Scalar,
+    PM__ImagePremultiplyU64Scalar,
+    PM__ImagePremultiplyF32Scalar,
+    PM__ImagePremultiplyF64Scalar,
+};
+
+static PM__ImageAlphaFunction PM_IMAGE_UNPREMULTIPLY_FUNCTIONS[6] = {
+    PM__ImageUnpremultiplyU8Scalar,
+    PM__ImageUnpremultiplyU16Scalar,
+    PM__ImageUnpremultiplyU32Scalar,
+    PM__ImageUnpremultiplyU64Scalar,
+    PM__ImageUnpremultiplyF32Scalar,
+    PM__ImageUnpremultiplyF64Scalar,
+};
+
+static volatile PM_Bool PM_IMAGE_CHANNEL_FUNCTIONS_SELECTED = PM_FALSE;
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageSelectChannelFunctions()
+{
+#if defined(PM_ARCH_X86)
+    if (PM_CPUHasFeature(PICOMEDIA_CPU_FEATURE_SSSE3))
+    {
+        PM_IMAGE_PERMUTE_FUNCTION = PM__ImagePermuteSSSE3;
+        PM_IMAGE_LUMA_FUNCTIONS[0] = PM__ImageLumaU8SSSE3;
+    }
+
+    if (PM_CPUHasFeature(PICOMEDIA_CPU_FEATURE_SSE41))
+    {
+        PM_IMAGE_LUMA_FUNCTIONS[1] = PM__ImageLumaU16SSE41;
+        PM_IMAGE_LUMA_FUNCTIONS[4] = PM__ImageLumaF32SSE41;
+        PM_IMAGE_PREMULTIPLY_FUNCTIONS[0] = PM__ImagePremultiplyU8SSE41;
+        PM_IMAGE_PREMULTIPLY_FUNCTIONS[1] = PM__ImagePremultiplyU16SSE41;
+        PM_IMAGE_PREMULTIPLY_FUNCTIONS[4] = PM__ImagePremultiplyF32SSE41;
+        PM_IMAGE_UNPREMULTIPLY_FUNCTIONS[0] = PM__ImageUnpremultiplyU8SSE41;
+        PM_IMAGE_UNPREMULTIPLY_FUNCTIONS[1] = PM__ImageUnpremultiplyU16SSE41;
+        PM_IMAGE_UNPREMULTIPLY_FUNCTIONS[4] = PM__ImageUnpremultiplyF32SSE41;
+    }
+#elif defined(PM_ARCH_ARM64)
+    PM_IMAGE_PERMUTE_FUNCTION = PM__ImagePermuteNEON;
+    PM_IMAGE_LUMA_FUNCTIONS[0] = PM__ImageLumaU8NEON;
+    PM_IMAGE_LUMA_FUNCTIONS[1] = PM__ImageLumaU16NEON;
+    PM_IMAGE_LUMA_FUNCTIONS[4] = PM__ImageLumaF32NEON;
+    PM_IMAGE_PREMULTIPLY_FUNCTIONS[0] = PM__ImagePremultiplyU8NEON;
+    PM_IMAGE_PREMULTIPLY_FUNCTIONS[1] = PM__ImagePremultiplyU16NEON;
+    PM_IMAGE_PREMULTIPLY_FUNCTIONS[4] = PM__ImagePremultiplyF32NEON;
+    PM_IMAGE_UNPREMULTIPLY_FUNCTIONS[0] = PM__ImageUnpremultiplyU8NEON;
+    PM_IMAGE_UNPREMULTIPLY_FUNCTIONS[1] = PM__ImageUnpremultiplyU16NEON;
+    PM_IMAGE_UNPREMULTIPLY_FUNCTIONS[4] = PM__ImageUnpremultiplyF32NEON;
+#endif
+
+    PM_IMAGE_CHANNEL_FUNCTIONS_SELECTED = PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImagePermuteBandWorker(PM_Size begin, PM_Size end, void* data)
+{
+    const PM__ImagePermuteBand* band = (const PM__ImagePermuteBand*)data;
+    PM_Size rowSize = band->pixelsPerRow * band->permute->srcPixelSize;
+
+    PM_IMAGE_PERMUTE_FUNCTION(band->permute, band->data + begin * rowSize, (end - begin) * band->pixelsPerRow);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageAlphaBandWorker(PM_Size begin, PM_Size end, void* data)
+{
+    const PM__ImageAlphaBand* band = (const PM__ImageAlphaBand*)data;
+
+    band->function(band->alpha, band->data + begin * band->pixelsPerRow * band->pixelSize, (end - begin) * band->pixelsPerRow);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageLumaBandWorker(PM_Size begin, PM_Size end, void* data)
+{
+    const PM__ImageLumaBand* band = (const PM__ImageLumaBand*)data;
+
+    // Every band is converted at the start of its own pixels, the bands are moved next to each other afterwards
+    for (PM_Size i = begin; i < end; i++)
+    {
+        PM_Size first = i * band->bandPixels;
+        PM_Byte* pixels = band->data + first * band->srcPixelSize;
+        band->function(band->luma, pixels, pixels, PM_Min(band->bandPixels, band->pixelCount - first));
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageRunLuma(const PM__ImageLuma* luma, PM__ImageLumaFunction function, PM_Byte* data, PM_Size pixelCount, PM_Size channelSize)
+{
+    PM_Size srcPixelSize = luma->srcChannels * channelSize;
+    PM_Size dstPixelSize = luma->dstChannels * channelSize;
+
+    // Converting in place only works front to back, so the bands cannot write their final position directly
+    PM_Size threadCount = PM_ThreadPoolGetThreadCount(NULL) + 1;
+    PM_Size bandCount = PM_Min(threadCount * PM_IMAGE_CHANNEL_BANDS_PER_THREAD, pixelCount / PM_IMAGE_CHANNEL_MIN_BAND_PIXELS);
+
+    if (threadCount == 1 || bandCount <= 1)
+    {
+        function(luma, data, data, pixelCount);
+        return;
+    }
+
+    PM__ImageLumaBand band;
+    band.luma = luma;
+    band.function = function;
+    band.data = data;
+    band.srcPixelSize = srcPixelSize;
+    band.bandPixels = (pixelCount + bandCount - 1) / bandCount;
+    band.pixelCount = pixelCount;
+
+    // Rounding the band size up can leave the last bands empty
+    bandCount = (pixelCount + band.bandPixels - 1) / band.bandPixels;
+
+    PM_ParallelFor(NULL, 0, bandCount, 1, PM__ImageLumaBandWorker, &band);
+
+    // Every band ends before the next one starts, in both the source and destination layouts
+    for (PM_Size i = 1; i < bandCount; i++)
+    {
+        PM_Size first = i * band.bandPixels;
+        PM_Memmove(data + first * dstPixelSize, data + first * srcPixelSize, PM_Min(band.bandPixels, pixelCount - first) * dstPixelSize);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PM_ImageTransformsChangeChannelFormat(PM_Image* image, PM_UInt32 newChannelFormat)
+{
+    return PM_ImageTransformsChangeChannelFormatEx(image, newChannelFormat, 0);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PM_ImageTransformsChangeChannelFormatEx(PM_Image* image, PM_UInt32 newChannelFormat, PM_UInt32 flags)
+{
+    PM_Assert(image != NULL);
+
+    PM_UInt32 alphaFlags = flags & (PICOMEDIA_IMAGE_CONVERSION_FLAG_PREMULTIPLY_ALPHA | PICOMEDIA_IMAGE_CONVERSION_FLAG_UNPREMULTIPLY_ALPHA);
+
+    if (image->channelFormat == newChannelFormat && alphaFlags == 0)
+    {
+        return PM_TRUE;
+    }
+
+    PM_UInt8 srcLayout[PM_IMAGE_MAX_CHANNELS];
+    PM_UInt8 dstLayout[PM_IMAGE_MAX_CHANNELS];
+    PM_UInt8 srcChannels = PM__ImageGetChannelLayout(image->channelFormat, srcLayout);
+    PM_UInt8 dstChannels = PM__ImageGetChannelLayout(newChannelFormat, dstLayout);
+
+    PM__ImagePermute permute;
+    permute.channelSize = image->bitsPerChannel / 8;
+    permute.srcPixelSize = permute.channelSize * srcChannels;
+    permute.dstPixelSize = permute.channelSize * dstChannels;
+    permute.dstChannels = dstChannels;
+
+    if (srcChannels == 0 || dstChannels == 0 || srcChannels != image->numChannels
+        || !PM__ImageGetOpaqueValue(image->dataType, permute.opaque))
+    {
+        PM_LogError("Unsupported channel format conversion!");
+        return PM_FALSE;
+    }
+
+    if (alphaFlags == (PICOMEDIA_IMAGE_CONVERSION_FLAG_PREMULTIPLY_ALPHA | PICOMEDIA_IMAGE_CONVERSION_FLAG_UNPREMULTIPLY_ALPHA))
+    {
+        PM_LogError("Alpha cannot be premultiplied and unpremultiplied at the same time!");
+        return PM_FALSE;
+    }
+
+    if (!PM_IMAGE_CHANNEL_FUNCTIONS_SELECTED)
+    {
+        PM__ImageSelectChannelFunctions();
+    }
+
+    PM_Size pixelCount = (PM_Size)image->width * image->height;
+    PM_Size dataTypeIndex = image->dataType - PICOIMEDIA_IMAGE_DATA_TYPE_UINT8;
+    PM_Size grain = PM_Max(PM_IMAGE_CHANNEL_MIN_BAND_PIXELS / PM_Max((PM_Size)image->width, (PM_Size)1), (PM_Size)1);
+    PM_Int8 srcAlpha = PM__ImageFindChannel(srcLayout, srcChannels, PM_IMAGE_CHANNEL_ALPHA);
+
+    // The alpha representation changes on the source pixels, every other conversion below is linear in the color channels
+    if (alphaFlags != 0 && srcAlpha >= 0)
+    {
+        PM__ImageAlpha alpha;
+        alpha.channels = srcChannels;
+        alpha.alpha = (PM_Size)srcAlpha;
+        PM__ImageBuildAlphaShuffle(&alpha, permute.channelSize);
+
+        PM__ImageAlphaBand band;
+        band.alpha = &alpha;
+        band.function = alphaFlags == PICOMEDIA_IMAGE_CONVERSION_FLAG_PREMULTIPLY_ALPHA ? PM_IMAGE_PREMULTIPLY_FUNCTIONS[dataTypeIndex]
+                                                                                      : PM_IMAGE_UNPREMULTIPLY_FUNCTIONS[dataTypeIndex];
+        band.data = image->data;
+        band.pixelsPerRow = image->width;
+        band.pixelSize = permute.srcPixelSize;
+
+        PM_ParallelFor(NULL, 0, image->height, grain, PM__ImageAlphaBandWorker, &band);
+    }
+
+    if (image->channelFormat == newChannelFormat)
+    {
+        return PM_TRUE;
+    }
+
+    PM_Bool needsLuma = PM_FALSE;
+
+    for (PM_UInt8 i = 0; i < dstChannels; i++)
+    {
+        PM_Int8 channel = PM__ImageFindChannel(srcLayout, srcChannels, dstLayout[i]);
+
+        if (channel < 0 && dstLayout[i] == PM_IMAGE_CHANNEL_ALPHA)
+        {
+            channel = PM_IMAGE_CHANNEL_OPAQUE;
+        }
+        else if (channel < 0 && dstLayout[i] == PM_IMAGE_CHANNEL_GRAY)
+        {
+            needsLuma = PM_TRUE;
+        }
+        else if (channel < 0)
+        {
+            // Color from gray, all of red, green and blue take the gray value
+            channel = PM__ImageFindChannel(srcLayout, srcChannels, PM_IMAGE_CHANNEL_GRAY);
+        }
+
+        permute.map[i] = channel;
+    }
+
+    if (needsLuma)
+    {
+        PM_Size standard = (flags & PICOMEDIA_IMAGE_CONVERSION_FLAG_REC709) ? 1 : 0;
+
+        PM__ImageLuma luma;
+        luma.srcChannels = srcChannels;
+        luma.dstChannels = dstChannels;
+        luma.red = (PM_Size)PM__ImageFindChannel(srcLayout, srcChannels, PM_IMAGE_CHANNEL_RED);
+        luma.green = (PM_Size)PM__ImageFindChannel(srcLayout, srcChannels, PM_IMAGE_CHANNEL_GREEN);
+        luma.blue = (PM_Size)PM__ImageFindChannel(srcLayout, srcChannels, PM_IMAGE_CHANNEL_BLUE);
+        luma.alpha = srcAlpha >= 0 ? srcAlpha : PM_IMAGE_CHANNEL_OPAQUE;
+        PM_Memcpy(luma.opaque, permute.opaque, sizeof(luma.opaque));
+
+        for (PM_Size i = 0; i < 3; i++)
+        {
+            luma.weights8[i] = PM_IMAGE_LUMA_WEIGHTS_8[standard][i];
+            luma.weights16[i] = PM_IMAGE_LUMA_WEIGHTS_16[standard][i];
+            luma.weights[i] = PM_IMAGE_LUMA_WEIGHTS[standard][i];
+        }
+
+        PM__ImageRunLuma(&luma, PM_IMAGE_LUMA_FUNCTIONS[dataTypeIndex], image->data, pixelCount, permute.channelSize);
+    }
+    else if (permute.dstPixelSize == permute.srcPixelSize)
+    {
+        PM__ImageBuildPermuteShuffle(&permute);
+
+        // Swizzles touch every pixel independently, so they can be split in bands of rows
+        PM__ImagePermuteBand band;
+        band.permute = &permute;
+        band.data = image->data;
+        band.pixelsPerRow = image->width;
+
+        PM_ParallelFor(NULL, 0, image->height, grain, PM__ImagePermuteBandWorker, &band);
+    }
+    else
+    {
+        // Growing pixels are expanded back to front in the same buffer, which only has to grow if its capacity is too small
+        if (permute.dstPixelSize > permute.srcPixelSize && !PM_ImageReserve(image, pixelCount * permute.dstPixelSize))
+        {
+            PM_LogError("Failed to allocate memory for the converted image!");
+            return PM_FALSE;
+        }
+
+        PM__ImageBuildPermuteShuffle(&permute);
+        PM_IMAGE_PERMUTE_FUNCTION(&permute, image->data, pixelCount);
+    }
+
+    image->channelFormat = newChannelFormat;
+    image->numChannels = dstChannels;
+    image->dataSize = pixelCount * permute.dstPixelSize;
+
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
@@ -0,0 +1,855 @@
+#include "libpicomedia/image/image_transforms.h"
+#include "libpicomedia/common/cpu.h"
+
+#if defined(PM_ARCH_X86)
+    #include <immintrin.h>
+#elif defined(PM_ARCH_ARM64)
+    #include <arm_neon.h>
+#endif
+
+// Number of supported data types, they are numbered consecutively from PICOIMEDIA_IMAGE_DATA_TYPE_UINT8
+#define PM_IMAGE_DATA_TYPE_COUNT 6
+
+// Smallest number of samples converted by a single task, below this the threading overhead dominates
+#define PM_IMAGE_CONVERT_MIN_BAND_SAMPLES (1 << 16)
+
+// Number of bands per thread, so threads that finish early can pick up the remaining ones
+#define PM_IMAGE_CONVERT_BANDS_PER_THREAD 4
+
+// Runs at least this long are written with non-temporal stores, their output would not stay in the cache anyway
+#define PM_IMAGE_CONVERT_STREAM_SAMPLES (1 << 20)
+
+// Converts count consecutive samples from one data type to another
+typedef void (*PM__ImageConvertFunction)(const PM_Byte* src, PM_Byte* dst, PM_Size count);
+
+typedef struct PM__ImageConvertBand
+{
+    const PM_Byte* src;
+    PM_Byte* dst;
+    PM_Size srcRowSize;
+    PM_Size dstRowSize;
+    PM_Size samplesPerRow;
+    PM__ImageConvertFunction function;
+} PM__ImageConvertBand;
+
+// -----------------------------------------------------------------------------------------------
+
+// All the conversions map [0, max] of the integer types onto [0.0, 1.0] of the floating point types.
+// Widening integer conversions replicate the bits (0xAB -> 0xABAB) which is an exact multiplication by
+// (2^N - 1) / (2^M - 1), narrowing ones divide by the same factor and round to nearest.
+// Floating point values are clamped to [0.0, 1.0] before being rounded to an integer, NaN becomes 0.
+
+#define PM__IMAGE_DEFINE_CONVERT_WIDEN(name, SrcType, DstType, factor) \
+    static void PM__ImageConvert##name##Scalar(const PM_Byte* src, PM_Byte* dst, PM_Size count) \
+    { \
+        const SrcType* s = (const SrcType*)src; \
+        DstType* d = (DstType*)dst; \
+        for (PM_Size i = 0; i < count; i++) \
+        { \
+            d[i] = (DstType)((DstType)s[i] * (DstType)(factor)); \
+        } \
+    }
+
+#define PM__IMAGE_DEFINE_CONVERT_NARROW(name, SrcType, DstType, divisor) \
+    static void PM__ImageConvert##name##Scalar(const PM_Byte* src, PM_Byte* dst, PM_Size count) \
+    { \
+        const SrcType* s = (const SrcType*)src; \
+        DstType* d = (DstType*)dst; \
+        for (PM_Size i = 0; i < count; i++) \
+        { \
+            SrcType q = s[i] / (SrcType)(divisor); \
+            SrcType r = s[i] - q * (SrcType)(divisor); \
+            d[i] = (DstType)(q + (r > (SrcType)(divisor) / 2)); \
+        } \
+    }
+
+#define PM__IMAGE_DEFINE_CONVERT_TO_FLOAT(name, SrcType, DstType, MathType, maxValue) \
+    static void PM__ImageConvert##name##Scalar(const PM_Byte* src, PM_Byte* dst, PM_Size count) \
+    { \
+        const SrcType* s = (const SrcType*)src; \
+        DstType* d = (DstType*)dst; \
+        const MathType scale = (MathType)1 / (MathType)(maxValue); \
+        for (PM_Size i = 0; i < count; i++) \
+        { \
+            d[i] = (DstType)((MathType)s[i] * scale); \
+        } \
+    }
+
+#define PM__IMAGE_DEFINE_CONVERT_FROM_FLOAT(name, SrcType, DstType, MathType, maxValue) \
+    static void PM__ImageConvert##name##Scalar(const PM_Byte* src, PM_Byte* dst, PM_Size count) \
+    { \
+        const SrcType* s = (const SrcType*)src; \
+        DstType* d = (DstType*)dst; \
+        for (PM_Size i = 0; i < count; i++) \
+        { \
+            MathType x = (MathType)s[i]; \
+            x = x > 0 ? x : 0; \
+            d[i] = x >= 1 ? (DstType)(maxValue) : (DstType)(x * (MathType)(maxValue) + (MathType)0.5); \
+        } \
+    }
+
+#define PM__IMAGE_DEFINE_CONVERT_FLOAT(name, SrcType, DstType) \
+    static void PM__ImageConvert##name##Scalar(const PM_Byte* src, PM_Byte* dst, PM_Size count) \
+    { \
+        const SrcType* s = (const SrcType*)src; \
+        DstType* d = (DstType*)dst; \
+        for (PM_Size i = 0; i < count; i++) \
+        { \
+            d[i] = (DstType)s[i]; \
+        } \
+    }
+
+PM__IMAGE_DEFINE_CONVERT_WIDEN(U8ToU16, PM_UInt8, PM_UInt16, 0x0101)
+PM__IMAGE_DEFINE_CONVERT_WIDEN(U8ToU32, PM_UInt8, PM_UInt32, 0x01010101)
+PM__IMAGE_DEFINE_CONVERT_WIDEN(U8ToU64, PM_UInt8, PM_UInt64, 0x0101010101010101ULL)
+PM__IMAGE_DEFINE_CONVERT_WIDEN(U16ToU32, PM_UInt16, PM_UInt32, 0x00010001)
+PM__IMAGE_DEFINE_CONVERT_WIDEN(U16ToU64, PM_UInt16, PM_UInt64, 0x0001000100010001ULL)
+PM__IMAGE_DEFINE_CONVERT_WIDEN(U32ToU64, PM_UInt32, PM_UInt64, 0x0000000100000001ULL)
+
+PM__IMAGE_DEFINE_CONVERT_NARROW(U16ToU8, PM_UInt16, PM_UInt8, 0x0101)
+PM__IMAGE_DEFINE_CONVERT_NARROW(U32ToU8, PM_UInt32, PM_UInt8, 0x01010101)
+PM__IMAGE_DEFINE_CONVERT_NARROW(U32ToU16, PM_UInt32, PM_UInt16, 0x00010001)
+PM__IMAGE_DEFINE_CONVERT_NARROW(U64ToU8, PM_UInt64, PM_UInt8, 0x0101010101010101ULL)
+PM__IMAGE_DEFINE_CONVERT_NARROW(U64ToU16, PM_UInt64, PM_UInt16, 0x0001000100010001ULL)
+PM__IMAGE_DEFINE_CONVERT_NARROW(U64ToU32, PM_UInt64, PM_UInt32, 0x0000000100000001ULL)
+
+PM__IMAGE_DEFINE_CONVERT_TO_FLOAT(U8ToF32, PM_UInt8, PM_Float32, PM_Float32, 0xFF)
+PM__IMAGE_DEFINE_CONVERT_TO_FLOAT(U8ToF64, PM_UInt8, PM_Float64, PM_Float64, 0xFF)
+PM__IMAGE_DEFINE_CONVERT_TO_FLOAT(U16ToF32, PM_UInt16, PM_Float32, PM_Float32, 0xFFFF)
+PM__IMAGE_DEFINE_CONVERT_TO_FLOAT(U16ToF64, PM_UInt16, PM_Float64, PM_Float64, 0xFFFF)
+PM__IMAGE_DEFINE_CONVERT_TO_FLOAT(U32ToF32, PM_UInt32, PM_Float32, PM_Float64, 0xFFFFFFFFU)
+PM__IMAGE_DEFINE_CONVERT_TO_FLOAT(U32ToF64, PM_UInt32, PM_Float64, PM_Float64, 0xFFFFFFFFU)
+PM__IMAGE_DEFINE_CONVERT_TO_FLOAT(U64ToF32, PM_UInt64, PM_Float32, PM_Float64, 0xFFFFFFFFFFFFFFFFULL)
+PM__IMAGE_DEFINE_CONVERT_TO_FLOAT(U64ToF64, PM_UInt64, PM_Float64, PM_Float64, 0xFFFFFFFFFFFFFFFFULL)
+
+PM__IMAGE_DEFINE_CONVERT_FROM_FLOAT(F32ToU8, PM_Float32, PM_UInt8, PM_Float32, 0xFF)
+PM__IMAGE_DEFINE_CONVERT_FROM_FLOAT(F32ToU16, PM_Float32, PM_UInt16, PM_Float32, 0xFFFF)
+PM__IMAGE_DEFINE_CONVERT_FROM_FLOAT(F32ToU32, PM_Float32, PM_UInt32, PM_Float64, 0xFFFFFFFFU)
+PM__IMAGE_DEFINE_CONVERT_FROM_FLOAT(F32ToU64, PM_Float32, PM_UInt64, PM_Float64, 0xFFFFFFFFFFFFFFFFULL)
+PM__IMAGE_DEFINE_CONVERT_FROM_FLOAT(F64ToU8, PM_Float64, PM_UInt8, PM_Float64, 0xFF)
+PM__IMAGE_DEFINE_CONVERT_FROM_FLOAT(F64ToU16, PM_Float64, PM_UInt16, PM_Float64, 0xFFFF)
+PM__IMAGE_DEFINE_CONVERT_FROM_FLOAT(F64ToU32, PM_Float64, PM_UInt32, PM_Float64, 0xFFFFFFFFU)
+PM__IMAGE_DEFINE_CONVERT_FROM_FLOAT(F64ToU64, PM_Float64, PM_UInt64, PM_Float64, 0xFFFFFFFFFFFFFFFFULL)
+
+PM__IMAGE_DEFINE_CONVERT_FLOAT(F32ToF64, PM_Float32, PM_Float64)
+PM__IMAGE_DEFINE_CONVERT_FLOAT(F64ToF32, PM_Float64, PM_Float32)
+
+// -----------------------------------------------------------------------------------------------
+
+#if defined(PM_ARCH_X86)
+
+// Number of leading samples left to the scalar code so that the vector stores are aligned,
+// stores split across two cache lines are several times slower once the data no longer fits in the cache
+static PM_Size PM__ImageConvertGetHeadCount(const PM_Byte* dst, PM_Size dstElementSize, PM_Size alignment, PM_Size count)
+{
+    PM_Size misalignment = (PM_Size)dst & (alignment - 1);
+    PM_Size head = misalignment != 0 ? (alignment - misalignment) / dstElementSize : 0;
+    return PM_Min(head, count);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Long runs are written around the cache, the stores have to be aligned then
+static PM_Bool PM__ImageConvertShouldStream(const void* dst, PM_Size count)
+{
+    return count >= PM_IMAGE_CONVERT_STREAM_SAMPLES && ((PM_Size)dst & 31) == 0;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("avx") void PM__ImageConvertStoreF32AVX(PM_Float32* dst, __m256 x, PM_Bool stream)
+{
+    if (stream)
+    {
+        _mm256_stream_ps(dst, x);
+    }
+    else
+    {
+        _mm256_storeu_ps(dst, x);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("avx") void PM__ImageConvertStoreF64AVX(PM_Float64* dst, __m256d x, PM_Bool stream)
+{
+    if (stream)
+    {
+        _mm256_stream_pd(dst, x);
+    }
+    else
+    {
+        _mm256_storeu_pd(dst, x);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("sse4.1") void PM__ImageConvertU8ToF32SSE41(const PM_Byte* src, PM_Byte* dst, PM_Size count)
+{
+    PM_Float32* d = (PM_Float32*)dst;
+    const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+    PM_Size i = PM__ImageConvertGetHeadCount(dst, sizeof(PM_Float32), 16, count);
+    PM__ImageConvertU8ToF32Scalar(src, dst, i);
+
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i*)(src + i));
+        _mm_storeu_ps(d + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(x)), scale));
+        _mm_storeu_ps(d + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_srli_si128(x, 4))), scale));
+        _mm_storeu_ps(d + i + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_srli_si128(x, 8))), scale));
+        _mm_storeu_ps(d + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_srli_si128(x, 12))), scale));
+    }
+
+    PM__ImageConvertU8ToF32Scalar(src + i, dst + i * sizeof(PM_Float32), count - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("sse4.1") void PM__ImageConvertU16ToF32SSE41(const PM_Byte* src, PM_Byte* dst, PM_Size count)
+{
+    const PM_UInt16* s = (const PM_UInt16*)src;
+    PM_Float32* d = (PM_Float32*)dst;
+    const __m128 scale = _mm_set1_ps(1.0f / 65535.0f);
+    PM_Size i = PM__ImageConvertGetHeadCount(dst, sizeof(PM_Float32), 16, count);
+    PM__ImageConvertU16ToF32Scalar(src, dst, i);
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i*)(s + i));
+        _mm_storeu_ps(d + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepu16_epi32(x)), scale));
+        _mm_storeu_ps(d + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepu16_epi32(_mm_srli_si128(x, 8))), scale));
+    }
+
+    PM__ImageConvertU16ToF32Scalar(src + i * sizeof(PM_UInt16), dst + i * sizeof(PM_Float32), count - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Clamps to [0, 1] and scales to [0.5, max + 0.5] so the truncating conversion rounds to nearest,
+// max_ps returns its second operand when the first one is NaN so NaN ends up as 0 like in the scalar code
+static PM_TARGET("sse4.1") __m128i PM__ImageConvertQuantizeSSE41(__m128 x, __m128 maxValue)
+{
+    x = _mm_min_ps(_mm_max_ps(x, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(x, maxValue), _mm_set1_ps(0.5f)));
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("sse4.1") void PM__ImageConvertF32ToU8SSE41(const PM_Byte* src, PM_Byte* dst, PM_Size count)
+{
+    const PM_Float32* s = (const PM_Float32*)src;
+    const __m128 maxValue = _mm_set1_ps(255.0f);
+    PM_Size i = PM__ImageConvertGetHeadCount(dst, sizeof(PM_UInt8), 16, count);
+    PM__ImageConvertF32ToU8Scalar(src, dst, i);
+
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i a = PM__ImageConvertQuantizeSSE41(_mm_loadu_ps(s + i), maxValue);
+        __m128i b = PM__ImageConvertQuantizeSSE41(_mm_loadu_ps(s + i + 4), maxValue);
+        __m128i c = PM__ImageConvertQuantizeSSE41(_mm_loadu_ps(s + i + 8), maxValue);
+        __m128i e = PM__ImageConvertQuantizeSSE41(_mm_loadu_ps(s + i + 12), maxValue);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(_mm_packus_epi32(a, b), _mm_packus_epi32(c, e)));
+    }
+
+    PM__ImageConvertF32ToU8Scalar(src + i * sizeof(PM_Float32), dst + i, count - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("sse4.1") void PM__ImageConvertF32ToU16SSE41(const PM_Byte* src, PM_Byte* dst, PM_Size count)
+{
+    const PM_Float32* s = (const PM_Float32*)src;
+    PM_UInt16* d = (PM_UInt16*)dst;
+    const __m128 maxValue = _mm_set1_ps(65535.0f);
+    PM_Size i = PM__ImageConvertGetHeadCount(dst, sizeof(PM_UInt16), 16, count);
+    PM__ImageConvertF32ToU16Scalar(src, dst, i);
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i a = PM__ImageConvertQuantizeSSE41(_mm_loadu_ps(s + i), maxValue);
+        __m128i b = PM__ImageConvertQuantizeSSE41(_mm_loadu_ps(s + i + 4), maxValue);
+        _mm_storeu_si128((__m128i*)(d + i), _mm_packus_epi32(a, b));
+    }
+
+    PM__ImageConvertF32ToU16Scalar(src + i * sizeof(PM_Float32), dst + i * sizeof(PM_UInt16), count - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("sse4.1") void PM__ImageConvertU8ToU16SSE41(const PM_Byte* src, PM_Byte* dst, PM_Size count)
+{
+    PM_UInt16* d = (PM_UInt16*)dst;
+    PM_Size i = PM__ImageConvertGetHeadCount(dst, sizeof(PM_UInt16), 16, count);
+    PM__ImageConvertU8ToU16Scalar(src, dst, i);
+
+    // Interleaving a byte with itself gives v | (v << 8), that is v * 257
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i*)(src + i));
+        _mm_storeu_si128((__m128i*)(d + i), _mm_unpacklo_epi8(x, x));
+        _mm_storeu_si128((__m128i*)(d + i + 8), _mm_unpackhi_epi8(x, x));
+    }
+
+    PM__ImageConvertU8ToU16Scalar(src + i, dst + i * sizeof(PM_UInt16), count - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// round(v / 257) is (t - (t >> 8)) >> 8 with t = v + 128, the saturation only affects values that round to 255 anyway
+static PM_TARGET("sse4.1") __m128i PM__ImageConvertDivide257SSE41(__m128i x)
+{
+    __m128i t = _mm_adds_epu16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_sub_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("sse4.1") void PM__ImageConvertU16ToU8SSE41(const PM_Byte* src, PM_Byte* dst, PM_Size count)
+{
+    const PM_UInt16* s = (const PM_UInt16*)src;
+    PM_Size i = PM__ImageConvertGetHeadCount(dst, sizeof(PM_UInt8), 16, count);
+    PM__ImageConvertU16ToU8Scalar(src, dst, i);
+
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i a = PM__ImageConvertDivide257SSE41(_mm_loadu_si128((const __m128i*)(s + i)));
+        __m128i b = PM__ImageConvertDivide257SSE41(_mm_loadu_si128((const __m128i*)(s + i + 8)));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(a, b));
+    }
+
+    PM__ImageConvertU16ToU8Scalar(src + i * sizeof(PM_UInt16), dst + i, count - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("avx2") void PM__ImageConvertU8ToF32AVX2(const PM_Byte* src, PM_Byte* dst, PM_Size count)
+{
+    PM_Float32* d = (PM_Float32*)dst;
+    const __m256 scale = _mm256_set1_ps(1.0f / 255.0f);
+    PM_Size i = PM__ImageConvertGetHeadCount(dst, sizeof(PM_Float32), 32, count);
+    PM__ImageConvertU8ToF32Scalar(src, dst, i);
+    PM_Bool stream = PM__ImageConvertShouldStream(d + i, count - i);
+
+    for (; i + 32 <= count; i += 32)
+    {
+        for (PM_Size j = 0; j < 32; j += 8)
+        {
+            __m256i x = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(src + i + j)));
+            PM__ImageConvertStoreF32AVX(d + i + j, _mm256_mul_ps(_mm256_cvtepi32_ps(x), scale), stream);
+        }
+    }
+
+    if (stream)
+    {
+        _mm_sfence();
+    }
+
+    PM__ImageConvertU8ToF32Scalar(src + i, dst + i * sizeof(PM_Float32), count - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("avx2") void PM__ImageConvertU16ToF32AVX2(const PM_Byte* src, PM_Byte* dst, PM_Size count)
+{
+    const PM_UInt16* s = (const PM_UInt16*)src;
+    PM_Float32* d = (PM_Float32*)dst;
+    const __m256 scale = _mm256_set1_ps(1.0f / 65535.0f);
+    PM_Size i = PM__ImageConvertGetHeadCount(dst, sizeof(PM_Float32), 32, count);
+    PM__ImageConvertU16ToF32Scalar(src, dst, i);
+    PM_Bool stream = PM__ImageConvertShouldStream(d + i, count - i);
+
+    for (; i + 16 <= count; i += 16)
+    {
+        __m256i a = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(s + i)));
+        __m256i b = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(s + i + 8)));
+        PM__ImageConvertStoreF32AVX(d + i, _mm256_mul_ps(_mm256_cvtepi32_ps(a), scale), stream);
+        PM__ImageConvertStoreF32AVX(d + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(b), scale), stream);
+    }
+
+    if (stream)
+    {
+        _mm_sfence();
+    }
+
+    PM__ImageConvertU16ToF32Scalar(src + i * sizeof(PM_UInt16), dst + i * sizeof(PM_Float32), count - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("avx2") __m256i PM__ImageConvertQuantizeAVX2(__m256 x, __m256 maxValue)
+{
+    x = _mm256_min_ps(_mm256_max_ps(x, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+    return _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(x, maxValue), _mm256_set1_ps(0.5f)));
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("avx2") void PM__ImageConvertF32ToU8AVX2(const PM_Byte* src, PM_Byte* dst, PM_Size count)
+{
+    const PM_Float32* s = (const PM_Float32*)src;
+    const __m256 maxValue = _mm256_set1_ps(255.0f);
+    // The packs work within 128-bit lanes, this puts the 32-bit groups back in order
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    PM_Size i = PM__ImageConvertGetHeadCount(dst, sizeof(PM_UInt8), 32, count);
+    PM__ImageConvertF32ToU8Scalar(src, dst, i);
+
+    for (; i + 32 <= count; i += 32)
+    {
+        __m256i a = PM__ImageConvertQuantizeAVX2(_mm256_loadu_ps(s + i), maxValue);
+        __m256i b = PM__ImageConvertQuantizeAVX2(_mm256_loadu_ps(s + i + 8), maxValue);
+        __m256i c = PM__ImageConvertQuantizeAVX2(_mm256_loadu_ps(s + i + 16), maxValue);
+        __m256i e = PM__ImageConvertQuantizeAVX2(_mm256_loadu_ps(s + i + 24), maxValue);
+        __m256i packed = _mm256_packus_epi16(_mm256_packus_epi32(a, b), _mm256_packus_epi32(c, e));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_permutevar8x32_epi32(packed, order));
+    }
+
+    PM__ImageConvertF32ToU8Scalar(src + i * sizeof(PM_Float32), dst + i, count - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("avx2") void PM__ImageConvertF32ToU16AVX2(const PM_Byte* src, PM_Byte* dst, PM_Size count)
+{
+    const PM_Float32* s = (const PM_Float32*)src;
+    PM_UInt16* d = (PM_UInt16*)dst;
+    const __m256 maxValue = _mm256_set1_ps(65535.0f);
+    PM_Size i = PM__ImageConvertGetHeadCount(dst, sizeof(PM_UInt16), 32, count);
+    PM__ImageConvertF32ToU16Scalar(src, dst, i);
+
+    for (; i + 16 <= count; i += 16)
+    {
+        __m256i a = PM__ImageConvertQuantizeAVX2(_mm256_loadu_ps(s + i), maxValue);
+        __m256i b = PM__ImageConvertQuantizeAVX2(_mm256_loadu_ps(s + i + 8), maxValue);
+        __m256i packed = _mm256_packus_epi32(a, b);
+        _mm256_storeu_si256((__m256i*)(d + i), _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+
+    PM__ImageConvertF32ToU16Scalar(src + i * sizeof(PM_Float32), dst + i * sizeof(PM_UInt16), count - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("avx2") void PM__ImageConvertU8ToU16AVX2(const PM_Byte* src, PM_Byte* dst, PM_Size count)
+{
+    PM_UInt16* d = (PM_UInt16*)dst;
+    PM_Size i = PM__ImageConvertGetHeadCount(dst, sizeof(PM_UInt16), 32, count);
+    PM__ImageConvertU8ToU16Scalar(src, dst, i);
+
+    for (; i + 32 <= count; i += 32)
+    {
+        __m256i a = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(src + i)));
+        __m256i b = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(src + i + 16)));
+        _mm256_storeu_si256((__m256i*)(d + i), _mm256_or_si256(a, _mm256_slli_epi16(a, 8)));
+        _mm256_storeu_si256((__m256i*)(d + i + 16), _mm256_or_si256(b, _mm256_slli_epi16(b, 8)));
+    }
+
+    PM__ImageConvertU8ToU16Scalar(src + i, dst + i * sizeof(PM_UInt16), count - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("avx2") __m256i PM__ImageConvertDivide257AVX2(__m256i x)
+{
+    __m256i t = _mm256_adds_epu16(x, _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_sub_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("avx2") void PM__ImageConvertU16ToU8AVX2(const PM_Byte* src, PM_Byte* dst, PM_Size count)
+{
+    const PM_UInt16* s = (const PM_UInt16*)src;
+    PM_Size i = PM__ImageConvertGetHeadCount(dst, sizeof(PM_UInt8), 32, count);
+    PM__ImageConvertU16ToU8Scalar(src, dst, i);
+
+    for (; i + 32 <= count; i += 32)
+    {
+        __m256i a = PM__ImageConvertDivide257AVX2(_mm256_loadu_si256((const __m256i*)(s + i)));
+        __m256i b = PM__ImageConvertDivide257AVX2(_mm256_loadu_si256((const __m256i*)(s + i + 16)));
+        __m256i packed = _mm256_packus_epi16(a, b);
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+
+    PM__ImageConvertU16ToU8Scalar(src + i * sizeof(PM_UInt16), dst + i, count - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("avx") void PM__ImageConvertF32ToF64AVX(const PM_Byte* src, PM_Byte* dst, PM_Size count)
+{
+    const PM_Float32* s = (const PM_Float32*)src;
+    PM_Float64* d = (PM_Float64*)dst;
+    PM_Size i = PM__ImageConvertGetHeadCount(dst, sizeof(PM_Float64), 32, count);
+    PM__ImageConvertF32ToF64Scalar(src, dst, i);
+    PM_Bool stream = PM__ImageConvertShouldStream(d + i, count - i);
+
+    for (; i + 8 <= count; i += 8)
+    {
+        PM__ImageConvertStoreF64AVX(d + i, _mm256_cvtps_pd(_mm_loadu_ps(s + i)), stream);
+        PM__ImageConvertStoreF64AVX(d + i + 4, _mm256_cvtps_pd(_mm_loadu_ps(s + i + 4)), stream);
+    }
+
+    if (stream)
+    {
+        _mm_sfence();
+    }
+
+    PM__ImageConvertF32ToF64Scalar(src + i * sizeof(PM_Float32), dst + i * sizeof(PM_Float64), count - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("avx") void PM__ImageConvertF64ToF32AVX(const PM_Byte* src, PM_Byte* dst, PM_Size count)
+{
+    const PM_Float64* s = (const PM_Float64*)src;
+    PM_Float32* d = (PM_Float32*)dst;
+    PM_Size i = PM__ImageConvertGetHeadCount(dst, sizeof(PM_Float32), 32, count);
+    PM__ImageConvertF64ToF32Scalar(src, dst, i);
+
+    for (; i + 8 <= count; i += 8)
+    {
+        _mm_storeu_ps(d + i, _mm256_cvtpd_ps(_mm256_loadu_pd(s + i)));
+        _mm_storeu_ps(d + i + 4, _mm256_cvtpd_ps(_mm256_loadu_pd(s + i + 4)));
+    }
+
+    PM__ImageConvertF64ToF32Scalar(src + i * sizeof(PM_Float64), dst + i * sizeof(PM_Float32), count - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+#elif defined(PM_ARCH_ARM64)
+
+static void PM__ImageConvertU8ToF32NEON(const PM_Byte* src, PM_Byte* dst, PM_Size count)
+{
+    PM_Float32* d = (PM_Float32*)dst;
+    const float32x4_t scale = vdupq_n_f32(1.0f / 255.0f);
+    PM_Size i = 0;
+
+    for (; i + 16 <= count; i += 16)
+    {
+        uint8x16_t x = vld1q_u8(src + i);
+        uint16x8_t lo = vmovl_u8(vget_low_u8(x));
+        uint16x8_t hi = vmovl_u8(vget_high_u8(x));
+        vst1q_f32(d + i, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(lo))), scale));
+        vst1q_f32(d + i + 4, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(lo))), scale));
+        vst1q_f32(d + i + 8, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(hi))), scale));
+        vst1q_f32(d + i + 12, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(hi))), scale));
+    }
+
+    PM__ImageConvertU8ToF32Scalar(src + i, dst + i * sizeof(PM_Float32), count - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageConvertU16ToF32NEON(const PM_Byte* src, PM_Byte* dst, PM_Size count)
+{
+    const PM_UInt16* s = (const PM_UInt16*)src;
+    PM_Float32* d = (PM_Float32*)dst;
+    const float32x4_t scale = vdupq_n_f32(1.0f / 65535.0f);
+    PM_Size i = 0;
+
+    for (; i + 8 <= count; i += 8)
+    {
+        uint16x8_t x = vld1q_u16(s + i);
+        vst1q_f32(d + i, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(x))), scale));
+        vst1q_f32(d + i + 4, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(x))), scale));
+    }
+
+    PM__ImageConvertU16ToF32Scalar(src + i * sizeof(PM_UInt16), dst + i * sizeof(PM_Float32), count - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// The float to unsigned conversion truncates and turns NaN into 0, as the scalar code does
+static uint32x4_t PM__ImageConvertQuantizeNEON(float32x4_t x, float32x4_t maxValue)
+{
+    x = vminq_f32(vmaxq_f32(x, vdupq_n_f32(0.0f)), vdupq_n_f32(1.0f));
+    return vcvtq_u32_f32(vaddq_f32(vmulq_f32(x, maxValue), vdupq_n_f32(0.5f)));
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageConvertF32ToU8NEON(const PM_Byte* src, PM_Byte* dst, PM_Size count)
+{
+    const PM_Float32* s = (const PM_Float32*)src;
+    const float32x4_t maxValue = vdupq_n_f32(255.0f);
+    PM_Size i = 0;
+
+    for (; i + 16 <= count; i += 16)
+    {
+        uint16x8_t lo = vcombine_u16(vmovn_u32(PM__ImageConvertQuantizeNEON(vld1q_f32(s + i), maxValue)),
+                                     vmovn_u32(PM__ImageConvertQuantizeNEON(vld1q_f32(s + i + 4), maxValue)));
+        uint16x8_t hi = vcombine_u16(vmovn_u32(PM__ImageConvertQuantizeNEON(vld1q_f32(s + i + 8), maxValue)),
+                                     vmovn_u32(PM__ImageConvertQuantizeNEON(vld1q_f32(s + i + 12), maxValue)));
+        vst1q_u8(dst + i, vcombine_u8(vmovn_u16(lo), vmovn_u16(hi)));
+    }
+
+    PM__ImageConvertF32ToU8Scalar(src + i * sizeof(PM_Float32), dst + i, count - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageConvertF32ToU16NEON(const PM_Byte* src, PM_Byte* dst, PM_Size count)
+{
+    const PM_Float32* s = (const PM_Float32*)src;
+    PM_UInt16* d = (PM_UInt16*)dst;
+    const float32x4_t maxValue = vdupq_n_f32(65535.0f);
+    PM_Size i = 0;
+
+    for (; i + 8 <= count; i += 8)
+    {
+        vst1q_u16(d + i, vcombine_u16(vmovn_u32(PM__ImageConvertQuantizeNEON(vld1q_f32(s + i), maxValue)),
+                                      vmovn_u32(PM__ImageConvertQuantizeNEON(vld1q_f32(s + i + 4), maxValue))));
+    }
+
+    PM__ImageConvertF32ToU16Scalar(src + i * sizeof(PM_Float32), dst + i * sizeof(PM_UInt16), count - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageConvertU8ToU16NEON(const PM_Byte* src, PM_Byte* dst, PM_Size count)
+{
+    PM_UInt16* d = (PM_UInt16*)dst;
+    PM_Size i = 0;
+
+    // Interleaving a byte with itself gives v | (v << 8), that is v * 257
+    for (; i + 16 <= count; i += 16)
+    {
+        uint8x16_t x = vld1q_u8(src + i);
+        vst1q_u16(d + i, vreinterpretq_u16_u8(vzip1q_u8(x, x)));
+        vst1q_u16(d + i + 8, vreinterpretq_u16_u8(vzip2q_u8(x, x)));
+    }
+
+    PM__ImageConvertU8ToU16Scalar(src + i, dst + i * sizeof(PM_UInt16), count - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageConvertU16ToU8NEON(const PM_Byte* src, PM_Byte* dst, PM_Size count)
+{
+    const PM_UInt16* s = (const PM_UInt16*)src;
+    const uint16x8_t half = vdupq_n_u16(128);
+    PM_Size i = 0;
+
+    // round(v / 257) is (t - (t >> 8)) >> 8 with t = v + 128, the saturation only affects values that round to 255 anyway
+    for (; i + 16 <= count; i += 16)
+    {
+        uint16x8_t a = vqaddq_u16(vld1q_u16(s + i), half);
+        uint16x8_t b = vqaddq_u16(vld1q_u16(s + i + 8), half);
+        a = vsubq_u16(a, vshrq_n_u16(a, 8));
+        b = vsubq_u16(b, vshrq_n_u16(b, 8));
+        vst1q_u8(dst + i, vcombine_u8(vshrn_n_u16(a, 8), vshrn_n_u16(b, 8)));
+    }
+
+    PM__ImageConvertU16ToU8Scalar(src + i * sizeof(PM_UInt16), dst + i, count - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageConvertF32ToF64NEON(const PM_Byte* src, PM_Byte* dst, PM_Size count)
+{
+    const PM_Float32* s = (const PM_Float32*)src;
+    PM_Float64* d = (PM_Float64*)dst;
+    PM_Size i = 0;
+
+    for (; i + 4 <= count; i += 4)
+    {
+        float32x4_t x = vld1q_f32(s + i);
+        vst1q_f64(d + i, vcvt_f64_f32(vget_low_f32(x)));
+        vst1q_f64(d + i + 2, vcvt_high_f64_f32(x));
+    }
+
+    PM__ImageConvertF32ToF64Scalar(src + i * sizeof(PM_Float32), dst + i * sizeof(PM_Float64), count - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageConvertF64ToF32NEON(const PM_Byte* src, PM_Byte* dst, PM_Size count)
+{
+    const PM_Float64* s = (const PM_Float64*)src;
+    PM_Float32* d = (PM_Float32*)dst;
+    PM_Size i = 0;
+
+    for (; i + 4 <= count; i += 4)
+    {
+        vst1q_f32(d + i, vcvt_high_f32_f64(vcvt_f32_f64(vld1q_f64(s + i)), vld1q_f64(s + i + 2)));
+    }
+
+    PM__ImageConvertF64ToF32Scalar(src + i * sizeof(PM_Float64), dst + i * sizeof(PM_Float32), count - i);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+#endif
+
+// Indexed by [source type][destination type], the diagonal is never used as it is a plain copy
+static PM__ImageConvertFunction PM_IMAGE_CONVERT_FUNCTIONS[PM_IMAGE_DATA_TYPE_COUNT][PM_IMAGE_DATA_TYPE_COUNT] = {
+    { NULL,                           PM__ImageConvertU8ToU16Scalar,  PM__ImageConvertU8ToU32Scalar,  PM__ImageConvertU8ToU64Scalar,  PM__ImageConvertU8ToF32Scalar,  PM__ImageConvertU8ToF64Scalar  },
+    { PM__ImageConvertU16ToU8Scalar,  NULL,                           PM__ImageConvertU16ToU32Scalar, PM__ImageConvertU16ToU64Scalar, PM__ImageConvertU16ToF32Scalar, PM__ImageConvertU16ToF64Scalar },
+    { PM__ImageConvertU32ToU8Scalar,  PM__ImageConvertU32ToU16Scalar, NULL,                           PM__ImageConvertU32ToU64Scalar, PM__ImageConvertU32ToF32Scalar, PM__ImageConvertU32ToF64Scalar },
+    { PM__ImageConvertU64ToU8Scalar,  PM__ImageConvertU64ToU16Scalar, PM__ImageConvertU64ToU32Scalar, NULL,                           PM__ImageConvertU64ToF32Scalar, PM__ImageConvertU64ToF64Scalar },
+    { PM__ImageConvertF32ToU8Scalar,  PM__ImageConvertF32ToU16Scalar, PM__ImageConvertF32ToU32Scalar, PM__ImageConvertF32ToU64Scalar, NULL,                           PM__ImageConvertF32ToF64Scalar },
+    { PM__ImageConvertF64ToU8Scalar,  PM__ImageConvertF64ToU16Scalar, PM__ImageConvertF64ToU32Scalar, PM__ImageConvertF64ToU64Scalar, PM__ImageConvertF64ToF32Scalar, NULL                           },
+};
+
+static volatile PM_Bool PM_IMAGE_CONVERT_FUNCTIONS_SELECTED = PM_FALSE;
+
+// -----------------------------------------------------------------------------------------------
+
+#define PM__IMAGE_DATA_TYPE_INDEX(dataType) ((dataType) - PICOIMEDIA_IMAGE_DATA_TYPE_UINT8)
+
+#define PM__IMAGE_SET_CONVERT_FUNCTION(srcType, dstType, function) \
+    PM_IMAGE_CONVERT_FUNCTIONS[PM__IMAGE_DATA_TYPE_INDEX(srcType)][PM__IMAGE_DATA_TYPE_INDEX(dstType)] = function
+
+static void PM__ImageSelectConvertFunctions()
+{
+#if defined(PM_ARCH_X86)
+    if (PM_CPUHasFeature(PICOMEDIA_CPU_FEATURE_SSE41))
+    {
+        PM__IMAGE_SET_CONVERT_FUNCTION(PICOIMEDIA_IMAGE_DATA_TYPE_UINT8, PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT32, PM__ImageConvertU8ToF32SSE41);
+        PM__IMAGE_SET_CONVERT_FUNCTION(PICOIMEDIA_IMAGE_DATA_TYPE_UINT16, PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT32, PM__ImageConvertU16ToF32SSE41);
+        PM__IMAGE_SET_CONVERT_FUNCTION(PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT32, PICOIMEDIA_IMAGE_DATA_TYPE_UINT8, PM__ImageConvertF32ToU8SSE41);
+        PM__IMAGE_SET_CONVERT_FUNCTION(PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT32, PICOIMEDIA_IMAGE_DATA_TYPE_UINT16, PM__ImageConvertF32ToU16SSE41);
+        PM__IMAGE_SET_CONVERT_FUNCTION(PICOIMEDIA_IMAGE_DATA_TYPE_UINT8, PICOIMEDIA_IMAGE_DATA_TYPE_UINT16, PM__ImageConvertU8ToU16SSE41);
+        PM__IMAGE_SET_CONVERT_FUNCTION(PICOIMEDIA_IMAGE_DATA_TYPE_UINT16, PICOIMEDIA_IMAGE_DATA_TYPE_UINT8, PM__ImageConvertU16ToU8SSE41);
+    }
+
+    if (PM_CPUHasFeature(PICOMEDIA_CPU_FEATURE_AVX))
+    {
+        PM__IMAGE_SET_CONVERT_FUNCTION(PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT32, PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT64, PM__ImageConvertF32ToF64AVX);
+        PM__IMAGE_SET_CONVERT_FUNCTION(PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT64, PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT32, PM__ImageConvertF64ToF32AVX);
+    }
+
+    if (PM_CPUHasFeature(PICOMEDIA_CPU_FEATURE_AVX2))
+    {
+        PM__IMAGE_SET_CONVERT_FUNCTION(PICOIMEDIA_IMAGE_DATA_TYPE_UINT8, PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT32, PM__ImageConvertU8ToF32AVX2);
+        PM__IMAGE_SET_CONVERT_FUNCTION(PICOIMEDIA_IMAGE_DATA_TYPE_UINT16, PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT32, PM__ImageConvertU16ToF32AVX2);
+        PM__IMAGE_SET_CONVERT_FUNCTION(PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT32, PICOIMEDIA_IMAGE_DATA_TYPE_UINT8, PM__ImageConvertF32ToU8AVX2);
+        PM__IMAGE_SET_CONVERT_FUNCTION(PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT32, PICOIMEDIA_IMAGE_DATA_TYPE_UINT16, PM__ImageConvertF32ToU16AVX2);
+        PM__IMAGE_SET_CONVERT_FUNCTION(PICOIMEDIA_IMAGE_DATA_TYPE_UINT8, PICOIMEDIA_IMAGE_DATA_TYPE_UINT16, PM__ImageConvertU8ToU16AVX2);
+        PM__IMAGE_SET_CONVERT_FUNCTION(PICOIMEDIA_IMAGE_DATA_TYPE_UINT16, PICOIMEDIA_IMAGE_DATA_TYPE_UINT8, PM__ImageConvertU16ToU8AVX2);
+    }
+#elif defined(PM_ARCH_ARM64)
+    PM__IMAGE_SET_CONVERT_FUNCTION(PICOIMEDIA_IMAGE_DATA_TYPE_UINT8, PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT32, PM__ImageConvertU8ToF32NEON);
+    PM__IMAGE_SET_CONVERT_FUNCTION(PICOIMEDIA_IMAGE_DATA_TYPE_UINT16, PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT32, PM__ImageConvertU16ToF32NEON);
+    PM__IMAGE_SET_CONVERT_FUNCTION(PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT32, PICOIMEDIA_IMAGE_DATA_TYPE_UINT8, PM__ImageConvertF32ToU8NEON);
+    PM__IMAGE_SET_CONVERT_FUNCTION(PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT32, PICOIMEDIA_IMAGE_DATA_TYPE_UINT16, PM__ImageConvertF32ToU16NEON);
+    PM__IMAGE_SET_CONVERT_FUNCTION(PICOIMEDIA_IMAGE_DATA_TYPE_UINT8, PICOIMEDIA_IMAGE_DATA_TYPE_UINT16, PM__ImageConvertU8ToU16NEON);
+    PM__IMAGE_SET_CONVERT_FUNCTION(PICOIMEDIA_IMAGE_DATA_TYPE_UINT16, PICOIMEDIA_IMAGE_DATA_TYPE_UINT8, PM__ImageConvertU16ToU8NEON);
+    PM__IMAGE_SET_CONVERT_FUNCTION(PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT32, PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT64, PM__ImageConvertF32ToF64NEON);
+    PM__IMAGE_SET_CONVERT_FUNCTION(PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT64, PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT32, PM__ImageConvertF64ToF32NEON);
+#endif
+
+    PM_IMAGE_CONVERT_FUNCTIONS_SELECTED = PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM__ImageConvertFunction PM__ImageGetConvertFunction(PM_UInt32 srcDataType, PM_UInt32 dstDataType)
+{
+    PM_UInt32 srcIndex = PM__IMAGE_DATA_TYPE_INDEX(srcDataType);
+    PM_UInt32 dstIndex = PM__IMAGE_DATA_TYPE_INDEX(dstDataType);
+
+    if (srcIndex >= PM_IMAGE_DATA_TYPE_COUNT || dstIndex >= PM_IMAGE_DATA_TYPE_COUNT)
+    {
+        return NULL;
+    }
+
+    if (!PM_IMAGE_CONVERT_FUNCTIONS_SELECTED)
+    {
+        PM__ImageSelectConvertFunctions();
+    }
+
+    return PM_IMAGE_CONVERT_FUNCTIONS[srcIndex][dstIndex];
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageConvertBandWorker(PM_Size begin, PM_Size end, void* data)
+{
+    const PM__ImageConvertBand* band = (const PM__ImageConvertBand*)data;
+
+    // Rows are tightly packed, so a band of rows is a single run of samples
+    band->function(band->src + begin * band->srcRowSize, band->dst + begin * band->dstRowSize, (end - begin) * band->samplesPerRow);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PM_ImageTransformsConvertSamples(const void* src, PM_UInt32 srcDataType, void* dst, PM_UInt32 dstDataType, PM_Size count)
+{
+    PM_Assert(src != NULL);
+    PM_Assert(dst != NULL);
+
+    if (srcDataType == dstDataType)
+    {
+        PM_Memcpy(dst, src, count * PM_ImageGetDataTypeSize(srcDataType));
+        return PM_TRUE;
+    }
+
+    PM__ImageConvertFunction function = PM__ImageGetConvertFunction(srcDataType, dstDataType);
+    if (function == NULL)
+    {
+        PM_LogError("Unsupported data type conversion!");
+        return PM_FALSE;
+    }
+
+    function((const PM_Byte*)src, (PM_Byte*)dst, count);
+
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PM_ImageTransformsChangeDataType(PM_Image* image, PM_UInt32 newDataType)
+{
+    PM_Assert(image != NULL);
+
+    if (image->dataType == newDataType)
+    {
+        return PM_TRUE;
+    }
+
+    PM__ImageConvertFunction function = PM__ImageGetConvertFunction(image->dataType, newDataType);
+    if (function == NULL)
+    {
+        PM_LogError("Unsupported data type conversion!");
+        return PM_FALSE;
+    }
+
+    PM_Image newImage = {0};
+    PM_ImageInit(&newImage);
+
+    if(!PM_ImageAllocate(&newImage, image->width, image->height, image->channelFormat, newDataType, image->numChannels))
+    {
+        PM_LogError("Failed to allocate memory for new image!");
+        return PM_FALSE;
+    }
+
+    PM__ImageConvertBand band;
+    band.src = image->data;
+    band.dst = newImage.data;
+    band.samplesPerRow = (PM_Size)image->width * image->numChannels;
+    band.srcRowSize = band.samplesPerRow * PM_ImageGetDataTypeSize(image->dataType);
+    band.dstRowSize = band.samplesPerRow * PM_ImageGetDataTypeSize(newDataType);
+    band.function = function;
+
+    // Small images end up as a single band, which PM_ParallelFor runs on the calling thread
+    PM_Size threadCount = PM_ThreadPoolGetThreadCount(NULL) + 1;
+    PM_Size minRows = PM_Max(PM_IMAGE_CONVERT_MIN_BAND_SAMPLES / band.samplesPerRow, (PM_Size)1);
+    PM_Size grain = PM_Max(image->height / (threadCount * PM_IMAGE_CONVERT_BANDS_PER_THREAD), minRows);
+
+    PM_ParallelFor(NULL, 0, image->height, grain, PM__ImageConvertBandWorker, &band);
+
+    // The converted buffer replaces the old one, no need to copy it back
+    PM_Free(image->data);
+    image->data = newImage.data;
+    image->dataCapacity = newImage.dataCapacity;
+    image->dataSize = newImage.dataSize;
+    image->dataType = newImage.dataType;
+    image->bitsPerChannel = newImage.bitsPerChannel;
+
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
@@ -0,0 +1,1366 @@
+#include "libpicomedia/image/image_transforms.h"
+#include "libpicomedia/common/cpu.h"
+
+#if defined(PM_ARCH_X86)
+    #include <immintrin.h>
+#elif defined(PM_ARCH_ARM64)
+    #include <arm_neon.h>
+#endif
+
+// Number of supported data types, they are numbered consecutively from PICOIMEDIA_IMAGE_DATA_TYPE_UINT8
+#define PM_IMAGE_RESIZE_DATA_TYPE_COUNT 6
+
+// Smallest number of destination samples resized by a single task
+#define PM_IMAGE_RESIZE_MIN_BAND_SAMPLES (1 << 16)
+
+// Number of bands per thread, so threads that finish early can pick up the remaining ones
+#define PM_IMAGE_RESIZE_BANDS_PER_THREAD 4
+
+// Fixed point weights are 2.14 numbers summing to exactly PM_IMAGE_RESIZE_ONE
+#define PM_IMAGE_RESIZE_PRECISION 14
+#define PM_IMAGE_RESIZE_ONE (1 << PM_IMAGE_RESIZE_PRECISION)
+
+// Intermediate 8-bit samples keep this many extra fractional bits between the two passes
+#define PM_IMAGE_RESIZE_U8_EXTRA_BITS 7
+
+// Largest power of two box downscale factor, which keeps the 16-bit column sums within 32 bits
+#define PM_IMAGE_BOX_MAX_FACTOR (1 << 16)
+
+typedef PM_Float64 (*PM__ImageResizeFilterFunction)(PM_Float64 x);
+
+typedef struct PM__ImageResizeFilter
+{
+    PM__ImageResizeFilterFunction function;
+    PM_Float64 support;     // The filter is 0 outside of [-support, support]
+} PM__ImageResizeFilter;
+
+// Filter weights along one axis. Every destination sample weighs the same number of consecutive source
+// samples, windows reaching past an edge are moved inside the image with zero weights where they moved.
+typedef struct PM__ImageResizeAxis
+{
+    PM_Size srcSize;
+    PM_Size dstSize;
+    PM_Size taps;               // Source samples weighed for each destination sample
+    PM_Size* first;             // First source sample of each destination sample
+    PM_Float64* weights;        // taps weights for each destination sample
+    PM_Float32* weights32;      // The same, in single precision
+    PM_Int16* fixedWeights;     // The same, in fixed point
+    void* memory;
+} PM__ImageResizeAxis;
+
+// Resamples the pixels of a source row into an intermediate row of axis->dstSize pixels
+typedef void (*PM__ImageResizeHorizontalFunction)(const PM__ImageResizeAxis* axis, PM_Size channels, const PM_Byte* src, PM_Byte* dst);
+
+// Resamples count samples of the taps intermediate rows weighed by the destination row index into a destination row
+typedef void (*PM__ImageResizeVerticalFunction)(const PM__ImageResizeAxis* axis, PM_Size index, const PM_Byte* const* rows, PM_Byte* dst, PM_Size count);
+
+// Intermediate samples are 16-bit fixed point for 8-bit images, and floating point for the other ones
+typedef struct PM__ImageResizeKernel
+{
+    PM__ImageResizeHorizontalFunction horizontal;
+    PM__ImageResizeVerticalFunction vertical;
+    PM_Size intermediateSize;
+} PM__ImageResizeKernel;
+
+// Each band resamples its own source rows into a ring of taps intermediate rows, as the windows of
+// consecutive destination rows only move forward
+typedef struct PM__ImageResizeBand
+{
+    const PM__ImageResizeKernel* kernel;
+    const PM__ImageResizeAxis* horizontal;
+    const PM__ImageResizeAxis* vertical;
+    const PM_Byte* src;
+    PM_Byte* dst;
+    PM_Size channels;
+    PM_Size srcRowSize;
+    PM_Size dstRowSize;
+    PM_Size bandRows;
+    PM_Byte* rings;
+    PM_Size ringSize;
+    const PM_Byte** rows;
+} PM__ImageResizeBand;
+
+// Adds a source row to the sums of its columns
+typedef void (*PM__ImageBoxAccumulateFunction)(const PM_Byte* src, PM_Byte* sums, PM_Size count);
+
+// Averages groups of factor columns of the sums of rows source rows into a destination row
+typedef void (*PM__ImageBoxAverageFunction)(const PM_Byte* sums, PM_Byte* dst, PM_Size srcWidth, PM_Size channels, PM_Size factor, PM_Size rows);
+
+typedef struct PM__ImageBoxKernel
+{
+    PM__ImageBoxAccumulateFunction accumulate;
+    PM__ImageBoxAverageFunction average;
+    PM_Size sumSize;
+} PM__ImageBoxKernel;
+
+typedef struct PM__ImageBoxBand
+{
+    const PM__ImageBoxKernel* kernel;
+    const PM_Byte* src;
+    PM_Byte* dst;
+    PM_Size srcWidth;
+    PM_Size srcHeight;
+    PM_Size channels;
+    PM_Size factor;
+    PM_Size srcRowSize;
+    PM_Size dstRowSize;
+    PM_Size bandRows;
+    PM_Byte* sums;
+    PM_Size sumsSize;
+} PM__ImageBoxBand;
+
+// -----------------------------------------------------------------------------------------------
+
+// sin(pi * x), with a polynomial over a quarter period so the library does not depend on libm
+static PM_Float64 PM__ImageResizeSinPi(PM_Float64 x)
+{
+    PM_Float64 half = x * 0.5;
+    PM_Float64 turns = (PM_Float64)(PM_Int64)(half >= 0.0 ? half + 0.5 : half - 0.5);
+    x -= 2.0 * turns;
+
+    if (x > 0.5)
+    {
+        x = 1.0 - x;
+    }
+    else if (x < -0.5)
+    {
+        x = -1.0 - x;
+    }
+
+    PM_Float64 t = x * 3.14159265358979323846;
+    PM_Float64 t2 = t * t;
+    PM_Float64 result = 1.0 / 1307674368000.0;
+    result = result * -t2 + 1.0 / 6227020800.0;
+    result = result * -t2 + 1.0 / 39916800.0;
+    result = result * -t2 + 1.0 / 362880.0;
+    result = result * -t2 + 1.0 / 5040.0;
+    result = result * -t2 + 1.0 / 120.0;
+    result = result * -t2 + 1.0 / 6.0;
+    result = result * -t2 + 1.0;
+
+    return result * t;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Float64 PM__ImageResizeFilterBox(PM_Float64 x)
+{
+    // Half open, so a source sample on the edge between two destination samples is not counted twice
+    return (x >= -0.5 && x < 0.5) ? 1.0 : 0.0;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Float64 PM__ImageResizeFilterTriangle(PM_Float64 x)
+{
+    x = x < 0.0 ? -x : x;
+    return x < 1.0 ? 1.0 - x : 0.0;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Keys cubic with a = -0.5 (Catmull-Rom), interpolating and exact for quadratic signals
+static PM_Float64 PM__ImageResizeFilterCubic(PM_Float64 x)
+{
+    const PM_Float64 a = -0.5;
+    x = x < 0.0 ? -x : x;
+
+    if (x < 1.0)
+    {
+        return ((a + 2.0) * x - (a + 3.0)) * x * x + 1.0;
+    }
+
+    if (x < 2.0)
+    {
+        return ((a * x - 5.0 * a) * x + 8.0 * a) * x - 4.0 * a;
+    }
+
+    return 0.0;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Lanczos with 3 lobes, sinc(x) * sinc(x / 3)
+static PM_Float64 PM__ImageResizeFilterLanczos(PM_Float64 x)
+{
+    if (x > -1e-9 && x < 1e-9)
+    {
+        return 1.0;
+    }
+
+    if (x <= -3.0 || x >= 3.0)
+    {
+        return 0.0;
+    }
+
+    return 3.0 * PM__ImageResizeSinPi(x) * PM__ImageResizeSinPi(x / 3.0) / (9.86960440108935861883 * x * x);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Bool PM__ImageResizeGetFilter(PM_UInt32 filter, PM__ImageResizeFilter* result)
+{
+    switch (filter)
+    {
+    case PICOMEDIA_IMAGE_RESIZE_FILTER_BOX:
+        result->function = PM__ImageResizeFilterBox;
+        result->support = 0.5;
+        return PM_TRUE;
+    case PICOMEDIA_IMAGE_RESIZE_FILTER_BILINEAR:
+        result->function = PM__ImageResizeFilterTriangle;
+        result->support = 1.0;
+        return PM_TRUE;
+    case PICOMEDIA_IMAGE_RESIZE_FILTER_BICUBIC:
+        result->function = PM__ImageResizeFilterCubic;
+        result->support = 2.0;
+        return PM_TRUE;
+    case PICOMEDIA_IMAGE_RESIZE_FILTER_LANCZOS:
+        result->function = PM__ImageResizeFilterLanczos;
+        result->support = 3.0;
+        return PM_TRUE;
+    default:
+        return PM_FALSE;
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Source window [begin, end) of a destination sample, sample i covering [i, i + 1) on its axis
+static void PM__ImageResizeGetWindow(const PM__ImageResizeFilter* filter, PM_Float64 scale, PM_Size srcSize, PM_Size i, PM_Float64* center, PM_Size* begin, PM_Size* end)
+{
+    // Downscaling stretches the filter, so it also removes the frequencies the destination cannot hold
+    PM_Float64 support = filter->support * PM_Max(scale, 1.0);
+    PM_Float64 low = (*center = ((PM_Float64)i + 0.5) * scale) - support + 0.5;
+    PM_Float64 high = *center + support + 0.5;
+
+    *begin = low > 0.0 ? (PM_Size)low : 0;
+    *end = high < (PM_Float64)srcSize ? (PM_Size)high : srcSize;
+    *begin = PM_Min(*begin, srcSize - 1);
+    *end = PM_Max(*end, *begin + 1);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageResizeAxisDestroy(PM__ImageResizeAxis* axis)
+{
+    PM_Free(axis->memory);
+    axis->memory = NULL;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Bool PM__ImageResizeAxisInit(PM__ImageResizeAxis* axis, const PM__ImageResizeFilter* filter, PM_Size srcSize, PM_Size dstSize)
+{
+    PM_Float64 scale = (PM_Float64)srcSize / (PM_Float64)dstSize;
+    PM_Float64 filterScale = PM_Max(scale, 1.0);
+    PM_Float64 center = 0.0;
+    PM_Size begin = 0, end = 0;
+
+    axis->srcSize = srcSize;
+    axis->dstSize = dstSize;
+    axis->taps = 1;
+
+    for (PM_Size i = 0; i < dstSize; i++)
+    {
+        PM__ImageResizeGetWindow(filter, scale, srcSize, i, &center, &begin, &end);
+        axis->taps = PM_Max(axis->taps, end - begin);
+    }
+
+    // Largest members first, so each array stays aligned
+    PM_Size weightCount = dstSize * axis->taps;
+    axis->memory = PM_Malloc(dstSize * sizeof(PM_Size) + weightCount * (sizeof(PM_Float64) + sizeof(PM_Float32) + sizeof(PM_Int16)));
+    if (axis->memory == NULL)
+    {
+        return PM_FALSE;
+    }
+
+    axis->weights = (PM_Float64*)axis->memory;
+    axis->first = (PM_Size*)(axis->weights + weightCount);
+    axis->weights32 = (PM_Float32*)(axis->first + dstSize);
+    axis->fixedWeights = (PM_Int16*)(axis->weights32 + weightCount);
+
+    for (PM_Size i = 0; i < dstSize; i++)
+    {
+        PM_Float64* weights = axis->weights + i * axis->taps;
+        PM__ImageResizeGetWindow(filter, scale, srcSize, i, &center, &begin, &end);
+
+        PM_Size first = PM_Min(begin, srcSize - axis->taps);
+        PM_Float64 sum = 0.0;
+
+        for (PM_Size k = 0; k < axis->taps; k++)
+        {
+            PM_Size j = first + k;
+            weights[k] = (j >= begin && j < end) ? filter->function(((PM_Float64)j + 0.5 - center) / filterScale) : 0.0;
+            sum += weights[k];
+        }
+
+        // A box narrower than a source sample can fall between two sample centers, it picks the nearest one
+        if (sum == 0.0)
+        {
+            PM_Size nearest = PM_Min((PM_Size)center, srcSize - 1);
+            weights[nearest - first] = 1.0;
+            sum = 1.0;
+        }
+
+        // Rounding errors are moved to the largest fixed point weight, so flat areas stay exactly flat
+        PM_Int16* fixedWeights = axis->fixedWeights + i * axis->taps;
+        PM_Int32 fixedSum = 0;
+        PM_Size largest = 0;
+
+        for (PM_Size k = 0; k < axis->taps; k++)
+        {
+            PM_Float64 weight = weights[k] / sum;
+            PM_Float64 fixed = weight * PM_IMAGE_RESIZE_ONE;
+
+            weights[k] = weight;
+            axis->weights32[i * axis->taps + k] = (PM_Float32)weight;
+            fixedWeights[k] = (PM_Int16)(fixed >= 0.0 ? (PM_Int32)(fixed + 0.5) : -(PM_Int32)(0.5 - fixed));
+            fixedSum += fixedWeights[k];
+            largest = fixedWeights[k] > fixedWeights[largest] ? k : largest;
+        }
+
+        fixedWeights[largest] = (PM_Int16)(fixedWeights[largest] + PM_IMAGE_RESIZE_ONE - fixedSum);
+        axis->first[i] = first;
+    }
+
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// 8-bit samples are kept with PM_IMAGE_RESIZE_U8_EXTRA_BITS fractional bits between the two passes, clamped
+// to the range of the source so they fit in 16 bits
+static void PM__ImageResizeHorizontalU8(const PM__ImageResizeAxis* axis, PM_Size channels, const PM_Byte* src, PM_Byte* dst)
+{
+    const PM_UInt8* s = (const PM_UInt8*)src;
+    PM_UInt16* d = (PM_UInt16*)dst;
+    PM_Size taps = axis->taps;
+    const PM_Int32 shift = PM_IMAGE_RESIZE_PRECISION - PM_IMAGE_RESIZE_U8_EXTRA_BITS;
+    const PM_Int32 maximum = 0xFF << PM_IMAGE_RESIZE_U8_EXTRA_BITS;
+
+    for (PM_Size i = 0; i < axis->dstSize; i++)
+    {
+        const PM_Int16* weights = axis->fixedWeights + i * taps;
+        const PM_UInt8* pixel = s + axis->first[i] * channels;
+
+        for (PM_Size c = 0; c < channels; c++)
+        {
+            PM_Int32 sum = 1 << (shift - 1);
+            for (PM_Size k = 0; k < taps; k++)
+            {
+                sum += weights[k] * (PM_Int32)pixel[k * channels + c];
+            }
+            sum = sum < 0 ? 0 : sum >> shift;
+            d[i * channels + c] = (PM_UInt16)PM_Min(sum, maximum);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageResizeVerticalU8(const PM__ImageResizeAxis* axis, PM_Size index, const PM_Byte* const* rows, PM_Byte* dst, PM_Size count)
+{
+    const PM_Int16* weights = axis->fixedWeights + index * axis->taps;
+    const PM_Int32 shift = PM_IMAGE_RESIZE_PRECISION + PM_IMAGE_RESIZE_U8_EXTRA_BITS;
+    PM_UInt8* d = (PM_UInt8*)dst;
+
+    for (PM_Size x = 0; x < count; x++)
+    {
+        PM_Int32 sum = 1 << (shift - 1);
+        for (PM_Size k = 0; k < axis->taps; k++)
+        {
+            sum += weights[k] * (PM_Int32)((const PM_UInt16*)rows[k])[x];
+        }
+        sum = sum < 0 ? 0 : sum >> shift;
+        d[x] = (PM_UInt8)PM_Min(sum, 0xFF);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_UInt16 PM__ImageResizeStoreU16(PM_Float32 value)
+{
+    return value <= 0.0f ? 0 : value >= 65535.0f ? 0xFFFF : (PM_UInt16)(value + 0.5f);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_UInt32 PM__ImageResizeStoreU32(PM_Float64 value)
+{
+    return value <= 0.0 ? 0 : value >= 4294967295.0 ? 0xFFFFFFFFu : (PM_UInt32)(value + 0.5);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_UInt64 PM__ImageResizeStoreU64(PM_Float64 value)
+{
+    return value <= 0.0 ? 0 : value >= 18446744073709551615.0 ? 0xFFFFFFFFFFFFFFFFull : (PM_UInt64)(value + 0.5);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// The other types are resampled in floating point, 16-bit ones in single precision as 2.14 weights would lose
+// a few of their low bits. Floating point samples are not clamped.
+
+#define PM__IMAGE_DEFINE_RESIZE_FLOAT(name, Type, Float, weightsField, store) \
+    static void PM__ImageResizeHorizontal##name(const PM__ImageResizeAxis* axis, PM_Size channels, const PM_Byte* src, PM_Byte* dst) \
+    { \
+        const Type* s = (const Type*)src; \
+        Float* d = (Float*)dst; \
+        PM_Size taps = axis->taps; \
+        for (PM_Size i = 0; i < axis->dstSize; i++) \
+        { \
+            const Float* weights = axis->weightsField + i * taps; \
+            const Type* pixel = s + axis->first[i] * channels; \
+            for (PM_Size c = 0; c < channels; c++) \
+            { \
+                Float sum = 0; \
+                for (PM_Size k = 0; k < taps; k++) \
+                { \
+                    sum += weights[k] * (Float)pixel[k * channels + c]; \
+                } \
+                d[i * channels + c] = sum; \
+            } \
+        } \
+    } \
+    \
+    static void PM__ImageResizeVertical##name(const PM__ImageResizeAxis* axis, PM_Size index, const PM_Byte* const* rows, PM_Byte* dst, PM_Size count) \
+    { \
+        const Float* weights = axis->weightsField + index * axis->taps; \
+        Type* d = (Type*)dst; \
+        for (PM_Size x = 0; x < count; x++) \
+        { \
+            Float sum = 0; \
+            for (PM_Size k = 0; k < axis->taps; k++) \
+            { \
+                sum += weights[k] * ((const Float*)rows[k])[x]; \
+            } \
+            d[x] = store(sum); \
+        } \
+    }
+
+PM__IMAGE_DEFINE_RESIZE_FLOAT(U16, PM_UInt16, PM_Float32, weights32, PM__ImageResizeStoreU16)
+PM__IMAGE_DEFINE_RESIZE_FLOAT(U32, PM_UInt32, PM_Float64, weights, PM__ImageResizeStoreU32)
+PM__IMAGE_DEFINE_RESIZE_FLOAT(U64, PM_UInt64, PM_Float64, weights, PM__ImageResizeStoreU64)
+PM__IMAGE_DEFINE_RESIZE_FLOAT(F32, PM_Float32, PM_Float32, weights32, (PM_Float32))
+PM__IMAGE_DEFINE_RESIZE_FLOAT(F64, PM_Float64, PM_Float64, weights, (PM_Float64))
+
+// -----------------------------------------------------------------------------------------------
+
+// Vectorized forms. Horizontal ones handle 3 and 4 channels, the 3 channel pixels being spread to 4 lanes,
+// and read up to a pixel past the window so they stop short of the end of the row. Vertical ones work on
+// runs of samples regardless of the channels.
+
+#if defined(PM_ARCH_X86)
+
+static PM_TARGET("avx2") void PM__ImageResizeHorizontalU8AVX2(const PM__ImageResizeAxis* axis, PM_Size channels, const PM_Byte* src, PM_Byte* dst)
+{
+    if (channels != 3 && channels != 4)
+    {
+        PM__ImageResizeHorizontalU8(axis, channels, src, dst);
+        return;
+    }
+
+    const PM_UInt8* s = (const PM_UInt8*)src;
+    PM_UInt16* d = (PM_UInt16*)dst;
+    PM_Size taps = axis->taps;
+    PM_Size rowSize = axis->srcSize * channels;
+    const PM_Int32 shift = PM_IMAGE_RESIZE_PRECISION - PM_IMAGE_RESIZE_U8_EXTRA_BITS;
+    const PM_Int32 maximum = 0xFF << PM_IMAGE_RESIZE_U8_EXTRA_BITS;
+
+    const __m128i spread = channels == 3 ?
+        _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1) :
+        _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m256i pairs = _mm256_setr_epi32(0, 0, 0, 0, 1, 1, 1, 1);
+
+    for (PM_Size i = 0; i < axis->dstSize; i++)
+    {
+        const PM_Int16* weights = axis->fixedWeights + i * taps;
+        PM_Size first = axis->first[i];
+        const PM_UInt8* pixel = s + first * channels;
+        __m256i sum4 = _mm256_setzero_si256();
+        __m128i sum = _mm_setzero_si128();
+        PM_Size k = 0;
+
+        // Four pixels at once, the channels of two consecutive pixels interleaved to be weighed in pairs
+        for (; k + 4 <= taps && (first + k) * channels + 16 <= rowSize; k += 4)
+        {
+            __m128i x = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(pixel + k * channels)), spread);
+            __m256i x16 = _mm256_cvtepu8_epi16(x);
+            __m256i interleaved = _mm256_unpacklo_epi16(x16, _mm256_srli_si256(x16, 8));
+            __m256i w = _mm256_permutevar8x32_epi32(_mm256_castsi128_si256(_mm_loadl_epi64((const __m128i*)(weights + k))), pairs);
+            sum4 = _mm256_add_epi32(sum4, _mm256_madd_epi16(interleaved, w));
+        }
+
+        for (; k + 2 <= taps && (first + k) * channels + 8 <= rowSize; k += 2)
+        {
+            __m128i x = _mm_cvtepu8_epi16(_mm_shuffle_epi8(_mm_loadl_epi64((const __m128i*)(pixel + k * channels)), spread));
+            __m128i interleaved = _mm_unpacklo_epi16(x, _mm_srli_si128(x, 8));
+            __m128i w = _mm_set1_epi32((PM_Int32)((PM_UInt16)weights[k] | ((PM_UInt32)(PM_UInt16)weights[k + 1] << 16)));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(interleaved, w));
+        }
+
+        sum = _mm_add_epi32(sum, _mm_add_epi32(_mm256_castsi256_si128(sum4), _mm256_extracti128_si256(sum4, 1)));
+
+        PM_Int32 lanes[4];
+        _mm_storeu_si128((__m128i*)lanes, sum);
+
+        for (; k < taps; k++)
+        {
+            for (PM_Size c = 0; c < channels; c++)
+            {
+                lanes[c] += weights[k] * (PM_Int32)pixel[k * channels + c];
+            }
+        }
+
+        for (PM_Size c = 0; c < channels; c++)
+        {
+            PM_Int32 value = lanes[c] + (1 << (shift - 1));
+            value = value < 0 ? 0 : value >> shift;
+            d[i * channels + c] = (PM_UInt16)PM_Min(value, maximum);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("avx2") void PM__ImageResizeVerticalU8AVX2(const PM__ImageResizeAxis* axis, PM_Size index, const PM_Byte* const* rows, PM_Byte* dst, PM_Size count)
+{
+    const PM_Int16* weights = axis->fixedWeights + index * axis->taps;
+    PM_Size taps = axis->taps;
+    const PM_Int32 shift = PM_IMAGE_RESIZE_PRECISION + PM_IMAGE_RESIZE_U8_EXTRA_BITS;
+    const __m256i round = _mm256_set1_epi32(1 << (shift - 1));
+    PM_UInt8* d = (PM_UInt8*)dst;
+    PM_Size x = 0;
+
+    // The intermediate samples fit in signed 16 bits, so two rows are weighed at once, the last one with a
+    // zero weighed copy of itself when the number of rows is odd
+    for (; x + 16 <= count; x += 16)
+    {
+        __m256i sumLow = round;
+        __m256i sumHigh = round;
+
+        for (PM_Size k = 0; k < taps; k += 2)
+        {
+            PM_Size next = k + 1 < taps ? k + 1 : k;
+            PM_Int16 nextWeight = k + 1 < taps ? weights[k + 1] : 0;
+            __m256i a = _mm256_loadu_si256((const __m256i*)((const PM_UInt16*)rows[k] + x));
+            __m256i b = _mm256_loadu_si256((const __m256i*)((const PM_UInt16*)rows[next] + x));
+            __m256i w = _mm256_set1_epi32((PM_Int32)((PM_UInt16)weights[k] | ((PM_UInt32)(PM_UInt16)nextWeight << 16)));
+
+            sumLow = _mm256_add_epi32(sumLow, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), w));
+            sumHigh = _mm256_add_epi32(sumHigh, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), w));
+        }
+
+        // Unpacking within lanes and packing back within lanes restores the order of the samples
+        __m256i packed = _mm256_packus_epi32(_mm256_srai_epi32(sumLow, shift), _mm256_srai_epi32(sumHigh, shift));
+        __m128i bytes = _mm_packus_epi16(_mm256_castsi256_si128(packed), _mm256_extracti128_si256(packed, 1));
+        _mm_storeu_si128((__m128i*)(d + x), bytes);
+    }
+
+    for (; x < count; x++)
+    {
+        PM_Int32 sum = 1 << (shift - 1);
+        for (PM_Size k = 0; k < taps; k++)
+        {
+            sum += weights[k] * (PM_Int32)((const PM_UInt16*)rows[k])[x];
+        }
+        sum = sum < 0 ? 0 : sum >> shift;
+        d[x] = (PM_UInt8)PM_Min(sum, 0xFF);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("avx2") void PM__ImageResizeVerticalU16AVX2(const PM__ImageResizeAxis* axis, PM_Size index, const PM_Byte* const* rows, PM_Byte* dst, PM_Size count)
+{
+    const PM_Float32* weights = axis->weights32 + index * axis->taps;
+    PM_Size taps = axis->taps;
+    PM_UInt16* d = (PM_UInt16*)dst;
+    PM_Size x = 0;
+
+    for (; x + 16 <= count; x += 16)
+    {
+        __m256 sumLow = _mm256_setzero_ps();
+        __m256 sumHigh = _mm256_setzero_ps();
+
+        for (PM_Size k = 0; k < taps; k++)
+        {
+            const PM_Float32* row = (const PM_Float32*)rows[k] + x;
+            __m256 w = _mm256_set1_ps(weights[k]);
+
+            sumLow = _mm256_add_ps(sumLow, _mm256_mul_ps(_mm256_loadu_ps(row), w));
+            sumHigh = _mm256_add_ps(sumHigh, _mm256_mul_ps(_mm256_loadu_ps(row + 8), w));
+        }
+
+        // Rounded to nearest and saturated by the pack, which works within lanes
+        __m256i packed = _mm256_packus_epi32(_mm256_cvtps_epi32(sumLow), _mm256_cvtps_epi32(sumHigh));
+        _mm256_storeu_si256((__m256i*)(d + x), _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+
+    for (; x < count; x++)
+    {
+        PM_Float32 sum = 0.0f;
+        for (PM_Size k = 0; k < taps; k++)
+        {
+            sum += weights[k] * ((const PM_Float32*)rows[k])[x];
+        }
+        d[x] = PM__ImageResizeStoreU16(sum);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("avx2") void PM__ImageResizeHorizontalF32AVX2(const PM__ImageResizeAxis* axis, PM_Size channels, const PM_Byte* src, PM_Byte* dst)
+{
+    if (channels != 3 && channels != 4)
+    {
+        PM__ImageResizeHorizontalF32(axis, channels, src, dst);
+        return;
+    }
+
+    const PM_Float32* s = (const PM_Float32*)src;
+    PM_Float32* d = (PM_Float32*)dst;
+    PM_Size taps = axis->taps;
+    PM_Size rowSize = axis->srcSize * channels;
+
+    for (PM_Size i = 0; i < axis->dstSize; i++)
+    {
+        const PM_Float32* weights = axis->weights32 + i * taps;
+        PM_Size first = axis->first[i];
+        const PM_Float32* pixel = s + first * channels;
+        __m256 sum2 = _mm256_setzero_ps();
+        __m128 sum = _mm_setzero_ps();
+        PM_Size k = 0;
+
+        // Two pixels at once, one per lane
+        for (; k + 2 <= taps && (first + k) * channels + 8 <= rowSize; k += 2)
+        {
+            __m256 x = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(pixel + k * channels)), _mm_loadu_ps(pixel + (k + 1) * channels), 1);
+            __m256 w = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(weights[k])), _mm_set1_ps(weights[k + 1]), 1);
+            sum2 = _mm256_add_ps(sum2, _mm256_mul_ps(x, w));
+        }
+
+        sum = _mm_add_ps(_mm256_castps256_ps128(sum2), _mm256_extractf128_ps(sum2, 1));
+
+        PM_Float32 lanes[4];
+        _mm_storeu_ps(lanes, sum);
+
+        for (; k < taps; k++)
+        {
+            for (PM_Size c = 0; c < channels; c++)
+            {
+                lanes[c] += weights[k] * pixel[k * channels + c];
+            }
+        }
+
+        for (PM_Size c = 0; c < channels; c++)
+        {
+            d[i * channels + c] = lanes[c];
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("avx2") void PM__ImageResizeVerticalF32AVX2(const PM__ImageResizeAxis* axis, PM_Size index, const PM_Byte* const* rows, PM_Byte* dst, PM_Size count)
+{
+    const PM_Float32* weights = axis->weights32 + index * axis->taps;
+    PM_Size taps = axis->taps;
+    PM_Float32* d = (PM_Float32*)dst;
+    PM_Size x = 0;
+
+    for (; x + 16 <= count; x += 16)
+    {
+        __m256 sumLow = _mm256_setzero_ps();
+        __m256 sumHigh = _mm256_setzero_ps();
+
+        for (PM_Size k = 0; k < taps; k++)
+        {
+            const PM_Float32* row = (const PM_Float32*)rows[k] + x;
+            __m256 w = _mm256_set1_ps(weights[k]);
+
+            sumLow = _mm256_add_ps(sumLow, _mm256_mul_ps(_mm256_loadu_ps(row), w));
+            sumHigh = _mm256_add_ps(sumHigh, _mm256_mul_ps(_mm256_loadu_ps(row + 8), w));
+        }
+
+        _mm256_storeu_ps(d + x, sumLow);
+        _mm256_storeu_ps(d + x + 8, sumHigh);
+    }
+
+    for (; x < count; x++)
+    {
+        PM_Float32 sum = 0.0f;
+        for (PM_Size k = 0; k < taps; k++)
+        {
+            sum += weights[k] * ((const PM_Float32*)rows[k])[x];
+        }
+        d[x] = sum;
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+#elif defined(PM_ARCH_ARM64)
+
+static void PM__ImageResizeHorizontalU8NEON(const PM__ImageResizeAxis* axis, PM_Size channels, const PM_Byte* src, PM_Byte* dst)
+{
+    if (channels != 3 && channels != 4)
+    {
+        PM__ImageResizeHorizontalU8(axis, channels, src, dst);
+        return;
+    }
+
+    const PM_UInt8* s = (const PM_UInt8*)src;
+    PM_UInt16* d = (PM_UInt16*)dst;
+    PM_Size taps = axis->taps;
+    PM_Size rowSize = axis->srcSize * channels;
+    const PM_Int32 shift = PM_IMAGE_RESIZE_PRECISION - PM_IMAGE_RESIZE_U8_EXTRA_BITS;
+    const PM_Int32 maximum = 0xFF << PM_IMAGE_RESIZE_U8_EXTRA_BITS;
+
+    static const PM_UInt8 spread3[8] = { 0, 1, 2, 0xFF, 3, 4, 5, 0xFF };
+    static const PM_UInt8 spread4[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+    const uint8x8_t spread = vld1_u8(channels == 3 ? spread3 : spread4);
+
+    for (PM_Size i = 0; i < axis->dstSize; i++)
+    {
+        const PM_Int16* weights = axis->fixedWeights + i * taps;
+        PM_Size first = axis->first[i];
+        const PM_UInt8* pixel = s + first * channels;
+        int32x4_t sum = vdupq_n_s32(0);
+        PM_Size k = 0;
+
+        // Two pixels at once, one per half of the widened register
+        for (; k + 2 <= taps && (first + k) * channels + 8 <= rowSize; k += 2)
+        {
+            int16x8_t x = vreinterpretq_s16_u16(vmovl_u8(vtbl1_u8(vld1_u8(pixel + k * channels), spread)));
+            sum = vmlal_n_s16(sum, vget_low_s16(x), weights[k]);
+            sum = vmlal_n_s16(sum, vget_high_s16(x), weights[k + 1]);
+        }
+
+        PM_Int32 lanes[4];
+        vst1q_s32(lanes, sum);
+
+        for (; k < taps; k++)
+        {
+            for (PM_Size c = 0; c < channels; c++)
+            {
+                lanes[c] += weights[k] * (PM_Int32)pixel[k * channels + c];
+            }
+        }
+
+        for (PM_Size c = 0; c < channels; c++)
+        {
+            PM_Int32 value = lanes[c] + (1 << (shift - 1));
+            value = value < 0 ? 0 : value >> shift;
+            d[i * channels + c] = (PM_UInt16)PM_Min(value, maximum);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageResizeVerticalU8NEON(const PM__ImageResizeAxis* axis, PM_Size index, const PM_Byte* const* rows, PM_Byte* dst, PM_Size count)
+{
+    const PM_Int16* weights = axis->fixedWeights + index * axis->taps;
+    PM_Size taps = axis->taps;
+    const PM_Int32 shift = PM_IMAGE_RESIZE_PRECISION + PM_IMAGE_RESIZE_U8_EXTRA_BITS;
+    const int32x4_t round = vdupq_n_s32(1 << (shift - 1));
+    PM_UInt8* d = (PM_UInt8*)dst;
+    PM_Size x = 0;
+
+    for (; x + 8 <= count; x += 8)
+    {
+        int32x4_t sumLow = round;
+        int32x4_t sumHigh = round;
+
+        for (PM_Size k = 0; k < taps; k++)
+        {
+            int16x8_t row = vreinterpretq_s16_u16(vld1q_u16((const PM_UInt16*)rows[k] + x));
+            sumLow = vmlal_n_s16(sumLow, vget_low_s16(row), weights[k]);
+            sumHigh = vmlal_high_n_s16(sumHigh, row, weights[k]);
+        }
+
+        uint16x8_t words = vcombine_u16(vqmovun_s32(vshrq_n_s32(sumLow, PM_IMAGE_RESIZE_PRECISION + PM_IMAGE_RESIZE_U8_EXTRA_BITS)), vqmovun_s32(vshrq_n_s32(sumHigh, PM_IMAGE_RESIZE_PRECISION + PM_IMAGE_RESIZE_U8_EXTRA_BITS)));
+        vst1_u8(d + x, vqmovn_u16(words));
+    }
+
+    for (; x < count; x++)
+    {
+        PM_Int32 sum = 1 << (shift - 1);
+        for (PM_Size k = 0; k < taps; k++)
+        {
+            sum += weights[k] * (PM_Int32)((const PM_UInt16*)rows[k])[x];
+        }
+        sum = sum < 0 ? 0 : sum >> shift;
+        d[x] = (PM_UInt8)PM_Min(sum, 0xFF);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageResizeVerticalU16NEON(const PM__ImageResizeAxis* axis, PM_Size index, const PM_Byte* const* rows, PM_Byte* dst, PM_Size count)
+{
+    const PM_Float32* weights = axis->weights32 + index * axis->taps;
+    PM_Size taps = axis->taps;
+    PM_UInt16* d = (PM_UInt16*)dst;
+    PM_Size x = 0;
+
+    for (; x + 8 <= count; x += 8)
+    {
+        float32x4_t sumLow = vdupq_n_f32(0.0f);
+        float32x4_t sumHigh = vdupq_n_f32(0.0f);
+
+        for (PM_Size k = 0; k < taps; k++)
+        {
+            const PM_Float32* row = (const PM_Float32*)rows[k] + x;
+            sumLow = vmlaq_n_f32(sumLow, vld1q_f32(row), weights[k]);
+            sumHigh = vmlaq_n_f32(sumHigh, vld1q_f32(row + 4), weights[k]);
+        }
+
+        vst1q_u16(d + x, vcombine_u16(vqmovun_s32(vcvtnq_s32_f32(sumLow)), vqmovun_s32(vcvtnq_s32_f32(sumHigh))));
+    }
+
+    for (; x < count; x++)
+    {
+        PM_Float32 sum = 0.0f;
+        for (PM_Size k = 0; k < taps; k++)
+        {
+            sum += weights[k] * ((const PM_Float32*)rows[k])[x];
+        }
+        d[x] = PM__ImageResizeStoreU16(sum);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageResizeHorizontalF32NEON(const PM__ImageResizeAxis* axis, PM_Size channels, const PM_Byte* src, PM_Byte* dst)
+{
+    if (channels != 3 && channels != 4)
+    {
+        PM__ImageResizeHorizontalF32(axis, channels, src, dst);
+        return;
+    }
+
+    const PM_Float32* s = (const PM_Float32*)src;
+    PM_Float32* d = (PM_Float32*)dst;
+    PM_Size taps = axis->taps;
+    PM_Size rowSize = axis->srcSize * channels;
+
+    for (PM_Size i = 0; i < axis->dstSize; i++)
+    {
+        const PM_Float32* weights = axis->weights32 + i * taps;
+        PM_Size first = axis->first[i];
+        const PM_Float32* pixel = s + first * channels;
+        float32x4_t sum = vdupq_n_f32(0.0f);
+        PM_Size k = 0;
+
+        for (; k < taps && (first + k) * channels + 4 <= rowSize; k++)
+        {
+            sum = vmlaq_n_f32(sum, vld1q_f32(pixel + k * channels), weights[k]);
+        }
+
+        PM_Float32 lanes[4];
+        vst1q_f32(lanes, sum);
+
+        for (; k < taps; k++)
+        {
+            for (PM_Size c = 0; c < channels; c++)
+            {
+                lanes[c] += weights[k] * pixel[k * channels + c];
+            }
+        }
+
+        for (PM_Size c = 0; c < channels; c++)
+        {
+            d[i * channels + c] = lanes[c];
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageResizeVerticalF32NEON(const PM__ImageResizeAxis* axis, PM_Size index, const PM_Byte* const* rows, PM_Byte* dst, PM_Size count)
+{
+    const PM_Float32* weights = axis->weights32 + index * axis->taps;
+    PM_Size taps = axis->taps;
+    PM_Float32* d = (PM_Float32*)dst;
+    PM_Size x = 0;
+
+    for (; x + 8 <= count; x += 8)
+    {
+        float32x4_t sumLow = vdupq_n_f32(0.0f);
+        float32x4_t sumHigh = vdupq_n_f32(0.0f);
+
+        for (PM_Size k = 0; k < taps; k++)
+        {
+            const PM_Float32* row = (const PM_Float32*)rows[k] + x;
+            sumLow = vmlaq_n_f32(sumLow, vld1q_f32(row), weights[k]);
+            sumHigh = vmlaq_n_f32(sumHigh, vld1q_f32(row + 4), weights[k]);
+        }
+
+        vst1q_f32(d + x, sumLow);
+        vst1q_f32(d + x + 4, sumHigh);
+    }
+
+    for (; x < count; x++)
+    {
+        PM_Float32 sum = 0.0f;
+        for (PM_Size k = 0; k < taps; k++)
+        {
+            sum += weights[k] * ((const PM_Float32*)rows[k])[x];
+        }
+        d[x] = sum;
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+#endif
+
+static PM__ImageResizeKernel PM_IMAGE_RESIZE_KERNELS[PM_IMAGE_RESIZE_DATA_TYPE_COUNT] =
+{
+    { PM__ImageResizeHorizontalU8, PM__ImageResizeVerticalU8, sizeof(PM_UInt16) },
+    { PM__ImageResizeHorizontalU16, PM__ImageResizeVerticalU16, sizeof(PM_Float32) },
+    { PM__ImageResizeHorizontalU32, PM__ImageResizeVerticalU32, sizeof(PM_Float64) },
+    { PM__ImageResizeHorizontalU64, PM__ImageResizeVerticalU64, sizeof(PM_Float64) },
+    { PM__ImageResizeHorizontalF32, PM__ImageResizeVerticalF32, sizeof(PM_Float32) },
+    { PM__ImageResizeHorizontalF64, PM__ImageResizeVerticalF64, sizeof(PM_Float64) }
+};
+static volatile PM_Bool PM_IMAGE_RESIZE_KERNELS_SELECTED = PM_FALSE;
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageSelectResizeKernels()
+{
+#if defined(PM_ARCH_X86)
+    if (PM_CPUHasFeature(PICOMEDIA_CPU_FEATURE_AVX2))
+    {
+        PM_IMAGE_RESIZE_KERNELS[0].horizontal = PM__ImageResizeHorizontalU8AVX2;
+        PM_IMAGE_RESIZE_KERNELS[0].vertical = PM__ImageResizeVerticalU8AVX2;
+        PM_IMAGE_RESIZE_KERNELS[1].vertical = PM__ImageResizeVerticalU16AVX2;
+        PM_IMAGE_RESIZE_KERNELS[4].horizontal = PM__ImageResizeHorizontalF32AVX2;
+        PM_IMAGE_RESIZE_KERNELS[4].vertical = PM__ImageResizeVerticalF32AVX2;
+    }
+#elif defined(PM_ARCH_ARM64)
+    PM_IMAGE_RESIZE_KERNELS[0].horizontal = PM__ImageResizeHorizontalU8NEON;
+    PM_IMAGE_RESIZE_KERNELS[0].vertical = PM__ImageResizeVerticalU8NEON;
+    PM_IMAGE_RESIZE_KERNELS[1].vertical = PM__ImageResizeVerticalU16NEON;
+    PM_IMAGE_RESIZE_KERNELS[4].horizontal = PM__ImageResizeHorizontalF32NEON;
+    PM_IMAGE_RESIZE_KERNELS[4].vertical = PM__ImageResizeVerticalF32NEON;
+#endif
+
+    PM_IMAGE_RESIZE_KERNELS_SELECTED = PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageResizeBandWorker(PM_Size begin, PM_Size end, void* data)
+{
+    const PM__ImageResizeBand* band = (const PM__ImageResizeBand*)data;
+    const PM__ImageResizeAxis* vertical = band->vertical;
+    PM_Size taps = vertical->taps;
+    PM_Size ringRowSize = band->ringSize / taps;
+    PM_Size samples = band->horizontal->dstSize * band->channels;
+
+    for (PM_Size b = begin; b < end; b++)
+    {
+        PM_Byte* ring = band->rings + b * band->ringSize;
+        const PM_Byte** rows = band->rows + b * taps;
+        PM_Size firstRow = b * band->bandRows;
+        PM_Size lastRow = PM_Min(firstRow + band->bandRows, vertical->dstSize);
+        PM_Size nextSrcRow = vertical->first[firstRow];
+
+        for (PM_Size y = firstRow; y < lastRow; y++)
+        {
+            PM_Size first = vertical->first[y];
+
+            // Source row r lives in slot r % taps of the ring until row r + taps is needed
+            for (PM_Size r = PM_Max(first, nextSrcRow); r < first + taps; r++)
+            {
+                band->kernel->horizontal(band->horizontal, band->channels, band->src + r * band->srcRowSize, ring + (r % taps) * ringRowSize);
+                nextSrcRow = r + 1;
+            }
+
+            for (PM_Size k = 0; k < taps; k++)
+            {
+                rows[k] = ring + ((first + k) % taps) * ringRowSize;
+            }
+
+            band->kernel->vertical(vertical, y, rows, band->dst + y * band->dstRowSize, samples);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PM_ImageTransformsResize(PM_Image* dest, const PM_Image* src, PM_UInt32 width, PM_UInt32 height, PM_UInt32 filter)
+{
+    PM_Assert(dest != NULL);
+    PM_Assert(src != NULL);
+    PM_Assert(dest != src);
+
+    PM__ImageResizeFilter resizeFilter;
+    if (!PM__ImageResizeGetFilter(filter, &resizeFilter))
+    {
+        PM_LogError("Unsupported resize filter!");
+        return PM_FALSE;
+    }
+
+    PM_UInt32 dataTypeIndex = src->dataType - PICOIMEDIA_IMAGE_DATA_TYPE_UINT8;
+    if (dataTypeIndex >= PM_IMAGE_RESIZE_DATA_TYPE_COUNT)
+    {
+        PM_LogError("Unsupported data type!");
+        return PM_FALSE;
+    }
+
+    if (src->width == 0 || src->height == 0 || width == 0 || height == 0)
+    {
+        PM_LogError("Cannot resize an empty image!");
+        return PM_FALSE;
+    }
+
+    if (!PM_IMAGE_RESIZE_KERNELS_SELECTED)
+    {
+        PM__ImageSelectResizeKernels();
+    }
+
+    PM__ImageResizeAxis horizontal = {0};
+    PM__ImageResizeAxis vertical = {0};
+
+    if (!PM__ImageResizeAxisInit(&horizontal, &resizeFilter, src->width, width) || !PM__ImageResizeAxisInit(&vertical, &resizeFilter, src->height, height))
+    {
+        PM__ImageResizeAxisDestroy(&horizontal);
+        PM__ImageResizeAxisDestroy(&vertical);
+        PM_LogError("Failed to allocate memory for the resize weights!");
+        return PM_FALSE;
+    }
+
+    if (!PM_ImageAllocate(dest, width, height, src->channelFormat, src->dataType, src->numChannels))
+    {
+        PM__ImageResizeAxisDestroy(&horizontal);
+        PM__ImageResizeAxisDestroy(&vertical);
+        PM_LogError("Failed to allocate memory for new image!");
+        return PM_FALSE;
+    }
+
+    PM__ImageResizeBand band;
+    band.kernel = &PM_IMAGE_RESIZE_KERNELS[dataTypeIndex];
+    band.horizontal = &horizontal;
+    band.vertical = &vertical;
+    band.src = src->data;
+    band.dst = dest->data;
+    band.channels = src->numChannels;
+    band.srcRowSize = (PM_Size)src->width * src->numChannels * PM_ImageGetDataTypeSize(src->dataType);
+    band.dstRowSize = (PM_Size)width * src->numChannels * PM_ImageGetDataTypeSize(src->dataType);
+
+    // Bands redo the horizontal pass of the source rows shared with their neighbours, so there are only a
+    // few per thread. Small images end up as a single band, which PM_ParallelFor runs on the calling thread.
+    PM_Size threadCount = PM_ThreadPoolGetThreadCount(NULL) + 1;
+    PM_Size samplesPerRow = (PM_Size)width * src->numChannels;
+    PM_Size minRows = PM_Max(PM_IMAGE_RESIZE_MIN_BAND_SAMPLES / samplesPerRow, (PM_Size)1);
+    band.bandRows = PM_Max((PM_Size)height / (threadCount * PM_IMAGE_RESIZE_BANDS_PER_THREAD), minRows);
+    PM_Size bandCount = ((PM_Size)height + band.bandRows - 1) / band.bandRows;
+
+    // The row pointers go first so they stay aligned, 8-bit rings are only a multiple of 2 bytes long
+    band.ringSize = vertical.taps * samplesPerRow * band.kernel->intermediateSize;
+    PM_Size rowsSize = bandCount * vertical.taps * sizeof(const PM_Byte*);
+    PM_Byte* scratch = (PM_Byte*)PM_Malloc(rowsSize + bandCount * band.ringSize);
+
+    if (scratch == NULL)
+    {
+        PM__ImageResizeAxisDestroy(&horizontal);
+        PM__ImageResizeAxisDestroy(&vertical);
+        PM_ImageDestroy(dest);
+        PM_LogError("Failed to allocate memory for the resize buffers!");
+        return PM_FALSE;
+    }
+
+    band.rows = (const PM_Byte**)scratch;
+    band.rings = scratch + rowsSize;
+
+    PM_ParallelFor(NULL, 0, bandCount, 1, PM__ImageResizeBandWorker, &band);
+
+    PM_Free(scratch);
+    PM__ImageResizeAxisDestroy(&horizontal);
+    PM__ImageResizeAxisDestroy(&vertical);
+
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Box downscaling sums the rows of a block into per column sums, then sums groups of columns. Blocks on the
+// right and bottom edges may be smaller, every destination pixel is the average of the pixels it covers.
+
+#define PM__IMAGE_DEFINE_BOX(name, Type, SumType, TotalType, average, store) \
+    static void PM__ImageBoxAccumulate##name(const PM_Byte* src, PM_Byte* sums, PM_Size count) \
+    { \
+        const Type* s = (const Type*)src; \
+        SumType* d = (SumType*)sums; \
+        for (PM_Size i = 0; i < count; i++) \
+        { \
+            d[i] += (SumType)s[i]; \
+        } \
+    } \
+    \
+    static void PM__ImageBoxAverage##name(const PM_Byte* sums, PM_Byte* dst, PM_Size srcWidth, PM_Size channels, PM_Size factor, PM_Size rows) \
+    { \
+        const SumType* s = (const SumType*)sums; \
+        Type* d = (Type*)dst; \
+        for (PM_Size x = 0; x < srcWidth; x += factor) \
+        { \
+            PM_Size columns = PM_Min(factor, srcWidth - x); \
+            TotalType count = (TotalType)(columns * rows); \
+            for (PM_Size c = 0; c < channels; c++) \
+            { \
+                TotalType total = 0; \
+                for (PM_Size k = 0; k < columns; k++) \
+                { \
+                    total += (TotalType)s[(x + k) * channels + c]; \
+                } \
+                *d++ = store(average(total, count)); \
+            } \
+        } \
+    }
+
+#define PM__IMAGE_BOX_AVERAGE_INTEGER(total, count) (((total) + (count) / 2) / (count))
+#define PM__IMAGE_BOX_AVERAGE_FLOAT(total, count) ((total) / (count))
+
+PM__IMAGE_DEFINE_BOX(U8, PM_UInt8, PM_UInt32, PM_UInt64, PM__IMAGE_BOX_AVERAGE_INTEGER, (PM_UInt8))
+PM__IMAGE_DEFINE_BOX(U16, PM_UInt16, PM_UInt32, PM_UInt64, PM__IMAGE_BOX_AVERAGE_INTEGER, (PM_UInt16))
+PM__IMAGE_DEFINE_BOX(U32, PM_UInt32, PM_Float64, PM_Float64, PM__IMAGE_BOX_AVERAGE_FLOAT, PM__ImageResizeStoreU32)
+PM__IMAGE_DEFINE_BOX(U64, PM_UInt64, PM_Float64, PM_Float64, PM__IMAGE_BOX_AVERAGE_FLOAT, PM__ImageResizeStoreU64)
+PM__IMAGE_DEFINE_BOX(F32, PM_Float32, PM_Float64, PM_Float64, PM__IMAGE_BOX_AVERAGE_FLOAT, (PM_Float32))
+PM__IMAGE_DEFINE_BOX(F64, PM_Float64, PM_Float64, PM_Float64, PM__IMAGE_BOX_AVERAGE_FLOAT, (PM_Float64))
+
+// -----------------------------------------------------------------------------------------------
+
+#if defined(PM_ARCH_X86)
+
+static PM_TARGET("avx2") void PM__ImageBoxAccumulateU8AVX2(const PM_Byte* src, PM_Byte* sums, PM_Size count)
+{
+    const PM_UInt8* s = (const PM_UInt8*)src;
+    PM_UInt32* d = (PM_UInt32*)sums;
+    PM_Size i = 0;
+
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i*)(s + i));
+        __m256i low = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(d + i)), _mm256_cvtepu8_epi32(x));
+        __m256i high = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(d + i + 8)), _mm256_cvtepu8_epi32(_mm_srli_si128(x, 8)));
+        _mm256_storeu_si256((__m256i*)(d + i), low);
+        _mm256_storeu_si256((__m256i*)(d + i + 8), high);
+    }
+
+    for (; i < count; i++)
+    {
+        d[i] += s[i];
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("avx2") void PM__ImageBoxAccumulateU16AVX2(const PM_Byte* src, PM_Byte* sums, PM_Size count)
+{
+    const PM_UInt16* s = (const PM_UInt16*)src;
+    PM_UInt32* d = (PM_UInt32*)sums;
+    PM_Size i = 0;
+
+    for (; i + 16 <= count; i += 16)
+    {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(s + i));
+        __m256i low = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(d + i)), _mm256_cvtepu16_epi32(_mm256_castsi256_si128(x)));
+        __m256i high = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(d + i + 8)), _mm256_cvtepu16_epi32(_mm256_extracti128_si256(x, 1)));
+        _mm256_storeu_si256((__m256i*)(d + i), low);
+        _mm256_storeu_si256((__m256i*)(d + i + 8), high);
+    }
+
+    for (; i < count; i++)
+    {
+        d[i] += s[i];
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+#elif defined(PM_ARCH_ARM64)
+
+static void PM__ImageBoxAccumulateU8NEON(const PM_Byte* src, PM_Byte* sums, PM_Size count)
+{
+    const PM_UInt8* s = (const PM_UInt8*)src;
+    PM_UInt32* d = (PM_UInt32*)sums;
+    PM_Size i = 0;
+
+    for (; i + 8 <= count; i += 8)
+    {
+        uint16x8_t x = vmovl_u8(vld1_u8(s + i));
+        vst1q_u32(d + i, vaddw_u16(vld1q_u32(d + i), vget_low_u16(x)));
+        vst1q_u32(d + i + 4, vaddw_high_u16(vld1q_u32(d + i + 4), x));
+    }
+
+    for (; i < count; i++)
+    {
+        d[i] += s[i];
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageBoxAccumulateU16NEON(const PM_Byte* src, PM_Byte* sums, PM_Size count)
+{
+    const PM_UInt16* s = (const PM_UInt16*)src;
+    PM_UInt32* d = (PM_UInt32*)sums;
+    PM_Size i = 0;
+
+    for (; i + 8 <= count; i += 8)
+    {
+        uint16x8_t x = vld1q_u16(s + i);
+        vst1q_u32(d + i, vaddw_u16(vld1q_u32(d + i), vget_low_u16(x)));
+        vst1q_u32(d + i + 4, vaddw_high_u16(vld1q_u32(d + i + 4), x));
+    }
+
+    for (; i < count; i++)
+    {
+        d[i] += s[i];
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+#endif
+
+static PM__ImageBoxKernel PM_IMAGE_BOX_KERNELS[PM_IMAGE_RESIZE_DATA_TYPE_COUNT] =
+{
+    { PM__ImageBoxAccumulateU8, PM__ImageBoxAverageU8, sizeof(PM_UInt32) },
+    { PM__ImageBoxAccumulateU16, PM__ImageBoxAverageU16, sizeof(PM_UInt32) },
+    { PM__ImageBoxAccumulateU32, PM__ImageBoxAverageU32, sizeof(PM_Float64) },
+    { PM__ImageBoxAccumulateU64, PM__ImageBoxAverageU64, sizeof(PM_Float64) },
+    { PM__ImageBoxAccumulateF32, PM__ImageBoxAverageF32, sizeof(PM_Float64) },
+    { PM__ImageBoxAccumulateF64, PM__ImageBoxAverageF64, sizeof(PM_Float64) }
+};
+static volatile PM_Bool PM_IMAGE_BOX_KERNELS_SELECTED = PM_FALSE;
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageSelectBoxKernels()
+{
+#if defined(PM_ARCH_X86)
+    if (PM_CPUHasFeature(PICOMEDIA_CPU_FEATURE_AVX2))
+    {
+        PM_IMAGE_BOX_KERNELS[0].accumulate = PM__ImageBoxAccumulateU8AVX2;
+        PM_IMAGE_BOX_KERNELS[1].accumulate = PM__ImageBoxAccumulateU16AVX2;
+    }
+#elif defined(PM_ARCH_ARM64)
+    PM_IMAGE_BOX_KERNELS[0].accumulate = PM__ImageBoxAccumulateU8NEON;
+    PM_IMAGE_BOX_KERNELS[1].accumulate = PM__ImageBoxAccumulateU16NEON;
+#endif
+
+    PM_IMAGE_BOX_KERNELS_SELECTED = PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImageBoxBandWorker(PM_Size begin, PM_Size end, void* data)
+{
+    const PM__ImageBoxBand* band = (const PM__ImageBoxBand*)data;
+    PM_Size samples = band->srcWidth * band->channels;
+    PM_Size dstHeight = (band->srcHeight + band->factor - 1) / band->factor;
+
+    for (PM_Size b = begin; b < end; b++)
+    {
+        PM_Byte* sums = band->sums + b * band->sumsSize;
+        PM_Size lastRow = PM_Min((b + 1) * band->bandRows, dstHeight);
+
+        for (PM_Size y = b * band->bandRows; y < lastRow; y++)
+        {
+            PM_Size firstSrcRow = y * band->factor;
+            PM_Size rows = PM_Min(band->factor, band->srcHeight - firstSrcRow);
+
+            PM_Memset(sums, 0, band->sumsSize);
+            for (PM_Size r = 0; r < rows; r++)
+            {
+                band->kernel->accumulate(band->src + (firstSrcRow + r) * band->srcRowSize, sums, samples);
+            }
+
+            band->kernel->average(sums, band->dst + y * band->dstRowSize, band->srcWidth, band->channels, band->factor, rows);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PM_ImageTransformsDownscaleBox(PM_Image* dest, const PM_Image* src, PM_UInt32 factor)
+{
+    PM_Assert(dest != NULL);
+    PM_Assert(src != NULL);
+    PM_Assert(dest != src);
+
+    if (factor == 0 || (factor & (factor - 1)) != 0 || factor > PM_IMAGE_BOX_MAX_FACTOR)
+    {
+        PM_LogError("The downscale factor must be a power of two up to 65536!");
+        return PM_FALSE;
+    }
+
+    PM_UInt32 dataTypeIndex = src->dataType - PICOIMEDIA_IMAGE_DATA_TYPE_UINT8;
+    if (dataTypeIndex >= PM_IMAGE_RESIZE_DATA_TYPE_COUNT)
+    {
+        PM_LogError("Unsupported data type!");
+        return PM_FALSE;
+    }
+
+    if (src->width == 0 || src->height == 0)
+    {
+        PM_LogError("Cannot resize an empty image!");
+        return PM_FALSE;
+    }
+
+    if (!PM_IMAGE_BOX_KERNELS_SELECTED)
+    {
+        PM__ImageSelectBoxKernels();
+    }
+
+    PM_UInt32 width = (src->width + factor - 1) / factor;
+    PM_UInt32 height = (src->height + factor - 1) / factor;
+
+    if (!PM_ImageAllocate(dest, width, height, src->channelFormat, src->dataType, src->numChannels))
+    {
+        PM_LogError("Failed to allocate memory for new image!");
+        return PM_FALSE;
+    }
+
+    PM__ImageBoxBand band;
+    band.kernel = &PM_IMAGE_BOX_KERNELS[dataTypeIndex];
+    band.src = src->data;
+    band.dst = dest->data;
+    band.srcWidth = src->width;
+    band.srcHeight = src->height;
+    band.channels = src->numChannels;
+    band.factor = factor;
+    band.srcRowSize = (PM_Size)src->width * src->numChannels * PM_ImageGetDataTypeSize(src->dataType);
+    band.dstRowSize = (PM_Size)width * src->numChannels * PM_ImageGetDataTypeSize(src->dataType);
+    band.sumsSize = (PM_Size)src->width * src->numChannels * band.kernel->sumSize;
+
+    // The bands are sized by the source samples they read
+    PM_Size threadCount = PM_ThreadPoolGetThreadCount(NULL) + 1;
+    PM_Size srcSamplesPerRow = (PM_Size)src->width * src->numChannels * factor;
+    PM_Size minRows = PM_Max(PM_IMAGE_RESIZE_MIN_BAND_SAMPLES / srcSamplesPerRow, (PM_Size)1);
+    band.bandRows = PM_Max((PM_Size)height / (threadCount * PM_IMAGE_RESIZE_BANDS_PER_THREAD), minRows);
+    PM_Size bandCount = ((PM_Size)height + band.bandRows - 1) / band.bandRows;
+
+    band.sums = (PM_Byte*)PM_Malloc(bandCount * band.sumsSize);
+    if (band.sums == NULL)
+    {
+        PM_ImageDestroy(dest);
+        PM_LogError("Failed to allocate memory for the downscale buffers!");
+        return PM_FALSE;
+    }
+
+    PM_ParallelFor(NULL, 0, bandCount, 1, PM__ImageBoxBandWorker, &band);
+
+    PM_Free(band.sums);
+
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
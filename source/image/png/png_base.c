@@ -49,7 +49,8 @@ PM_Bool PM_ImagePNGHeaderIsValid(const PM_PNGHeader* header)
 {
     PM_Assert(header != NULL);
 
-    if (header->width == 0 || header->height == 0)
+    // The specification limits both dimensions to 2^31 - 1
+    if (header->width == 0 || header->height == 0 || header->width > 0x7FFFFFFF || header->height > 0x7FFFFFFF)
     {
         return PM_FALSE;
     }
@@ -372,6 +373,7 @@ void  PM_ImagePNGContextInit(PM_PNGContext* context)
     context->timeChunk = NULL;
     context->rawData = NULL;
     context->dataSize = 0;
+    context->inflateContext = NULL;
 }
 
 // -----------------------------------------------------------------------------------------------
@@ -439,6 +441,12 @@ void  PM_ImagePNGContextDestroy(PM_PNGContext* context)
         context->rawData = NULL;
     }
 
+    if (context->inflateContext != NULL)
+    {
+        PM_Delete(context->inflateContext);
+        context->inflateContext = NULL;
+    }
+
     context->dataSize = 0;
 
 }
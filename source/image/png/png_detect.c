@@ -7,7 +7,7 @@ PM_Bool PM_ImagePNGDetect(PM_Stream* stream)
     PM_Assert(stream != NULL);
 
     static const PM_UInt8 pngMagic[] = { 0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A };
-    static PM_UInt8 magicNumber[sizeof(pngMagic)] = {0};
+    PM_UInt8 magicNumber[sizeof(pngMagic)] = {0};
 
     PM_StreamRead(stream, (PM_Byte*)magicNumber, sizeof(magicNumber));
     
@@ -0,0 +1,566 @@
+#include "libpicomedia/image/png/png.h"
+
+#if defined(PM_ARCH_X86)
+    #include <immintrin.h>
+#elif defined(PM_ARCH_ARM64)
+    #include <arm_neon.h>
+#endif
+
+// Reconstructs one scanline for a single filter type, prev is never NULL here
+typedef void (*PM__ImagePNGUnfilterFunction)(PM_UInt8* dst, const PM_UInt8* src, const PM_UInt8* prev, PM_Size rowSize, PM_Size bytesPerPixel);
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_UInt8 PM__ImagePNGPaethPredictor(PM_Int32 a, PM_Int32 b, PM_Int32 c)
+{
+    PM_Int32 p = a + b - c;
+    PM_Int32 pa = p > a ? p - a : a - p;
+    PM_Int32 pb = p > b ? p - b : b - p;
+    PM_Int32 pc = p > c ? p - c : c - p;
+
+    if (pa <= pb && pa <= pc)
+    {
+        return (PM_UInt8)a;
+    }
+    else if (pb <= pc)
+    {
+        return (PM_UInt8)b;
+    }
+    return (PM_UInt8)c;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImagePNGUnfilterNoneScalar(PM_UInt8* dst, const PM_UInt8* src, const PM_UInt8* prev, PM_Size rowSize, PM_Size bytesPerPixel)
+{
+    (void)prev;
+    (void)bytesPerPixel;
+
+    // The destination may overlap the source
+    PM_Memmove(dst, src, rowSize);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImagePNGUnfilterSubScalar(PM_UInt8* dst, const PM_UInt8* src, const PM_UInt8* prev, PM_Size rowSize, PM_Size bytesPerPixel)
+{
+    (void)prev;
+
+    PM_Size i = 0;
+    PM_Size firstPixelSize = PM_Min(bytesPerPixel, rowSize);
+
+    for (i = 0; i < firstPixelSize; i++)
+    {
+        dst[i] = src[i];
+    }
+    for (; i < rowSize; i++)
+    {
+        dst[i] = (PM_UInt8)(src[i] + dst[i - bytesPerPixel]);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImagePNGUnfilterUpScalar(PM_UInt8* dst, const PM_UInt8* src, const PM_UInt8* prev, PM_Size rowSize, PM_Size bytesPerPixel)
+{
+    (void)bytesPerPixel;
+
+    for (PM_Size i = 0; i < rowSize; i++)
+    {
+        dst[i] = (PM_UInt8)(src[i] + prev[i]);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImagePNGUnfilterAverageScalar(PM_UInt8* dst, const PM_UInt8* src, const PM_UInt8* prev, PM_Size rowSize, PM_Size bytesPerPixel)
+{
+    PM_Size i = 0;
+    PM_Size firstPixelSize = PM_Min(bytesPerPixel, rowSize);
+
+    for (i = 0; i < firstPixelSize; i++)
+    {
+        dst[i] = (PM_UInt8)(src[i] + (prev[i] >> 1));
+    }
+    for (; i < rowSize; i++)
+    {
+        dst[i] = (PM_UInt8)(src[i] + ((dst[i - bytesPerPixel] + prev[i]) >> 1));
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImagePNGUnfilterPaethScalar(PM_UInt8* dst, const PM_UInt8* src, const PM_UInt8* prev, PM_Size rowSize, PM_Size bytesPerPixel)
+{
+    PM_Size i = 0;
+    PM_Size firstPixelSize = PM_Min(bytesPerPixel, rowSize);
+
+    for (i = 0; i < firstPixelSize; i++)
+    {
+        dst[i] = (PM_UInt8)(src[i] + prev[i]);
+    }
+    for (; i < rowSize; i++)
+    {
+        dst[i] = (PM_UInt8)(src[i] + PM__ImagePNGPaethPredictor(dst[i - bytesPerPixel], prev[i], prev[i - bytesPerPixel]));
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// The first scanline of a pass has an implicit all zero row above it
+static void PM__ImagePNGUnfilterAverageFirstRow(PM_UInt8* dst, const PM_UInt8* src, PM_Size rowSize, PM_Size bytesPerPixel)
+{
+    PM_Size i = 0;
+    PM_Size firstPixelSize = PM_Min(bytesPerPixel, rowSize);
+
+    for (i = 0; i < firstPixelSize; i++)
+    {
+        dst[i] = src[i];
+    }
+    for (; i < rowSize; i++)
+    {
+        dst[i] = (PM_UInt8)(src[i] + (dst[i - bytesPerPixel] >> 1));
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+#if defined(PM_ARCH_X86)
+
+// Sub is a prefix sum with a stride of one pixel, computed in log2(16 / bpp) shifted additions
+#define PM__IMAGE_PNG_DEFINE_SUB_SSE2(bpp) \
+    static PM_TARGET("sse2") void PM__ImagePNGUnfilterSubSSE2_##bpp(PM_UInt8* dst, const PM_UInt8* src, PM_Size rowSize) \
+    { \
+        __m128i carry = _mm_setzero_si128(); \
+        PM_Size i = 0; \
+        for (; i + 16 <= rowSize; i += 16) \
+        { \
+            __m128i x = _mm_add_epi8(_mm_loadu_si128((const __m128i*)(src + i)), carry); \
+            x = _mm_add_epi8(x, _mm_slli_si128(x, bpp)); \
+            if (2 * bpp < 16) x = _mm_add_epi8(x, _mm_slli_si128(x, (2 * bpp) & 15)); \
+            if (4 * bpp < 16) x = _mm_add_epi8(x, _mm_slli_si128(x, (4 * bpp) & 15)); \
+            if (8 * bpp < 16) x = _mm_add_epi8(x, _mm_slli_si128(x, (8 * bpp) & 15)); \
+            _mm_storeu_si128((__m128i*)(dst + i), x); \
+            carry = _mm_srli_si128(x, 16 - bpp); \
+        } \
+        for (; i < rowSize; i++) \
+        { \
+            dst[i] = (PM_UInt8)(src[i] + (i >= bpp ? dst[i - bpp] : 0)); \
+        } \
+    }
+
+PM__IMAGE_PNG_DEFINE_SUB_SSE2(1)
+PM__IMAGE_PNG_DEFINE_SUB_SSE2(2)
+PM__IMAGE_PNG_DEFINE_SUB_SSE2(3)
+PM__IMAGE_PNG_DEFINE_SUB_SSE2(4)
+PM__IMAGE_PNG_DEFINE_SUB_SSE2(6)
+PM__IMAGE_PNG_DEFINE_SUB_SSE2(8)
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("sse2") void PM__ImagePNGUnfilterSubSSE2(PM_UInt8* dst, const PM_UInt8* src, const PM_UInt8* prev, PM_Size rowSize, PM_Size bytesPerPixel)
+{
+    switch (bytesPerPixel)
+    {
+        case 1: PM__ImagePNGUnfilterSubSSE2_1(dst, src, rowSize); break;
+        case 2: PM__ImagePNGUnfilterSubSSE2_2(dst, src, rowSize); break;
+        case 3: PM__ImagePNGUnfilterSubSSE2_3(dst, src, rowSize); break;
+        case 4: PM__ImagePNGUnfilterSubSSE2_4(dst, src, rowSize); break;
+        case 6: PM__ImagePNGUnfilterSubSSE2_6(dst, src, rowSize); break;
+        case 8: PM__ImagePNGUnfilterSubSSE2_8(dst, src, rowSize); break;
+        default: PM__ImagePNGUnfilterSubScalar(dst, src, prev, rowSize, bytesPerPixel); break;
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("sse2") void PM__ImagePNGUnfilterUpSSE2(PM_UInt8* dst, const PM_UInt8* src, const PM_UInt8* prev, PM_Size rowSize, PM_Size bytesPerPixel)
+{
+    (void)bytesPerPixel;
+
+    PM_Size i = 0;
+    for (; i + 16 <= rowSize; i += 16)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(prev + i));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_add_epi8(x, b));
+    }
+    for (; i < rowSize; i++)
+    {
+        dst[i] = (PM_UInt8)(src[i] + prev[i]);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("avx2") void PM__ImagePNGUnfilterUpAVX2(PM_UInt8* dst, const PM_UInt8* src, const PM_UInt8* prev, PM_Size rowSize, PM_Size bytesPerPixel)
+{
+    (void)bytesPerPixel;
+
+    PM_Size i = 0;
+    for (; i + 32 <= rowSize; i += 32)
+    {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(prev + i));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_add_epi8(x, b));
+    }
+    for (; i < rowSize; i++)
+    {
+        dst[i] = (PM_UInt8)(src[i] + prev[i]);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Average and Paeth depend on the pixel to the left, so they work on one pixel (up to 8 bytes) at a time.
+// Below 3 bytes per pixel a vector per pixel does less work than the scalar loop, which handles those rows.
+static PM_TARGET("sse2") __m128i PM__ImagePNGLoadPixelSSE2(const PM_UInt8* data, PM_Size bytesPerPixel)
+{
+    PM_UInt64 value = 0;
+    PM_Memcpy(&value, data, bytesPerPixel);
+    return _mm_loadl_epi64((const __m128i*)&value);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("sse2") void PM__ImagePNGStorePixelSSE2(PM_UInt8* data, __m128i pixel, PM_Size bytesPerPixel)
+{
+    PM_UInt64 value = 0;
+    _mm_storel_epi64((__m128i*)&value, pixel);
+    PM_Memcpy(data, &value, bytesPerPixel);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("sse2") void PM__ImagePNGUnfilterAverageSSE2(PM_UInt8* dst, const PM_UInt8* src, const PM_UInt8* prev, PM_Size rowSize, PM_Size bytesPerPixel)
+{
+    if (bytesPerPixel < 3)
+    {
+        PM__ImagePNGUnfilterAverageScalar(dst, src, prev, rowSize, bytesPerPixel);
+        return;
+    }
+
+    __m128i a = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi8(1);
+
+    // Scanlines with at least one byte per pixel are always a whole number of pixels
+    for (PM_Size i = 0; i < rowSize; i += bytesPerPixel)
+    {
+        __m128i b = PM__ImagePNGLoadPixelSSE2(prev + i, bytesPerPixel);
+        __m128i x = PM__ImagePNGLoadPixelSSE2(src + i, bytesPerPixel);
+
+        // pavgb rounds up, the filter rounds down
+        __m128i average = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+        a = _mm_add_epi8(average, x);
+
+        PM__ImagePNGStorePixelSSE2(dst + i, a, bytesPerPixel);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Paeth predictor on 16 bit lanes, ABS is the absolute value implementation of the instruction set
+#define PM__IMAGE_PNG_PAETH_SSE_BODY(ABS) \
+    __m128i zero = _mm_setzero_si128(); \
+    __m128i a = zero; \
+    __m128i c = zero; \
+    for (PM_Size i = 0; i < rowSize; i += bytesPerPixel) \
+    { \
+        __m128i b = _mm_unpacklo_epi8(PM__ImagePNGLoadPixelSSE2(prev + i, bytesPerPixel), zero); \
+        __m128i x = _mm_unpacklo_epi8(PM__ImagePNGLoadPixelSSE2(src + i, bytesPerPixel), zero); \
+        __m128i pa = _mm_sub_epi16(b, c); \
+        __m128i pb = _mm_sub_epi16(a, c); \
+        __m128i pc = _mm_add_epi16(pa, pb); \
+        pa = ABS(pa); \
+        pb = ABS(pb); \
+        pc = ABS(pc); \
+        __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb)); \
+        __m128i useA = _mm_cmpeq_epi16(pa, smallest); \
+        __m128i useB = _mm_cmpeq_epi16(pb, smallest); \
+        __m128i nearest = _mm_or_si128(_mm_and_si128(useB, b), _mm_andnot_si128(useB, c)); \
+        nearest = _mm_or_si128(_mm_and_si128(useA, a), _mm_andnot_si128(useA, nearest)); \
+        a = _mm_add_epi8(nearest, x); \
+        PM__ImagePNGStorePixelSSE2(dst + i, _mm_packus_epi16(a, a), bytesPerPixel); \
+        c = b; \
+    }
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("sse2") __m128i PM__ImagePNGAbs16SSE2(__m128i x)
+{
+    return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("sse2") void PM__ImagePNGUnfilterPaethSSE2(PM_UInt8* dst, const PM_UInt8* src, const PM_UInt8* prev, PM_Size rowSize, PM_Size bytesPerPixel)
+{
+    if (bytesPerPixel < 3)
+    {
+        PM__ImagePNGUnfilterPaethScalar(dst, src, prev, rowSize, bytesPerPixel);
+        return;
+    }
+
+    PM__IMAGE_PNG_PAETH_SSE_BODY(PM__ImagePNGAbs16SSE2)
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_TARGET("ssse3") void PM__ImagePNGUnfilterPaethSSSE3(PM_UInt8* dst, const PM_UInt8* src, const PM_UInt8* prev, PM_Size rowSize, PM_Size bytesPerPixel)
+{
+    if (bytesPerPixel < 3)
+    {
+        PM__ImagePNGUnfilterPaethScalar(dst, src, prev, rowSize, bytesPerPixel);
+        return;
+    }
+
+    PM__IMAGE_PNG_PAETH_SSE_BODY(_mm_abs_epi16)
+}
+
+#elif defined(PM_ARCH_ARM64)
+
+// Sub is a prefix sum with a stride of one pixel, computed in log2(16 / bpp) shifted additions
+#define PM__IMAGE_PNG_DEFINE_SUB_NEON(bpp) \
+    static void PM__ImagePNGUnfilterSubNEON_##bpp(PM_UInt8* dst, const PM_UInt8* src, PM_Size rowSize) \
+    { \
+        const uint8x16_t zero = vdupq_n_u8(0); \
+        uint8x16_t carry = zero; \
+        PM_Size i = 0; \
+        for (; i + 16 <= rowSize; i += 16) \
+        { \
+            uint8x16_t x = vaddq_u8(vld1q_u8(src + i), carry); \
+            x = vaddq_u8(x, vextq_u8(zero, x, 16 - bpp)); \
+            if (2 * bpp < 16) x = vaddq_u8(x, vextq_u8(zero, x, (16 - 2 * bpp) & 15)); \
+            if (4 * bpp < 16) x = vaddq_u8(x, vextq_u8(zero, x, (16 - 4 * bpp) & 15)); \
+            if (8 * bpp < 16) x = vaddq_u8(x, vextq_u8(zero, x, (16 - 8 * bpp) & 15)); \
+            vst1q_u8(dst + i, x); \
+            carry = vextq_u8(x, zero, 16 - bpp); \
+        } \
+        for (; i < rowSize; i++) \
+        { \
+            dst[i] = (PM_UInt8)(src[i] + (i >= bpp ? dst[i - bpp] : 0)); \
+        } \
+    }
+
+PM__IMAGE_PNG_DEFINE_SUB_NEON(1)
+PM__IMAGE_PNG_DEFINE_SUB_NEON(2)
+PM__IMAGE_PNG_DEFINE_SUB_NEON(3)
+PM__IMAGE_PNG_DEFINE_SUB_NEON(4)
+PM__IMAGE_PNG_DEFINE_SUB_NEON(6)
+PM__IMAGE_PNG_DEFINE_SUB_NEON(8)
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImagePNGUnfilterSubNEON(PM_UInt8* dst, const PM_UInt8* src, const PM_UInt8* prev, PM_Size rowSize, PM_Size bytesPerPixel)
+{
+    switch (bytesPerPixel)
+    {
+        case 1: PM__ImagePNGUnfilterSubNEON_1(dst, src, rowSize); break;
+        case 2: PM__ImagePNGUnfilterSubNEON_2(dst, src, rowSize); break;
+        case 3: PM__ImagePNGUnfilterSubNEON_3(dst, src, rowSize); break;
+        case 4: PM__ImagePNGUnfilterSubNEON_4(dst, src, rowSize); break;
+        case 6: PM__ImagePNGUnfilterSubNEON_6(dst, src, rowSize); break;
+        case 8: PM__ImagePNGUnfilterSubNEON_8(dst, src, rowSize); break;
+        default: PM__ImagePNGUnfilterSubScalar(dst, src, prev, rowSize, bytesPerPixel); break;
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImagePNGUnfilterUpNEON(PM_UInt8* dst, const PM_UInt8* src, const PM_UInt8* prev, PM_Size rowSize, PM_Size bytesPerPixel)
+{
+    (void)bytesPerPixel;
+
+    PM_Size i = 0;
+    for (; i + 16 <= rowSize; i += 16)
+    {
+        vst1q_u8(dst + i, vaddq_u8(vld1q_u8(src + i), vld1q_u8(prev + i)));
+    }
+    for (; i < rowSize; i++)
+    {
+        dst[i] = (PM_UInt8)(src[i] + prev[i]);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Average and Paeth depend on the pixel to the left, so they work on one pixel (up to 8 bytes) at a time.
+// Below 3 bytes per pixel a vector per pixel does less work than the scalar loop, which handles those rows.
+static uint8x8_t PM__ImagePNGLoadPixelNEON(const PM_UInt8* data, PM_Size bytesPerPixel)
+{
+    PM_UInt64 value = 0;
+    PM_Memcpy(&value, data, bytesPerPixel);
+    return vcreate_u8(value);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImagePNGStorePixelNEON(PM_UInt8* data, uint8x8_t pixel, PM_Size bytesPerPixel)
+{
+    PM_UInt64 value = vget_lane_u64(vreinterpret_u64_u8(pixel), 0);
+    PM_Memcpy(data, &value, bytesPerPixel);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImagePNGUnfilterAverageNEON(PM_UInt8* dst, const PM_UInt8* src, const PM_UInt8* prev, PM_Size rowSize, PM_Size bytesPerPixel)
+{
+    if (bytesPerPixel < 3)
+    {
+        PM__ImagePNGUnfilterAverageScalar(dst, src, prev, rowSize, bytesPerPixel);
+        return;
+    }
+
+    uint8x8_t a = vdup_n_u8(0);
+
+    for (PM_Size i = 0; i < rowSize; i += bytesPerPixel)
+    {
+        uint8x8_t b = PM__ImagePNGLoadPixelNEON(prev + i, bytesPerPixel);
+        uint8x8_t x = PM__ImagePNGLoadPixelNEON(src + i, bytesPerPixel);
+
+        // vhadd truncates, exactly like the filter
+        a = vadd_u8(vhadd_u8(a, b), x);
+
+        PM__ImagePNGStorePixelNEON(dst + i, a, bytesPerPixel);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImagePNGUnfilterPaethNEON(PM_UInt8* dst, const PM_UInt8* src, const PM_UInt8* prev, PM_Size rowSize, PM_Size bytesPerPixel)
+{
+    if (bytesPerPixel < 3)
+    {
+        PM__ImagePNGUnfilterPaethScalar(dst, src, prev, rowSize, bytesPerPixel);
+        return;
+    }
+
+    uint8x8_t a = vdup_n_u8(0);
+    uint8x8_t c = vdup_n_u8(0);
+
+    for (PM_Size i = 0; i < rowSize; i += bytesPerPixel)
+    {
+        uint8x8_t b = PM__ImagePNGLoadPixelNEON(prev + i, bytesPerPixel);
+        uint8x8_t x = PM__ImagePNGLoadPixelNEON(src + i, bytesPerPixel);
+
+        uint16x8_t pa = vabdl_u8(b, c);
+        uint16x8_t pb = vabdl_u8(a, c);
+        uint16x8_t pc = vabdq_u16(vaddl_u8(a, b), vshll_n_u8(c, 1));
+        uint16x8_t smallest = vminq_u16(pc, vminq_u16(pa, pb));
+
+        uint8x8_t useA = vmovn_u16(vceqq_u16(pa, smallest));
+        uint8x8_t useB = vmovn_u16(vceqq_u16(pb, smallest));
+        uint8x8_t nearest = vbsl_u8(useA, a, vbsl_u8(useB, b, c));
+
+        a = vadd_u8(nearest, x);
+        c = b;
+
+        PM__ImagePNGStorePixelNEON(dst + i, a, bytesPerPixel);
+    }
+}
+
+#endif
+
+// -----------------------------------------------------------------------------------------------
+
+// Indexed by the filter type, starts out with the scalar kernels so it is always safe to use
+static PM__ImagePNGUnfilterFunction PM_PNG_UNFILTER_FUNCTIONS[5] = {
+    PM__ImagePNGUnfilterNoneScalar,
+    PM__ImagePNGUnfilterSubScalar,
+    PM__ImagePNGUnfilterUpScalar,
+    PM__ImagePNGUnfilterAverageScalar,
+    PM__ImagePNGUnfilterPaethScalar
+};
+static volatile PM_Bool PM_PNG_UNFILTER_FUNCTIONS_SELECTED = PM_FALSE;
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImagePNGSelectUnfilterFunctions()
+{
+#if defined(PM_ARCH_X86)
+    if (PM_CPUHasFeature(PICOMEDIA_CPU_FEATURE_SSE2))
+    {
+        PM_PNG_UNFILTER_FUNCTIONS[PICOMEDIA_PNG_FILTER_SUB] = PM__ImagePNGUnfilterSubSSE2;
+        PM_PNG_UNFILTER_FUNCTIONS[PICOMEDIA_PNG_FILTER_UP] = PM__ImagePNGUnfilterUpSSE2;
+        PM_PNG_UNFILTER_FUNCTIONS[PICOMEDIA_PNG_FILTER_AVERAGE] = PM__ImagePNGUnfilterAverageSSE2;
+        PM_PNG_UNFILTER_FUNCTIONS[PICOMEDIA_PNG_FILTER_PAETH] = PM__ImagePNGUnfilterPaethSSE2;
+    }
+
+    if (PM_CPUHasFeature(PICOMEDIA_CPU_FEATURE_SSSE3))
+    {
+        PM_PNG_UNFILTER_FUNCTIONS[PICOMEDIA_PNG_FILTER_PAETH] = PM__ImagePNGUnfilterPaethSSSE3;
+    }
+
+    if (PM_CPUHasFeature(PICOMEDIA_CPU_FEATURE_AVX2))
+    {
+        PM_PNG_UNFILTER_FUNCTIONS[PICOMEDIA_PNG_FILTER_UP] = PM__ImagePNGUnfilterUpAVX2;
+    }
+#elif defined(PM_ARCH_ARM64)
+    PM_PNG_UNFILTER_FUNCTIONS[PICOMEDIA_PNG_FILTER_SUB] = PM__ImagePNGUnfilterSubNEON;
+    PM_PNG_UNFILTER_FUNCTIONS[PICOMEDIA_PNG_FILTER_UP] = PM__ImagePNGUnfilterUpNEON;
+    PM_PNG_UNFILTER_FUNCTIONS[PICOMEDIA_PNG_FILTER_AVERAGE] = PM__ImagePNGUnfilterAverageNEON;
+    PM_PNG_UNFILTER_FUNCTIONS[PICOMEDIA_PNG_FILTER_PAETH] = PM__ImagePNGUnfilterPaethNEON;
+#endif
+
+    PM_PNG_UNFILTER_FUNCTIONS_SELECTED = PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Bool PM__ImagePNGUnfilterScanline(PM_UInt8 filterType, PM_UInt8* dst, const PM_UInt8* src, const PM_UInt8* prev, PM_Size rowSize, PM_Size bytesPerPixel, const PM__ImagePNGUnfilterFunction* functions)
+{
+    PM_Assert(dst != NULL);
+    PM_Assert(src != NULL);
+    PM_Assert(bytesPerPixel > 0);
+
+    if (filterType > PICOMEDIA_PNG_FILTER_PAETH)
+    {
+        PM_LogWarning("PM_ImagePNGUnfilterScanline: Invalid filter type %d.", filterType);
+        return PM_FALSE;
+    }
+
+    // The row above the first one is treated as all zeros
+    if (prev == NULL)
+    {
+        switch (filterType)
+        {
+            case PICOMEDIA_PNG_FILTER_UP      : filterType = PICOMEDIA_PNG_FILTER_NONE; break;
+            case PICOMEDIA_PNG_FILTER_PAETH   : filterType = PICOMEDIA_PNG_FILTER_SUB; break;
+            case PICOMEDIA_PNG_FILTER_AVERAGE : PM__ImagePNGUnfilterAverageFirstRow(dst, src, rowSize, bytesPerPixel); return PM_TRUE;
+            default: break;
+        }
+    }
+
+    functions[filterType](dst, src, prev, rowSize, bytesPerPixel);
+
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PM_ImagePNGUnfilterScanline(PM_UInt8 filterType, PM_UInt8* dst, const PM_UInt8* src, const PM_UInt8* prev, PM_Size rowSize, PM_Size bytesPerPixel)
+{
+    if (!PM_PNG_UNFILTER_FUNCTIONS_SELECTED)
+    {
+        PM__ImagePNGSelectUnfilterFunctions();
+    }
+
+    return PM__ImagePNGUnfilterScanline(filterType, dst, src, prev, rowSize, bytesPerPixel, PM_PNG_UNFILTER_FUNCTIONS);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PM_ImagePNGUnfilterScanlineScalar(PM_UInt8 filterType, PM_UInt8* dst, const PM_UInt8* src, const PM_UInt8* prev, PM_Size rowSize, PM_Size bytesPerPixel)
+{
+    static const PM__ImagePNGUnfilterFunction scalarFunctions[5] = {
+        PM__ImagePNGUnfilterNoneScalar,
+        PM__ImagePNGUnfilterSubScalar,
+        PM__ImagePNGUnfilterUpScalar,
+        PM__ImagePNGUnfilterAverageScalar,
+        PM__ImagePNGUnfilterPaethScalar
+    };
+
+    return PM__ImagePNGUnfilterScanline(filterType, dst, src, prev, rowSize, bytesPerPixel, scalarFunctions);
+}
+
+// -----------------------------------------------------------------------------------------------
@@ -4,6 +4,7 @@
 
 // -----------------------------------------------------------------------------------------------
 
+// Borrows the type and data of the next chunk from the stream, the caller has to release the stream when done with it
 static PM_Bool PM__ImagePNGNextChunk(PM_Stream* stream, PM_Size* chunkSizeOut, PM_UInt8** chunkDataOut)
 {
     PM_Assert(stream != NULL);
@@ -12,7 +13,7 @@ static PM_Bool PM__ImagePNGNextChunk(PM_Stream* stream, PM_Size* chunkSizeOut, P
 
     PM_UInt32 chunkLength = 0;
     PM_UInt32 chunkCRC = 0;
-    PM_UInt8* chunkData = NULL;
+    PM_Byte* chunkData = NULL;
 
 
     // Read chunk length
@@ -23,47 +24,28 @@ static PM_Bool PM__ImagePNGNextChunk(PM_Stream* stream, PM_Size* chunkSizeOut, P
         return PM_FALSE;
     }
 
-    // Allocate memory for chunk data
-    chunkData = (PM_UInt8*)PM_Malloc(chunkLength + sizeof(PM_UInt32));
-    if ( chunkData == NULL )
+    // The chunk type and data are used in place when the stream is backed by memory,
+    // otherwise the stream reads them into its own buffer that is reused for all the chunks
+    PM_Size requiredSize = (PM_Size)chunkLength + sizeof(PM_UInt32);
+    if ( PM_StreamAcquire(stream, requiredSize, &chunkData) != requiredSize )
     {
-        PM_LogWarning("PM__ImagePNGNextChunk: Failed to allocate memory for chunk data.");
+        PM_LogWarning("PM__ImagePNGNextChunk: Failed to read chunk data.");
+        PM_StreamRelease(stream);
         return PM_FALSE;
     }
-    
-
-    // Read chunk type
-    PM_StreamSetRequireReverse(stream, PM_FALSE);
-    if ( PM_StreamRead(stream, (PM_Byte*)chunkData, sizeof(PM_UInt32)) != sizeof(PM_UInt32) )
-    {
-        PM_LogWarning("PM__ImagePNGNextChunk: Failed to read chunk type.");
-        return PM_FALSE;
-    }
-
-    // Read chunk data
-    if ( chunkLength > 0 )
-    {
-        // Read chunk data
-        if ( PM_StreamRead(stream, (PM_Byte*)(chunkData + sizeof(PM_UInt32)), chunkLength) != chunkLength )
-        {
-            PM_LogWarning("PM__ImagePNGNextChunk: Failed to read chunk data.");
-            PM_Free(chunkData);
-            return PM_FALSE;
-        }
-    }
 
     // Read chunk CRC
     PM_StreamSetRequireReverse(stream, !PM_IsBigEndian());
     if ( PM_StreamRead(stream, (PM_Byte*)&chunkCRC, sizeof(PM_UInt32)) != sizeof(PM_UInt32) )
     {
         PM_LogWarning("PM__ImagePNGNextChunk: Failed to read chunk CRC.");
-        PM_Free(chunkData);
+        PM_StreamRelease(stream);
         return PM_FALSE;
     }
 
     // Verify chunk CRC
 
-    PM_UInt32 crc = PM_CRC32(chunkData, chunkLength + sizeof(PM_UInt32), 0);
+    PM_UInt32 crc = PM_CRC32((PM_UInt8*)chunkData, chunkLength + sizeof(PM_UInt32), 0);
 
     if ( crc != chunkCRC )
     {
@@ -73,12 +55,12 @@ static PM_Bool PM__ImagePNGNextChunk(PM_Stream* stream, PM_Size* chunkSizeOut, P
             (PM_Char)(chunkData[2]),
             (PM_Char)(chunkData[3]));
 
-        PM_Free(chunkData);
+        PM_StreamRelease(stream);
         return PM_FALSE;
     }
     
     *chunkSizeOut = chunkLength;
-    *chunkDataOut = chunkData;
+    *chunkDataOut = (PM_UInt8*)chunkData;
 
     return PM_TRUE;
 }
@@ -160,8 +142,6 @@ static PM_Bool PM__ImagePNGReadIHDR(PM_PNGContext* context, PM_UInt8* chunkData,
 
 static PM_Bool PM__ImagePNGReadiTXt(PM_PNGContext* context, PM_UInt8* chunkData, PM_Size chunkSize)
 {
-    (void) chunkSize;
-
     if (context->header == NULL)
     {
         PM_LogWarning("PM__ImagePNGReadiTXt: IHDR chunk not read.");
@@ -186,7 +166,10 @@ static PM_Bool PM__ImagePNGReadiTXt(PM_PNGContext* context, PM_UInt8* chunkData,
 
     PM_PNGTextChunk* textChunk = &context->textChunks[context->textChunkCount];
     
-    memcpy(textChunk->keyword, chunkData, 80);
+    // The chunk may be a view into the source, so never read past its end
+    PM_Size keywordSize = PM_Min(chunkSize, sizeof(textChunk->keyword) - 1);
+    PM_Memcpy(textChunk->keyword, chunkData, keywordSize);
+    textChunk->keyword[keywordSize] = '\0';
 
     PM_ImagePNGTextChunkPrint(textChunk);
 
@@ -195,9 +178,558 @@ static PM_Bool PM__ImagePNGReadiTXt(PM_PNGContext* context, PM_UInt8* chunkData,
 
 // -----------------------------------------------------------------------------------------------
 
+static PM_Bool PM__ImagePNGReadPLTE(PM_PNGContext* context, PM_UInt8* chunkData, PM_Size chunkSize)
+{
+    if (context->header == NULL)
+    {
+        PM_LogWarning("PM__ImagePNGReadPLTE: IHDR chunk not read.");
+        return PM_FALSE;
+    }
+
+    if (context->palette != NULL)
+    {
+        PM_LogWarning("PM__ImagePNGReadPLTE: PLTE chunk already read.");
+        return PM_FALSE;
+    }
+
+    if (chunkSize % 3 != 0 || chunkSize / 3 > 256 || chunkSize == 0)
+    {
+        PM_LogWarning("PM__ImagePNGReadPLTE: Invalid palette size %zu.", chunkSize);
+        return PM_FALSE;
+    }
+
+    context->palette = PM_New(PM_PNGPallette);
+    if (context->palette == NULL)
+    {
+        PM_LogWarning("PM__ImagePNGReadPLTE: Failed to allocate memory for palette.");
+        return PM_FALSE;
+    }
+
+    PM_ImagePNGPalletteInit(context->palette);
+    context->palette->size = chunkSize / 3;
+    PM_Memcpy(context->palette->data, chunkData, chunkSize);
+
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Bool PM__ImagePNGReadtRNS(PM_PNGContext* context, PM_UInt8* chunkData, PM_Size chunkSize)
+{
+    if (context->header == NULL)
+    {
+        PM_LogWarning("PM__ImagePNGReadtRNS: IHDR chunk not read.");
+        return PM_FALSE;
+    }
+
+    if (context->transparency != NULL)
+    {
+        PM_LogWarning("PM__ImagePNGReadtRNS: tRNS chunk already read.");
+        return PM_FALSE;
+    }
+
+    context->transparency = PM_New(PM_PNGTransparency);
+    if (context->transparency == NULL)
+    {
+        PM_LogWarning("PM__ImagePNGReadtRNS: Failed to allocate memory for transparency.");
+        return PM_FALSE;
+    }
+    PM_ImagePNGTransparencyInit(context->transparency);
+
+    switch (context->header->colorType)
+    {
+        case 0:
+        {
+            if (chunkSize != 2)
+            {
+                PM_LogWarning("PM__ImagePNGReadtRNS: Invalid tRNS size for grayscale image.");
+                return PM_FALSE;
+            }
+            context->transparency->gray = (PM_UInt16)((chunkData[0] << 8) | chunkData[1]);
+            break;
+        }
+        case 2:
+        {
+            if (chunkSize != 6)
+            {
+                PM_LogWarning("PM__ImagePNGReadtRNS: Invalid tRNS size for truecolor image.");
+                return PM_FALSE;
+            }
+            for (PM_Size i = 0; i < 3; i++)
+            {
+                context->transparency->rgb[i] = (PM_UInt16)((chunkData[i * 2] << 8) | chunkData[i * 2 + 1]);
+            }
+            break;
+        }
+        case 3:
+        {
+            if (chunkSize > 256)
+            {
+                PM_LogWarning("PM__ImagePNGReadtRNS: Invalid tRNS size for indexed-color image.");
+                return PM_FALSE;
+            }
+            // Entries not covered by the chunk are fully opaque
+            PM_Memset(context->transparency->alpha, 0xFF, sizeof(context->transparency->alpha));
+            PM_Memcpy(context->transparency->alpha, chunkData, chunkSize);
+            break;
+        }
+        default:
+        {
+            PM_LogWarning("PM__ImagePNGReadtRNS: tRNS chunk not allowed for color type %d.", context->header->colorType);
+            return PM_FALSE;
+        }
+    }
+
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_UInt8 PM__ImagePNGGetChannelCount(PM_UInt8 colorType)
+{
+    switch (colorType)
+    {
+        case 0: return 1;
+        case 2: return 3;
+        case 3: return 1;
+        case 4: return 2;
+        case 6: return 4;
+        default: return 0;
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Size PM__ImagePNGGetRowSize(const PM_PNGHeader* header, PM_UInt32 width)
+{
+    return ((PM_Size)width * PM__ImagePNGGetChannelCount(header->colorType) * header->bitDepth + 7) / 8;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Size PM__ImagePNGGetFilterBytesPerPixel(const PM_PNGHeader* header)
+{
+    return PM_Max((PM_Size)1, (PM_Size)PM__ImagePNGGetChannelCount(header->colorType) * header->bitDepth / 8);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Adam7 interlacing passes, { xStart, yStart, xStep, yStep }
+static const PM_UInt8 PM_PNG_ADAM7_PASSES[7][4] = {
+    { 0, 0, 8, 8 },
+    { 4, 0, 8, 8 },
+    { 0, 4, 4, 8 },
+    { 2, 0, 4, 4 },
+    { 0, 2, 2, 4 },
+    { 1, 0, 2, 2 },
+    { 0, 1, 1, 2 }
+};
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImagePNGGetPassSize(const PM_PNGHeader* header, PM_UInt32 pass, PM_UInt32* passWidth, PM_UInt32* passHeight)
+{
+    if (header->interlaceMethod == 0)
+    {
+        *passWidth = header->width;
+        *passHeight = header->height;
+        return;
+    }
+
+    const PM_UInt8* passInfo = PM_PNG_ADAM7_PASSES[pass];
+    *passWidth = header->width > passInfo[0] ? (header->width - passInfo[0] + passInfo[2] - 1) / passInfo[2] : 0;
+    *passHeight = header->height > passInfo[1] ? (header->height - passInfo[1] + passInfo[3] - 1) / passInfo[3] : 0;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Images that need no expansion are decoded straight into the image buffer and unfiltered in place
+static PM_Bool PM__ImagePNGCanDecodeDirectly(const PM_PNGContext* context)
+{
+    const PM_PNGHeader* header = context->header;
+    return header->interlaceMethod == 0
+        && (header->bitDepth == 8 || header->bitDepth == 16)
+        && header->colorType != 3
+        && context->transparency == NULL;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Bool PM__ImagePNGBeginImageData(PM_PNGContext* context, PM_Image* image)
+{
+    if (context->header == NULL)
+    {
+        PM_LogWarning("PM__ImagePNGBeginImageData: IHDR chunk not read.");
+        return PM_FALSE;
+    }
+
+    const PM_PNGHeader* header = context->header;
+
+    if (!PM_ImagePNGHeaderIsValid(header))
+    {
+        PM_LogWarning("PM__ImagePNGBeginImageData: Invalid PNG header.");
+        return PM_FALSE;
+    }
+
+    if (header->colorType == 3 && context->palette == NULL)
+    {
+        PM_LogWarning("PM__ImagePNGBeginImageData: Missing PLTE chunk for indexed-color image.");
+        return PM_FALSE;
+    }
+
+    PM_UInt32 channelFormat = PICOMEDIA_IMAGE_CHANNEL_FORMAT_UNKNOWN;
+    PM_UInt8 numChannels = 0;
+    PM_Bool hasTransparency = context->transparency != NULL;
+
+    switch (header->colorType)
+    {
+        case 0: channelFormat = hasTransparency ? PICOMEDIA_IMAGE_CHANNEL_FORMAT_GRAYA : PICOMEDIA_IMAGE_CHANNEL_FORMAT_GRAY; numChannels = hasTransparency ? 2 : 1; break;
+        case 2: channelFormat = hasTransparency ? PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGBA : PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGB; numChannels = hasTransparency ? 4 : 3; break;
+        case 3: channelFormat = hasTransparency ? PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGBA : PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGB; numChannels = hasTransparency ? 4 : 3; break;
+        case 4: channelFormat = PICOMEDIA_IMAGE_CHANNEL_FORMAT_GRAYA; numChannels = 2; break;
+        case 6: channelFormat = PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGBA; numChannels = 4; break;
+        default: break;
+    }
+
+    PM_UInt32 dataType = header->bitDepth == 16 ? PICOIMEDIA_IMAGE_DATA_TYPE_UINT16 : PICOIMEDIA_IMAGE_DATA_TYPE_UINT8;
+
+    // The dimensions come from the file, so the decoded size is checked in PM_Size before the image and
+    // the inflate output are allocated, the filtered data is never larger than the decoded image plus filter bytes
+    PM_ImageInfo info;
+    PM_ImageInfoInit(&info);
+    info.width = header->width;
+    info.height = header->height;
+    info.numChannels = numChannels;
+    info.dataType = dataType;
+    PM_Size decodedSize = PM_ImageInfoGetDataSize(&info);
+    if (decodedSize == SIZE_MAX || decodedSize > PICOMEDIA_IMAGE_MAX_DATA_SIZE)
+    {
+        PM_LogWarning("PM__ImagePNGBeginImageData: Image is too large(%u x %u).", header->width, header->height);
+        return PM_FALSE;
+    }
+
+    if (!PM_ImageAllocate(image, header->width, header->height, channelFormat, dataType, numChannels))
+    {
+        PM_LogWarning("PM__ImagePNGBeginImageData: Failed to allocate image.");
+        return PM_FALSE;
+    }
+
+    // Size of the decompressed stream, every scanline of every pass is prefixed with a filter type byte
+    PM_Size filteredSize = 0;
+    PM_UInt32 passCount = header->interlaceMethod == 0 ? 1 : 7;
+    for (PM_UInt32 pass = 0; pass < passCount; pass++)
+    {
+        PM_UInt32 passWidth = 0, passHeight = 0;
+        PM__ImagePNGGetPassSize(header, pass, &passWidth, &passHeight);
+        if (passWidth > 0 && passHeight > 0)
+        {
+            filteredSize += (PM__ImagePNGGetRowSize(header, passWidth) + 1) * passHeight;
+        }
+    }
+
+    PM_UInt8* filteredData = NULL;
+    if (PM__ImagePNGCanDecodeDirectly(context))
+    {
+        if (!PM_ImageReserve(image, filteredSize))
+        {
+            PM_LogWarning("PM__ImagePNGBeginImageData: Failed to reserve image data.");
+            return PM_FALSE;
+        }
+        filteredData = (PM_UInt8*)image->data;
+    }
+    else
+    {
+        context->rawData = (PM_UInt8*)PM_Malloc(filteredSize);
+        if (context->rawData == NULL)
+        {
+            PM_LogWarning("PM__ImagePNGBeginImageData: Failed to allocate %zu bytes for image data.", filteredSize);
+            return PM_FALSE;
+        }
+        filteredData = context->rawData;
+    }
+    context->dataSize = filteredSize;
+
+    context->inflateContext = PM_New(PM_InflateContext);
+    if (context->inflateContext == NULL)
+    {
+        PM_LogWarning("PM__ImagePNGBeginImageData: Failed to allocate inflate context.");
+        return PM_FALSE;
+    }
+
+    PM_InflateContextInit(context->inflateContext, PM_TRUE);
+    PM_InflateContextSetOutput(context->inflateContext, filteredData, filteredSize);
+
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_UInt32 PM__ImagePNGGetSample(const PM_UInt8* row, PM_Size index, PM_UInt8 bitDepth)
+{
+    switch (bitDepth)
+    {
+        case 16: return ((PM_UInt32)row[index * 2] << 8) | row[index * 2 + 1];
+        case 8: return row[index];
+        default:
+        {
+            PM_Size bitOffset = index * bitDepth;
+            return (row[bitOffset >> 3] >> (8 - bitDepth - (bitOffset & 7))) & ((1u << bitDepth) - 1);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Bool PM__ImagePNGExpandScanline(const PM_PNGContext* context, PM_Image* image, const PM_UInt8* row, PM_UInt32 rowWidth, PM_UInt32 y, PM_UInt32 xStart, PM_UInt32 xStep)
+{
+    const PM_PNGHeader* header = context->header;
+    const PM_PNGTransparency* transparency = context->transparency;
+    PM_UInt8 inChannels = PM__ImagePNGGetChannelCount(header->colorType);
+    PM_UInt8 outChannels = image->numChannels;
+    PM_UInt8 bitDepth = header->bitDepth;
+    PM_UInt32 maxValue = bitDepth == 16 ? 0xFFFF : 0xFF;
+    PM_UInt32 scale = bitDepth < 8 ? 0xFF / ((1u << bitDepth) - 1) : 1;
+    PM_UInt32 samples[4] = { 0 };
+
+    for (PM_UInt32 i = 0; i < rowWidth; i++)
+    {
+        PM_Size pixelIndex = (PM_Size)y * image->width + xStart + (PM_Size)i * xStep;
+        PM_UInt32 values[4] = { 0 };
+
+        for (PM_UInt8 c = 0; c < inChannels; c++)
+        {
+            samples[c] = PM__ImagePNGGetSample(row, (PM_Size)i * inChannels + c, bitDepth);
+        }
+
+        if (header->colorType == 3)
+        {
+            // The palette can be shorter than the bit depth allows, an index past its end is an error
+            PM_UInt32 index = samples[0];
+            if (index >= context->palette->size)
+            {
+                PM_LogWarning("PM__ImagePNGExpandScanline: Palette index %u out of range (palette size %zu).", index, context->palette->size);
+                return PM_FALSE;
+            }
+
+            values[0] = context->palette->data[index][0];
+            values[1] = context->palette->data[index][1];
+            values[2] = context->palette->data[index][2];
+            values[3] = transparency != NULL ? transparency->alpha[index] : 0xFF;
+        }
+        else
+        {
+            for (PM_UInt8 c = 0; c < inChannels; c++)
+            {
+                values[c] = samples[c] * scale;
+            }
+
+            if (transparency != NULL)
+            {
+                PM_Bool isTransparent = header->colorType == 0
+                    ? samples[0] == transparency->gray
+                    : (samples[0] == transparency->rgb[0] && samples[1] == transparency->rgb[1] && samples[2] == transparency->rgb[2]);
+                values[inChannels] = isTransparent ? 0 : maxValue;
+            }
+        }
+
+        if (bitDepth == 16)
+        {
+            PM_UInt16* out = (PM_UInt16*)image->data + pixelIndex * outChannels;
+            for (PM_UInt8 c = 0; c < outChannels; c++)
+            {
+                out[c] = (PM_UInt16)values[c];
+            }
+        }
+        else
+        {
+            PM_UInt8* out = (PM_UInt8*)image->data + pixelIndex * outChannels;
+            for (PM_UInt8 c = 0; c < outChannels; c++)
+            {
+                out[c] = (PM_UInt8)values[c];
+            }
+        }
+    }
+
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Bool PM__ImagePNGFinishImageData(PM_PNGContext* context, PM_Image* image)
+{
+    const PM_PNGHeader* header = context->header;
+    PM_InflateContext* inflateContext = context->inflateContext;
+    PM_Size bytesPerPixel = PM__ImagePNGGetFilterBytesPerPixel(header);
+
+    if (inflateContext == NULL)
+    {
+        PM_LogWarning("PM__ImagePNGFinishImageData: No IDAT chunk found.");
+        return PM_FALSE;
+    }
+
+    if (PM_InflateGetOutputSize(inflateContext) != context->dataSize)
+    {
+        PM_LogWarning("PM__ImagePNGFinishImageData: Image data is truncated (%zu of %zu bytes).", PM_InflateGetOutputSize(inflateContext), context->dataSize);
+        return PM_FALSE;
+    }
+
+    if (PM_InflateFeed(inflateContext, NULL, 0) != PICOMEDIA_INFLATE_STATUS_DONE)
+    {
+        PM_LogWarning("PM__ImagePNGFinishImageData: Compressed stream is not terminated, ignoring.");
+    }
+
+    if (PM__ImagePNGCanDecodeDirectly(context))
+    {
+        // Scanline y is read from y * (rowSize + 1) + 1 and written to y * rowSize, as the destination
+        // never runs ahead of the source the filter bytes can be stripped while unfiltering
+        PM_UInt8* data = (PM_UInt8*)image->data;
+        PM_Size rowSize = PM__ImagePNGGetRowSize(header, header->width);
+
+        for (PM_UInt32 y = 0; y < header->height; y++)
+        {
+            PM_UInt8* src = data + (PM_Size)y * (rowSize + 1);
+            PM_UInt8* dst = data + (PM_Size)y * rowSize;
+            PM_UInt8* prev = y > 0 ? dst - rowSize : NULL;
+
+            if (!PM_ImagePNGUnfilterScanline(src[0], dst, src + 1, prev, rowSize, bytesPerPixel))
+            {
+                return PM_FALSE;
+            }
+        }
+
+        // PNG samples are big endian
+        if (header->bitDepth == 16 && !PM_IsBigEndian())
+        {
+            PM_Size sampleCount = image->dataSize / 2;
+            for (PM_Size i = 0; i < sampleCount; i++)
+            {
+                PM_UInt8 temp = data[i * 2];
+                data[i * 2] = data[i * 2 + 1];
+                data[i * 2 + 1] = temp;
+            }
+        }
+
+        return PM_TRUE;
+    }
+
+    PM_UInt8* filteredData = context->rawData;
+    PM_UInt32 passCount = header->interlaceMethod == 0 ? 1 : 7;
+
+    for (PM_UInt32 pass = 0; pass < passCount; pass++)
+    {
+        PM_UInt32 passWidth = 0, passHeight = 0;
+        PM__ImagePNGGetPassSize(header, pass, &passWidth, &passHeight);
+        if (passWidth == 0 || passHeight == 0)
+        {
+            continue;
+        }
+
+        PM_UInt32 xStart = header->interlaceMethod == 0 ? 0 : PM_PNG_ADAM7_PASSES[pass][0];
+        PM_UInt32 yStart = header->interlaceMethod == 0 ? 0 : PM_PNG_ADAM7_PASSES[pass][1];
+        PM_UInt32 xStep = header->interlaceMethod == 0 ? 1 : PM_PNG_ADAM7_PASSES[pass][2];
+        PM_UInt32 yStep = header->interlaceMethod == 0 ? 1 : PM_PNG_ADAM7_PASSES[pass][3];
+        PM_Size rowSize = PM__ImagePNGGetRowSize(header, passWidth);
+        PM_UInt8* prev = NULL;
+
+        for (PM_UInt32 y = 0; y < passHeight; y++)
+        {
+            PM_UInt8* row = filteredData + 1;
+
+            if (!PM_ImagePNGUnfilterScanline(filteredData[0], row, row, prev, rowSize, bytesPerPixel))
+            {
+                return PM_FALSE;
+            }
+
+            if (!PM__ImagePNGExpandScanline(context, image, row, passWidth, yStart + y * yStep, xStart, xStep))
+            {
+                return PM_FALSE;
+            }
+
+            prev = row;
+            filteredData += rowSize + 1;
+        }
+    }
+
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PM_ImagePNGProbe(PM_Stream* stream, PM_ImageInfo* info)
+{
+    PM_Assert(stream != NULL);
+    PM_Assert(info != NULL);
+
+    PM_ImageInfoInit(info);
+
+    // Signature, length and type of the first chunk, and the 13 bytes of IHDR which must come first
+    static const PM_UInt8 pngMagic[] = { 0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A };
+    PM_UInt8 data[sizeof(pngMagic) + 8 + 13] = { 0 };
+
+    PM_StreamSetRequireReverse(stream, PM_FALSE);
+    PM_StreamSetCursorPosition(stream, 0);
+
+    if ( PM_StreamRead(stream, (PM_Byte*)data, sizeof(data)) != sizeof(data) )
+    {
+        PM_LogWarning("PM_ImagePNGProbe: Failed to read PNG header.");
+        return PM_FALSE;
+    }
+
+    if ( PM_Memcmp(data, pngMagic, sizeof(pngMagic)) != 0 || PM_Memcmp(data + 12, "IHDR", 4) != 0 )
+    {
+        PM_LogWarning("PM_ImagePNGProbe: Invalid PNG signature or missing IHDR chunk.");
+        return PM_FALSE;
+    }
+
+    const PM_UInt8* ihdr = data + 16;
+    PM_PNGHeader header;
+    header.width = ((PM_UInt32)ihdr[0] << 24) | ((PM_UInt32)ihdr[1] << 16) | ((PM_UInt32)ihdr[2] << 8) | (PM_UInt32)ihdr[3];
+    header.height = ((PM_UInt32)ihdr[4] << 24) | ((PM_UInt32)ihdr[5] << 16) | ((PM_UInt32)ihdr[6] << 8) | (PM_UInt32)ihdr[7];
+    header.bitDepth = ihdr[8];
+    header.colorType = ihdr[9];
+    header.compressionMethod = ihdr[10];
+    header.filterMethod = ihdr[11];
+    header.interlaceMethod = ihdr[12];
+
+    if (!PM_ImagePNGHeaderIsValid(&header))
+    {
+        PM_LogWarning("PM_ImagePNGProbe: Invalid PNG header.");
+        return PM_FALSE;
+    }
+
+    info->fileFormat = PICOMEDIA_IMAGE_FILE_FORMAT_PNG;
+    info->width = header.width;
+    info->height = header.height;
+    info->dataType = header.bitDepth == 16 ? PICOIMEDIA_IMAGE_DATA_TYPE_UINT16 : PICOIMEDIA_IMAGE_DATA_TYPE_UINT8;
+    info->bitsPerChannel = header.bitDepth == 16 ? 16 : 8;
+
+    switch (header.colorType)
+    {
+        case 0: info->channelFormat = PICOMEDIA_IMAGE_CHANNEL_FORMAT_GRAY; info->numChannels = 1; break;
+        case 2: info->channelFormat = PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGB; info->numChannels = 3; break;
+        case 3: info->channelFormat = PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGB; info->numChannels = 3; break;
+        case 4: info->channelFormat = PICOMEDIA_IMAGE_CHANNEL_FORMAT_GRAYA; info->numChannels = 2; break;
+        case 6: info->channelFormat = PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGBA; info->numChannels = 4; break;
+        default: break;
+    }
+
+    // A tRNS chunk adds an alpha channel to the types without one, size for it so the estimate stays an upper bound
+    PM_ImageInfo bound = *info;
+    if (header.colorType == 0 || header.colorType == 2 || header.colorType == 3)
+    {
+        bound.numChannels++;
+    }
+    info->decodedSize = PM_ImageInfoGetDataSize(&bound);
+
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
 PM_Bool PM_ImagePNGRead(PM_Stream* stream, PM_Image* image)
 {
-    (void)image;
+    PM_Assert(stream != NULL);
+    PM_Assert(image != NULL);
 
     PM_PNGContext pngContext = {0};
     PM_ImagePNGContextInit(&pngContext);
@@ -241,23 +773,55 @@ PM_Bool PM_ImagePNGRead(PM_Stream* stream, PM_Image* image)
             if(!PM__ImagePNGReadIHDR(&pngContext, chunkPayloadData, chunkSize) )
             {
                 PM_LogWarning("PM_ImagePNGRead: Failed to read IHDR chunk.");
+                PM_StreamRelease(stream);
                 PM_ImagePNGContextDestroy(&pngContext);
-                PM_Free(chunkData);
                 return PM_FALSE;
             }
         }
         else if ( PM_Memcmp(chunkData, "PLTE", 4) == 0 )
         {
-            PM_LogInfo("PLTE Chunk");
+            if(!PM__ImagePNGReadPLTE(&pngContext, chunkPayloadData, chunkSize) )
+            {
+                PM_LogWarning("PM_ImagePNGRead: Failed to read PLTE chunk.");
+                PM_StreamRelease(stream);
+                PM_ImagePNGContextDestroy(&pngContext);
+                return PM_FALSE;
+            }
+        }
+        else if ( PM_Memcmp(chunkData, "tRNS", 4) == 0 )
+        {
+            if(!PM__ImagePNGReadtRNS(&pngContext, chunkPayloadData, chunkSize) )
+            {
+                PM_LogWarning("PM_ImagePNGRead: Failed to read tRNS chunk.");
+                PM_StreamRelease(stream);
+                PM_ImagePNGContextDestroy(&pngContext);
+                return PM_FALSE;
+            }
         }
         else if ( PM_Memcmp(chunkData, "IDAT", 4) == 0 )
         {
-            PM_LogInfo("IDAT Chunk");
+            // The IDAT chunks form a single zlib stream, which is decompressed as the chunks come in
+            if ( pngContext.inflateContext == NULL && !PM__ImagePNGBeginImageData(&pngContext, image) )
+            {
+                PM_LogWarning("PM_ImagePNGRead: Failed to prepare image data.");
+                PM_StreamRelease(stream);
+                PM_ImagePNGContextDestroy(&pngContext);
+                return PM_FALSE;
+            }
+
+            if ( PM_InflateFeed(pngContext.inflateContext, chunkPayloadData, chunkSize) == PICOMEDIA_INFLATE_STATUS_ERROR )
+            {
+                PM_LogWarning("PM_ImagePNGRead: Failed to decompress IDAT chunk.");
+                PM_StreamRelease(stream);
+                PM_ImagePNGContextDestroy(&pngContext);
+                return PM_FALSE;
+            }
         }
         else if ( PM_Memcmp(chunkData, "IEND", 4) == 0 )
         {
             PM_LogInfo("IEND Chunk");
             endChunkEncountered = PM_TRUE;
+            PM_StreamRelease(stream);
             break;
         }
         else if (PM_Memcmp(chunkData, "iTXt", 4) == 0)
@@ -265,8 +829,8 @@ PM_Bool PM_ImagePNGRead(PM_Stream* stream, PM_Image* image)
             if(!PM__ImagePNGReadiTXt(&pngContext, chunkPayloadData, chunkSize))
             {
                 PM_LogWarning("PM_ImagePNGRead: Failed to read iTXt chunk.");
+                PM_StreamRelease(stream);
                 PM_ImagePNGContextDestroy(&pngContext);
-                PM_Free(chunkData);
                 return PM_FALSE;
             }
         }
@@ -279,11 +843,7 @@ PM_Bool PM_ImagePNGRead(PM_Stream* stream, PM_Image* image)
                 (PM_Char)(chunkData[3]));
         }
 
-        if (chunkData != NULL) {
-            PM_Free(chunkData);
-            chunkData = NULL;
-        }
-
+        PM_StreamRelease(stream);
     }
     
     if ( !endChunkEncountered )
@@ -295,12 +855,12 @@ PM_Bool PM_ImagePNGRead(PM_Stream* stream, PM_Image* image)
 
 
 
-    // if (!PM_ImageAllocate(image, image->width, image->height, image->channelFormat, image->dataType, image->numChannels))
-    // {
-    //     PM_LogWarning("PM_ImagePNGRead: Failed to allocate image.");
-    //     PM_ImagePNGContextDestroy(&pngContext);
-    //     return PM_FALSE;
-    // }
+    if ( !PM__ImagePNGFinishImageData(&pngContext, image) )
+    {
+        PM_LogWarning("PM_ImagePNGRead: Failed to decode image data.");
+        PM_ImagePNGContextDestroy(&pngContext);
+        return PM_FALSE;
+    }
 
     PM_ImagePNGContextDestroy(&pngContext);
 
@@ -315,7 +875,7 @@ PM_Bool PM_ImagePNGReadFromFile(const PM_Byte* filePath, PM_Image* image)
     PM_Assert(image != NULL);
     
     PM_Stream stream = {0};
-    if ( ! PM_StreamInitFromFile(&stream, filePath, PICOMEDIA_STREAM_FLAG_READ) ) 
+    if ( ! PM_StreamInitFromFileMapped(&stream, filePath) ) 
     {
         PM_LogWarning("Failed to initialize stream from file! \n");
         return PM_FALSE;
@@ -0,0 +1,468 @@
+#include "libpicomedia/image/ppm/ppm.h"
+
+#if defined(PM_ARCH_X86)
+    #include <immintrin.h>
+#elif defined(PM_ARCH_ARM64)
+    #include <arm_neon.h>
+#endif
+
+#define PM_PPM_ASCII_TOKEN_VALUE 0
+#define PM_PPM_ASCII_TOKEN_END   1
+#define PM_PPM_ASCII_TOKEN_ERROR 2
+
+// Two decimal digits for every number from 0 to 99
+static const PM_Char PM_PPM_DIGIT_PAIRS[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+// The text of every 8 bit value with the separating space, and its length (built on first use)
+static PM_Char PM_PPM_DECIMAL_U8[256][4];
+static PM_UInt8 PM_PPM_DECIMAL_U8_LENGTH[256];
+static volatile PM_Bool PM_PPM_DECIMAL_TABLES_READY = PM_FALSE;
+
+// Parses numbers from position until maxValues are parsed or the text runs out, updating position and valueCount
+typedef PM_Bool (*PM__ImagePPMParseASCIIFunction)(const PM_UInt8* text, PM_Size textSize, PM_Bool isLastBlock, PM_UInt16* values, PM_Size maxValues, PM_Size* position, PM_Size* valueCount);
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Bool PM__ImagePPMIsWhiteSpace(PM_UInt8 ch)
+{
+    // ' ', '\t', '\n', '\v', '\f', '\r'
+    return ch == ' ' || (ch >= '\t' && ch <= '\r');
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Skips the whitespace and comments in front of the next number and reads it
+static PM_UInt32 PM__ImagePPMScanASCIIToken(const PM_UInt8* text, PM_Size textSize, PM_Bool isLastBlock, PM_Size* position, PM_UInt32* value)
+{
+    PM_Size i = *position;
+
+    while (i < textSize)
+    {
+        if (text[i] == '#')
+        {
+            const PM_UInt8* lineEnd = (const PM_UInt8*)PM_Memchr(text + i, '\n', textSize - i);
+            if (lineEnd == NULL)
+            {
+                // The rest of the comment is in the next block
+                *position = isLastBlock ? textSize : i;
+                return PM_PPM_ASCII_TOKEN_END;
+            }
+            i = (PM_Size)(lineEnd - text) + 1;
+        }
+        else if (PM__ImagePPMIsWhiteSpace(text[i]))
+        {
+            i++;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    *position = i;
+
+    if (i == textSize)
+    {
+        return PM_PPM_ASCII_TOKEN_END;
+    }
+
+    if ((PM_UInt8)(text[i] - '0') > 9)
+    {
+        return PM_PPM_ASCII_TOKEN_ERROR;
+    }
+
+    PM_UInt32 number = 0;
+    while (i < textSize && (PM_UInt8)(text[i] - '0') <= 9)
+    {
+        number = number * 10 + (PM_UInt32)(text[i] - '0');
+        if (number > 65535)
+        {
+            return PM_PPM_ASCII_TOKEN_ERROR;
+        }
+        i++;
+    }
+
+    // The number might continue in the next block
+    if (i == textSize && !isLastBlock)
+    {
+        return PM_PPM_ASCII_TOKEN_END;
+    }
+
+    *position = i;
+    *value = number;
+    return PM_PPM_ASCII_TOKEN_VALUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Bool PM__ImagePPMParseASCIIScalar(const PM_UInt8* text, PM_Size textSize, PM_Bool isLastBlock, PM_UInt16* values, PM_Size maxValues, PM_Size* position, PM_Size* valueCount)
+{
+    PM_UInt32 value = 0;
+
+    while (*valueCount < maxValues)
+    {
+        PM_UInt32 status = PM__ImagePPMScanASCIIToken(text, textSize, isLastBlock, position, &value);
+        if (status == PM_PPM_ASCII_TOKEN_END)
+        {
+            break;
+        }
+        else if (status == PM_PPM_ASCII_TOKEN_ERROR)
+        {
+            return PM_FALSE;
+        }
+
+        values[(*valueCount)++] = (PM_UInt16)value;
+    }
+
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+#if defined(PM_ARCH_X86) || defined(PM_ARCH_ARM64)
+
+// Converts up to 8 decimal digits with a few multiplications instead of one step per digit,
+// text must have 8 readable bytes (only the first length of them are used)
+static PM_UInt32 PM__ImagePPMParseDigitsSWAR(const PM_UInt8* text, PM_Size length)
+{
+    PM_UInt64 digits = 0;
+    PM_Memcpy(&digits, text, sizeof(digits));
+
+    // The first digit is the lowest byte, shifting the unused bytes out leaves leading zeros in their place
+    digits -= 0x3030303030303030ULL;
+    digits <<= (8 - length) * 8;
+
+    digits = ((digits & 0x0F0F0F0F0F0F0F0FULL) * 2561) >> 8;
+    digits = ((digits & 0x00FF00FF00FF00FFULL) * 6553601) >> 16;
+    return (PM_UInt32)(((digits & 0x0000FFFF0000FFFFULL) * 42949672960001ULL) >> 32);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Parses the numbers of the 16 bytes at position from the masks of their digits and whitespace.
+// Returns PM_FALSE if the next number has to go through the scalar parser instead (comments,
+// invalid characters and numbers that do not fit are left to it for the error handling).
+// The text must have 24 readable bytes from position.
+static PM_Bool PM__ImagePPMParseASCIIMasks(const PM_UInt8* text, PM_UInt32 digitMask, PM_UInt32 spaceMask, PM_UInt16* values, PM_Size maxValues, PM_Size* position, PM_Size* valueCount)
+{
+    if ((digitMask | spaceMask) != 0xFFFF)
+    {
+        return PM_FALSE;
+    }
+
+    // Position is always at the start of a number or at whitespace, so a digit in the first lane starts a number
+    PM_UInt32 starts = digitMask & ~(digitMask << 1);
+    PM_UInt32 ends = digitMask & ~(digitMask >> 1);
+    PM_Size nextPosition = *position + 16;
+
+    // A number touching the end of the block might continue in the next one, it is parsed with the next block
+    if (digitMask & 0x8000)
+    {
+        PM_UInt32 lastStart = 31 - PM_CountLeadingZeros32(starts);
+        if (lastStart == 0)
+        {
+            return PM_FALSE;
+        }
+        starts &= (1u << lastStart) - 1;
+        nextPosition = *position + lastStart;
+    }
+
+    while (starts != 0)
+    {
+        PM_UInt32 start = PM_CountTrailingZeros32(starts);
+        PM_UInt32 end = PM_CountTrailingZeros32(ends & ~((1u << start) - 1));
+        PM_UInt32 length = end - start + 1;
+
+        if (length > 5)
+        {
+            *position += start;
+            return PM_FALSE;
+        }
+
+        PM_UInt32 value = PM__ImagePPMParseDigitsSWAR(text + *position + start, length);
+        if (value > 65535)
+        {
+            *position += start;
+            return PM_FALSE;
+        }
+
+        values[(*valueCount)++] = (PM_UInt16)value;
+        if (*valueCount == maxValues)
+        {
+            *position += end + 1;
+            return PM_TRUE;
+        }
+
+        starts &= starts - 1;
+    }
+
+    *position = nextPosition;
+    return PM_TRUE;
+}
+
+#endif
+
+// -----------------------------------------------------------------------------------------------
+
+#if defined(PM_ARCH_X86)
+
+static PM_TARGET("sse2") PM_Bool PM__ImagePPMParseASCIISSE2(const PM_UInt8* text, PM_Size textSize, PM_Bool isLastBlock, PM_UInt16* values, PM_Size maxValues, PM_Size* position, PM_Size* valueCount)
+{
+    const __m128i zeroCharacter = _mm_set1_epi8('0');
+    const __m128i tabCharacter = _mm_set1_epi8('\t');
+    const __m128i spaceCharacter = _mm_set1_epi8(' ');
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i four = _mm_set1_epi8(4);
+
+    while (*valueCount < maxValues && *position + 32 <= textSize)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(text + *position));
+
+        // Unsigned range checks: ch - '0' <= 9 for digits, ch - '\t' <= 4 for the control whitespace
+        __m128i digits = _mm_sub_epi8(chunk, zeroCharacter);
+        __m128i controls = _mm_sub_epi8(chunk, tabCharacter);
+        PM_UInt32 digitMask = (PM_UInt32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(digits, nine), digits));
+        PM_UInt32 spaceMask = (PM_UInt32)_mm_movemask_epi8(_mm_or_si128(
+            _mm_cmpeq_epi8(chunk, spaceCharacter),
+            _mm_cmpeq_epi8(_mm_min_epu8(controls, four), controls)
+        ));
+
+        if (!PM__ImagePPMParseASCIIMasks(text, digitMask, spaceMask, values, maxValues, position, valueCount))
+        {
+            PM_UInt32 value = 0;
+            PM_UInt32 status = PM__ImagePPMScanASCIIToken(text, textSize, isLastBlock, position, &value);
+            if (status == PM_PPM_ASCII_TOKEN_ERROR)
+            {
+                return PM_FALSE;
+            }
+            else if (status == PM_PPM_ASCII_TOKEN_END)
+            {
+                return PM_TRUE;
+            }
+            values[(*valueCount)++] = (PM_UInt16)value;
+        }
+    }
+
+    return PM__ImagePPMParseASCIIScalar(text, textSize, isLastBlock, values, maxValues, position, valueCount);
+}
+
+#elif defined(PM_ARCH_ARM64)
+
+static PM_UInt32 PM__ImagePPMMoveMaskNEON(uint8x16_t mask)
+{
+    static const PM_UInt8 PM_PPM_MASK_BITS[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+
+    uint8x16_t bits = vandq_u8(mask, vld1q_u8(PM_PPM_MASK_BITS));
+    return (PM_UInt32)vaddv_u8(vget_low_u8(bits)) | ((PM_UInt32)vaddv_u8(vget_high_u8(bits)) << 8);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Bool PM__ImagePPMParseASCIINEON(const PM_UInt8* text, PM_Size textSize, PM_Bool isLastBlock, PM_UInt16* values, PM_Size maxValues, PM_Size* position, PM_Size* valueCount)
+{
+    while (*valueCount < maxValues && *position + 32 <= textSize)
+    {
+        uint8x16_t chunk = vld1q_u8(text + *position);
+
+        // Unsigned range checks: ch - '0' <= 9 for digits, ch - '\t' <= 4 for the control whitespace
+        PM_UInt32 digitMask = PM__ImagePPMMoveMaskNEON(vcleq_u8(vsubq_u8(chunk, vdupq_n_u8('0')), vdupq_n_u8(9)));
+        PM_UInt32 spaceMask = PM__ImagePPMMoveMaskNEON(vorrq_u8(
+            vceqq_u8(chunk, vdupq_n_u8(' ')),
+            vcleq_u8(vsubq_u8(chunk, vdupq_n_u8('\t')), vdupq_n_u8(4))
+        ));
+
+        if (!PM__ImagePPMParseASCIIMasks(text, digitMask, spaceMask, values, maxValues, position, valueCount))
+        {
+            PM_UInt32 value = 0;
+            PM_UInt32 status = PM__ImagePPMScanASCIIToken(text, textSize, isLastBlock, position, &value);
+            if (status == PM_PPM_ASCII_TOKEN_ERROR)
+            {
+                return PM_FALSE;
+            }
+            else if (status == PM_PPM_ASCII_TOKEN_END)
+            {
+                return PM_TRUE;
+            }
+            values[(*valueCount)++] = (PM_UInt16)value;
+        }
+    }
+
+    return PM__ImagePPMParseASCIIScalar(text, textSize, isLastBlock, values, maxValues, position, valueCount);
+}
+
+#endif
+
+// -----------------------------------------------------------------------------------------------
+
+// Starts out with the scalar parser so it is always safe to use
+static PM__ImagePPMParseASCIIFunction PM_PPM_PARSE_ASCII_FUNCTION = PM__ImagePPMParseASCIIScalar;
+static volatile PM_Bool PM_PPM_ASCII_FUNCTIONS_SELECTED = PM_FALSE;
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImagePPMSelectASCIIFunctions()
+{
+#if defined(PM_ARCH_X86)
+    if (PM_CPUHasFeature(PICOMEDIA_CPU_FEATURE_SSE2))
+    {
+        PM_PPM_PARSE_ASCII_FUNCTION = PM__ImagePPMParseASCIISSE2;
+    }
+#elif defined(PM_ARCH_ARM64)
+    PM_PPM_PARSE_ASCII_FUNCTION = PM__ImagePPMParseASCIINEON;
+#endif
+
+    PM_PPM_ASCII_FUNCTIONS_SELECTED = PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PM_ImagePPMParseASCII(const PM_UInt8* text, PM_Size textSize, PM_Bool isLastBlock, PM_UInt16* values, PM_Size maxValues, PM_Size* bytesConsumed, PM_Size* valuesParsed)
+{
+    PM_Assert(text != NULL || textSize == 0);
+    PM_Assert(values != NULL || maxValues == 0);
+    PM_Assert(bytesConsumed != NULL);
+    PM_Assert(valuesParsed != NULL);
+
+    if (!PM_PPM_ASCII_FUNCTIONS_SELECTED)
+    {
+        PM__ImagePPMSelectASCIIFunctions();
+    }
+
+    *bytesConsumed = 0;
+    *valuesParsed = 0;
+
+    return PM_PPM_PARSE_ASCII_FUNCTION(text, textSize, isLastBlock, values, maxValues, bytesConsumed, valuesParsed);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PM_ImagePPMParseASCIIScalar(const PM_UInt8* text, PM_Size textSize, PM_Bool isLastBlock, PM_UInt16* values, PM_Size maxValues, PM_Size* bytesConsumed, PM_Size* valuesParsed)
+{
+    PM_Assert(text != NULL || textSize == 0);
+    PM_Assert(values != NULL || maxValues == 0);
+    PM_Assert(bytesConsumed != NULL);
+    PM_Assert(valuesParsed != NULL);
+
+    *bytesConsumed = 0;
+    *valuesParsed = 0;
+
+    return PM__ImagePPMParseASCIIScalar(text, textSize, isLastBlock, values, maxValues, bytesConsumed, valuesParsed);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImagePPMBuildDecimalTables()
+{
+    for (PM_UInt32 value = 0; value < 256; value++)
+    {
+        PM_Char* text = PM_PPM_DECIMAL_U8[value];
+        PM_UInt8 length = 0;
+
+        if (value >= 100)
+        {
+            text[length++] = (PM_Char)('0' + value / 100);
+        }
+        if (value >= 10)
+        {
+            text[length++] = PM_PPM_DIGIT_PAIRS[(value % 100) * 2];
+        }
+        text[length++] = (PM_Char)('0' + value % 10);
+        text[length++] = ' ';
+        PM_PPM_DECIMAL_U8_LENGTH[value] = length;
+
+        // Every entry is copied with a fixed size, the bytes past the length are overwritten by the next value
+        while (length < 4)
+        {
+            text[length++] = ' ';
+        }
+    }
+
+    PM_PPM_DECIMAL_TABLES_READY = PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Char* PM__ImagePPMFormatUInt16(PM_Char* text, PM_UInt32 value)
+{
+    if (value < 256)
+    {
+        PM_Memcpy(text, PM_PPM_DECIMAL_U8[value], 4);
+        return text + PM_PPM_DECIMAL_U8_LENGTH[value];
+    }
+
+    // Written back to front two digits at a time
+    PM_Char digits[8];
+    PM_Char* digitsEnd = digits + sizeof(digits);
+    PM_Char* first = digitsEnd;
+
+    while (value >= 100)
+    {
+        first -= 2;
+        PM_Memcpy(first, PM_PPM_DIGIT_PAIRS + (value % 100) * 2, 2);
+        value /= 100;
+    }
+
+    if (value >= 10)
+    {
+        first -= 2;
+        PM_Memcpy(first, PM_PPM_DIGIT_PAIRS + value * 2, 2);
+    }
+    else
+    {
+        *(--first) = (PM_Char)('0' + value);
+    }
+
+    PM_Size length = (PM_Size)(digitsEnd - first);
+    PM_Memcpy(text, first, length);
+    text[length] = ' ';
+
+    return text + length + 1;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Size PM_ImagePPMFormatASCII(const PM_Byte* values, PM_UInt32 dataType, PM_Size valueCount, PM_Char* text)
+{
+    PM_Assert(values != NULL || valueCount == 0);
+    PM_Assert(text != NULL);
+    PM_Assert(dataType == PICOIMEDIA_IMAGE_DATA_TYPE_UINT8 || dataType == PICOIMEDIA_IMAGE_DATA_TYPE_UINT16);
+
+    if (!PM_PPM_DECIMAL_TABLES_READY)
+    {
+        PM__ImagePPMBuildDecimalTables();
+    }
+
+    PM_Char* cursor = text;
+
+    if (dataType == PICOIMEDIA_IMAGE_DATA_TYPE_UINT8)
+    {
+        const PM_UInt8* samples = (const PM_UInt8*)values;
+        for (PM_Size i = 0; i < valueCount; i++)
+        {
+            PM_Memcpy(cursor, PM_PPM_DECIMAL_U8[samples[i]], 4);
+            cursor += PM_PPM_DECIMAL_U8_LENGTH[samples[i]];
+        }
+    }
+    else
+    {
+        const PM_UInt16* samples = (const PM_UInt16*)values;
+        for (PM_Size i = 0; i < valueCount; i++)
+        {
+            cursor = PM__ImagePPMFormatUInt16(cursor, samples[i]);
+        }
+    }
+
+    return (PM_Size)(cursor - text);
+}
+
+// -----------------------------------------------------------------------------------------------
@@ -1,5 +1,28 @@
 #include "libpicomedia/image/ppm/ppm.h"
 
+#define PM_PPM_ASCII_BLOCK_SIZE (64 * 1024)
+#define PM_PPM_ASCII_BATCH_SIZE 4096
+
+// Smallest number of pixels converted by a single task
+#define PM_PPM_MIN_BAND_PIXELS (1 << 15)
+
+#if defined(PM_ARCH_X86)
+    #include <immintrin.h>
+#elif defined(PM_ARCH_ARM64)
+    #include <arm_neon.h>
+#endif
+
+// Binary samples are at known offsets of the data, so bands of rows are converted independently
+typedef struct PM__ImagePPMBand
+{
+    const PM_UInt8* src;
+    PM_Byte* dst;
+    PM_Size rowSamples;
+    PM_UInt32 maxColorValue;
+    const PM_UInt8* scaleTable8;
+    const PM_UInt16* scaleTable16;
+} PM__ImagePPMBand;
+
 // -----------------------------------------------------------------------------------------------
 
 // Skips all whitespace and comments
@@ -39,6 +62,155 @@ static PM_Bool PM__ImagePPMSkipASCII(PM_Stream* stream)
 
 // -----------------------------------------------------------------------------------------------
 
+// Scale table from 8 bit samples with the given max value to the full 0-255 range (values above the max value are clamped)
+static void PM__ImagePPMBuildScaleTable8(PM_UInt8* scaleTable, PM_UInt32 maxColorValue)
+{
+    for (PM_UInt32 value = 0; value < 256; value++)
+    {
+        PM_UInt32 clamped = PM_Min(value, maxColorValue);
+        scaleTable[value] = (PM_UInt8)((clamped * 255 + maxColorValue / 2) / maxColorValue);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImagePPMScaleSamples8(PM_UInt8* dst, const PM_UInt8* src, PM_Size count, const PM_UInt8* scaleTable)
+{
+    for (PM_Size i = 0; i < count; i++)
+    {
+        dst[i] = scaleTable[src[i]];
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Scale table from 16 bit samples with the given max value to the full 0-65535 range, one division per possible value instead of one per sample
+static PM_UInt16* PM__ImagePPMCreateScaleTable16(PM_UInt32 maxColorValue)
+{
+    PM_UInt16* scaleTable = PM_NewN(PM_UInt16, (maxColorValue + 1));
+    if (scaleTable == NULL)
+    {
+        return NULL;
+    }
+
+    for (PM_UInt32 value = 0; value <= maxColorValue; value++)
+    {
+        scaleTable[value] = (PM_UInt16)((value * 65535 + maxColorValue / 2) / maxColorValue);
+    }
+
+    return scaleTable;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Scales 16 bit samples in place (values above the max value are clamped)
+static void PM__ImagePPMScaleSamples16(PM_UInt16* samples, PM_Size count, const PM_UInt16* scaleTable, PM_UInt32 maxColorValue)
+{
+    for (PM_Size i = 0; i < count; i++)
+    {
+        samples[i] = scaleTable[PM_Min((PM_UInt32)samples[i], maxColorValue)];
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImagePPMSwapSamples16Scalar(PM_UInt16* dst, const PM_UInt8* src, PM_Size count)
+{
+    for (PM_Size i = 0; i < count; i++)
+    {
+        dst[i] = (PM_UInt16)((src[i * 2] << 8) | src[i * 2 + 1]);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+#if defined(PM_ARCH_X86)
+
+static PM_TARGET("sse2") void PM__ImagePPMSwapSamples16SSE2(PM_UInt16* dst, const PM_UInt8* src, PM_Size count)
+{
+    PM_Size i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i samples = _mm_loadu_si128((const __m128i*)(src + i * 2));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(_mm_slli_epi16(samples, 8), _mm_srli_epi16(samples, 8)));
+    }
+
+    PM__ImagePPMSwapSamples16Scalar(dst + i, src + i * 2, count - i);
+}
+
+#elif defined(PM_ARCH_ARM64)
+
+static void PM__ImagePPMSwapSamples16NEON(PM_UInt16* dst, const PM_UInt8* src, PM_Size count)
+{
+    PM_Size i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        vst1q_u16(dst + i, vreinterpretq_u16_u8(vrev16q_u8(vld1q_u8(src + i * 2))));
+    }
+
+    PM__ImagePPMSwapSamples16Scalar(dst + i, src + i * 2, count - i);
+}
+
+#endif
+
+// -----------------------------------------------------------------------------------------------
+
+// Converts big endian 16 bit samples to the host byte order
+static void PM__ImagePPMLoadSamples16(PM_UInt16* dst, const PM_UInt8* src, PM_Size count)
+{
+    if (PM_IsBigEndian())
+    {
+        PM_Memcpy(dst, src, count * sizeof(PM_UInt16));
+        return;
+    }
+
+#if defined(PM_ARCH_X86)
+    if (PM_CPUHasFeature(PICOMEDIA_CPU_FEATURE_SSE2))
+    {
+        PM__ImagePPMSwapSamples16SSE2(dst, src, count);
+        return;
+    }
+#elif defined(PM_ARCH_ARM64)
+    PM__ImagePPMSwapSamples16NEON(dst, src, count);
+    return;
+#endif
+
+    PM__ImagePPMSwapSamples16Scalar(dst, src, count);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__ImagePPMBandWorker(PM_Size begin, PM_Size end, void* data)
+{
+    const PM__ImagePPMBand* band = (const PM__ImagePPMBand*)data;
+    PM_Size first = begin * band->rowSamples;
+    PM_Size count = (end - begin) * band->rowSamples;
+
+    if (band->maxColorValue <= 255)
+    {
+        if (band->maxColorValue == 255)
+        {
+            PM_Memcpy((PM_UInt8*)band->dst + first, band->src + first, count);
+        }
+        else
+        {
+            PM__ImagePPMScaleSamples8((PM_UInt8*)band->dst + first, band->src + first, count, band->scaleTable8);
+        }
+        return;
+    }
+
+    // 16 bit samples are stored big endian
+    PM_UInt16* samples = (PM_UInt16*)band->dst + first;
+    PM__ImagePPMLoadSamples16(samples, band->src + first * 2, count);
+
+    if (band->scaleTable16 != NULL)
+    {
+        PM__ImagePPMScaleSamples16(samples, count, band->scaleTable16, band->maxColorValue);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
 static PM_Bool PM__ImagePPMReadHeader(PM_Stream* stream, PM_Image* image, PM_UInt8 magicNumber, PM_UInt32* maxColorValue)
 {
     if ( (PM_StreamReadInt8(stream) != 'P') || (PM_StreamReadInt8(stream) != magicNumber) )
@@ -51,21 +223,33 @@ static PM_Bool PM__ImagePPMReadHeader(PM_Stream* stream, PM_Image* image, PM_UIn
     PM__ImagePPMSkipASCII(stream); 
 
     // Read the width
-    image->width = (PM_UInt32)PM_ReadASCIIIntegerFromStream(stream);
+    PM_Int64 width = PM_ReadASCIIIntegerFromStream(stream);
 
     // Skip the whitespace and comments
     PM__ImagePPMSkipASCII(stream);
 
     // Read the height
-    image->height = (PM_UInt32)PM_ReadASCIIIntegerFromStream(stream);
+    PM_Int64 height = PM_ReadASCIIIntegerFromStream(stream);
+
+    if ( width <= 0 || width > UINT32_MAX || height <= 0 || height > UINT32_MAX )
+    {
+        PM_LogWarning("Invalid PPM image dimensions(%lld x %lld)! \n", (long long)width, (long long)height);
+        return PM_FALSE;
+    }
+    image->width = (PM_UInt32)width;
+    image->height = (PM_UInt32)height;
 
     // Skip the whitespace and comments
     PM__ImagePPMSkipASCII(stream);
     
     // Read max color value
-    *maxColorValue = (PM_UInt32)PM_ReadASCIIIntegerFromStream(stream);
-    *maxColorValue = PM_Max(*maxColorValue, 0);
-    *maxColorValue = PM_Min(*maxColorValue, 65536);
+    PM_Int64 maxValue = PM_ReadASCIIIntegerFromStream(stream);
+    if ( maxValue <= 0 || maxValue > 65535 )
+    {
+        PM_LogWarning("Invalid PPM max color value(%lld)! \n", (long long)maxValue);
+        return PM_FALSE;
+    }
+    *maxColorValue = (PM_UInt32)maxValue;
 
     // PPM only supports 8-bit and 16-bit color values
     if ( *maxColorValue > 255 )
@@ -81,8 +265,69 @@ static PM_Bool PM__ImagePPMReadHeader(PM_Stream* stream, PM_Image* image, PM_UIn
     image->channelFormat = PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGB;
     image->numChannels = 3;
 
-    // Skip the whitespace
-    PM__ImagePPMSkipASCII(stream);
+    // Reading the max color value consumed the single whitespace character that ends the header,
+    // the binary P6 data can start with bytes that look like whitespace so nothing more is skipped
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// The dimensions come from the file, so the decoded size is checked before anything is allocated for it
+static PM_Bool PM__ImagePPMCheckDataSize(const PM_Image* image, PM_Size* dataSize)
+{
+    PM_ImageInfo info;
+    PM_ImageInfoInit(&info);
+    info.width = image->width;
+    info.height = image->height;
+    info.numChannels = image->numChannels;
+    info.dataType = image->dataType;
+    *dataSize = PM_ImageInfoGetDataSize(&info);
+    if ( *dataSize == SIZE_MAX || *dataSize > PICOMEDIA_IMAGE_MAX_DATA_SIZE )
+    {
+        PM_LogWarning("Image is too large(%u x %u)! \n", image->width, image->height);
+        return PM_FALSE;
+    }
+
+    return PM_TRUE;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+PM_Bool PM_ImagePPMProbe(PM_Stream* stream, PM_ImageInfo* info)
+{
+    PM_Assert(stream != NULL);
+    PM_Assert(info != NULL);
+
+    PM_ImageInfoInit(info);
+
+    PM_StreamSetCursorPosition(stream, 0);
+    PM_UInt32 ppmType = PM_ImagePPMDetect(stream);
+    if (ppmType == PICOMEDIA_PPM_FORMAT_UNKNOWN)
+    {
+        PM_LogWarning("Failed to detect PPM type! \n");
+        return PM_FALSE;
+    }
+
+    // The header parser only fills the properties of the image, no data is allocated
+    PM_Image image;
+    PM_ImageInit(&image);
+    PM_UInt32 maxColorValue = 0;
+
+    PM_StreamSetCursorPosition(stream, 0);
+    if ( ! PM__ImagePPMReadHeader(stream, &image, ppmType == PICOMEDIA_PPM_FORMAT_P3 ? '3' : '6', &maxColorValue) )
+    {
+        PM_LogWarning("Failed to read PPM header! \n");
+        return PM_FALSE;
+    }
+
+    info->fileFormat = PICOMEDIA_IMAGE_FILE_FORMAT_PPM;
+    info->width = image.width;
+    info->height = image.height;
+    info->channelFormat = image.channelFormat;
+    info->dataType = image.dataType;
+    info->numChannels = image.numChannels;
+    info->bitsPerChannel = (PM_UInt8)(PM_ImageGetDataTypeSize(image.dataType) * 8);
+    info->decodedSize = PM_ImageInfoGetDataSize(info);
 
     return PM_TRUE;
 }
@@ -100,59 +345,73 @@ PM_Bool PM_ImagePPMReadP6(PM_Stream* stream, PM_Image* image)
 
     if ( ! PM__ImagePPMReadHeader(stream, image, '6', &maxColorValue) )
     {
-        PM_LogError("Failed to read PPM header! \n");
+        PM_LogWarning("Failed to read PPM header! \n");
+        return PM_FALSE;
+    }
+
+    PM_Size dataSize = 0;
+    if ( ! PM__ImagePPMCheckDataSize(image, &dataSize) )
+    {
+        return PM_FALSE;
+    }
+
+    // The binary data has a known size, so a truncated file is rejected before the image is allocated
+    PM_Size headerSize = PM_StreamGetCursorPosition(stream);
+    if ( headerSize > PM_StreamGetSourceSize(stream) || PM_StreamGetSourceSize(stream) - headerSize < dataSize )
+    {
+        PM_LogWarning("PPM image data is truncated! \n");
         return PM_FALSE;
     }
 
     // Allocate memory for the image
     if (! PM_ImageAllocate(image, image->width, image->height, image->channelFormat, image->dataType, 3))
     {
-        PM_LogError("Failed to allocate memory for the image! \n");
+        PM_LogWarning("Failed to allocate memory for the image! \n");
         return PM_FALSE;
     }
 
-    // Read the image data
-    PM_Size bytesPerChannel = image->bitsPerChannel / 8;
-    PM_Size bytesPerPixel = bytesPerChannel * image->numChannels;
-    PM_Size rowSize = image->width * bytesPerPixel;
-    PM_Size pixelOffset = 0;
-
-    PM_Byte* rowData = (PM_Byte*)PM_Malloc(rowSize);
-    if (rowData == NULL)
+    // The samples are converted straight from the stream's bytes, without an intermediate copy
+    PM_Byte* pixelData = NULL;
+    if (PM_StreamAcquire(stream, dataSize, &pixelData) != dataSize)
     {
-        PM_LogError("Failed to allocate memory for the image row data! \n");
+        PM_LogWarning("Failed to read image data! \n");
+        PM_StreamRelease(stream);
+        PM_ImageDestroy(image);
         return PM_FALSE;
     }
 
-    // print the header info
+    PM_UInt8 scaleTable8[256];
+    PM__ImagePPMBand band;
+    band.src = (const PM_UInt8*)pixelData;
+    band.dst = image->data;
+    band.rowSamples = (PM_Size)image->width * image->numChannels;
+    band.maxColorValue = maxColorValue;
+    band.scaleTable8 = scaleTable8;
+    band.scaleTable16 = NULL;
 
-    for (PM_UInt32 y = 0; y < image->height; y++)
+    if (image->dataType == PICOIMEDIA_IMAGE_DATA_TYPE_UINT8)
+    {
+        PM__ImagePPMBuildScaleTable8(scaleTable8, maxColorValue);
+    }
+    else if (maxColorValue != 65535)
     {
-        if (PM_StreamRead(stream, rowData, rowSize) != rowSize)
+        band.scaleTable16 = PM__ImagePPMCreateScaleTable16(maxColorValue);
+        if (band.scaleTable16 == NULL)
         {
-            PM_LogError("Failed to read image data! \n");
-            PM_Free(rowData);
+            PM_LogWarning("Failed to allocate memory for the sample scale table! \n");
+            PM_StreamRelease(stream);
+            PM_ImageDestroy(image);
             return PM_FALSE;
         }
-
-        for (PM_UInt32 x = 0 ; x < image->width ; x++)
-        {
-            pixelOffset = (y * image->width + x) * bytesPerPixel;
-            if (image->dataType == PICOIMEDIA_IMAGE_DATA_TYPE_UINT8)
-            {
-                *((PM_UInt8*)(image->data + pixelOffset + 0 * bytesPerChannel)) = (PM_UInt8)( ((PM_Float64)rowData[x * bytesPerPixel + 0] / (PM_Float64)maxColorValue) * 255.0);
-                *((PM_UInt8*)(image->data + pixelOffset + 1 * bytesPerChannel)) = (PM_UInt8)( ((PM_Float64)rowData[x * bytesPerPixel + 1] / (PM_Float64)maxColorValue) * 255.0);
-                *((PM_UInt8*)(image->data + pixelOffset + 2 * bytesPerChannel)) = (PM_UInt8)( ((PM_Float64)rowData[x * bytesPerPixel + 2] / (PM_Float64)maxColorValue) * 255.0);
-            }
-            else if (image->dataType == PICOIMEDIA_IMAGE_DATA_TYPE_UINT16)
-            {
-                *((PM_UInt16*)(image->data + pixelOffset + 0 * bytesPerChannel)) = (PM_UInt16)(((PM_Float64)rowData[x * bytesPerPixel + 0] / (PM_Float64)maxColorValue) * 65535.0);
-                *((PM_UInt16*)(image->data + pixelOffset + 1 * bytesPerChannel)) = (PM_UInt16)(((PM_Float64)rowData[x * bytesPerPixel + 1] / (PM_Float64)maxColorValue) * 65535.0);
-                *((PM_UInt16*)(image->data + pixelOffset + 2 * bytesPerChannel)) = (PM_UInt16)(((PM_Float64)rowData[x * bytesPerPixel + 2] / (PM_Float64)maxColorValue) * 65535.0);
-            }
-        }
     }
 
+    // The samples are converted by bands of rows straight from the borrowed data, the stream is not touched meanwhile
+    PM_Size grain = PM_Max(PM_PPM_MIN_BAND_PIXELS / PM_Max((PM_Size)image->width, (PM_Size)1), (PM_Size)1);
+    PM_ParallelFor(NULL, 0, image->height, grain, PM__ImagePPMBandWorker, &band);
+
+    PM_Free((PM_UInt16*)band.scaleTable16);
+    PM_StreamRelease(stream);
+
     return PM_TRUE;
 }
 
@@ -169,61 +428,129 @@ PM_Bool PM_ImagePPMReadP3(PM_Stream* stream, PM_Image* image)
 
     if ( ! PM__ImagePPMReadHeader(stream, image, '3', &maxColorValue) )
     {
-        PM_LogError("Failed to read PPM header! \n");
+        PM_LogWarning("Failed to read PPM header! \n");
+        return PM_FALSE;
+    }
+
+    PM_Size dataSize = 0;
+    if ( ! PM__ImagePPMCheckDataSize(image, &dataSize) )
+    {
         return PM_FALSE;
     }
 
     // Allocate memory for the image
     if (! PM_ImageAllocate(image, image->width, image->height, image->channelFormat, image->dataType, 3))
     {
-        PM_LogError("Failed to allocate memory for the image! \n");
+        PM_LogWarning("Failed to allocate memory for the image! \n");
+        return PM_FALSE;
+    }
+
+    // Read the image, the text is parsed in large blocks and numbers cut off at the end of a block are
+    // moved to the front of the buffer to be parsed with the next one
+    PM_Size valueCount = (PM_Size)image->width * image->height * image->numChannels;
+    PM_Size valuesRead = 0;
+    PM_Size textSize = 0;
+    PM_Size textCapacity = PM_PPM_ASCII_BLOCK_SIZE;
+    PM_UInt8* text = (PM_UInt8*)PM_Malloc(textCapacity);
+    PM_UInt16 values[PM_PPM_ASCII_BATCH_SIZE];
+
+    if (text == NULL)
+    {
+        PM_LogWarning("Failed to allocate memory for the image text! \n");
+        PM_ImageDestroy(image);
         return PM_FALSE;
     }
 
-    // Read the image
-    PM_Size bytesPerChannel = image->bitsPerChannel / 8;
-    PM_Size bytesPerPixel = bytesPerChannel * image->numChannels;
-    PM_Byte* data = (PM_Byte*)image->data;
+    PM_StreamSetRequireReverse(stream, PM_FALSE);
 
-    for (PM_UInt32 y = 0; y < image->height; y++)
+    while (valuesRead < valueCount)
     {
-        for (PM_UInt32 x = 0 ; x < image->width ; x++)
+        // A comment longer than the buffer is the only thing that can fill it without being consumed
+        if (textSize == textCapacity)
         {
-            for (PM_UInt32 c = 0; c < image->numChannels; c++)
+            PM_UInt8* grownText = (PM_UInt8*)PM_Realloc(text, textCapacity * 2);
+            if (grownText == NULL)
             {
-                PM_Size offset = image->width * y * bytesPerPixel + x * bytesPerPixel + c * bytesPerChannel;
+                PM_LogWarning("Failed to allocate memory for the image text! \n");
+                PM_Free(text);
+                PM_ImageDestroy(image);
+                return PM_FALSE;
+            }
+            text = grownText;
+            textCapacity *= 2;
+        }
 
-                if (!PM__ImagePPMSkipASCII(stream))
-                {
-                    PM_LogError("Failed to read the image data! \n");
-                    return PM_FALSE;
-                }
+        textSize += PM_StreamRead(stream, (PM_Byte*)text + textSize, textCapacity - textSize);
+        PM_Bool isLastBlock = PM_StreamGetCursorPosition(stream) >= PM_StreamGetSourceSize(stream);
+        PM_Size textOffset = 0;
 
-                PM_Int64 value = PM_ReadASCIIIntegerFromStream(stream);
+        while (valuesRead < valueCount)
+        {
+            // 16 bit values are parsed straight into the image
+            PM_UInt16* target = values;
+            PM_Size maxValues = PM_Min(valueCount - valuesRead, (PM_Size)PM_PPM_ASCII_BATCH_SIZE);
+            if (image->dataType == PICOIMEDIA_IMAGE_DATA_TYPE_UINT16)
+            {
+                target = (PM_UInt16*)image->data + valuesRead;
+                maxValues = valueCount - valuesRead;
+            }
 
-                if (value > maxColorValue)
-                {
-                    PM_LogError("Invalid color value! \n");
-                    return PM_FALSE;
-                }
+            PM_Size bytesConsumed = 0;
+            PM_Size valuesParsed = 0;
+            if (!PM_ImagePPMParseASCII(text + textOffset, textSize - textOffset, isLastBlock, target, maxValues, &bytesConsumed, &valuesParsed))
+            {
+                PM_LogWarning("Failed to parse the image data! \n");
+                PM_Free(text);
+                PM_ImageDestroy(image);
+                return PM_FALSE;
+            }
 
-                if (image->dataType == PICOIMEDIA_IMAGE_DATA_TYPE_UINT8)
-                {
-                    *((PM_UInt8*)data + offset) = (PM_UInt8)value;
-                }
-                else if (image->dataType == PICOIMEDIA_IMAGE_DATA_TYPE_UINT16)
-                {
-                    *((PM_UInt16*)data + offset) = (PM_UInt16)value;
-                }
-                else 
+            PM_Bool isValid = PM_TRUE;
+            for (PM_Size i = 0; i < valuesParsed && isValid; i++)
+            {
+                isValid = target[i] <= maxColorValue;
+            }
+
+            if (!isValid)
+            {
+                PM_LogWarning("Invalid color value! \n");
+                PM_Free(text);
+                PM_ImageDestroy(image);
+                return PM_FALSE;
+            }
+
+            if (image->dataType == PICOIMEDIA_IMAGE_DATA_TYPE_UINT8)
+            {
+                PM_UInt8* data = (PM_UInt8*)image->data + valuesRead;
+                for (PM_Size i = 0; i < valuesParsed; i++)
                 {
-                    PM_LogError("Unsupported data type! \n");
-                    return PM_FALSE;
+                    data[i] = (PM_UInt8)values[i];
                 }
             }
+
+            textOffset += bytesConsumed;
+            valuesRead += valuesParsed;
+
+            if (valuesParsed < maxValues)
+            {
+                break;
+            }
         }
+
+        if (valuesRead < valueCount && isLastBlock)
+        {
+            PM_LogWarning("Failed to read the image data! \n");
+            PM_Free(text);
+            PM_ImageDestroy(image);
+            return PM_FALSE;
+        }
+
+        textSize -= textOffset;
+        PM_Memmove(text, text + textOffset, textSize);
     }
 
+    PM_Free(text);
+
     return PM_TRUE;
 }
 
@@ -281,9 +608,9 @@ PM_Bool PM_ImagePPMReadFromFile(const PM_Byte* filePath, PM_Image* image)
     PM_Assert(image != NULL);
     
     PM_Stream stream = {0};
-    if ( ! PM_StreamInitFromFile(&stream, filePath, PICOMEDIA_STREAM_FLAG_READ) ) 
+    if ( ! PM_StreamInitFromFileMapped(&stream, filePath) ) 
     {
-        PM_LogError("Failed to initialize stream from file! \n");
+        PM_LogWarning("Failed to initialize stream from file! \n");
         return PM_FALSE;
     }
 
@@ -1,5 +1,7 @@
 #include "libpicomedia/image/ppm/ppm.h"
 
+#define PM_PPM_WRITE_BLOCK_SIZE (64 * 1024)
+
 // -----------------------------------------------------------------------------------------------
 
 PM_Bool PM__ImagePPMWriteHeader(PM_Stream* stream, const PM_Image* image, PM_UInt32 ppmFormat)
@@ -88,13 +90,47 @@ PM_Bool PM_ImagePPMWriteP6(const PM_Image* image, PM_Stream* stream)
         PM_LogError("Failed to write PPM header! \n");
         return PM_FALSE;
     }
-    
-    if (! PM_StreamWrite(stream, image->data, image->dataSize) )
+
+    if (image->dataType == PICOIMEDIA_IMAGE_DATA_TYPE_UINT8 || PM_IsBigEndian())
+    {
+        if (! PM_StreamWrite(stream, image->data, image->dataSize) )
+        {
+            PM_LogWarning("Failed to write PPM data! \n");
+            return PM_FALSE;
+        }
+
+        return PM_TRUE;
+    }
+
+    // 16 bit samples are stored big endian, so they are swapped a block at a time on little endian hosts
+    PM_UInt8* block = (PM_UInt8*)PM_Malloc(PM_PPM_WRITE_BLOCK_SIZE);
+    if (block == NULL)
     {
-        PM_LogError("Failed to write PPM data! \n");
+        PM_LogWarning("Failed to allocate memory for the image data! \n");
         return PM_FALSE;
     }
 
+    const PM_UInt16* samples = (const PM_UInt16*)image->data;
+    PM_Size sampleCount = image->dataSize / sizeof(PM_UInt16);
+    for (PM_Size i = 0; i < sampleCount; i += PM_PPM_WRITE_BLOCK_SIZE / 2)
+    {
+        PM_Size blockSamples = PM_Min(sampleCount - i, (PM_Size)PM_PPM_WRITE_BLOCK_SIZE / 2);
+        for (PM_Size j = 0; j < blockSamples; j++)
+        {
+            block[j * 2 + 0] = (PM_UInt8)(samples[i + j] >> 8);
+            block[j * 2 + 1] = (PM_UInt8)(samples[i + j] & 0xFF);
+        }
+
+        if (PM_StreamWrite(stream, (const PM_Byte*)block, blockSamples * 2) != blockSamples * 2)
+        {
+            PM_LogWarning("Failed to write PPM data! \n");
+            PM_Free(block);
+            return PM_FALSE;
+        }
+    }
+
+    PM_Free(block);
+
     return PM_TRUE;
 }
 
@@ -118,37 +154,41 @@ PM_Bool PM_ImagePPMWriteP3(const PM_Image* image, PM_Stream* stream)
         return PM_FALSE;
     }
 
-    PM_Size bytesPerPixel  = (image->bitsPerChannel / 8) * image->numChannels;
+    // Whole rows are formatted into a buffer and written out a block of rows at a time
+    PM_Size valuesPerRow = (PM_Size)image->width * image->numChannels;
+    PM_Size bytesPerValue = (image->dataType == PICOIMEDIA_IMAGE_DATA_TYPE_UINT8) ? sizeof(PM_UInt8) : sizeof(PM_UInt16);
+    PM_Size maxRowTextSize = valuesPerRow * PICOMEDIA_PPM_ASCII_MAX_VALUE_SIZE + 1;
+    PM_Size rowsPerBlock = PM_Max(PM_PPM_WRITE_BLOCK_SIZE / maxRowTextSize, (PM_Size)1);
+
+    PM_Char* text = (PM_Char*)PM_Malloc(rowsPerBlock * maxRowTextSize);
+    if (text == NULL)
+    {
+        PM_LogWarning("Failed to allocate memory for the image text! \n");
+        return PM_FALSE;
+    }
 
-    PM_Char pixelValueBuffer[128];
-    for (PM_UInt32 i = 0; i < image->height; i++)
+    for (PM_UInt32 i = 0; i < image->height; i += (PM_UInt32)rowsPerBlock)
     {
-        for (PM_UInt32 j = 0; j < image->width; j++)
+        PM_UInt32 blockRows = (PM_UInt32)PM_Min((PM_Size)(image->height - i), rowsPerBlock);
+        PM_Size textSize = 0;
+
+        for (PM_UInt32 j = 0; j < blockRows; j++)
         {
-            PM_Size pixelIndex = (i * image->width) + j;
-            PM_Size pixelOffset = pixelIndex * bytesPerPixel;
-
-            if (image->dataType == PICOIMEDIA_IMAGE_DATA_TYPE_UINT8)
-            {
-                PM_UInt8* pixel = (PM_UInt8*)&image->data[pixelOffset];
-                sprintf(pixelValueBuffer, "%d %d %d ", pixel[0], pixel[1], pixel[2]);
-            }
-            else if (image->dataType == PICOIMEDIA_IMAGE_DATA_TYPE_UINT16)
-            {
-                PM_UInt16* pixel = (PM_UInt16*)&image->data[pixelOffset];
-                sprintf(pixelValueBuffer, "%d %d %d ", pixel[0], pixel[1], pixel[2]);
-            }
-            else
-            {
-                PM_LogError("Invalid PPM format! \n");
-                return PM_FALSE;
-            }
-
-            PM_StreamWrite(stream, pixelValueBuffer, strlen(pixelValueBuffer));
+            const PM_Byte* row = image->data + (PM_Size)(i + j) * valuesPerRow * bytesPerValue;
+            textSize += PM_ImagePPMFormatASCII(row, image->dataType, valuesPerRow, text + textSize);
+            text[textSize++] = '\n';
+        }
+
+        if (PM_StreamWrite(stream, text, textSize) != textSize)
+        {
+            PM_LogWarning("Failed to write PPM data! \n");
+            PM_Free(text);
+            return PM_FALSE;
         }
-        PM_StreamWriteInt8(stream, '\n');
     }
 
+    PM_Free(text);
+
     return PM_TRUE;
 }
 
@@ -0,0 +1,131 @@
+#include "libpicomedia/libpicomedia.h"
+#include "test_utils.h"
+
+#define TEST_BUFFER_SIZE    (4 * 1024 * 1024 + 77)
+
+static const PM_UInt8* PM__TestString(const PM_Char* string)
+{
+    return (const PM_UInt8*)string;
+}
+
+static void PM__TestChecksumsKnownValues()
+{
+    const PM_UInt8* check = PM__TestString("123456789");
+
+    PM_TestCheck(PM_CRC32Bitwise(check, 9, 0) == 0xCBF43926);
+    PM_TestCheck(PM_CRC32(check, 9, 0) == 0xCBF43926);
+    PM_TestCheck(PM_CRC32(check, 0, 0) == 0);
+    PM_TestCheck(PM_CRC32CFourByte(check, 9, 0) == 0xE3069283);
+    PM_TestCheck(PM_CRC32C(check, 9, 0) == 0xE3069283);
+    PM_TestCheck(PM_Adler32(PM__TestString("Wikipedia"), 9, 1) == 0x11E60398);
+    PM_TestCheck(PM_Adler32(check, 0, 1) == 1);
+    PM_TestCheck(PM_XXHash64(check, 0, 0) == 0xEF46DB3751D8E999ull);
+    PM_TestCheck(PM_XXHash64(PM__TestString("abc"), 3, 0) == 0x44BC2CF5AD770999ull);
+    PM_TestCheck(PM_XXHash64(PM__TestString("Nobody inspects the spammish repetition"), 39, 0) == 0xFBCEA83C8A378BF1ull);
+}
+
+// The dispatched functions must match the table ones for every length and alignment, so the vector bodies and
+// their scalar heads and tails are all covered
+static void PM__TestChecksumsScalarEquivalence(const PM_UInt8* buffer, PM_Size iterations)
+{
+    for (PM_Size iteration = 0; iteration < iterations; iteration++)
+    {
+        PM_Size offset = PM_TestRandomRange(64);
+        PM_Size size = (iteration < 300) ? iteration : PM_TestRandomRange(PM_TestRandomRange(8) == 0 ? 256 * 1024 : 4096);
+        const PM_UInt8* data = buffer + offset;
+        PM_UInt32 previous = (PM_UInt32)PM_TestRandom();
+
+        PM_UInt32 crc32 = PM_CRC32OneByte(data, size, previous);
+        PM_TestCheck(PM_CRC32(data, size, previous) == crc32);
+        PM_TestCheck(PM_CRC32FourByte(data, size, previous) == crc32);
+        PM_TestCheck(PM_CRC32SixteenByte(data, size, previous) == crc32);
+        if (size <= 4096)
+        {
+            PM_TestCheck(PM_CRC32Bitwise(data, size, previous) == crc32);
+            PM_TestCheck(PM_CRC32HalfByte(data, size, previous) == crc32);
+        }
+
+        PM_TestCheck(PM_CRC32C(data, size, previous) == PM_CRC32CFourByte(data, size, previous));
+
+        // any valid Adler-32 state, both sums below 65521
+        PM_UInt32 previousAdler32 = (PM_UInt32)(PM_TestRandomRange(65521) << 16 | PM_TestRandomRange(65521));
+        PM_TestCheck(PM_Adler32(data, size, previousAdler32) == PM_Adler32Scalar(data, size, previousAdler32));
+    }
+
+    // all ones is the worst case for the deferred modulo of the vector Adler-32 sums
+    PM_UInt8* ones = (PM_UInt8*)PM_Malloc(1024 * 1024);
+    PM_Memset(ones, 0xFF, 1024 * 1024);
+    PM_TestCheck(PM_Adler32(ones, 1024 * 1024, 1) == PM_Adler32Scalar(ones, 1024 * 1024, 1));
+    PM_TestCheck(PM_Adler32(ones, 1024 * 1024, 0xFFF0FFF0) == PM_Adler32Scalar(ones, 1024 * 1024, 0xFFF0FFF0));
+    PM_Free(ones);
+}
+
+static void PM__TestChecksumsChaining(const PM_UInt8* buffer, PM_Size iterations)
+{
+    for (PM_Size iteration = 0; iteration < iterations; iteration++)
+    {
+        PM_Size size = PM_TestRandomRange(100000);
+        PM_Size split = PM_TestRandomRange(size + 1);
+        PM_Size tail = size - split;
+
+        PM_UInt32 crc32 = PM_CRC32(buffer, size, 0);
+        PM_UInt32 crc32Head = PM_CRC32(buffer, split, 0);
+        PM_UInt32 crc32Tail = PM_CRC32(buffer + split, tail, 0);
+        PM_TestCheck(PM_CRC32(buffer + split, tail, crc32Head) == crc32);
+        PM_TestCheck(PM_CRC32Combine(crc32Head, crc32Tail, tail) == crc32);
+
+        PM_TestCheck(PM_CRC32C(buffer + split, tail, PM_CRC32C(buffer, split, 0)) == PM_CRC32C(buffer, size, 0));
+        PM_TestCheck(PM_Adler32(buffer + split, tail, PM_Adler32(buffer, split, 1)) == PM_Adler32(buffer, size, 1));
+    }
+
+    // xxHash does not chain, but the result must not depend on the alignment of the data
+    for (PM_Size iteration = 0; iteration < iterations; iteration++)
+    {
+        PM_Size size = PM_TestRandomRange(1000);
+        PM_Size offset = 1 + PM_TestRandomRange(63);
+        PM_UInt8* copy = (PM_UInt8*)PM_Malloc(size + 64);
+        PM_Memcpy(copy + offset, buffer, size);
+        PM_TestCheck(PM_XXHash64(copy + offset, size, iteration) == PM_XXHash64(buffer, size, iteration));
+        PM_Free(copy);
+    }
+}
+
+static void PM__TestChecksumsParallel(const PM_UInt8* buffer)
+{
+    PM_ThreadPool* pool = PM_ThreadPoolCreate(3);
+    PM_TestCheck(pool != NULL);
+
+    PM_Size sizes[5] = { 0, 1000, 64 * 1024 + 3, 1024 * 1024 + 1, TEST_BUFFER_SIZE - 64 };
+    for (PM_Size i = 0; i < 5; i++)
+    {
+        PM_UInt32 expected = PM_CRC32(buffer + i, sizes[i], 0x12345678);
+        PM_TestCheck(PM_CRC32Parallel(buffer + i, sizes[i], 0x12345678, NULL) == expected);
+        PM_TestCheck(PM_CRC32Parallel(buffer + i, sizes[i], 0x12345678, pool) == expected);
+    }
+
+    PM_ThreadPoolDestroy(pool);
+}
+
+int main(int argc, char** argv, char** envp)
+{
+    PM_LogInfo("Starting test for Common/Checksums");
+    PM_TestRandomSeed(10);
+
+    PM_UInt8* buffer = (PM_UInt8*)PM_Malloc(TEST_BUFFER_SIZE);
+    PM_TestRandomFill(buffer, TEST_BUFFER_SIZE);
+
+    PM_LogInfo("Testing Common/Checksums known values");
+    PM__TestChecksumsKnownValues();
+
+    PM_LogInfo("Testing Common/Checksums/PM_CRC32,PM_CRC32C,PM_Adler32 against the scalar implementations");
+    PM__TestChecksumsScalarEquivalence(buffer, 2000);
+
+    PM_LogInfo("Testing Common/Checksums/PM_CRC32Combine and chained calls");
+    PM__TestChecksumsChaining(buffer, 200);
+
+    PM_LogInfo("Testing Common/Checksums/PM_CRC32Parallel");
+    PM__TestChecksumsParallel(buffer);
+
+    PM_Free(buffer);
+    return PM_TestFinish("Common/Checksums");
+}
@@ -0,0 +1,228 @@
+#include "libpicomedia/libpicomedia.h"
+#include "test_utils.h"
+
+#include <stdio.h>
+
+#define TEST_FILE_NAME      "stream_sources_test.bin"
+#define TEST_MAX_FILE_SIZE  (200 * 1024)
+#define TEST_MAX_OP_SIZE    (70 * 1024)
+
+static PM_Bool PM__TestWriteFile(const char* fileName, const PM_Byte* data, PM_Size size)
+{
+    FILE* file = fopen(fileName, "wb");
+    if (file == NULL)
+        return PM_FALSE;
+    PM_Size written = fwrite(data, 1, size, file);
+    fclose(file);
+    return written == size;
+}
+
+static PM_Byte* PM__TestReadFile(const char* fileName, PM_Size* size)
+{
+    FILE* file = fopen(fileName, "rb");
+    if (file == NULL)
+        return NULL;
+    fseek(file, 0, SEEK_END);
+    *size = (PM_Size)ftell(file);
+    fseek(file, 0, SEEK_SET);
+    PM_Byte* data = (PM_Byte*)PM_Malloc(*size + 1);
+    *size = fread(data, 1, *size, file);
+    fclose(file);
+    return data;
+}
+
+// Runs the same random reads, peeks, seeks and acquires on a buffered file stream, a mapped stream and a memory
+// stream of the same data, the memory stream being the reference
+static void PM__TestStreamSourcesRead(PM_Size iterations)
+{
+    PM_Byte* reference = (PM_Byte*)PM_Malloc(TEST_MAX_FILE_SIZE);
+    PM_Byte* outputs[3];
+    for (PM_Size i = 0; i < 3; i++)
+        outputs[i] = (PM_Byte*)PM_Malloc(TEST_MAX_OP_SIZE);
+
+    for (PM_Size iteration = 0; iteration < iterations; iteration++)
+    {
+        PM_Size fileSize = 1 + PM_TestRandomRange(TEST_MAX_FILE_SIZE);
+        PM_TestRandomFill(reference, fileSize);
+        if (!PM_TestCheck(PM__TestWriteFile(TEST_FILE_NAME, reference, fileSize)))
+            break;
+
+        PM_Stream streams[3];
+        PM_StreamInit(&streams[0]);
+        PM_StreamInit(&streams[1]);
+        PM_StreamInit(&streams[2]);
+        PM_TestCheck(PM_StreamInitFromMemory(&streams[0], reference, fileSize, PICOMEDIA_STREAM_FLAG_READ, PM_FALSE));
+        PM_TestCheck(PM_StreamInitFromFile(&streams[1], TEST_FILE_NAME, PICOMEDIA_STREAM_FLAG_READ));
+        PM_TestCheck(PM_StreamInitFromFileMapped(&streams[2], TEST_FILE_NAME));
+        PM_TestCheck(streams[2].sourceType == PICOMEDIA_STREAM_SOURCE_TYPE_MMAP);
+        PM_TestCheck(PM_StreamGetSourceSize(&streams[1]) == fileSize);
+        PM_TestCheck(PM_StreamGetSourceSize(&streams[2]) == fileSize);
+
+        // unbuffered, tiny and regular buffers, so both the buffered and the bypass paths are used
+        PM_Size bufferSizes[4] = { 0, 1 + PM_TestRandomRange(64), 1 + PM_TestRandomRange(5000), PICOMEDIA_STREAM_DEFAULT_BUFFER_SIZE };
+        PM_StreamSetBufferSize(&streams[1], bufferSizes[iteration % 4]);
+
+        for (PM_Size i = 0; i < 3; i++)
+            PM_StreamSetRequireReverse(&streams[i], PM_FALSE);
+
+        PM_Bool passed = PM_TRUE;
+        for (PM_Size operation = 0; operation < 200 && passed; operation++)
+        {
+            PM_Size kind = PM_TestRandomRange(4);
+            PM_Size size = PM_TestRandomRange(PM_TestRandomRange(4) == 0 ? TEST_MAX_OP_SIZE : 50);
+            PM_Size position = PM_TestRandomRange(fileSize + 10);
+            PM_Size results[3];
+
+            for (PM_Size i = 0; i < 3; i++)
+            {
+                switch (kind)
+                {
+                case 0:
+                    results[i] = PM_StreamRead(&streams[i], outputs[i], size);
+                    break;
+                case 1:
+                    results[i] = PM_StreamPeek(&streams[i], outputs[i], size);
+                    break;
+                case 2:
+                    results[i] = PM_StreamSetCursorPosition(&streams[i], position);
+                    break;
+                default:
+                {
+                    PM_Byte* data = NULL;
+                    results[i] = PM_StreamAcquire(&streams[i], size, &data);
+                    if (results[i] > 0)
+                        PM_Memcpy(outputs[i], data, results[i]);
+                    PM_StreamRelease(&streams[i]);
+                    break;
+                }
+                }
+            }
+
+            for (PM_Size i = 1; i < 3; i++)
+            {
+                passed &= PM_TestCheck(results[i] == results[0]);
+                passed &= PM_TestCheck(PM_StreamGetCursorPosition(&streams[i]) == PM_StreamGetCursorPosition(&streams[0]));
+                if (kind != 2 && results[i] == results[0])
+                    passed &= PM_TestCheck(PM_Memcmp(outputs[i], outputs[0], results[0]) == 0);
+            }
+        }
+
+        for (PM_Size i = 0; i < 3; i++)
+            PM_StreamDestroy(&streams[i]);
+    }
+
+    for (PM_Size i = 0; i < 3; i++)
+        PM_Free(outputs[i]);
+    PM_Free(reference);
+}
+
+// A short acquire at the end of the stream returns the remaining bytes, the borrowed data of a memory
+// stream points into the source and the one of a file stream is a copy
+static void PM__TestStreamAcquireEnd()
+{
+    PM_Byte data[100];
+    for (PM_Size i = 0; i < sizeof(data); i++)
+        data[i] = (PM_Byte)i;
+    PM_TestCheck(PM__TestWriteFile(TEST_FILE_NAME, data, sizeof(data)));
+
+    PM_Stream memoryStream;
+    PM_StreamInit(&memoryStream);
+    PM_TestCheck(PM_StreamInitFromMemory(&memoryStream, data, sizeof(data), PICOMEDIA_STREAM_FLAG_READ, PM_FALSE));
+    PM_StreamSetCursorPosition(&memoryStream, 90);
+
+    PM_Byte* borrowed = NULL;
+    PM_TestCheck(PM_StreamAcquire(&memoryStream, 64, &borrowed) == 10);
+    PM_TestCheck(borrowed == data + 90);
+    PM_StreamRelease(&memoryStream);
+    PM_TestCheck(PM_StreamGetCursorPosition(&memoryStream) == sizeof(data));
+    PM_TestCheck(PM_StreamAcquire(&memoryStream, 1, &borrowed) == 0);
+    PM_StreamRelease(&memoryStream);
+    PM_StreamDestroy(&memoryStream);
+
+    PM_Stream fileStream;
+    PM_StreamInit(&fileStream);
+    PM_TestCheck(PM_StreamInitFromFile(&fileStream, TEST_FILE_NAME, PICOMEDIA_STREAM_FLAG_READ));
+    PM_StreamSetCursorPosition(&fileStream, 95);
+    PM_TestCheck(PM_StreamAcquire(&fileStream, 64, &borrowed) == 5);
+    PM_TestCheck(PM_Memcmp(borrowed, data + 95, 5) == 0);
+    // reads are allowed while the data is borrowed and must not change it
+    PM_StreamSetCursorPosition(&fileStream, 0);
+    PM_TestCheck(PM_StreamReadByte(&fileStream) == 0);
+    PM_TestCheck(PM_Memcmp(borrowed, data + 95, 5) == 0);
+    PM_StreamRelease(&fileStream);
+    PM_StreamDestroy(&fileStream);
+}
+
+// Random writes and seeks through the write-behind buffer of a file stream, checked against the file written out
+static void PM__TestStreamBufferedWrite(PM_Size iterations)
+{
+    PM_Byte* expected = (PM_Byte*)PM_Malloc(TEST_MAX_FILE_SIZE + TEST_MAX_OP_SIZE);
+    PM_Byte* buffer = (PM_Byte*)PM_Malloc(TEST_MAX_OP_SIZE);
+
+    for (PM_Size iteration = 0; iteration < iterations; iteration++)
+    {
+        PM_Memset(expected, 0, TEST_MAX_FILE_SIZE + TEST_MAX_OP_SIZE);
+        PM_Size written = 0;
+
+        PM_Stream stream;
+        PM_StreamInit(&stream);
+        if (!PM_TestCheck(PM_StreamInitFromFile(&stream, TEST_FILE_NAME, PICOMEDIA_STREAM_FLAG_WRITE)))
+            break;
+        PM_Size bufferSizes[3] = { 0, 1 + PM_TestRandomRange(64), 1 + PM_TestRandomRange(5000) };
+        PM_StreamSetBufferSize(&stream, bufferSizes[iteration % 3]);
+
+        for (PM_Size operation = 0; operation < 100; operation++)
+        {
+            if (PM_TestRandomRange(4) == 0)
+                PM_StreamSetCursorPosition(&stream, PM_TestRandomRange(written + 1));
+
+            PM_Size position = PM_StreamGetCursorPosition(&stream);
+            PM_Size size = PM_TestRandomRange(PM_TestRandomRange(4) == 0 ? TEST_MAX_OP_SIZE - 10000 : 40);
+            if (position + size > TEST_MAX_FILE_SIZE)
+                continue;
+
+            PM_TestRandomFill(buffer, size);
+            PM_TestCheck(PM_StreamWrite(&stream, buffer, size) == size);
+            PM_Memcpy(expected + position, buffer, size);
+            if (position + size > written)
+                written = position + size;
+
+            // flushed data must be visible to other readers of the file
+            if (operation == 50)
+            {
+                PM_TestCheck(PM_StreamFlush(&stream));
+                PM_Size fileSize = 0;
+                PM_Byte* contents = PM__TestReadFile(TEST_FILE_NAME, &fileSize);
+                PM_TestCheck(contents != NULL && fileSize == written && PM_Memcmp(contents, expected, written) == 0);
+                PM_Free(contents);
+            }
+        }
+        PM_StreamDestroy(&stream);
+
+        PM_Size fileSize = 0;
+        PM_Byte* contents = PM__TestReadFile(TEST_FILE_NAME, &fileSize);
+        PM_TestCheck(contents != NULL && fileSize == written && PM_Memcmp(contents, expected, written) == 0);
+        PM_Free(contents);
+    }
+
+    PM_Free(buffer);
+    PM_Free(expected);
+}
+
+int main(int argc, char** argv, char** envp)
+{
+    PM_LogInfo("Starting test for Common/Stream sources");
+    PM_TestRandomSeed(4);
+
+    PM_LogInfo("Testing Common/Stream/PM_StreamInitFromFile,PM_StreamInitFromFileMapped,PM_StreamAcquire against memory streams");
+    PM__TestStreamSourcesRead(60);
+
+    PM_LogInfo("Testing Common/Stream/PM_StreamAcquire,PM_StreamRelease at the end of a stream");
+    PM__TestStreamAcquireEnd();
+
+    PM_LogInfo("Testing Common/Stream/PM_StreamWrite,PM_StreamFlush,PM_StreamSetBufferSize");
+    PM__TestStreamBufferedWrite(60);
+
+    remove(TEST_FILE_NAME);
+    return PM_TestFinish("Common/Stream sources");
+}
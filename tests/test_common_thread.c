@@ -0,0 +1,233 @@
+#include "libpicomedia/libpicomedia.h"
+#include "test_utils.h"
+
+#define TEST_QUEUE_PRODUCERS            4
+#define TEST_QUEUE_CONSUMERS            4
+#define TEST_QUEUE_ITEMS_PER_PRODUCER   20000
+
+struct PM_TestQueueContext
+{
+    PM_MPMCQueue* queue;
+    PM_Semaphore* freeSlots;
+    PM_Semaphore* queuedItems;
+    volatile PM_Int64 poppedCount;
+    volatile PM_Int64 poppedSum;
+    volatile PM_Int64 nextProducer;
+};
+typedef struct PM_TestQueueContext PM_TestQueueContext;
+
+struct PM_TestTaskContext
+{
+    PM_ThreadPool* pool;
+    PM_TaskGroup* group;
+    volatile PM_Int64 sum;
+    volatile PM_Int32 count;
+};
+typedef struct PM_TestTaskContext PM_TestTaskContext;
+
+static void PM__TestSumRange(PM_Size begin, PM_Size end, void* data)
+{
+    PM_TestTaskContext* context = (PM_TestTaskContext*)data;
+    PM_Int64 sum = 0;
+    for (PM_Size i = begin; i < end; i++)
+        sum += (PM_Int64)i;
+    PM_AtomicAddInt64(&context->sum, sum);
+    PM_AtomicAddInt32(&context->count, 1);
+}
+
+static void PM__TestNestedRange(PM_Size begin, PM_Size end, void* data)
+{
+    PM_TestTaskContext* context = (PM_TestTaskContext*)data;
+    for (PM_Size i = begin; i < end; i++)
+        PM_ParallelFor(context->pool, 0, 1000, 7, PM__TestSumRange, context);
+}
+
+static void PM__TestCountTask(void* data)
+{
+    PM_TestTaskContext* context = (PM_TestTaskContext*)data;
+    PM_AtomicAddInt32(&context->count, 1);
+}
+
+// Waits on its own group from inside a task, which must run the queued tasks instead of deadlocking
+static void PM__TestSpawningTask(void* data)
+{
+    PM_TestTaskContext* context = (PM_TestTaskContext*)data;
+    PM_TestTaskContext inner = { context->pool, NULL, 0, 0 };
+    inner.group = PM_TaskGroupCreate(context->pool);
+    for (PM_Int32 i = 0; i < 100; i++)
+        PM_TaskGroupRun(inner.group, PM__TestCountTask, &inner);
+    PM_TaskGroupWait(inner.group);
+    PM_TaskGroupDestroy(inner.group);
+    PM_AtomicAddInt32(&context->count, inner.count);
+}
+
+// The semaphores block the threads instead of spinning on a full or empty queue, a push or pop can still fail
+// for a moment while another thread is halfway through its own one on the same slot
+static PM_Bool PM__TestQueueProducer(PM_Thread* thread, void* data)
+{
+    PM_TestQueueContext* context = (PM_TestQueueContext*)data;
+    PM_Int64 producer = PM_AtomicAddInt64(&context->nextProducer, 1) - 1;
+    for (PM_Int64 i = 0; i < TEST_QUEUE_ITEMS_PER_PRODUCER; i++)
+    {
+        PM_Int64 value = producer * TEST_QUEUE_ITEMS_PER_PRODUCER + i;
+        PM_SemaphoreWait(context->freeSlots);
+        while (!PM_MPMCQueuePush(context->queue, &value))
+            ;
+        PM_SemaphorePost(context->queuedItems, 1);
+    }
+    return PM_TRUE;
+}
+
+static PM_Bool PM__TestQueueConsumer(PM_Thread* thread, void* data)
+{
+    PM_TestQueueContext* context = (PM_TestQueueContext*)data;
+    const PM_Int64 count = TEST_QUEUE_PRODUCERS * TEST_QUEUE_ITEMS_PER_PRODUCER / TEST_QUEUE_CONSUMERS;
+    PM_Int64 value = 0;
+    for (PM_Int64 i = 0; i < count; i++)
+    {
+        PM_SemaphoreWait(context->queuedItems);
+        while (!PM_MPMCQueuePop(context->queue, &value))
+            ;
+        PM_SemaphorePost(context->freeSlots, 1);
+        PM_AtomicAddInt64(&context->poppedSum, value);
+        PM_AtomicAddInt64(&context->poppedCount, 1);
+    }
+    return PM_TRUE;
+}
+
+static void PM__TestParallelFor()
+{
+    PM_TestTaskContext context = { PM_ThreadPoolCreate(6), NULL, 0, 0 };
+    PM_TestCheck(context.pool != NULL);
+    PM_TestCheck(PM_ThreadPoolGetThreadCount(context.pool) == 6);
+
+    PM_Size grains[4] = { 0, 1, 7, 1000000 };
+    for (PM_Size i = 0; i < 4; i++)
+    {
+        context.sum = 0;
+        PM_ParallelFor(context.pool, 5, 100005, grains[i], PM__TestSumRange, &context);
+        PM_TestCheck(context.sum == (PM_Int64)100005 * 100004 / 2 - 5 * 4 / 2);
+    }
+
+    context.count = 0;
+    PM_ParallelFor(context.pool, 10, 10, 0, PM__TestSumRange, &context);
+    PM_TestCheck(context.count == 0);
+
+    context.sum = 0;
+    PM_ParallelFor(context.pool, 0, 50, 1, PM__TestNestedRange, &context);
+    PM_TestCheck(context.sum == 50 * 499500);
+
+    context.sum = 0;
+    PM_ParallelFor(NULL, 0, 1000, 0, PM__TestSumRange, &context);
+    PM_TestCheck(context.sum == 499500);
+    PM_TestCheck(PM_ThreadPoolGetThreadCount(NULL) >= 1);
+
+    PM_ThreadPoolDestroy(context.pool);
+}
+
+static void PM__TestTaskGroup()
+{
+    PM_TestTaskContext context = { PM_ThreadPoolCreate(4), NULL, 0, 0 };
+    context.group = PM_TaskGroupCreate(context.pool);
+    PM_TestCheck(context.group != NULL);
+
+    for (PM_Int32 i = 0; i < 10000; i++)
+        PM_TaskGroupRun(context.group, PM__TestCountTask, &context);
+    PM_TaskGroupWait(context.group);
+    PM_TestCheck(context.count == 10000);
+
+    context.count = 0;
+    for (PM_Int32 i = 0; i < 20; i++)
+        PM_TaskGroupRun(context.group, PM__TestSpawningTask, &context);
+    PM_TaskGroupWait(context.group);
+    PM_TestCheck(context.count == 20 * 100);
+
+    PM_TaskGroupDestroy(context.group);
+    PM_ThreadPoolDestroy(context.pool);
+}
+
+static void PM__TestQueue()
+{
+    PM_MPMCQueue* queue = PM_MPMCQueueCreate(5, sizeof(PM_Int64));
+    PM_TestCheck(PM_MPMCQueueGetCapacity(queue) == 8);
+
+    PM_Int64 value = 0;
+    PM_TestCheck(!PM_MPMCQueuePop(queue, &value));
+    for (PM_Int64 i = 0; i < 8; i++)
+        PM_TestCheck(PM_MPMCQueuePush(queue, &i));
+    PM_TestCheck(!PM_MPMCQueuePush(queue, &value));
+    for (PM_Int64 i = 0; i < 8; i++)
+        PM_TestCheck(PM_MPMCQueuePop(queue, &value) && value == i);
+    PM_TestCheck(!PM_MPMCQueuePop(queue, &value));
+    PM_MPMCQueueDestroy(queue);
+
+    // capacities and element sizes whose slots do not fit in memory are refused
+    PM_TestCheck(PM_MPMCQueueCreate(SIZE_MAX, sizeof(PM_Int64)) == NULL);
+    PM_TestCheck(PM_MPMCQueueCreate(SIZE_MAX / 2 + 2, 1) == NULL);
+    PM_TestCheck(PM_MPMCQueueCreate((PM_Size)1 << (sizeof(PM_Size) * 8 - 2), sizeof(PM_Int64)) == NULL);
+    PM_TestCheck(PM_MPMCQueueCreate(2, SIZE_MAX - 4) == NULL);
+
+    // every pushed value is popped exactly once, checked by the sum of all the values
+    PM_TestQueueContext context = { PM_MPMCQueueCreate(100, sizeof(PM_Int64)), PM_SemaphoreCreate(100), PM_SemaphoreCreate(0), 0, 0, 0 };
+    PM_Thread* threads[TEST_QUEUE_PRODUCERS + TEST_QUEUE_CONSUMERS];
+    for (PM_Size i = 0; i < TEST_QUEUE_PRODUCERS; i++)
+        threads[i] = PM_ThreadCreate(PM__TestQueueProducer, &context);
+    for (PM_Size i = 0; i < TEST_QUEUE_CONSUMERS; i++)
+        threads[TEST_QUEUE_PRODUCERS + i] = PM_ThreadCreate(PM__TestQueueConsumer, &context);
+
+    for (PM_Size i = 0; i < TEST_QUEUE_PRODUCERS + TEST_QUEUE_CONSUMERS; i++)
+    {
+        PM_TestCheck(PM_ThreadJoin(threads[i]));
+        PM_ThreadDestroy(threads[i]);
+    }
+
+    const PM_Int64 total = TEST_QUEUE_PRODUCERS * TEST_QUEUE_ITEMS_PER_PRODUCER;
+    PM_TestCheck(context.poppedCount == total);
+    PM_TestCheck(context.poppedSum == total * (total - 1) / 2);
+    PM_TestCheck(!PM_MPMCQueuePop(context.queue, &value));
+    PM_TestCheck(!PM_SemaphoreTryWait(context.queuedItems));
+
+    PM_SemaphorePost(context.queuedItems, 3);
+    PM_TestCheck(PM_SemaphoreTryWait(context.queuedItems));
+    PM_TestCheck(PM_SemaphoreTryWait(context.queuedItems));
+    PM_TestCheck(PM_SemaphoreTryWait(context.queuedItems));
+    PM_TestCheck(!PM_SemaphoreTryWait(context.queuedItems));
+
+    PM_SemaphoreDestroy(context.queuedItems);
+    PM_SemaphoreDestroy(context.freeSlots);
+    PM_MPMCQueueDestroy(context.queue);
+}
+
+static void PM__TestAtomics()
+{
+    volatile PM_Int32 value32 = 5;
+    PM_TestCheck(PM_AtomicAddInt32(&value32, 3) == 8);
+    PM_TestCheck(!PM_AtomicCompareExchangeInt32(&value32, 5, 1));
+    PM_TestCheck(PM_AtomicCompareExchangeInt32(&value32, 8, 1));
+    PM_TestCheck(PM_AtomicLoadInt32(&value32) == 1);
+
+    volatile PM_Int64 value64 = 0;
+    PM_AtomicStoreInt64(&value64, 1ll << 40);
+    PM_TestCheck(PM_AtomicAddInt64(&value64, -1) == (1ll << 40) - 1);
+    PM_TestCheck(PM_AtomicCompareExchangeInt64(&value64, (1ll << 40) - 1, 7));
+    PM_TestCheck(PM_AtomicLoadInt64(&value64) == 7);
+}
+
+int main(int argc, char** argv, char** envp)
+{
+    PM_LogInfo("Starting test for Common/Thread");
+
+    PM_LogInfo("Testing Common/Thread atomics");
+    PM__TestAtomics();
+
+    PM_LogInfo("Testing Common/Thread/PM_ParallelFor");
+    PM__TestParallelFor();
+
+    PM_LogInfo("Testing Common/Thread/PM_TaskGroupRun,PM_TaskGroupWait");
+    PM__TestTaskGroup();
+
+    PM_LogInfo("Testing Common/Thread/PM_MPMCQueuePush,PM_MPMCQueuePop,PM_Semaphore*");
+    PM__TestQueue();
+
+    return PM_TestFinish("Common/Thread");
+}
@@ -0,0 +1,298 @@
+#include "libpicomedia/libpicomedia.h"
+#include "test_utils.h"
+
+#define TEST_BMP_FILE_HEADER_SIZE   14
+
+static void PM__TestWrite16(PM_Byte* data, PM_UInt32 value)
+{
+    data[0] = (PM_Byte)value;
+    data[1] = (PM_Byte)(value >> 8);
+}
+
+static void PM__TestWrite32(PM_Byte* data, PM_UInt32 value)
+{
+    data[0] = (PM_Byte)value;
+    data[1] = (PM_Byte)(value >> 8);
+    data[2] = (PM_Byte)(value >> 16);
+    data[3] = (PM_Byte)(value >> 24);
+}
+
+// Writes the file and info headers of a BMP, the info header fields past the 40 byte ones are left to the caller
+static void PM__TestWriteHeaders(PM_Byte* file, PM_Size fileSize, PM_Size dataOffset, PM_UInt32 infoHeaderSize, PM_Int32 width,
+                                 PM_Int32 height, PM_UInt32 bitsPerPixel, PM_UInt32 compression, PM_UInt32 imageSize, PM_UInt32 colorsUsed)
+{
+    file[0] = 'B';
+    file[1] = 'M';
+    PM__TestWrite32(file + 2, (PM_UInt32)fileSize);
+    PM__TestWrite32(file + 10, (PM_UInt32)dataOffset);
+    PM__TestWrite32(file + 14, infoHeaderSize);
+    PM__TestWrite32(file + 18, (PM_UInt32)width);
+    PM__TestWrite32(file + 22, (PM_UInt32)height);
+    PM__TestWrite16(file + 26, 1);
+    PM__TestWrite16(file + 28, bitsPerPixel);
+    PM__TestWrite32(file + 30, compression);
+    PM__TestWrite32(file + 34, imageSize);
+    PM__TestWrite32(file + 46, colorsUsed);
+}
+
+// Value of a channel selected by a bit mask, scaled to 8 bits by replicating its bits like the reader does
+static PM_UInt8 PM__TestExpandMasked(PM_UInt32 pixel, PM_UInt32 mask)
+{
+    if (mask == 0)
+        return 0;
+
+    PM_UInt32 shift = 0, bits = 0;
+    while (((mask >> shift) & 1) == 0)
+        shift++;
+    while (shift + bits < 32 && ((mask >> (shift + bits)) & 1) != 0)
+        bits++;
+
+    PM_UInt32 value = (pixel & mask) >> shift;
+    if (bits > 8)
+    {
+        value >>= bits - 8;
+        bits = 8;
+    }
+
+    PM_UInt32 result = 0;
+    for (PM_Int32 position = 8 - (PM_Int32)bits; position > -(PM_Int32)bits; position -= (PM_Int32)bits)
+        result |= position >= 0 ? value << position : value >> -position;
+    return (PM_UInt8)result;
+}
+
+// Random uncompressed and bit field BMPs of every bit depth and header size, decoded and checked pixel by pixel
+static void PM__TestReadUncompressed(PM_Size iterations)
+{
+    static const PM_UInt32 bitDepths[6] = { 1, 4, 8, 16, 24, 32 };
+    static const PM_UInt32 infoHeaderSizes[4] = { 40, 56, 108, 124 };
+    static const PM_UInt32 masks16[4][4] = { { 0xF800, 0x07E0, 0x001F, 0 }, { 0x7C00, 0x03E0, 0x001F, 0x8000 },
+                                             { 0x0F00, 0x00F0, 0x000F, 0xF000 }, { 0x001F, 0x07E0, 0xF800, 0 } };
+    static const PM_UInt32 masks32[4][4] = { { 0xFF0000, 0xFF00, 0xFF, 0xFF000000 }, { 0xFF000000, 0xFF0000, 0xFF00, 0xFF },
+                                             { 0x3FF00000, 0xFFC00, 0x3FF, 0xC0000000 }, { 0xFF0000, 0xFF00, 0xFF, 0 } };
+
+    for (PM_Size iteration = 0; iteration < iterations; iteration++)
+    {
+        PM_UInt32 bitsPerPixel = bitDepths[PM_TestRandomRange(6)];
+        PM_Int32 width = 1 + (PM_Int32)PM_TestRandomRange(iteration % 8 == 0 ? 300 : 40);
+        PM_Int32 height = 1 + (PM_Int32)PM_TestRandomRange(10);
+        PM_Bool isTopDown = PM_TestRandomRange(2) == 1;
+        PM_UInt32 infoHeaderSize = infoHeaderSizes[PM_TestRandomRange(4)];
+
+        PM_UInt32 compression = PICOMEDIA_BMP_COMPRESSION_RGB;
+        PM_UInt32 masks[4] = { 0, 0, 0, 0 };
+        PM_Size maskSet = PM_TestRandomRange(5);
+        if (maskSet > 0 && (bitsPerPixel == 16 || bitsPerPixel == 32))
+        {
+            compression = PICOMEDIA_BMP_COMPRESSION_BITFIELDS;
+            PM_Memcpy(masks, bitsPerPixel == 16 ? masks16[maskSet - 1] : masks32[maskSet - 1], sizeof(masks));
+            // the 40 byte header has no room for an alpha mask
+            if (infoHeaderSize < 56)
+                masks[3] = 0;
+        }
+
+        PM_UInt32 colorsUsed = 0, paletteSize = 0;
+        if (bitsPerPixel <= 8)
+        {
+            colorsUsed = PM_TestRandomRange(2) ? 0 : 1 + (PM_UInt32)PM_TestRandomRange((PM_Size)1 << bitsPerPixel);
+            paletteSize = colorsUsed ? colorsUsed : 1u << bitsPerPixel;
+        }
+
+        PM_Size stride = ((PM_Size)width * bitsPerPixel + 31) / 32 * 4;
+        PM_Size masksSize = (compression == PICOMEDIA_BMP_COMPRESSION_BITFIELDS && infoHeaderSize == 40) ? 12 : 0;
+        PM_Size dataOffset = TEST_BMP_FILE_HEADER_SIZE + infoHeaderSize + masksSize + paletteSize * 4;
+        PM_Size fileSize = dataOffset + stride * height;
+        PM_Byte* file = (PM_Byte*)PM_Malloc(fileSize);
+        PM_TestRandomFill(file, fileSize);
+        PM_Memset(file, 0, TEST_BMP_FILE_HEADER_SIZE + infoHeaderSize);
+        PM__TestWriteHeaders(file, fileSize, dataOffset, infoHeaderSize, width, isTopDown ? -height : height, bitsPerPixel,
+                             compression, (PM_UInt32)(stride * height), colorsUsed);
+        if (compression == PICOMEDIA_BMP_COMPRESSION_BITFIELDS)
+        {
+            for (PM_Size i = 0; i < (infoHeaderSize >= 56 ? 4u : 3u); i++)
+                PM__TestWrite32(file + 54 + i * 4, masks[i]);
+        }
+        const PM_UInt8* palette = (const PM_UInt8*)file + TEST_BMP_FILE_HEADER_SIZE + infoHeaderSize + masksSize;
+
+        // the default masks of uncompressed 16 and 32-bit pixels, without alpha
+        if (compression == PICOMEDIA_BMP_COMPRESSION_RGB && bitsPerPixel == 16)
+        {
+            masks[0] = 0x7C00;
+            masks[1] = 0x03E0;
+            masks[2] = 0x001F;
+        }
+        else if (compression == PICOMEDIA_BMP_COMPRESSION_RGB && bitsPerPixel >= 24)
+        {
+            masks[0] = 0xFF0000;
+            masks[1] = 0xFF00;
+            masks[2] = 0xFF;
+        }
+        PM_UInt8 channels = masks[3] ? 4 : 3;
+
+        PM_Image image;
+        PM_ImageInit(&image);
+        if (!PM_TestCheck(PM_ImageBMPReadFromMemory(file, fileSize, &image)))
+        {
+            PM_Free(file);
+            continue;
+        }
+
+        if (PM_TestCheck(image.width == (PM_UInt32)width && image.height == (PM_UInt32)height && image.numChannels == channels))
+        {
+            PM_Bool passed = PM_TRUE;
+            for (PM_Int32 y = 0; y < height && passed; y++)
+            {
+                const PM_UInt8* row = (const PM_UInt8*)file + dataOffset + (isTopDown ? y : height - 1 - y) * stride;
+                for (PM_Int32 x = 0; x < width && passed; x++)
+                {
+                    PM_UInt8 expected[4];
+                    if (bitsPerPixel <= 8)
+                    {
+                        PM_Size bit = (PM_Size)x * bitsPerPixel;
+                        PM_UInt32 index = (row[bit / 8] >> (8 - bitsPerPixel - bit % 8)) & ((1u << bitsPerPixel) - 1);
+                        // indices past the palette are black
+                        for (PM_Size c = 0; c < 3; c++)
+                            expected[c] = index < paletteSize ? palette[index * 4 + 2 - c] : 0;
+                    }
+                    else
+                    {
+                        PM_Size bytesPerPixel = bitsPerPixel / 8;
+                        PM_UInt32 pixel = 0;
+                        for (PM_Size i = 0; i < bytesPerPixel; i++)
+                            pixel |= (PM_UInt32)row[x * bytesPerPixel + i] << (8 * i);
+                        for (PM_Size c = 0; c < 4; c++)
+                            expected[c] = PM__TestExpandMasked(pixel, masks[c]);
+                    }
+
+                    passed = PM_Memcmp(expected, image.data + ((PM_Size)y * width + x) * channels, channels) == 0;
+                    if (!PM_TestCheck(passed))
+                        PM_LogInfo("Pixel (%d, %d) of a %dx%d %u bpp BMP (compression %u, header %u) does not match", x, y, width,
+                                   height, bitsPerPixel, compression, infoHeaderSize);
+                }
+            }
+        }
+
+        PM_ImageDestroy(&image);
+        PM_Free(file);
+    }
+}
+
+// Every writer format read back, with few enough colors for the palette formats
+static void PM__TestWriteRoundTrip(PM_Size iterations)
+{
+    static const PM_UInt32 formats[6] = { PICOMEDIA_BMP_FORMAT_AUTO, PICOMEDIA_BMP_FORMAT_BGR24, PICOMEDIA_BMP_FORMAT_BGRA32,
+                                          PICOMEDIA_BMP_FORMAT_PALETTE8, PICOMEDIA_BMP_FORMAT_RLE8, PICOMEDIA_BMP_FORMAT_RLE4 };
+
+    for (PM_Size iteration = 0; iteration < iterations; iteration++)
+    {
+        PM_UInt32 format = formats[iteration % 6];
+        PM_UInt32 width = 1 + (PM_UInt32)PM_TestRandomRange(100), height = 1 + (PM_UInt32)PM_TestRandomRange(8);
+        PM_Bool hasAlpha = format == PICOMEDIA_BMP_FORMAT_BGRA32 || (format == PICOMEDIA_BMP_FORMAT_AUTO && iteration % 12 == 0);
+        PM_UInt8 channels = hasAlpha ? 4 : 3;
+        PM_Size colorCount = format == PICOMEDIA_BMP_FORMAT_RLE4 ? 16 : 200;
+
+        PM_Byte colors[256][4];
+        PM_TestRandomFill(colors, sizeof(colors));
+
+        PM_Image image;
+        PM_ImageInit(&image);
+        PM_ImageAllocate(&image, width, height, hasAlpha ? PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGBA : PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGB,
+                         PICOIMEDIA_IMAGE_DATA_TYPE_UINT8, channels);
+        // runs of random length, so the RLE encoders emit both encoded and absolute runs
+        PM_Size color = 0;
+        for (PM_Size i = 0; i < (PM_Size)width * height; i++)
+        {
+            if (PM_TestRandomRange(4) == 0)
+                color = PM_TestRandomRange(colorCount);
+            PM_Memcpy(image.data + i * channels, colors[color], channels);
+        }
+
+        PM_Size capacity = 4096 + (PM_Size)width * height * 5;
+        PM_Byte* data = (PM_Byte*)PM_Malloc(capacity);
+        PM_Size dataSize = 0;
+        PM_Image decoded;
+        PM_ImageInit(&decoded);
+        if (PM_TestCheck(PM_ImageBMPWriteToMemoryEx(&image, data, &dataSize, capacity, format)) &&
+            PM_TestCheck(PM_ImageBMPReadFromMemory(data, dataSize, &decoded)))
+        {
+            if (!PM_TestCheck(decoded.width == width && decoded.height == height && decoded.numChannels == channels &&
+                              PM_Memcmp(decoded.data, image.data, image.dataSize) == 0))
+                PM_LogInfo("BMP format %u round trip of a %ux%u image does not match", format, width, height);
+        }
+
+        PM_ImageDestroy(&decoded);
+        PM_ImageDestroy(&image);
+        PM_Free(data);
+    }
+}
+
+// An RLE8 image with a delta, an end of line and an absolute run, the pixels it skips are black
+static void PM__TestReadRLE8()
+{
+    static const PM_Byte runs[] = { 3, 5, 0, 2, 1, 1, 2, 7, 0, 0, 0, 3, 1, 2, 3, 0, 0, 1 };
+    static const PM_UInt8 expected[3][6] = { { 1, 2, 3, 0, 0, 0 }, { 0, 0, 0, 0, 7, 7 }, { 5, 5, 5, 0, 0, 0 } };
+
+    PM_Byte file[TEST_BMP_FILE_HEADER_SIZE + 40 + 8 * 4 + sizeof(runs)] = { 0 };
+    PM_Size dataOffset = TEST_BMP_FILE_HEADER_SIZE + 40 + 8 * 4;
+    PM__TestWriteHeaders(file, sizeof(file), dataOffset, 40, 6, 3, 8, PICOMEDIA_BMP_COMPRESSION_RLE8, sizeof(runs), 8);
+    for (PM_Size i = 0; i < 8; i++)
+        file[54 + i * 4 + 2] = (PM_Byte)(i * 30);
+    PM_Memcpy(file + dataOffset, runs, sizeof(runs));
+
+    PM_Image image;
+    PM_ImageInit(&image);
+    if (PM_TestCheck(PM_ImageBMPReadFromMemory(file, sizeof(file), &image)) && PM_TestCheck(image.width == 6 && image.height == 3))
+    {
+        for (PM_Size y = 0; y < 3; y++)
+        for (PM_Size x = 0; x < 6; x++)
+            PM_TestCheck((PM_UInt8)image.data[(y * 6 + x) * 3] == expected[y][x] * 30);
+    }
+    PM_ImageDestroy(&image);
+}
+
+// An RLE8 header whose decoded size wraps around 32 bits must be rejected before anything is allocated or decoded
+static void PM__TestReadOversized()
+{
+    PM_Size dataOffset = TEST_BMP_FILE_HEADER_SIZE + 40 + 256 * 4;
+    PM_Size runsSize = 1002;
+    PM_Size fileSize = dataOffset + runsSize;
+    PM_Byte* file = (PM_Byte*)PM_Malloc(fileSize);
+    PM_Memset(file, 0, fileSize);
+    PM__TestWriteHeaders(file, fileSize, dataOffset, 40, 65536, 21846, 8, PICOMEDIA_BMP_COMPRESSION_RLE8, (PM_UInt32)runsSize, 256);
+    for (PM_Size i = 0; i + 2 < runsSize; i += 2)
+    {
+        file[dataOffset + i] = (PM_Byte)255;
+        file[dataOffset + i + 1] = (PM_Byte)i;
+    }
+    file[fileSize - 1] = 1;
+
+    PM_ImageInfo info;
+    PM_TestCheck(PM_ImageProbeFromMemory(file, fileSize, &info));
+    PM_TestCheck(info.width == 65536 && info.height == 21846 && info.decodedSize > PICOMEDIA_IMAGE_MAX_DATA_SIZE);
+
+    PM_Image image;
+    PM_ImageInit(&image);
+    PM_TestCheck(!PM_ImageBMPReadFromMemory(file, fileSize, &image));
+    PM_TestCheck(image.data == NULL);
+    PM_ImageDestroy(&image);
+    PM_Free(file);
+}
+
+int main(int argc, char** argv, char** envp)
+{
+    PM_LogInfo("Starting test for Image/BMP");
+    PM_TestRandomSeed(21);
+
+    PM_LogInfo("Testing Image/BMP/PM_ImageBMPReadFromMemory on uncompressed and bit field images");
+    PM__TestReadUncompressed(2000);
+
+    PM_LogInfo("Testing Image/BMP/PM_ImageBMPReadFromMemory on RLE8 deltas");
+    PM__TestReadRLE8();
+
+    PM_LogInfo("Testing Image/BMP/PM_ImageBMPWriteToMemoryEx round trips");
+    PM__TestWriteRoundTrip(600);
+
+    PM_LogInfo("Testing Image/BMP/PM_ImageBMPReadFromMemory on an oversized RLE8 image");
+    PM__TestReadOversized();
+
+    return PM_TestFinish("Image/BMP");
+}
@@ -0,0 +1,336 @@
+#include "libpicomedia/libpicomedia.h"
+#include "test_utils.h"
+
+#define TEST_MAX_ROW_SIZE   1024
+
+// Adam7 interlacing passes, { xStart, yStart, xStep, yStep }
+static const PM_UInt32 PM_TEST_ADAM7_PASSES[7][4] = {
+    { 0, 0, 8, 8 }, { 4, 0, 8, 8 }, { 0, 4, 4, 8 }, { 2, 0, 4, 4 }, { 0, 2, 2, 4 }, { 1, 0, 2, 2 }, { 0, 1, 1, 2 }
+};
+
+static PM_UInt8 PM__TestPaeth(PM_Int32 a, PM_Int32 b, PM_Int32 c)
+{
+    PM_Int32 p = a + b - c;
+    PM_Int32 pa = p > a ? p - a : a - p;
+    PM_Int32 pb = p > b ? p - b : b - p;
+    PM_Int32 pc = p > c ? p - c : c - p;
+    if (pa <= pb && pa <= pc)
+        return (PM_UInt8)a;
+    return (PM_UInt8)(pb <= pc ? b : c);
+}
+
+// Applies a filter to a scanline, the reverse of what the decoder does
+static void PM__TestFilterScanline(PM_UInt8 filterType, PM_UInt8* dst, const PM_UInt8* row, const PM_UInt8* prev, PM_Size rowSize,
+                                   PM_Size bytesPerPixel)
+{
+    for (PM_Size i = 0; i < rowSize; i++)
+    {
+        PM_Int32 a = i >= bytesPerPixel ? row[i - bytesPerPixel] : 0;
+        PM_Int32 b = prev != NULL ? prev[i] : 0;
+        PM_Int32 c = (prev != NULL && i >= bytesPerPixel) ? prev[i - bytesPerPixel] : 0;
+        PM_Int32 predictor = 0;
+        switch (filterType)
+        {
+        case PICOMEDIA_PNG_FILTER_SUB: predictor = a; break;
+        case PICOMEDIA_PNG_FILTER_UP: predictor = b; break;
+        case PICOMEDIA_PNG_FILTER_AVERAGE: predictor = (a + b) / 2; break;
+        case PICOMEDIA_PNG_FILTER_PAETH: predictor = PM__TestPaeth(a, b, c); break;
+        default: break;
+        }
+        dst[i] = (PM_UInt8)(row[i] - predictor);
+    }
+}
+
+// The dispatched unfilter must match the scalar one for every filter, pixel size, length and alignment,
+// also when unfiltering in place or into a destination that starts before the source
+static void PM__TestUnfilterScanline(PM_Size iterations)
+{
+    PM_UInt8* src = (PM_UInt8*)PM_Malloc(TEST_MAX_ROW_SIZE + 64);
+    PM_UInt8* prev = (PM_UInt8*)PM_Malloc(TEST_MAX_ROW_SIZE + 64);
+    PM_UInt8* expected = (PM_UInt8*)PM_Malloc(TEST_MAX_ROW_SIZE + 64);
+    PM_UInt8* output = (PM_UInt8*)PM_Malloc(TEST_MAX_ROW_SIZE + 64);
+
+    for (PM_Size iteration = 0; iteration < iterations; iteration++)
+    {
+        PM_UInt8 filterType = (PM_UInt8)(iteration % 5);
+        PM_Size bytesPerPixel = 1 + PM_TestRandomRange(8);
+        PM_Size rowSize = iteration < 500 ? iteration % 100 : PM_TestRandomRange(TEST_MAX_ROW_SIZE);
+        PM_Size offset = PM_TestRandomRange(32);
+        PM_Bool hasPrevious = PM_TestRandomRange(4) != 0;
+        PM_TestRandomFill(src, TEST_MAX_ROW_SIZE + 64);
+        PM_TestRandomFill(prev, TEST_MAX_ROW_SIZE + 64);
+        const PM_UInt8* previous = hasPrevious ? prev + PM_TestRandomRange(32) : NULL;
+
+        PM_TestCheck(PM_ImagePNGUnfilterScanlineScalar(filterType, expected, src + offset, previous, rowSize, bytesPerPixel));
+
+        PM_Size outputOffset = PM_TestRandomRange(32);
+        PM_TestCheck(PM_ImagePNGUnfilterScanline(filterType, output + outputOffset, src + offset, previous, rowSize, bytesPerPixel));
+        PM_Bool passed = PM_TestCheck(PM_Memcmp(output + outputOffset, expected, rowSize) == 0);
+
+        // in place, the decoder strips the filter bytes by writing each row one byte before its source
+        PM_Size shift = PM_TestRandomRange(3);
+        PM_Memcpy(output + offset + shift, src + offset, rowSize);
+        PM_TestCheck(PM_ImagePNGUnfilterScanline(filterType, output + offset, output + offset + shift, previous, rowSize, bytesPerPixel));
+        passed &= PM_TestCheck(PM_Memcmp(output + offset, expected, rowSize) == 0);
+
+        if (!passed)
+            PM_LogInfo("PNG unfilter %u of %zu bytes with %zu bytes per pixel does not match", filterType, rowSize, bytesPerPixel);
+    }
+
+    PM_TestCheck(!PM_ImagePNGUnfilterScanline(5, output, src, prev, 16, 4));
+    PM_TestCheck(!PM_ImagePNGUnfilterScanlineScalar(5, output, src, prev, 16, 4));
+
+    PM_Free(output);
+    PM_Free(expected);
+    PM_Free(prev);
+    PM_Free(src);
+}
+
+// Random images of every color type, bit depth and interlace method, encoded with random filters and decoded
+static void PM__TestReadRandom(PM_Size iterations)
+{
+    static const PM_UInt8 colorTypes[5] = { 0, 2, 3, 4, 6 };
+    static const PM_UInt8 inChannelCounts[7] = { 1, 0, 3, 1, 2, 0, 4 };
+
+    for (PM_Size iteration = 0; iteration < iterations; iteration++)
+    {
+        PM_UInt8 colorType = colorTypes[iteration % 5];
+        PM_UInt8 bitDepth = 8;
+        if (colorType == 0 || colorType == 3)
+            bitDepth = (PM_UInt8)(1u << PM_TestRandomRange(colorType == 0 ? 5 : 4));
+        else
+            bitDepth = PM_TestRandomRange(2) ? 8 : 16;
+        PM_UInt8 interlaceMethod = (PM_UInt8)PM_TestRandomRange(2);
+        PM_UInt32 width = 1 + (PM_UInt32)PM_TestRandomRange(iteration % 16 == 0 ? 300 : 40);
+        PM_UInt32 height = 1 + (PM_UInt32)PM_TestRandomRange(iteration % 16 == 0 ? 100 : 20);
+        PM_Bool hasTransparency = (colorType == 0 || colorType == 2 || colorType == 3) && PM_TestRandomRange(3) == 0;
+
+        PM_UInt32 inChannels = inChannelCounts[colorType];
+        PM_UInt32 maxSample = bitDepth == 16 ? 0xFFFF : (1u << bitDepth) - 1;
+        PM_UInt32 paletteSize = colorType == 3 ? 1 + (PM_UInt32)PM_TestRandomRange(maxSample + 1) : 0;
+        PM_UInt8 palette[256 * 3];
+        PM_UInt8 paletteAlpha[256];
+        PM_TestRandomFill(palette, sizeof(palette));
+        PM_Memset(paletteAlpha, 0xFF, sizeof(paletteAlpha));
+        PM_Size alphaCount = colorType == 3 ? PM_TestRandomRange(paletteSize + 1) : 0;
+        PM_TestRandomFill(paletteAlpha, alphaCount);
+
+        // the samples of every pixel, with few distinct values so the tRNS key color is hit
+        PM_Size sampleCount = (PM_Size)width * height * inChannels;
+        PM_UInt32* samples = (PM_UInt32*)PM_Malloc(sampleCount * sizeof(PM_UInt32));
+        PM_UInt32 keyColor[3] = { 0 };
+        for (PM_Size c = 0; c < 3; c++)
+            keyColor[c] = (PM_UInt32)PM_TestRandomRange(2) * maxSample;
+        for (PM_Size i = 0; i < sampleCount; i++)
+        {
+            if (colorType == 3)
+                samples[i] = (PM_UInt32)PM_TestRandomRange(paletteSize);
+            else
+                samples[i] = PM_TestRandomRange(3) == 0 ? keyColor[i % inChannels % 3] : (PM_UInt32)PM_TestRandomRange(maxSample + 1);
+        }
+
+        // expected decoded pixels, palette and low bit depth samples are expanded to 8 bits
+        PM_UInt32 outChannels = colorType == 3 ? 3 : inChannels;
+        if (hasTransparency)
+            outChannels++;
+        PM_UInt32 dataType = bitDepth == 16 ? PICOIMEDIA_IMAGE_DATA_TYPE_UINT16 : PICOIMEDIA_IMAGE_DATA_TYPE_UINT8;
+        PM_Size expectedSize = (PM_Size)width * height * outChannels * (bitDepth == 16 ? 2 : 1);
+        PM_UInt8* expected = (PM_UInt8*)PM_Malloc(expectedSize);
+        for (PM_Size pixel = 0; pixel < (PM_Size)width * height; pixel++)
+        {
+            const PM_UInt32* in = samples + pixel * inChannels;
+            PM_UInt32 values[4] = { 0 };
+            if (colorType == 3)
+            {
+                for (PM_Size c = 0; c < 3; c++)
+                    values[c] = palette[in[0] * 3 + c];
+                values[3] = paletteAlpha[in[0]];
+            }
+            else
+            {
+                PM_Bool isKey = PM_TRUE;
+                for (PM_Size c = 0; c < inChannels; c++)
+                {
+                    values[c] = bitDepth < 8 ? in[c] * 255 / maxSample : in[c];
+                    isKey &= c < 3 && in[c] == keyColor[c];
+                }
+                if (hasTransparency)
+                    values[inChannels] = isKey ? 0 : (bitDepth == 16 ? 0xFFFF : 0xFF);
+            }
+
+            for (PM_Size c = 0; c < outChannels; c++)
+            {
+                if (bitDepth == 16)
+                    ((PM_UInt16*)expected)[pixel * outChannels + c] = (PM_UInt16)values[c];
+                else
+                    expected[pixel * outChannels + c] = (PM_UInt8)values[c];
+            }
+        }
+
+        // packed and filtered scanlines of every pass
+        PM_Size bitsPerPixel = (PM_Size)inChannels * bitDepth;
+        PM_Size bytesPerPixel = PM_Max(bitsPerPixel / 8, (PM_Size)1);
+        PM_Size filteredCapacity = ((PM_Size)width * bitsPerPixel / 8 + 8) * height * 2;
+        PM_UInt8* filtered = (PM_UInt8*)PM_Malloc(filteredCapacity);
+        PM_Size maxRowSize = ((PM_Size)width * bitsPerPixel + 7) / 8;
+        PM_UInt8* rows[2] = { (PM_UInt8*)PM_Malloc(maxRowSize), (PM_UInt8*)PM_Malloc(maxRowSize) };
+        PM_Size filteredSize = 0;
+        for (PM_Size pass = 0; pass < (interlaceMethod ? 7u : 1u); pass++)
+        {
+            PM_UInt32 xStart = interlaceMethod ? PM_TEST_ADAM7_PASSES[pass][0] : 0, yStart = interlaceMethod ? PM_TEST_ADAM7_PASSES[pass][1] : 0;
+            PM_UInt32 xStep = interlaceMethod ? PM_TEST_ADAM7_PASSES[pass][2] : 1, yStep = interlaceMethod ? PM_TEST_ADAM7_PASSES[pass][3] : 1;
+            if (xStart >= width || yStart >= height)
+                continue;
+
+            PM_UInt32 passWidth = (width - xStart + xStep - 1) / xStep;
+            PM_Size rowSize = (passWidth * bitsPerPixel + 7) / 8;
+            const PM_UInt8* prev = NULL;
+            for (PM_UInt32 y = yStart; y < height; y += yStep)
+            {
+                PM_UInt8* row = rows[(y / yStep) & 1];
+                PM_Memset(row, 0, rowSize);
+                for (PM_UInt32 i = 0; i < passWidth; i++)
+                {
+                    const PM_UInt32* in = samples + ((PM_Size)y * width + xStart + i * xStep) * inChannels;
+                    for (PM_Size c = 0; c < inChannels; c++)
+                    {
+                        PM_Size bit = ((PM_Size)i * inChannels + c) * bitDepth;
+                        if (bitDepth == 16)
+                        {
+                            row[bit / 8] = (PM_UInt8)(in[c] >> 8);
+                            row[bit / 8 + 1] = (PM_UInt8)in[c];
+                        }
+                        else
+                            row[bit / 8] |= (PM_UInt8)(in[c] << (8 - bitDepth - bit % 8));
+                    }
+                }
+
+                PM_UInt8 filterType = (PM_UInt8)PM_TestRandomRange(5);
+                filtered[filteredSize++] = filterType;
+                PM__TestFilterScanline(filterType, filtered + filteredSize, row, prev, rowSize, bytesPerPixel);
+                filteredSize += rowSize;
+                prev = row;
+            }
+        }
+
+        PM_UInt8* file = (PM_UInt8*)PM_Malloc(filteredSize * 3 + 4096);
+        PM_TestBuffer buffer = { file, 0 };
+        PM_TestPutPNGHeader(&buffer, width, height, bitDepth, colorType, interlaceMethod);
+        if (colorType == 3)
+            PM_TestPutPNGChunk(&buffer, "PLTE", palette, paletteSize * 3);
+        if (hasTransparency)
+        {
+            PM_UInt8 trns[256];
+            PM_TestBuffer trnsBuffer = { trns, 0 };
+            if (colorType == 3)
+            {
+                PM_Memcpy(trns, paletteAlpha, alphaCount);
+                trnsBuffer.size = alphaCount;
+            }
+            for (PM_Size c = 0; colorType != 3 && c < inChannels; c++)
+            {
+                PM_TestPut8(&trnsBuffer, keyColor[c] >> 8);
+                PM_TestPut8(&trnsBuffer, keyColor[c] & 0xFF);
+            }
+            PM_TestPutPNGChunk(&buffer, "tRNS", trns, trnsBuffer.size);
+        }
+        PM_TestPutPNGImageData(&buffer, filtered, filteredSize);
+        PM_TestPutPNGChunk(&buffer, "IEND", NULL, 0);
+
+        PM_Image image;
+        PM_ImageInit(&image);
+        if (PM_TestCheck(PM_ImagePNGReadFromMemory((PM_Byte*)file, buffer.size, &image)))
+        {
+            if (!PM_TestCheck(image.width == width && image.height == height && image.numChannels == outChannels &&
+                              image.dataType == dataType && PM_Memcmp(image.data, expected, expectedSize) == 0))
+                PM_LogInfo("PNG of color type %u, %u bits, interlace %u, %ux%u%s does not match", colorType, bitDepth,
+                           interlaceMethod, width, height, hasTransparency ? " with tRNS" : "");
+        }
+        PM_ImageDestroy(&image);
+
+        PM_Free(file);
+        PM_Free(rows[1]);
+        PM_Free(rows[0]);
+        PM_Free(filtered);
+        PM_Free(expected);
+        PM_Free(samples);
+    }
+}
+
+// Headers whose dimensions are out of range, or whose decoded size overflows, must be rejected before the
+// image data is allocated
+static void PM__TestReadOversized()
+{
+    static const PM_UInt32 dimensions[3][2] = { { 65536, 21846 }, { 0x80000000u, 1 }, { 1, 0x80000000u } };
+    static const PM_UInt8 palette[6] = { 0, 0, 0, 255, 255, 255 };
+    static const PM_UInt8 rows[8] = { 0, 0xFF, 0, 0x0F, 1, 0xAA, 0, 0 };
+
+    for (PM_Size i = 0; i < 3; i++)
+    {
+        PM_UInt8 file[256];
+        PM_TestBuffer buffer = { file, 0 };
+        PM_TestPutPNGHeader(&buffer, dimensions[i][0], dimensions[i][1], 1, 3, 0);
+        PM_TestPutPNGChunk(&buffer, "PLTE", palette, sizeof(palette));
+        PM_TestPutPNGImageData(&buffer, rows, sizeof(rows));
+        PM_TestPutPNGChunk(&buffer, "IEND", NULL, 0);
+
+        PM_Image image;
+        PM_ImageInit(&image);
+        PM_TestCheck(!PM_ImagePNGReadFromMemory((PM_Byte*)file, buffer.size, &image));
+        PM_ImageDestroy(&image);
+
+        PM_ImageInfo info;
+        PM_Bool isProbed = PM_ImageProbeFromMemory((PM_Byte*)file, buffer.size, &info);
+        PM_TestCheck(i == 0 ? isProbed && info.decodedSize > PICOMEDIA_IMAGE_MAX_DATA_SIZE : !isProbed);
+    }
+}
+
+// A palette index past the end of a palette shorter than the bit depth allows is rejected
+static void PM__TestReadPaletteIndex()
+{
+    static const PM_UInt8 palette[9] = { 10, 20, 30, 40, 50, 60, 70, 80, 90 };
+    // one row of four 2-bit indices, the last one past the palette in the first image
+    static const PM_UInt8 rows[2][2] = { { 0, 0x1B }, { 0, 0x1A } };
+
+    for (PM_Size i = 0; i < 2; i++)
+    {
+        PM_UInt8 file[256];
+        PM_TestBuffer buffer = { file, 0 };
+        PM_TestPutPNGHeader(&buffer, 4, 1, 2, 3, 0);
+        PM_TestPutPNGChunk(&buffer, "PLTE", palette, sizeof(palette));
+        PM_TestPutPNGImageData(&buffer, rows[i], sizeof(rows[i]));
+        PM_TestPutPNGChunk(&buffer, "IEND", NULL, 0);
+
+        PM_Image image;
+        PM_ImageInit(&image);
+        PM_Bool isRead = PM_ImagePNGReadFromMemory((PM_Byte*)file, buffer.size, &image);
+        if (i == 0)
+            PM_TestCheck(!isRead);
+        else if (PM_TestCheck(isRead))
+        {
+            static const PM_UInt8 expected[12] = { 10, 20, 30, 40, 50, 60, 70, 80, 90, 70, 80, 90 };
+            PM_TestCheck(image.numChannels == 3 && PM_Memcmp(image.data, expected, sizeof(expected)) == 0);
+        }
+        PM_ImageDestroy(&image);
+    }
+}
+
+int main(int argc, char** argv, char** envp)
+{
+    PM_LogInfo("Starting test for Image/PNG");
+    PM_TestRandomSeed(2);
+
+    PM_LogInfo("Testing Image/PNG/PM_ImagePNGUnfilterScanline against the scalar implementation");
+    PM__TestUnfilterScanline(5000);
+
+    PM_LogInfo("Testing Image/PNG/PM_ImagePNGReadFromMemory on random images");
+    PM__TestReadRandom(500);
+
+    PM_LogInfo("Testing Image/PNG/PM_ImagePNGReadFromMemory on oversized images");
+    PM__TestReadOversized();
+
+    PM_LogInfo("Testing Image/PNG/PM_ImagePNGReadFromMemory on out of range palette indices");
+    PM__TestReadPaletteIndex();
+
+    return PM_TestFinish("Image/PNG");
+}
@@ -0,0 +1,264 @@
+#include "libpicomedia/libpicomedia.h"
+#include "test_utils.h"
+
+#define TEST_TEXT_SIZE      4096
+#define TEST_MAX_VALUES     2048
+
+// Random P3 text, mostly valid numbers separated by whitespace and comments, with the odd invalid
+// character or number that does not fit in 16 bits
+static PM_Size PM__TestRandomASCII(PM_UInt8* text, PM_Size maxSize)
+{
+    static const PM_Char whitespace[] = " \t\r\n\v\f";
+    PM_Size size = 0;
+    PM_Bool isInvalid = PM_TestRandomRange(8) == 0;
+
+    while (size + 24 < maxSize)
+    {
+        PM_Size kind = PM_TestRandomRange(20);
+        if (kind == 0)
+        {
+            text[size++] = '#';
+            for (PM_Size length = PM_TestRandomRange(30); length > 0; length--)
+                text[size++] = (PM_UInt8)(' ' + PM_TestRandomRange(95));
+            text[size++] = PM_TestRandomRange(2) ? '\n' : '\r';
+        }
+        else if (kind == 1 && isInvalid)
+        {
+            text[size++] = (PM_UInt8)(PM_TestRandomRange(2) ? 'a' + PM_TestRandomRange(26) : PM_TestRandomRange(256));
+        }
+        else
+        {
+            // values of every length, up to a few digits past 65535
+            PM_UInt32 value = (PM_UInt32)(PM_TestRandom() >> (44 + PM_TestRandomRange(20)));
+            if (!isInvalid)
+                value %= 65536;
+            PM_Size start = size;
+            do
+            {
+                text[size++] = (PM_UInt8)('0' + value % 10);
+                value /= 10;
+            } while (value > 0);
+            for (PM_Size i = 0; i < (size - start) / 2; i++)
+            {
+                PM_UInt8 digit = text[start + i];
+                text[start + i] = text[size - 1 - i];
+                text[size - 1 - i] = digit;
+            }
+        }
+
+        for (PM_Size length = 1 + PM_TestRandomRange(PM_TestRandomRange(4) == 0 ? 20 : 2); length > 0; length--)
+            text[size++] = (PM_UInt8)whitespace[PM_TestRandomRange(6)];
+    }
+
+    return size;
+}
+
+// The dispatched parser must match the scalar one for every split of the text, including the numbers and
+// comments cut by the end of a block
+static void PM__TestParseASCII(PM_Size iterations)
+{
+    PM_UInt8* text = (PM_UInt8*)PM_Malloc(TEST_TEXT_SIZE);
+    PM_UInt16* values = (PM_UInt16*)PM_Malloc(TEST_MAX_VALUES * sizeof(PM_UInt16));
+    PM_UInt16* expectedValues = (PM_UInt16*)PM_Malloc(TEST_MAX_VALUES * sizeof(PM_UInt16));
+
+    for (PM_Size iteration = 0; iteration < iterations; iteration++)
+    {
+        PM_Size textSize = PM__TestRandomASCII(text, 32 + PM_TestRandomRange(TEST_TEXT_SIZE - 32));
+        PM_Size offset = PM_TestRandomRange(16);
+        PM_Size size = PM_TestRandomRange(textSize - offset + 1);
+        PM_Bool isLastBlock = PM_TestRandomRange(2) == 1;
+        PM_Size maxValues = PM_TestRandomRange(4) == 0 ? PM_TestRandomRange(40) : TEST_MAX_VALUES;
+
+        PM_Size consumed = 0, parsed = 0, expectedConsumed = 0, expectedParsed = 0;
+        PM_Bool result = PM_ImagePPMParseASCII(text + offset, size, isLastBlock, values, maxValues, &consumed, &parsed);
+        PM_Bool expectedResult = PM_ImagePPMParseASCIIScalar(text + offset, size, isLastBlock, expectedValues, maxValues,
+                                                             &expectedConsumed, &expectedParsed);
+
+        if (!PM_TestCheck(result == expectedResult && consumed == expectedConsumed && parsed == expectedParsed &&
+                          PM_Memcmp(values, expectedValues, parsed * sizeof(PM_UInt16)) == 0))
+            PM_LogInfo("PPM ASCII parse of %zu bytes at offset %zu (last block %d, %zu values) does not match", size, offset,
+                       (int)isLastBlock, maxValues);
+    }
+
+    PM_Free(expectedValues);
+    PM_Free(values);
+    PM_Free(text);
+}
+
+// Formatted values must parse back to themselves
+static void PM__TestFormatASCII(PM_Size iterations)
+{
+    PM_UInt16* values = (PM_UInt16*)PM_Malloc(TEST_MAX_VALUES * sizeof(PM_UInt16));
+    PM_UInt8* values8 = (PM_UInt8*)PM_Malloc(TEST_MAX_VALUES);
+    PM_UInt16* parsedValues = (PM_UInt16*)PM_Malloc(TEST_MAX_VALUES * sizeof(PM_UInt16));
+    PM_Char* text = (PM_Char*)PM_Malloc(TEST_MAX_VALUES * PICOMEDIA_PPM_ASCII_MAX_VALUE_SIZE);
+
+    for (PM_Size iteration = 0; iteration < iterations; iteration++)
+    {
+        PM_Bool is16Bit = iteration % 2 == 0;
+        PM_Size count = PM_TestRandomRange(TEST_MAX_VALUES + 1);
+        for (PM_Size i = 0; i < count; i++)
+        {
+            values[i] = (PM_UInt16)(PM_TestRandom() >> (48 + PM_TestRandomRange(16)));
+            values8[i] = (PM_UInt8)values[i];
+        }
+        if (!is16Bit)
+        {
+            for (PM_Size i = 0; i < count; i++)
+                values[i] = values8[i];
+        }
+
+        PM_Size textSize = PM_ImagePPMFormatASCII(is16Bit ? (const PM_Byte*)values : (const PM_Byte*)values8,
+                                                  is16Bit ? PICOIMEDIA_IMAGE_DATA_TYPE_UINT16 : PICOIMEDIA_IMAGE_DATA_TYPE_UINT8,
+                                                  count, text);
+        PM_TestCheck(textSize <= count * PICOMEDIA_PPM_ASCII_MAX_VALUE_SIZE);
+
+        PM_Size consumed = 0, parsed = 0;
+        PM_TestCheck(PM_ImagePPMParseASCII((const PM_UInt8*)text, textSize, PM_TRUE, parsedValues, TEST_MAX_VALUES, &consumed, &parsed));
+        PM_TestCheck(consumed == textSize && parsed == count);
+        PM_TestCheck(PM_Memcmp(parsedValues, values, count * sizeof(PM_UInt16)) == 0);
+    }
+
+    PM_Free(text);
+    PM_Free(parsedValues);
+    PM_Free(values8);
+    PM_Free(values);
+}
+
+// 8 and 16-bit images written as P3 and P6 and read back
+static void PM__TestRoundTrip(PM_Size iterations)
+{
+    for (PM_Size iteration = 0; iteration < iterations; iteration++)
+    {
+        PM_UInt32 format = iteration % 2 == 0 ? PICOMEDIA_PPM_FORMAT_P3 : PICOMEDIA_PPM_FORMAT_P6;
+        PM_UInt32 dataType = iteration % 4 < 2 ? PICOIMEDIA_IMAGE_DATA_TYPE_UINT8 : PICOIMEDIA_IMAGE_DATA_TYPE_UINT16;
+        PM_UInt32 width = 1 + (PM_UInt32)PM_TestRandomRange(iteration % 16 == 0 ? 700 : 60);
+        PM_UInt32 height = 1 + (PM_UInt32)PM_TestRandomRange(iteration % 16 == 0 ? 300 : 20);
+
+        PM_Image image;
+        PM_ImageInit(&image);
+        PM_ImageAllocate(&image, width, height, PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGB, dataType, 3);
+        PM_TestRandomFill(image.data, image.dataSize);
+
+        PM_Size capacity = 64 + image.dataSize / PM_ImageGetDataTypeSize(dataType) * PICOMEDIA_PPM_ASCII_MAX_VALUE_SIZE;
+        PM_Byte* data = (PM_Byte*)PM_Malloc(capacity);
+        PM_Size dataSize = 0;
+        PM_Image decoded;
+        PM_ImageInit(&decoded);
+        if (PM_TestCheck(PM_ImagePPMWriteToMemory(format, &image, data, &dataSize, capacity)) &&
+            PM_TestCheck(PM_ImagePPMReadFromMemory(data, dataSize, &decoded)))
+        {
+            if (!PM_TestCheck(decoded.width == width && decoded.height == height && decoded.dataType == dataType &&
+                              decoded.numChannels == 3 && PM_Memcmp(decoded.data, image.data, image.dataSize) == 0))
+                PM_LogInfo("%s round trip of a %ux%u %s image does not match", PM_ImagePPMFormatToString(format), width, height,
+                           PM_ImageDataTypeToString(dataType));
+        }
+
+        PM_ImageDestroy(&decoded);
+        PM_ImageDestroy(&image);
+        PM_Free(data);
+    }
+}
+
+// The P6 samples of max color values below 255 and 65535 are scaled to the full range, and invalid headers are rejected
+static void PM__TestReadHeaders()
+{
+    PM_Byte scaled8[] = { 'P', '6', '\n', '#', ' ', 'c', '\n', '2', ' ', '1', '\n', '1', '0', '0', '\n', 0, 50, 100, 7, 99, 100 };
+    PM_Image image;
+    PM_ImageInit(&image);
+    if (PM_TestCheck(PM_ImagePPMReadFromMemory(scaled8, sizeof(scaled8), &image)))
+    {
+        static const PM_UInt8 expected[6] = { 0, 128, 255, 18, 252, 255 };
+        PM_TestCheck(image.width == 2 && image.height == 1 && image.dataType == PICOIMEDIA_IMAGE_DATA_TYPE_UINT8);
+        PM_TestCheck(PM_Memcmp(image.data, expected, sizeof(expected)) == 0);
+    }
+    PM_ImageDestroy(&image);
+
+    PM_Byte scaled16[] = { 'P', '6', ' ', '1', ' ', '1', ' ', '1', '0', '0', '0', '\n', 0x01, (PM_Byte)0xF4, 0x00, 0x00, 0x03, (PM_Byte)0xE8 };
+    PM_ImageInit(&image);
+    if (PM_TestCheck(PM_ImagePPMReadFromMemory(scaled16, sizeof(scaled16), &image)))
+    {
+        const PM_UInt16* samples = (const PM_UInt16*)image.data;
+        PM_TestCheck(image.dataType == PICOIMEDIA_IMAGE_DATA_TYPE_UINT16);
+        PM_TestCheck(samples[0] == 32768 && samples[1] == 0 && samples[2] == 65535);
+    }
+    PM_ImageDestroy(&image);
+
+    static const PM_Char* invalidHeaders[4] = { "P6\n0 5\n255\n", "P6\n5 0\n255\n", "P3\n1 1\n0\n0 0 0\n", "P3\n1 1\n70000\n0 0 0\n" };
+    for (PM_Size i = 0; i < 4; i++)
+    {
+        PM_Byte data[32];
+        PM_Size size = 0;
+        while (invalidHeaders[i][size] != 0)
+        {
+            data[size] = invalidHeaders[i][size];
+            size++;
+        }
+
+        PM_ImageInfo info;
+        PM_ImageInit(&image);
+        PM_TestCheck(!PM_ImagePPMReadFromMemory(data, size, &image));
+        PM_TestCheck(!PM_ImageProbeFromMemory(data, size, &info));
+        PM_ImageDestroy(&image);
+    }
+}
+
+// Headers with dimensions too large to decode, out of range or with data cut short are rejected before anything
+// is allocated for the image
+static void PM__TestReadOversized()
+{
+    static const PM_Char* oversized[2] = { "P3\n200000 200000\n255\n1 2 3", "P6\n200000 200000\n255\n123" };
+    for (PM_Size i = 0; i < 2; i++)
+    {
+        PM_Byte data[32];
+        PM_Size size = strlen(oversized[i]);
+        PM_Memcpy(data, oversized[i], size);
+
+        PM_ImageInfo info;
+        PM_TestCheck(PM_ImageProbeFromMemory(data, size, &info));
+        PM_TestCheck(info.width == 200000 && info.height == 200000 && info.decodedSize > PICOMEDIA_IMAGE_MAX_DATA_SIZE);
+
+        PM_Image image;
+        PM_ImageInit(&image);
+        PM_TestCheck(!PM_ImagePPMReadFromMemory(data, size, &image));
+        PM_TestCheck(image.data == NULL);
+        PM_ImageDestroy(&image);
+    }
+
+    static const PM_Char* invalid[4] = { "P6\n-1 1\n255\n123", "P3\n1 4294967296\n255\n1 2 3", "P6\n4 4\n255\n123", "P6\n1 1\n65535\n12345" };
+    for (PM_Size i = 0; i < 4; i++)
+    {
+        PM_Byte data[32];
+        PM_Size size = strlen(invalid[i]);
+        PM_Memcpy(data, invalid[i], size);
+
+        PM_Image image;
+        PM_ImageInit(&image);
+        PM_TestCheck(!PM_ImagePPMReadFromMemory(data, size, &image));
+        PM_TestCheck(image.data == NULL);
+        PM_ImageDestroy(&image);
+    }
+}
+
+int main(int argc, char** argv, char** envp)
+{
+    PM_LogInfo("Starting test for Image/PPM");
+    PM_TestRandomSeed(8);
+
+    PM_LogInfo("Testing Image/PPM/PM_ImagePPMParseASCII against the scalar implementation");
+    PM__TestParseASCII(3000);
+
+    PM_LogInfo("Testing Image/PPM/PM_ImagePPMFormatASCII");
+    PM__TestFormatASCII(200);
+
+    PM_LogInfo("Testing Image/PPM/PM_ImagePPMWriteToMemory,PM_ImagePPMReadFromMemory round trips");
+    PM__TestRoundTrip(200);
+
+    PM_LogInfo("Testing Image/PPM/PM_ImagePPMReadFromMemory headers");
+    PM__TestReadHeaders();
+
+    PM_LogInfo("Testing Image/PPM/PM_ImagePPMReadFromMemory on oversized images");
+    PM__TestReadOversized();
+
+    return PM_TestFinish("Image/PPM");
+}
@@ -0,0 +1,183 @@
+#include "libpicomedia/libpicomedia.h"
+#include "test_utils.h"
+
+#include <stdio.h>
+
+#define TEST_FILE_NAME      "image_probe_test.bmp"
+
+typedef PM_Bool (*PM__TestReadFunction)(PM_Byte* data, PM_Size dataSize, PM_Image* image);
+
+// The probed description must be the one of the decoded image. The probe of a PNG stops at IHDR, so it does not
+// see the alpha channel a tRNS chunk adds, but its decoded size is an upper bound that accounts for it
+static void PM__TestProbeMatchesRead(PM_Byte* data, PM_Size dataSize, PM__TestReadFunction read, PM_UInt32 fileFormat,
+                                     PM_UInt8 addedChannels)
+{
+    PM_ImageInfo info;
+    PM_Image image;
+    PM_ImageInit(&image);
+    if (!PM_TestCheck(PM_ImageProbeFromMemory(data, dataSize, &info)) || !PM_TestCheck(read(data, dataSize, &image)))
+    {
+        PM_ImageDestroy(&image);
+        return;
+    }
+
+    PM_Bool passed = PM_TestCheck(info.fileFormat == fileFormat);
+    passed &= PM_TestCheck(info.width == image.width && info.height == image.height);
+    passed &= PM_TestCheck(info.numChannels + addedChannels == image.numChannels);
+    passed &= PM_TestCheck(addedChannels > 0 || info.channelFormat == image.channelFormat);
+    passed &= PM_TestCheck(info.dataType == image.dataType && info.bitsPerChannel == image.bitsPerChannel);
+    if (fileFormat == PICOMEDIA_IMAGE_FILE_FORMAT_PNG)
+        passed &= PM_TestCheck(info.decodedSize >= image.dataSize);
+    else
+        passed &= PM_TestCheck(info.decodedSize == image.dataSize);
+
+    if (!passed)
+        PM_LogInfo("Probe of a %ux%u %s image does not match its decoded image", image.width, image.height,
+                   PM_ImageFileFormatToString(fileFormat));
+    PM_ImageDestroy(&image);
+}
+
+// A PNG with unfiltered random scanlines
+static PM_Size PM__TestBuildPNG(PM_UInt8* file, PM_UInt32 width, PM_UInt32 height, PM_UInt8 bitDepth, PM_UInt8 colorType,
+                                PM_Bool hasTransparency)
+{
+    static const PM_UInt8 channelCounts[7] = { 1, 0, 3, 1, 2, 0, 4 };
+    PM_TestBuffer buffer = { file, 0 };
+    PM_TestPutPNGHeader(&buffer, width, height, bitDepth, colorType, 0);
+
+    // every index of a 256 color palette is valid, whatever the random data
+    PM_UInt8 chunk[256 * 3];
+    PM_TestRandomFill(chunk, sizeof(chunk));
+    if (colorType == 3)
+        PM_TestPutPNGChunk(&buffer, "PLTE", chunk, sizeof(chunk));
+    if (hasTransparency)
+        PM_TestPutPNGChunk(&buffer, "tRNS", chunk, colorType == 3 ? 16 : (colorType == 2 ? 6 : 2));
+
+    PM_Size rowSize = ((PM_Size)width * channelCounts[colorType] * bitDepth + 7) / 8;
+    PM_Size rawSize = (rowSize + 1) * height;
+    PM_UInt8* raw = (PM_UInt8*)PM_Malloc(rawSize);
+    PM_TestRandomFill(raw, rawSize);
+    for (PM_Size y = 0; y < height; y++)
+        raw[y * (rowSize + 1)] = PICOMEDIA_PNG_FILTER_NONE;
+    PM_TestPutPNGImageData(&buffer, raw, rawSize);
+    PM_Free(raw);
+
+    PM_TestPutPNGChunk(&buffer, "IEND", NULL, 0);
+    return buffer.size;
+}
+
+static void PM__TestProbeBMP()
+{
+    static const PM_UInt32 formats[3] = { PICOMEDIA_BMP_FORMAT_BGR24, PICOMEDIA_BMP_FORMAT_BGRA32, PICOMEDIA_BMP_FORMAT_RLE8 };
+    for (PM_Size i = 0; i < 3; i++)
+    {
+        PM_Bool hasAlpha = formats[i] == PICOMEDIA_BMP_FORMAT_BGRA32;
+        PM_Image image;
+        PM_ImageInit(&image);
+        PM_ImageAllocate(&image, 37, 11, hasAlpha ? PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGBA : PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGB,
+                         PICOIMEDIA_IMAGE_DATA_TYPE_UINT8, hasAlpha ? 4 : 3);
+        // few colors, so the palette formats can be written
+        for (PM_Size j = 0; j < image.dataSize; j++)
+            image.data[j] = (PM_Byte)(PM_TestRandomRange(4) * 60);
+
+        PM_Byte data[8192];
+        PM_Size dataSize = 0;
+        if (PM_TestCheck(PM_ImageBMPWriteToMemoryEx(&image, data, &dataSize, sizeof(data), formats[i])))
+            PM__TestProbeMatchesRead(data, dataSize, PM_ImageBMPReadFromMemory, PICOMEDIA_IMAGE_FILE_FORMAT_BMP, 0);
+
+        // the file probe reads the same header through a buffered stream
+        if (i == 0)
+        {
+            FILE* file = fopen(TEST_FILE_NAME, "wb");
+            if (PM_TestCheck(file != NULL))
+            {
+                fwrite(data, 1, dataSize, file);
+                fclose(file);
+            }
+
+            PM_ImageInfo memoryInfo, fileInfo;
+            PM_TestCheck(PM_ImageProbeFromMemory(data, dataSize, &memoryInfo));
+            PM_TestCheck(PM_ImageProbeFromFile(TEST_FILE_NAME, &fileInfo));
+            PM_TestCheck(memoryInfo.fileFormat == fileInfo.fileFormat && memoryInfo.width == fileInfo.width &&
+                         memoryInfo.height == fileInfo.height && memoryInfo.numChannels == fileInfo.numChannels &&
+                         memoryInfo.decodedSize == fileInfo.decodedSize);
+            remove(TEST_FILE_NAME);
+        }
+
+        PM_ImageDestroy(&image);
+    }
+}
+
+static void PM__TestProbePPM()
+{
+    for (PM_Size i = 0; i < 4; i++)
+    {
+        PM_UInt32 format = i % 2 == 0 ? PICOMEDIA_PPM_FORMAT_P3 : PICOMEDIA_PPM_FORMAT_P6;
+        PM_UInt32 dataType = i < 2 ? PICOIMEDIA_IMAGE_DATA_TYPE_UINT8 : PICOIMEDIA_IMAGE_DATA_TYPE_UINT16;
+        PM_Image image;
+        PM_ImageInit(&image);
+        PM_ImageAllocate(&image, 23, 9, PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGB, dataType, 3);
+        PM_TestRandomFill(image.data, image.dataSize);
+
+        PM_Byte data[8192];
+        PM_Size dataSize = 0;
+        if (PM_TestCheck(PM_ImagePPMWriteToMemory(format, &image, data, &dataSize, sizeof(data))))
+            PM__TestProbeMatchesRead(data, dataSize, PM_ImagePPMReadFromMemory, PICOMEDIA_IMAGE_FILE_FORMAT_PPM, 0);
+        PM_ImageDestroy(&image);
+    }
+}
+
+static void PM__TestProbePNG()
+{
+    static const PM_UInt8 formats[9][3] = { { 0, 1, 0 }, { 0, 8, 1 }, { 0, 16, 0 }, { 2, 8, 0 }, { 2, 16, 1 },
+                                            { 3, 4, 0 }, { 3, 8, 1 }, { 4, 8, 0 }, { 6, 16, 0 } };
+    PM_UInt8* file = (PM_UInt8*)PM_Malloc(16384);
+    for (PM_Size i = 0; i < 9; i++)
+    {
+        PM_Size size = PM__TestBuildPNG(file, 19, 13, formats[i][1], formats[i][0], formats[i][2]);
+        PM__TestProbeMatchesRead((PM_Byte*)file, size, PM_ImagePNGReadFromMemory, PICOMEDIA_IMAGE_FILE_FORMAT_PNG, formats[i][2]);
+    }
+    PM_Free(file);
+}
+
+// Unknown formats and headers cut short are rejected
+static void PM__TestProbeInvalid()
+{
+    static const PM_Char* inputs[8] = { "B", "BM", "P6", "P6\n12", "P3 4", "GIF89a", "\x89PNG\r\n\x1A\n", "\x89PNG\r\n\x1A\n\0\0\0\x0DIHDR\0\0" };
+    static const PM_Size sizes[8] = { 1, 2, 2, 5, 4, 6, 8, 18 };
+
+    PM_Byte junk[512];
+    PM_TestRandomFill(junk, sizeof(junk));
+    junk[0] = 'x';
+
+    PM_ImageInfo info;
+    PM_TestCheck(!PM_ImageProbeFromMemory(junk, sizeof(junk), &info));
+    PM_TestCheck(info.fileFormat == PICOMEDIA_IMAGE_FILE_FORMAT_UNKNOWN && info.width == 0 && info.height == 0);
+
+    for (PM_Size i = 0; i < 8; i++)
+    {
+        PM_Byte data[32];
+        PM_Memcpy(data, inputs[i], sizes[i]);
+        PM_TestCheck(!PM_ImageProbeFromMemory(data, sizes[i], &info));
+    }
+}
+
+int main(int argc, char** argv, char** envp)
+{
+    PM_LogInfo("Starting test for Image/Probe");
+    PM_TestRandomSeed(25);
+
+    PM_LogInfo("Testing Image/Probe/PM_ImageProbeFromMemory,PM_ImageProbeFromFile on BMP images");
+    PM__TestProbeBMP();
+
+    PM_LogInfo("Testing Image/Probe/PM_ImageProbeFromMemory on PPM images");
+    PM__TestProbePPM();
+
+    PM_LogInfo("Testing Image/Probe/PM_ImageProbeFromMemory on PNG images");
+    PM__TestProbePNG();
+
+    PM_LogInfo("Testing Image/Probe/PM_ImageProbeFromMemory on invalid data");
+    PM__TestProbeInvalid();
+
+    return PM_TestFinish("Image/Probe");
+}
@@ -0,0 +1,701 @@
+#include "libpicomedia/libpicomedia.h"
+#include "test_utils.h"
+
+#include <math.h>
+
+#define TEST_DATA_TYPE_COUNT    6
+
+enum
+{
+    TEST_CHANNEL_R,
+    TEST_CHANNEL_G,
+    TEST_CHANNEL_B,
+    TEST_CHANNEL_A,
+    TEST_CHANNEL_Y
+};
+
+static const PM_UInt32 PM__testChannelFormats[6] =
+{
+    PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGB, PICOMEDIA_IMAGE_CHANNEL_FORMAT_BGR,
+    PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGBA, PICOMEDIA_IMAGE_CHANNEL_FORMAT_BGRA,
+    PICOMEDIA_IMAGE_CHANNEL_FORMAT_GRAY, PICOMEDIA_IMAGE_CHANNEL_FORMAT_GRAYA
+};
+
+// Largest value of the integer data types, the floating point ones are normalized to 1
+static const PM_Float64 PM__testDataTypeMaximum[TEST_DATA_TYPE_COUNT] = { 255.0, 65535.0, 4294967295.0, 18446744073709551615.0, 1.0, 1.0 };
+
+static PM_UInt32 PM__TestDataType(PM_Size index)
+{
+    return PICOIMEDIA_IMAGE_DATA_TYPE_UINT8 + (PM_UInt32)index;
+}
+
+static PM_Float64 PM__TestGetSample(const void* data, PM_UInt32 dataType, PM_Size index)
+{
+    switch (dataType)
+    {
+    case PICOIMEDIA_IMAGE_DATA_TYPE_UINT8:   return ((const PM_UInt8*)data)[index];
+    case PICOIMEDIA_IMAGE_DATA_TYPE_UINT16:  return ((const PM_UInt16*)data)[index];
+    case PICOIMEDIA_IMAGE_DATA_TYPE_UINT32:  return ((const PM_UInt32*)data)[index];
+    case PICOIMEDIA_IMAGE_DATA_TYPE_UINT64:  return (PM_Float64)((const PM_UInt64*)data)[index];
+    case PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT32: return ((const PM_Float32*)data)[index];
+    default:                                 return ((const PM_Float64*)data)[index];
+    }
+}
+
+// Tolerance of a comparison of samples of a data type, the 64-bit integers go through doubles in the references
+static PM_Float64 PM__TestTolerance(PM_UInt32 dataType)
+{
+    switch (dataType)
+    {
+    case PICOIMEDIA_IMAGE_DATA_TYPE_UINT64:  return 4096.0;
+    case PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT32: return 1e-6;
+    case PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT64: return 1e-12;
+    default:                                 return 0.0;
+    }
+}
+
+// Random samples, in [0, 1] for the floating point data types
+static void PM__TestFillImage(PM_Image* image)
+{
+    PM_TestRandomFill(image->data, image->dataSize);
+    PM_Size count = (PM_Size)image->width * image->height * image->numChannels;
+    for (PM_Size i = 0; i < count; i++)
+    {
+        PM_Float64 value = (PM_Float64)PM_TestRandomRange(1000) / 999.0;
+        if (image->dataType == PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT32)
+            ((PM_Float32*)image->data)[i] = (PM_Float32)value;
+        else if (image->dataType == PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT64)
+            ((PM_Float64*)image->data)[i] = value;
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static void PM__TestConvertSamples()
+{
+    const PM_Size count = 1003;
+    PM_Byte* source = (PM_Byte*)PM_Malloc(count * 8);
+    PM_Byte* converted = (PM_Byte*)PM_Malloc(count * 8);
+
+    for (PM_Size sourceIndex = 0; sourceIndex < TEST_DATA_TYPE_COUNT; sourceIndex++)
+    {
+        PM_UInt32 sourceType = PM__TestDataType(sourceIndex);
+        PM_TestRandomFill(source, count * 8);
+        // out of range values, which are clamped when converted to integers
+        for (PM_Size i = 0; i < count; i++)
+        {
+            PM_Float64 value = (PM_Float64)PM_TestRandomRange(1400) / 1000.0 - 0.2;
+            if (sourceType == PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT32)
+                ((PM_Float32*)source)[i] = (PM_Float32)value;
+            else if (sourceType == PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT64)
+                ((PM_Float64*)source)[i] = value;
+        }
+
+        for (PM_Size destIndex = 0; destIndex < TEST_DATA_TYPE_COUNT; destIndex++)
+        {
+            PM_UInt32 destType = PM__TestDataType(destIndex);
+            if (!PM_TestCheck(PM_ImageTransformsConvertSamples(source, sourceType, converted, destType, count)))
+                continue;
+
+            PM_Float64 tolerance = PM__TestTolerance(destType);
+            if (sourceIndex >= 3 && destIndex < 4 && tolerance < 1.0)
+                tolerance = 1.0;
+
+            for (PM_Size i = 0; i < count; i++)
+            {
+                PM_Float64 value = PM__TestGetSample(source, sourceType, i);
+                PM_Float64 normalized = (sourceIndex < 4) ? value / PM__testDataTypeMaximum[sourceIndex] : value;
+                PM_Float64 expected = normalized;
+                if (destIndex < 4)
+                {
+                    normalized = PM_Min(PM_Max(normalized, 0.0), 1.0);
+                    expected = PM_Min(floor(normalized * PM__testDataTypeMaximum[destIndex] + 0.5), PM__testDataTypeMaximum[destIndex]);
+                }
+
+                PM_Float64 result = PM__TestGetSample(converted, destType, i);
+                if (!PM_TestCheck(fabs(result - expected) <= tolerance))
+                {
+                    PM_LogInfo("Sample %zu converted from %s to %s is %g, expected %g", i, PM_ImageDataTypeToString(sourceType),
+                               PM_ImageDataTypeToString(destType), result, expected);
+                    break;
+                }
+            }
+        }
+    }
+
+    PM_Free(source);
+    PM_Free(converted);
+
+    // every 16-bit value narrowed to 8 bits rounds to nearest
+    PM_UInt16* all16 = (PM_UInt16*)PM_Malloc(65536 * sizeof(PM_UInt16));
+    PM_UInt8* all8 = (PM_UInt8*)PM_Malloc(65536);
+    for (PM_Size i = 0; i < 65536; i++)
+        all16[i] = (PM_UInt16)i;
+    PM_ImageTransformsConvertSamples(all16, PICOIMEDIA_IMAGE_DATA_TYPE_UINT16, all8, PICOIMEDIA_IMAGE_DATA_TYPE_UINT8, 65536);
+    for (PM_Size i = 0; i < 65536; i++)
+    {
+        if (!PM_TestCheck(all8[i] == (PM_UInt8)floor((PM_Float64)i / 257.0 + 0.5)))
+            break;
+    }
+    PM_Free(all16);
+    PM_Free(all8);
+
+    // a large image converted in bands on the thread pool, and back
+    PM_Image image;
+    PM_ImageInit(&image);
+    PM_ImageAllocate(&image, 1000, 701, PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGBA, PICOIMEDIA_IMAGE_DATA_TYPE_UINT8, 4);
+    PM__TestFillImage(&image);
+    PM_Byte* original = (PM_Byte*)PM_Malloc(image.dataSize);
+    PM_Memcpy(original, image.data, image.dataSize);
+    PM_TestCheck(PM_ImageTransformsChangeDataType(&image, PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT32));
+    PM_TestCheck(image.dataType == PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT32 && image.dataSize == (PM_Size)1000 * 701 * 4 * 4);
+    PM_TestCheck(PM_ImageTransformsChangeDataType(&image, PICOIMEDIA_IMAGE_DATA_TYPE_UINT8));
+    PM_TestCheck(image.dataSize == (PM_Size)1000 * 701 * 4 && PM_Memcmp(image.data, original, image.dataSize) == 0);
+    PM_Free(original);
+    PM_ImageDestroy(&image);
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Size PM__TestChannelLayout(PM_UInt32 channelFormat, PM_Int32* layout)
+{
+    switch (channelFormat)
+    {
+    case PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGB:
+        layout[0] = TEST_CHANNEL_R; layout[1] = TEST_CHANNEL_G; layout[2] = TEST_CHANNEL_B;
+        return 3;
+    case PICOMEDIA_IMAGE_CHANNEL_FORMAT_BGR:
+        layout[0] = TEST_CHANNEL_B; layout[1] = TEST_CHANNEL_G; layout[2] = TEST_CHANNEL_R;
+        return 3;
+    case PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGBA:
+        layout[0] = TEST_CHANNEL_R; layout[1] = TEST_CHANNEL_G; layout[2] = TEST_CHANNEL_B; layout[3] = TEST_CHANNEL_A;
+        return 4;
+    case PICOMEDIA_IMAGE_CHANNEL_FORMAT_BGRA:
+        layout[0] = TEST_CHANNEL_B; layout[1] = TEST_CHANNEL_G; layout[2] = TEST_CHANNEL_R; layout[3] = TEST_CHANNEL_A;
+        return 4;
+    case PICOMEDIA_IMAGE_CHANNEL_FORMAT_GRAYA:
+        layout[0] = TEST_CHANNEL_Y; layout[1] = TEST_CHANNEL_A;
+        return 2;
+    default:
+        layout[0] = TEST_CHANNEL_Y;
+        return 1;
+    }
+}
+
+static PM_Int32 PM__TestFindChannel(const PM_Int32* layout, PM_Size channelCount, PM_Int32 channel)
+{
+    for (PM_Size i = 0; i < channelCount; i++)
+    {
+        if (layout[i] == channel)
+            return (PM_Int32)i;
+    }
+    return -1;
+}
+
+// Same rounding as the library, integer premultiplying rounds to nearest and unpremultiplying goes through floats
+static PM_Float64 PM__TestApplyAlpha(PM_UInt32 dataType, PM_UInt32 flags, PM_Float64 value, PM_Float64 alpha)
+{
+    PM_Float64 maximum = PM__testDataTypeMaximum[dataType - PICOIMEDIA_IMAGE_DATA_TYPE_UINT8];
+    PM_Bool isInteger = dataType < PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT32;
+
+    // the 32-bit products do not fit in a double, they are rounded in 64-bit integers
+    if (dataType == PICOIMEDIA_IMAGE_DATA_TYPE_UINT32)
+    {
+        PM_UInt64 color = (PM_UInt64)value, opacity = (PM_UInt64)alpha;
+        if (flags & PICOMEDIA_IMAGE_CONVERSION_FLAG_PREMULTIPLY_ALPHA)
+            return (PM_Float64)((color * opacity + 0x7FFFFFFF) / 0xFFFFFFFF);
+        return opacity == 0 ? 0.0 : (PM_Float64)PM_Min((color * 0xFFFFFFFF + opacity / 2) / opacity, (PM_UInt64)0xFFFFFFFF);
+    }
+
+    if (flags & PICOMEDIA_IMAGE_CONVERSION_FLAG_PREMULTIPLY_ALPHA)
+        return isInteger ? floor(value * alpha / maximum + 0.5) : value * alpha;
+
+    if (alpha == 0.0)
+        return 0.0;
+    if (!isInteger)
+        return value / alpha;
+    PM_Float32 scaled = (PM_Float32)value * ((PM_Float32)maximum / (PM_Float32)alpha) + 0.5f;
+    return floor(PM_Min(scaled, (PM_Float32)maximum));
+}
+
+static PM_Float64 PM__TestLuma(PM_UInt32 dataType, PM_Bool isRec709, PM_Float64 r, PM_Float64 g, PM_Float64 b)
+{
+    static const PM_UInt64 weights8[2][3] = { { 77, 150, 29 }, { 54, 183, 19 } };
+    static const PM_UInt64 weights16[2][3] = { { 19595, 38470, 7471 }, { 13933, 46871, 4732 } };
+    static const PM_Float64 weights[2][3] = { { 0.299, 0.587, 0.114 }, { 0.2126, 0.7152, 0.0722 } };
+
+    switch (dataType)
+    {
+    case PICOIMEDIA_IMAGE_DATA_TYPE_UINT8:
+    {
+        const PM_UInt64* w = weights8[isRec709];
+        return (PM_Float64)((w[0] * (PM_UInt64)r + w[1] * (PM_UInt64)g + w[2] * (PM_UInt64)b + 128) >> 8);
+    }
+    case PICOIMEDIA_IMAGE_DATA_TYPE_UINT16:
+    case PICOIMEDIA_IMAGE_DATA_TYPE_UINT32:
+    {
+        const PM_UInt64* w = weights16[isRec709];
+        return (PM_Float64)((w[0] * (PM_UInt64)r + w[1] * (PM_UInt64)g + w[2] * (PM_UInt64)b + 32768) >> 16);
+    }
+    case PICOIMEDIA_IMAGE_DATA_TYPE_UINT64:
+    {
+        const PM_UInt64* w = weights16[isRec709];
+        return ((PM_Float64)w[0] * r + (PM_Float64)w[1] * g + (PM_Float64)w[2] * b) / 65536.0;
+    }
+    default:
+        return weights[isRec709][0] * r + weights[isRec709][1] * g + weights[isRec709][2] * b;
+    }
+}
+
+// Converts every pair of channel formats of every data type and checks each pixel against a reference
+static void PM__TestChangeChannelFormat()
+{
+    for (PM_Size dataTypeIndex = 0; dataTypeIndex < TEST_DATA_TYPE_COUNT; dataTypeIndex++)
+    for (PM_Size sourceIndex = 0; sourceIndex < 6; sourceIndex++)
+    for (PM_Size destIndex = 0; destIndex < 6; destIndex++)
+    for (PM_Size trial = 0; trial < 8; trial++)
+    {
+        PM_UInt32 dataType = PM__TestDataType(dataTypeIndex);
+        PM_Int32 sourceLayout[4], destLayout[4];
+        PM_Size sourceChannels = PM__TestChannelLayout(PM__testChannelFormats[sourceIndex], sourceLayout);
+        PM_Size destChannels = PM__TestChannelLayout(PM__testChannelFormats[destIndex], destLayout);
+
+        // single pixels, odd widths for the vector tails and for the vectorized data types an image split in bands
+        PM_UInt32 width = 1 + (PM_UInt32)PM_TestRandomRange(70);
+        PM_UInt32 height = 1 + (PM_UInt32)PM_TestRandomRange(4);
+        if (trial == 0)
+            width = height = 1;
+        else if (trial == 7 && (dataType == PICOIMEDIA_IMAGE_DATA_TYPE_UINT8 || dataType == PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT32))
+        {
+            width = 512;
+            height = 160;
+        }
+
+        PM_UInt32 flags = PM_TestRandomRange(2) ? PICOMEDIA_IMAGE_CONVERSION_FLAG_REC709 : 0;
+        PM_Size alphaOperation = PM_TestRandomRange(3);
+        if (dataType == PICOIMEDIA_IMAGE_DATA_TYPE_UINT64)
+            alphaOperation = 0;
+        if (alphaOperation == 1)
+            flags |= PICOMEDIA_IMAGE_CONVERSION_FLAG_PREMULTIPLY_ALPHA;
+        else if (alphaOperation == 2)
+            flags |= PICOMEDIA_IMAGE_CONVERSION_FLAG_UNPREMULTIPLY_ALPHA;
+
+        PM_Image image;
+        PM_ImageInit(&image);
+        PM_ImageAllocate(&image, width, height, PM__testChannelFormats[sourceIndex], dataType, (PM_UInt8)sourceChannels);
+        PM__TestFillImage(&image);
+        // zero and full alpha values
+        if (dataType <= PICOIMEDIA_IMAGE_DATA_TYPE_UINT16)
+        {
+            for (PM_Size i = 0; i < image.dataSize; i++)
+            {
+                if (PM_TestRandomRange(16) == 0)
+                    image.data[i] = PM_TestRandomRange(2) ? 0x00 : 0xFF;
+            }
+        }
+
+        PM_Byte* original = (PM_Byte*)PM_Malloc(image.dataSize);
+        PM_Memcpy(original, image.data, image.dataSize);
+
+        if (!PM_TestCheck(PM_ImageTransformsChangeChannelFormatEx(&image, PM__testChannelFormats[destIndex], flags)))
+        {
+            PM_Free(original);
+            PM_ImageDestroy(&image);
+            continue;
+        }
+        PM_TestCheck(image.numChannels == destChannels && image.channelFormat == PM__testChannelFormats[destIndex]);
+        PM_TestCheck(image.dataSize == (PM_Size)width * height * destChannels * (image.bitsPerChannel / 8));
+
+        PM_Float64 tolerance = PM__TestTolerance(dataType);
+        PM_Int32 sourceAlpha = PM__TestFindChannel(sourceLayout, sourceChannels, TEST_CHANNEL_A);
+        PM_Size pixelCount = (PM_Size)width * height;
+        for (PM_Size pixel = 0; pixel < pixelCount; pixel++)
+        {
+            PM_Float64 samples[4];
+            for (PM_Size c = 0; c < sourceChannels; c++)
+                samples[c] = PM__TestGetSample(original, dataType, pixel * sourceChannels + c);
+            if (alphaOperation != 0 && sourceAlpha >= 0)
+            {
+                for (PM_Size c = 0; c < sourceChannels; c++)
+                {
+                    if ((PM_Int32)c != sourceAlpha)
+                        samples[c] = PM__TestApplyAlpha(dataType, flags, samples[c], samples[sourceAlpha]);
+                }
+            }
+
+            PM_Bool passed = PM_TRUE;
+            for (PM_Size c = 0; c < destChannels; c++)
+            {
+                PM_Int32 sourceChannel = PM__TestFindChannel(sourceLayout, sourceChannels, destLayout[c]);
+                PM_Float64 expected;
+                if (sourceChannel >= 0)
+                    expected = samples[sourceChannel];
+                else if (destLayout[c] == TEST_CHANNEL_A)
+                    expected = PM__testDataTypeMaximum[dataTypeIndex];
+                else if (destLayout[c] == TEST_CHANNEL_Y)
+                    expected = PM__TestLuma(dataType, (flags & PICOMEDIA_IMAGE_CONVERSION_FLAG_REC709) != 0,
+                                            samples[PM__TestFindChannel(sourceLayout, sourceChannels, TEST_CHANNEL_R)],
+                                            samples[PM__TestFindChannel(sourceLayout, sourceChannels, TEST_CHANNEL_G)],
+                                            samples[PM__TestFindChannel(sourceLayout, sourceChannels, TEST_CHANNEL_B)]);
+                else
+                    expected = samples[PM__TestFindChannel(sourceLayout, sourceChannels, TEST_CHANNEL_Y)];
+
+                PM_Float64 result = PM__TestGetSample(image.data, dataType, pixel * destChannels + c);
+                passed &= fabs(result - expected) <= tolerance * PM_Max(fabs(expected), 1.0);
+            }
+
+            if (!PM_TestCheck(passed))
+            {
+                PM_LogInfo("Pixel %zu of %s %s to %s (flags %x, %ux%u) does not match", pixel, PM_ImageDataTypeToString(dataType),
+                           PM_ImageChannelFromatToString(PM__testChannelFormats[sourceIndex]),
+                           PM_ImageChannelFromatToString(PM__testChannelFormats[destIndex]), flags, width, height);
+                break;
+            }
+        }
+
+        PM_Free(original);
+        PM_ImageDestroy(&image);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+// Flips, transposes and rotations, checked by where every pixel of the source ends up
+static void PM__TestOrientation()
+{
+    for (PM_Size operation = 0; operation < 6; operation++)
+    for (PM_Size dataTypeIndex = 0; dataTypeIndex < TEST_DATA_TYPE_COUNT; dataTypeIndex++)
+    for (PM_UInt8 channels = 1; channels <= 4; channels++)
+    for (PM_Size trial = 0; trial < 8; trial++)
+    {
+        PM_UInt32 width = 1 + (PM_UInt32)PM_TestRandomRange(150);
+        PM_UInt32 height = 1 + (PM_UInt32)PM_TestRandomRange(150);
+        if (trial % 4 == 0)
+            height = width;
+        if (trial == 1)
+            width = height = 1;
+        else if (trial == 2)
+        {
+            width = 1;
+            height = 77;
+        }
+        else if (trial == 3)
+            width = height = 257;
+
+        PM_Image image;
+        PM_ImageInit(&image);
+        PM_ImageAllocate(&image, width, height, PICOMEDIA_IMAGE_CHANNEL_FORMAT_UNKNOWN, PM__TestDataType(dataTypeIndex), channels);
+        PM_TestRandomFill(image.data, image.dataSize);
+        PM_Byte* original = (PM_Byte*)PM_Malloc(image.dataSize);
+        PM_Memcpy(original, image.data, image.dataSize);
+
+        PM_Bool result = PM_FALSE;
+        switch (operation)
+        {
+        case 0:  result = PM_ImageTransformsFlipHorizontal(&image); break;
+        case 1:  result = PM_ImageTransformsFlipVertical(&image); break;
+        case 2:  result = PM_ImageTransformsTranspose(&image); break;
+        case 3:  result = PM_ImageTransformsRotate90(&image); break;
+        case 4:  result = PM_ImageTransformsRotate180(&image); break;
+        default: result = PM_ImageTransformsRotate270(&image); break;
+        }
+
+        PM_Bool isSwapped = operation == 2 || operation == 3 || operation == 5;
+        PM_UInt32 newWidth = isSwapped ? height : width;
+        PM_UInt32 newHeight = isSwapped ? width : height;
+        PM_Size pixelSize = (PM_Size)channels * (image.bitsPerChannel / 8);
+        if (PM_TestCheck(result && image.width == newWidth && image.height == newHeight))
+        {
+            PM_Bool passed = PM_TRUE;
+            for (PM_UInt32 y = 0; y < height && passed; y++)
+            for (PM_UInt32 x = 0; x < width && passed; x++)
+            {
+                PM_UInt32 newX = x, newY = y;
+                switch (operation)
+                {
+                case 0:  newX = width - 1 - x; break;
+                case 1:  newY = height - 1 - y; break;
+                case 2:  newX = y; newY = x; break;
+                case 3:  newX = height - 1 - y; newY = x; break;
+                case 4:  newX = width - 1 - x; newY = height - 1 - y; break;
+                default: newX = y; newY = width - 1 - x; break;
+                }
+                passed = PM_Memcmp(image.data + ((PM_Size)newY * newWidth + newX) * pixelSize,
+                                   original + ((PM_Size)y * width + x) * pixelSize, pixelSize) == 0;
+            }
+            if (!PM_TestCheck(passed))
+                PM_LogInfo("Orientation %zu of a %ux%u image with %u channels of %s does not match", operation, width, height,
+                           channels, PM_ImageDataTypeToString(image.dataType));
+        }
+
+        PM_Free(original);
+        PM_ImageDestroy(&image);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------
+
+static PM_Float64 PM__TestFilter(PM_UInt32 filter, PM_Float64 x)
+{
+    x = fabs(x);
+    switch (filter)
+    {
+    case PICOMEDIA_IMAGE_RESIZE_FILTER_BOX:
+        return x < 0.5 ? 1.0 : 0.0;
+    case PICOMEDIA_IMAGE_RESIZE_FILTER_BILINEAR:
+        return x < 1.0 ? 1.0 - x : 0.0;
+    case PICOMEDIA_IMAGE_RESIZE_FILTER_BICUBIC:
+        if (x < 1.0)
+            return (1.5 * x - 2.5) * x * x + 1.0;
+        if (x < 2.0)
+            return ((-0.5 * x + 2.5) * x - 4.0) * x + 2.0;
+        return 0.0;
+    default:
+    {
+        if (x < 1e-9)
+            return 1.0;
+        if (x >= 3.0)
+            return 0.0;
+        PM_Float64 p = 3.14159265358979323846 * x;
+        return 3.0 * sin(p) * sin(p / 3.0) / (p * p);
+    }
+    }
+}
+
+static PM_Float64 PM__TestFilterSupport(PM_UInt32 filter)
+{
+    static const PM_Float64 supports[4] = { 0.5, 1.0, 2.0, 3.0 };
+    return supports[filter - PICOMEDIA_IMAGE_RESIZE_FILTER_BOX];
+}
+
+// Normalized weights of every source pixel for a destination pixel, the filter is stretched when downscaling
+static void PM__TestResizeWeights(PM_UInt32 filter, PM_UInt32 sourceSize, PM_UInt32 destSize, PM_UInt32 index, PM_Float64* weights)
+{
+    PM_Float64 scale = (PM_Float64)sourceSize / destSize;
+    PM_Float64 filterScale = PM_Max(scale, 1.0);
+    PM_Float64 support = PM__TestFilterSupport(filter) * filterScale;
+    PM_Float64 center = (index + 0.5) * scale;
+
+    PM_Float64 low = center - support + 0.5, high = center + support + 0.5;
+    PM_Int64 begin = low > 0.0 ? (PM_Int64)low : 0;
+    PM_Int64 end = high < sourceSize ? (PM_Int64)high : (PM_Int64)sourceSize;
+    begin = PM_Min(begin, (PM_Int64)sourceSize - 1);
+    end = PM_Max(end, begin + 1);
+
+    PM_Float64 sum = 0.0;
+    for (PM_Int64 j = 0; j < (PM_Int64)sourceSize; j++)
+    {
+        weights[j] = (j >= begin && j < end) ? PM__TestFilter(filter, (j + 0.5 - center) / filterScale) : 0.0;
+        sum += weights[j];
+    }
+    if (sum == 0.0)
+    {
+        weights[PM_Min((PM_Int64)center, (PM_Int64)sourceSize - 1)] = 1.0;
+        sum = 1.0;
+    }
+    for (PM_UInt32 j = 0; j < sourceSize; j++)
+        weights[j] /= sum;
+}
+
+static void PM__TestResize()
+{
+    static const PM_UInt32 channelFormats[5] = { 0, PICOMEDIA_IMAGE_CHANNEL_FORMAT_GRAY, PICOMEDIA_IMAGE_CHANNEL_FORMAT_GRAYA,
+                                                 PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGB, PICOMEDIA_IMAGE_CHANNEL_FORMAT_RGBA };
+
+    for (PM_Size dataTypeIndex = 0; dataTypeIndex < TEST_DATA_TYPE_COUNT; dataTypeIndex++)
+    for (PM_UInt32 filter = PICOMEDIA_IMAGE_RESIZE_FILTER_BOX; filter <= PICOMEDIA_IMAGE_RESIZE_FILTER_LANCZOS; filter++)
+    for (PM_UInt8 channels = 1; channels <= 4; channels++)
+    for (PM_Size trial = 0; trial < 5; trial++)
+    {
+        PM_UInt32 dataType = PM__TestDataType(dataTypeIndex);
+        PM_Float64 maximum = PM__testDataTypeMaximum[dataTypeIndex];
+        PM_UInt32 sourceWidth = 1 + (PM_UInt32)PM_TestRandomRange(60), sourceHeight = 1 + (PM_UInt32)PM_TestRandomRange(30);
+        PM_UInt32 destWidth = 1 + (PM_UInt32)PM_TestRandomRange(60), destHeight = 1 + (PM_UInt32)PM_TestRandomRange(30);
+        if (trial == 0)
+            sourceWidth = sourceHeight = 1;
+        else if (trial == 1)
+        {
+            destWidth = sourceWidth * 3 + 1;
+            destHeight = sourceHeight * 2;
+        }
+        else if (trial == 2)
+        {
+            destWidth = 1 + sourceWidth / 7;
+            destHeight = 1 + sourceHeight / 5;
+        }
+
+        PM_Image source, dest;
+        PM_ImageInit(&source);
+        PM_ImageInit(&dest);
+        PM_ImageAllocate(&source, sourceWidth, sourceHeight, channelFormats[channels], dataType, channels);
+
+        // the last trial is a flat image at the largest value, the non-negative filters must keep it flat up to 32-bit samples
+        PM_Bool isFlat = trial == 4;
+        PM_Size sampleCount = (PM_Size)sourceWidth * sourceHeight * channels;
+        for (PM_Size i = 0; i < sampleCount; i++)
+        {
+            PM_Float64 value = isFlat ? maximum : (PM_Float64)PM_TestRandomRange(1001) / 1000.0 * maximum;
+            switch (dataType)
+            {
+            case PICOIMEDIA_IMAGE_DATA_TYPE_UINT8:   ((PM_UInt8*)source.data)[i] = (PM_UInt8)value; break;
+            case PICOIMEDIA_IMAGE_DATA_TYPE_UINT16:  ((PM_UInt16*)source.data)[i] = (PM_UInt16)value; break;
+            case PICOIMEDIA_IMAGE_DATA_TYPE_UINT32:  ((PM_UInt32*)source.data)[i] = (PM_UInt32)value; break;
+            case PICOIMEDIA_IMAGE_DATA_TYPE_UINT64:  ((PM_UInt64*)source.data)[i] = isFlat ? 0xFFFFFFFFFFFFFFFFull : (PM_UInt64)(value / 2); break;
+            case PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT32: ((PM_Float32*)source.data)[i] = (PM_Float32)value; break;
+            default:                                 ((PM_Float64*)source.data)[i] = value; break;
+            }
+        }
+
+        if (!PM_TestCheck(PM_ImageTransformsResize(&dest, &source, destWidth, destHeight, filter)))
+        {
+            PM_ImageDestroy(&source);
+            continue;
+        }
+        PM_TestCheck(dest.width == destWidth && dest.height == destHeight && dest.numChannels == channels && dest.dataType == dataType);
+
+        PM_Float64* weightsX = (PM_Float64*)PM_Malloc(sizeof(PM_Float64) * sourceWidth * destWidth);
+        PM_Float64* weightsY = (PM_Float64*)PM_Malloc(sizeof(PM_Float64) * sourceHeight * destHeight);
+        for (PM_UInt32 x = 0; x < destWidth; x++)
+            PM__TestResizeWeights(filter, sourceWidth, destWidth, x, weightsX + (PM_Size)x * sourceWidth);
+        for (PM_UInt32 y = 0; y < destHeight; y++)
+            PM__TestResizeWeights(filter, sourceHeight, destHeight, y, weightsY + (PM_Size)y * sourceHeight);
+
+        // one step of rounding for the 8 and 16-bit results, which are computed in fixed point and single precision
+        PM_Float64 tolerance = 1e-9 * maximum;
+        if (dataType == PICOIMEDIA_IMAGE_DATA_TYPE_UINT8 || dataType == PICOIMEDIA_IMAGE_DATA_TYPE_UINT16)
+            tolerance = 1.01;
+        else if (dataType == PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT32)
+            tolerance = 1e-4;
+
+        PM_Bool passed = PM_TRUE;
+        for (PM_UInt32 y = 0; y < destHeight && passed; y++)
+        for (PM_UInt32 x = 0; x < destWidth && passed; x++)
+        for (PM_UInt8 c = 0; c < channels && passed; c++)
+        {
+            PM_Float64 expected = 0.0;
+            for (PM_UInt32 j = 0; j < sourceHeight; j++)
+            {
+                PM_Float64 weightY = weightsY[(PM_Size)y * sourceHeight + j];
+                if (weightY == 0.0)
+                    continue;
+                PM_Float64 row = 0.0;
+                for (PM_UInt32 i = 0; i < sourceWidth; i++)
+                {
+                    PM_Float64 weightX = weightsX[(PM_Size)x * sourceWidth + i];
+                    if (weightX != 0.0)
+                        row += weightX * PM__TestGetSample(source.data, dataType, ((PM_Size)j * sourceWidth + i) * channels + c);
+                }
+                // the 8-bit horizontal pass stores clamped intermediate rows
+                if (dataType == PICOIMEDIA_IMAGE_DATA_TYPE_UINT8)
+                    row = PM_Min(PM_Max(row, 0.0), maximum);
+                expected += weightY * row;
+            }
+            if (dataType < PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT32)
+                expected = PM_Min(PM_Max(expected, 0.0), maximum);
+
+            PM_Float64 result = PM__TestGetSample(dest.data, dataType, ((PM_Size)y * destWidth + x) * channels + c);
+            passed = fabs(result - expected) <= tolerance;
+            if (isFlat && filter <= PICOMEDIA_IMAGE_RESIZE_FILTER_BILINEAR && dataType <= PICOIMEDIA_IMAGE_DATA_TYPE_UINT32)
+                passed &= result == maximum;
+            if (!PM_TestCheck(passed))
+                PM_LogInfo("Resize %ux%u to %ux%u, filter %x, %s x%u: (%u, %u, %u) is %g, expected %g", sourceWidth, sourceHeight,
+                           destWidth, destHeight, filter, PM_ImageDataTypeToString(dataType), channels, x, y, c, result, expected);
+        }
+
+        PM_Free(weightsX);
+        PM_Free(weightsY);
+        PM_ImageDestroy(&source);
+        PM_ImageDestroy(&dest);
+    }
+}
+
+static void PM__TestDownscaleBox()
+{
+    for (PM_Size dataTypeIndex = 0; dataTypeIndex < TEST_DATA_TYPE_COUNT; dataTypeIndex++)
+    for (PM_UInt8 channels = 1; channels <= 4; channels++)
+    for (PM_Size trial = 0; trial < 8; trial++)
+    {
+        PM_UInt32 dataType = PM__TestDataType(dataTypeIndex);
+        PM_UInt32 sourceWidth = 1 + (PM_UInt32)PM_TestRandomRange(120), sourceHeight = 1 + (PM_UInt32)PM_TestRandomRange(60);
+        PM_UInt32 factor = 1u << PM_TestRandomRange(7);
+        if (trial == 7)
+        {
+            sourceWidth = 600;
+            sourceHeight = 300;
+            factor = 4;
+        }
+
+        PM_Image source, dest;
+        PM_ImageInit(&source);
+        PM_ImageInit(&dest);
+        PM_ImageAllocate(&source, sourceWidth, sourceHeight, PICOMEDIA_IMAGE_CHANNEL_FORMAT_UNKNOWN, dataType, channels);
+        PM__TestFillImage(&source);
+        // keep the 64-bit sums in range of the reference doubles
+        if (dataType == PICOIMEDIA_IMAGE_DATA_TYPE_UINT64)
+        {
+            for (PM_Size i = 0; i < (PM_Size)sourceWidth * sourceHeight * channels; i++)
+                ((PM_UInt64*)source.data)[i] >>= 12;
+        }
+
+        if (!PM_TestCheck(PM_ImageTransformsDownscaleBox(&dest, &source, factor)))
+        {
+            PM_ImageDestroy(&source);
+            continue;
+        }
+
+        PM_UInt32 destWidth = (sourceWidth + factor - 1) / factor, destHeight = (sourceHeight + factor - 1) / factor;
+        if (PM_TestCheck(dest.width == destWidth && dest.height == destHeight && dest.dataType == dataType))
+        {
+            PM_Float64 tolerance = 0.5001;
+            if (dataType == PICOIMEDIA_IMAGE_DATA_TYPE_UINT64)
+                tolerance = 1024.0;
+            else if (dataType == PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT32)
+                tolerance = 1e-6;
+            else if (dataType == PICOIMEDIA_IMAGE_DATA_TYPE_FLOAT64)
+                tolerance = 1e-9;
+
+            PM_Bool passed = PM_TRUE;
+            for (PM_UInt32 y = 0; y < destHeight && passed; y++)
+            for (PM_UInt32 x = 0; x < destWidth && passed; x++)
+            for (PM_UInt8 c = 0; c < channels && passed; c++)
+            {
+                PM_Float64 sum = 0.0;
+                PM_Size count = 0;
+                for (PM_UInt32 j = y * factor; j < sourceHeight && j < (y + 1) * factor; j++)
+                for (PM_UInt32 i = x * factor; i < sourceWidth && i < (x + 1) * factor; i++)
+                {
+                    sum += PM__TestGetSample(source.data, dataType, ((PM_Size)j * sourceWidth + i) * channels + c);
+                    count++;
+                }
+                PM_Float64 result = PM__TestGetSample(dest.data, dataType, ((PM_Size)y * destWidth + x) * channels + c);
+                passed = PM_TestCheck(fabs(result - sum / count) <= tolerance);
+            }
+        }
+
+        PM_ImageDestroy(&source);
+        PM_ImageDestroy(&dest);
+    }
+}
+
+int main(int argc, char** argv, char** envp)
+{
+    PM_LogInfo("Starting test for Image/Transforms");
+    PM_TestRandomSeed(15);
+
+    PM_LogInfo("Testing Image/Transforms/PM_ImageTransformsConvertSamples,PM_ImageTransformsChangeDataType");
+    PM__TestConvertSamples();
+
+    PM_LogInfo("Testing Image/Transforms/PM_ImageTransformsChangeChannelFormatEx");
+    PM__TestChangeChannelFormat();
+
+    PM_LogInfo("Testing Image/Transforms/PM_ImageTransformsFlip*,PM_ImageTransformsTranspose,PM_ImageTransformsRotate*");
+    PM__TestOrientation();
+
+    PM_LogInfo("Testing Image/Transforms/PM_ImageTransformsResize");
+    PM__TestResize();
+
+    PM_LogInfo("Testing Image/Transforms/PM_ImageTransformsDownscaleBox");
+    PM__TestDownscaleBox();
+
+    return PM_TestFinish("Image/Transforms");
+}
@@ -0,0 +1,181 @@
+#ifndef PICOMEDIA_TESTS_TEST_UTILS_H
+#define PICOMEDIA_TESTS_TEST_UTILS_H
+
+#include "libpicomedia/libpicomedia.h"
+
+/**
+ * @file test_utils.h
+ * @brief Small helpers shared by the tests, a failure counter, a deterministic random number generator and a PNG writer.
+ */
+
+/**
+ * @brief Checks a condition, logging the failed expression and counting it instead of stopping the test.
+ *
+ * PM_Assert can not be used for this as it breaks into the debugger, so a test would stop at its first failure.
+ */
+#define PM_TestCheck(condition) PM__TestCheck((condition) ? PM_TRUE : PM_FALSE, #condition, __FILE__, __LINE__)
+
+static PM_Size PM__testFailureCount = 0;
+static PM_UInt64 PM__testRandomState = 0x9E3779B97F4A7C15ull;
+
+static inline PM_Bool PM__TestCheck(PM_Bool passed, const PM_Char* condition, const PM_Char* file, PM_Int32 line)
+{
+    if (!passed)
+    {
+        PM_Log("Failed", "%s, file %s, line %d", condition, file, line);
+        PM__testFailureCount++;
+    }
+    return passed;
+}
+
+/**
+ * @brief Returns the exit code of a test, 0 if none of its checks failed.
+ */
+static inline int PM_TestFinish(const PM_Char* testName)
+{
+    if (PM__testFailureCount > 0)
+    {
+        PM_Log("Failed", "%zu check(s) failed in %s", PM__testFailureCount, testName);
+        return 1;
+    }
+
+    PM_LogInfo("Finished test for %s", testName);
+    return 0;
+}
+
+/**
+ * @brief Seeds the random number generator, so a test sees the same data on every run.
+ */
+static inline void PM_TestRandomSeed(PM_UInt64 seed)
+{
+    PM__testRandomState = seed ? seed : 0x9E3779B97F4A7C15ull;
+}
+
+/**
+ * @brief Returns the next value of a xorshift64* generator.
+ */
+static inline PM_UInt64 PM_TestRandom()
+{
+    PM__testRandomState ^= PM__testRandomState >> 12;
+    PM__testRandomState ^= PM__testRandomState << 25;
+    PM__testRandomState ^= PM__testRandomState >> 27;
+    return PM__testRandomState * 0x2545F4914F6CDD1Dull;
+}
+
+/**
+ * @brief Returns a random value in [0, count), count must not be 0.
+ */
+static inline PM_Size PM_TestRandomRange(PM_Size count)
+{
+    return (PM_Size)((PM_TestRandom() >> 11) % count);
+}
+
+/**
+ * @brief Fills a buffer with random bytes.
+ */
+static inline void PM_TestRandomFill(void* buffer, PM_Size size)
+{
+    PM_UInt8* bytes = (PM_UInt8*)buffer;
+    for (PM_Size i = 0; i < size; i++)
+        bytes[i] = (PM_UInt8)(PM_TestRandom() >> 56);
+}
+
+/**
+ * @brief A byte buffer written front to back, its capacity is up to the caller.
+ */
+typedef struct
+{
+    PM_UInt8* data;
+    PM_Size size;
+} PM_TestBuffer;
+
+static inline void PM_TestPut8(PM_TestBuffer* buffer, PM_UInt32 value)
+{
+    buffer->data[buffer->size++] = (PM_UInt8)value;
+}
+
+/**
+ * @brief Appends a big endian 32-bit value.
+ */
+static inline void PM_TestPut32(PM_TestBuffer* buffer, PM_UInt32 value)
+{
+    for (PM_Int32 shift = 24; shift >= 0; shift -= 8)
+        PM_TestPut8(buffer, value >> shift);
+}
+
+/**
+ * @brief Appends a PNG chunk, its length, type, data and CRC.
+ */
+static inline void PM_TestPutPNGChunk(PM_TestBuffer* buffer, const PM_Char* type, const PM_UInt8* data, PM_Size size)
+{
+    PM_TestPut32(buffer, (PM_UInt32)size);
+    PM_UInt8* crcStart = buffer->data + buffer->size;
+    for (PM_Size i = 0; i < 4; i++)
+        PM_TestPut8(buffer, (PM_UInt8)type[i]);
+    if (size > 0)
+        PM_Memcpy(buffer->data + buffer->size, data, size);
+    buffer->size += size;
+    PM_TestPut32(buffer, PM_CRC32(crcStart, size + 4, 0));
+}
+
+/**
+ * @brief Appends the PNG signature and the IHDR chunk.
+ */
+static inline void PM_TestPutPNGHeader(PM_TestBuffer* buffer, PM_UInt32 width, PM_UInt32 height, PM_UInt8 bitDepth, PM_UInt8 colorType,
+                                       PM_UInt8 interlaceMethod)
+{
+    static const PM_UInt8 signature[8] = { 0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A };
+    PM_Memcpy(buffer->data + buffer->size, signature, sizeof(signature));
+    buffer->size += sizeof(signature);
+
+    PM_UInt8 ihdr[13] = { 0 };
+    PM_TestBuffer ihdrBuffer = { ihdr, 0 };
+    PM_TestPut32(&ihdrBuffer, width);
+    PM_TestPut32(&ihdrBuffer, height);
+    ihdr[8] = bitDepth;
+    ihdr[9] = colorType;
+    ihdr[12] = interlaceMethod;
+    PM_TestPutPNGChunk(buffer, "IHDR", ihdr, sizeof(ihdr));
+}
+
+/**
+ * @brief Appends filtered scanlines as a zlib stream of stored blocks, split into IDAT chunks of random sizes.
+ */
+static inline void PM_TestPutPNGImageData(PM_TestBuffer* buffer, const PM_UInt8* data, PM_Size size)
+{
+    // blocks and chunks are at least 16 bytes but for the last ones, which bounds the size of their headers
+    PM_UInt8* zlib = (PM_UInt8*)PM_Malloc(size * 2 + 64);
+    PM_TestBuffer zlibBuffer = { zlib, 0 };
+    PM_TestPut8(&zlibBuffer, 0x78);
+    PM_TestPut8(&zlibBuffer, 0x01);
+
+    PM_Size position = 0;
+    do
+    {
+        PM_Size maxBlockSize = 16 + PM_TestRandomRange(PM_TestRandomRange(2) ? 65520 : 300);
+        PM_Size blockSize = PM_Min(size - position, maxBlockSize);
+        PM_Bool isFinal = position + blockSize == size;
+        PM_TestPut8(&zlibBuffer, isFinal ? 1 : 0);
+        PM_TestPut8(&zlibBuffer, (PM_UInt32)blockSize & 0xFF);
+        PM_TestPut8(&zlibBuffer, (PM_UInt32)blockSize >> 8);
+        PM_TestPut8(&zlibBuffer, ~(PM_UInt32)blockSize & 0xFF);
+        PM_TestPut8(&zlibBuffer, (~(PM_UInt32)blockSize >> 8) & 0xFF);
+        if (blockSize > 0)
+            PM_Memcpy(zlib + zlibBuffer.size, data + position, blockSize);
+        zlibBuffer.size += blockSize;
+        position += blockSize;
+    } while (position < size);
+    PM_TestPut32(&zlibBuffer, PM_Adler32(data, size, 1));
+
+    for (PM_Size offset = 0; offset < zlibBuffer.size; )
+    {
+        PM_Size maxChunkSize = 16 + PM_TestRandomRange(PM_TestRandomRange(2) ? 100000 : 50);
+        PM_Size chunkSize = PM_Min(zlibBuffer.size - offset, maxChunkSize);
+        PM_TestPutPNGChunk(buffer, "IDAT", zlib + offset, chunkSize);
+        offset += chunkSize;
+    }
+
+    PM_Free(zlib);
+}
+
+#endif // PICOMEDIA_TESTS_TEST_UTILS_H